@@ -22,19 +22,61 @@
 
 using namespace std;
 
+#include <atomic>
+#include <chrono>
 #include <cmath>
+#include <cstddef>
+#include <cstdio>
 #include <cstdlib>
+#include <cstring>
 #include <exception>
+#include <fstream>
+#include <iomanip>
 #include <iostream>
+#include <iterator>
 #include <string>
+#include <thread>
 #include <time.h>
+#include <unordered_map>
+#include <vector>
 #include "phasor.h"
+#include "internedString.h"
 #include "instantaneousMeasurement.h"
+#include "waveform.h"
 #include "parameter.h"
+#include "sampleArena.h"
+#include "phasorEstimator.h"
 #include "nodeSample.h"
 #include "lineSample.h"
 #include "distanceSample.h"
 #include "knnPredictionOfUnknownLineSample.h"
+#include "knnBatchPredictionOfUnknownLineSamples.h"
+#include "lineFeatureMatrix.h"
+#include "distanceKernel.h"
+#include "threadPool.h"
+#include "kdTreeIndex.h"
+#include "ivfIndex.h"
+#include "compactFeatureIndex.h"
+#include "trainingSetCondenser.h"
+#include "knnTuningResult.h"
+#include "knnTuner.h"
+#include "gridSnapshot.h"
+#include "lineModelRegistry.h"
+#include "trainingSetFile.h"
+#include "nodeCsvReader.h"
+#include "allocationCounter.h"
+#include "onlineTrainingStore.h"
+#include "knnPredictionResult.h"
+#include "knnQueryEngine.h"
+#include "gpuFeatureMatrix.h"
+#include "gpuBatchPredictionOfUnknownLineSamples.h"
+#include "nodeCapture.h"
+#include "pipelineItem.h"
+#include "boundedQueue.h"
+#include "ingestPipeline.h"
+#include "latencyHistogram.h"
+#include "knnInstrumentationSnapshot.h"
+#include "knnInstrumentation.h"
 
 
 /// <summary>
@@ -171,8 +213,82 @@ void TestZeroToNonPositivePowerExceptionFreeMemory(phasor* ph, phasor* pexp)
 }
 
 
-void TestParameterPhasorCalcAccuracyMemoryAllocationFailure(string, phasor*, instantaneousMeasurement*, parameter*, phasor*);
-void TestParameterPhasorCalcAccuracyFreeMemory(phasor*, instantaneousMeasurement*, parameter*, phasor*);
+/// <summary>
+/// Stream the samples of a reference phasor with a third harmonic through phasorEstimator one at a time and compare the phasor of
+/// each reporting interval to the reference phasor.
+/// </summary>
+/// <param name="samplesPerSecond">The sample rate of the feed</param>
+/// <param name="totalSamplingTime">The length of the feed in seconds</param>
+/// <param name="percentThirdHarmonic">The amplitude of the third harmonic as a percentage of the peak</param>
+void TestPhasorEstimatorClass(int samplesPerSecond = 7680, double totalSamplingTime = 1, double percentThirdHarmonic = 5)
+{
+    double frequency = 60;  // sine wave frequency in Hz
+    int numOfSamples = (int)((double)samplesPerSecond * totalSamplingTime);
+    phasor referencePhasor = phasor(120, 30);
+    double amplitude = sqrt(2) * referencePhasor.RMSvalue();
+    double angleOffset = M_PI / 180 * referencePhasor.PhaseAngleDegrees();
+
+    phasorEstimator estimator(samplesPerSecond, frequency);
+    double worstPercentError = 0;
+    for (int sampleIndex = 0; sampleIndex < numOfSamples; sampleIndex++) {
+        double timeStamp = (double)sampleIndex / (double)samplesPerSecond;
+        double harmonic = amplitude * percentThirdHarmonic / 100 * sin(3 * 2 * M_PI * frequency * timeStamp);
+        if (estimator.AddSample(amplitude * sin(2 * M_PI * frequency * timeStamp + angleOffset) + harmonic) == true) {
+            double percentError = 100 * (referencePhasor - estimator.Phasor).RMSvalue() / referencePhasor.RMSvalue();
+            if (percentError > worstPercentError) worstPercentError = percentError;
+        }
+    }
+
+    cout << "\nStreaming Phasor Estimator (" << to_string(estimator.SamplesPerReport()) << " samples per report):\n";
+    cout << "Reports: " << to_string(estimator.NumberOfReports) << "\n";
+    cout << "Last Phasor: " << estimator.Phasor.PhasorToString() << "\n";
+    cout << "Reference Phasor: " << referencePhasor.PhasorToString() << "\n";
+    cout << "The worst percent error is " << worstPercentError << "\n";
+}
+
+
+/// <summary>
+/// Store the samples of a reference phasor as a waveform in each storage format, calculate the phasor of a parameter reading the
+/// waveform in place, and compare the memory and the percent error with the array of instantaneous measurements.
+/// </summary>
+void TestWaveformClass()
+{
+    int samplesPerSecond = 32000;
+    double totalSamplingTime = 1;
+    double frequency = 60;  // sine wave frequency in Hz
+    int numOfSamples = (int)((double)samplesPerSecond * totalSamplingTime);
+    phasor referencePhasor = phasor(120, 30);
+
+    instantaneousMeasurement* samples = new instantaneousMeasurement[numOfSamples];
+    if (samples == NULL) {
+        cout << "Error: TestWaveformClass() failed to allocate memory for samples.\n";
+        return;
+    }
+    for (int sampleIndex = 0; sampleIndex < numOfSamples; sampleIndex++) {
+        samples[sampleIndex].timeStamp = (double)sampleIndex / (double)samplesPerSecond;
+        samples[sampleIndex].value = sqrt(2) * referencePhasor.RMSvalue() *
+            sin(2 * M_PI * frequency * samples[sampleIndex].timeStamp + M_PI / 180 * referencePhasor.PhaseAngleDegrees());
+    }
+
+    cout << "\nWaveform Storage (" << to_string(numOfSamples) << " samples, " <<
+        to_string(sizeof(instantaneousMeasurement) * numOfSamples) << " bytes as instantaneous measurements):\n";
+    waveformStorage storages[3] = { waveformStorage::Float64, waveformStorage::Float32, waveformStorage::Int16 };
+    string storageNames[3] = { "float64", "float32", "int16" };
+    for (int storageIndex = 0; storageIndex < 3; storageIndex++) {
+        waveform channel(samples, numOfSamples, storages[storageIndex]);
+        parameter testParameter(&channel, "V1", "V", 1, 0);
+        double percentError = 100 * (referencePhasor - testParameter.Phasor).RMSvalue() / referencePhasor.RMSvalue();
+        cout << storageNames[storageIndex] << ": " << to_string(channel.MemoryBytes()) << " bytes, uniform = " <<
+            to_string(channel.IsUniform()) << ", phasor = " << testParameter.Phasor.PhasorToString() << ", percent error = " <<
+            percentError << "\n";
+    }
+
+    delete[] samples;
+}
+
+
+void TestParameterPhasorCalcAccuracyMemoryAllocationFailure(string, phasor*, parameter*, phasor*);
+void TestParameterPhasorCalcAccuracyFreeMemory(phasor*, parameter*, phasor*);
 /// <summary>
 /// This will test the accuracy of the parameter class's phasor calculation by creating sample points from a reference phasor and
 /// the phasor calculated will be compared to the reference phasor. 
@@ -185,39 +301,33 @@ void TestParameterPhasorCalcAccuracy()
     int numOfSamples = (int)((double)samplesPerSecond * totalSamplingTime);
 
     phasor* referencePhasor = NULL;
-    instantaneousMeasurement* samples = NULL;
     parameter* testParameter = NULL;
     phasor* difference = NULL;
 
     referencePhasor = new phasor(120, 30);
     if (referencePhasor == NULL) {
-        TestParameterPhasorCalcAccuracyMemoryAllocationFailure("referencePhasor", referencePhasor, samples, testParameter, difference);
+        TestParameterPhasorCalcAccuracyMemoryAllocationFailure("referencePhasor", referencePhasor, testParameter, difference);
         return;
     }
 
-    // Create the array of samples
-    samples = new instantaneousMeasurement[numOfSamples];
-    if (samples == NULL) {
-        TestParameterPhasorCalcAccuracyMemoryAllocationFailure("samples", referencePhasor, samples, testParameter, difference);
-        return;
-    }
+    // Create the samples
+    vector<instantaneousMeasurement> samples(numOfSamples);
     for (int sampleIndex = 0; sampleIndex < numOfSamples; sampleIndex++) {
         samples[sampleIndex].timeStamp = (double)sampleIndex / (double)samplesPerSecond;
 
         // samples[sampleIndex].value = A * sin(wt + theta)
         double timeDependentAngle = 2 * M_PI * frequency * samples[sampleIndex].timeStamp;
-        double Amplitude = sqrt(2) * referencePhasor->RMSvalue;
-        double angleOffset = M_PI / 180 * referencePhasor->PhaseAngleDegrees;
+        double Amplitude = sqrt(2) * referencePhasor->RMSvalue();
+        double angleOffset = M_PI / 180 * referencePhasor->PhaseAngleDegrees();
         samples[sampleIndex].value = Amplitude * sin(timeDependentAngle + angleOffset);
     }
 
-    // Allocate the test parameter
-    testParameter = new parameter(samples, numOfSamples, "V1", "V", 1, 0);
+    // Allocate the test parameter, which takes the samples without copying them
+    testParameter = new parameter(move(samples), "V1", "V", 1, 0);
     if (testParameter == NULL) {
-        TestParameterPhasorCalcAccuracyMemoryAllocationFailure("testParameter", referencePhasor, samples, testParameter, difference);
+        TestParameterPhasorCalcAccuracyMemoryAllocationFailure("testParameter", referencePhasor, testParameter, difference);
         return;
     }
-    samples = NULL;
 
     // Print the test parameter, the calculated phasor, and the reference phasor
     testParameter->PrintParameter();
@@ -227,29 +337,33 @@ void TestParameterPhasorCalcAccuracy()
     // Calculate and print the percent error
     difference = new phasor();
     if (difference == NULL) {
-        TestParameterPhasorCalcAccuracyMemoryAllocationFailure("difference", referencePhasor, samples, testParameter, difference);
+        TestParameterPhasorCalcAccuracyMemoryAllocationFailure("difference", referencePhasor, testParameter, difference);
         return;
     }
     *difference = *referencePhasor - testParameter->Phasor;
-    double percentError = 100 * difference->RMSvalue / referencePhasor->RMSvalue;
+    double percentError = 100 * difference->RMSvalue() / referencePhasor->RMSvalue();
     cout << "The percent error is " << percentError << "\n";
 
-    TestParameterPhasorCalcAccuracyFreeMemory(referencePhasor, samples, testParameter, difference);
+    // Moving takes the samples along, so the moved-from parameter reports none
+    parameter movedParameter = move(*testParameter);
+    cout << "Samples after moving the parameter: " << movedParameter.NumberOfSamples() << " moved, " <<
+        testParameter->NumberOfSamples() << " left\n";
+
+    TestParameterPhasorCalcAccuracyFreeMemory(referencePhasor, testParameter, difference);
 }
 /// <summary>
 /// Display an error message when the method TestParameterPhasorCalcAccuracy() fails to allocate memory for a variable.
 /// </summary>
-void TestParameterPhasorCalcAccuracyMemoryAllocationFailure(string variableName, phasor* referencePhasor,
-    instantaneousMeasurement* samples, parameter* testParameter, phasor* difference)
+void TestParameterPhasorCalcAccuracyMemoryAllocationFailure(string variableName, phasor* referencePhasor, parameter* testParameter,
+    phasor* difference)
 {
     cout << "Error: TestParameterPhasorCalcAccuracyFreeMemory() failed to allocate memory for " << variableName << "\n";
-    TestParameterPhasorCalcAccuracyFreeMemory(referencePhasor, samples, testParameter, difference);
+    TestParameterPhasorCalcAccuracyFreeMemory(referencePhasor, testParameter, difference);
 }
 /// <summary>
 /// Free allocated memory for the method TestParameterPhasorCalcAccuracy()
 /// </summary>
-void TestParameterPhasorCalcAccuracyFreeMemory(phasor* referencePhasor, instantaneousMeasurement* samples, parameter* testParameter,
-    phasor* difference)
+void TestParameterPhasorCalcAccuracyFreeMemory(phasor* referencePhasor, parameter* testParameter, phasor* difference)
 {
     if (referencePhasor != NULL) {
         delete referencePhasor;
@@ -259,10 +373,6 @@ void TestParameterPhasorCalcAccuracyFreeMemory(phasor* referencePhasor, instanta
         delete testParameter;
         testParameter = NULL;
     }
-    if (samples != NULL) {
-        delete samples;
-        samples = NULL;
-    }
     if (difference != NULL) {
         delete difference;
         difference = NULL;
@@ -728,15 +838,15 @@ shared_ptr<nodeSample> TestKnnClassRandomNodeSample(int nodeNumber, phasor avera
     phasor* currents = NULL;
     shared_ptr<nodeSample> node = NULL;
 
-    phasor voltage = phasor(RandomDouble(0.9 * averageVoltage.RMSvalue, 1.1 * averageVoltage.RMSvalue),
-        averageVoltage.PhaseAngleDegrees);
+    phasor voltage = phasor(RandomDouble(0.9 * averageVoltage.RMSvalue(), 1.1 * averageVoltage.RMSvalue()),
+        averageVoltage.PhaseAngleDegrees());
 
     currents = new phasor[numberOfCurrents];
     if (currents == NULL) return NULL;
     for (int currentIndex = 0; currentIndex < numberOfCurrents; currentIndex++) {
         currents[currentIndex] =
-            phasor(RandomDouble(0.9 * averageCurrents[currentIndex].RMSvalue, 1.1 * averageCurrents[currentIndex].RMSvalue),
-                averageCurrents[currentIndex].PhaseAngleDegrees);
+            phasor(RandomDouble(0.9 * averageCurrents[currentIndex].RMSvalue(), 1.1 * averageCurrents[currentIndex].RMSvalue()),
+                averageCurrents[currentIndex].PhaseAngleDegrees());
     }
 
     node = shared_ptr<nodeSample>(new nodeSample(nodeNumber, voltage, currents, currentDestinationNodes, numberOfCurrents));
@@ -815,13 +925,1799 @@ void TestKnnClassFreeMemory(
 }
 
 
+lineSample* TestKnnClassRandomLineSample(bool, int node1Number = 1, int node2Number = 2);
+void TestKnnClassFreeLineSamples(lineSample**, int);
+/// <summary>
+/// Create a set of known line samples and a set of unknown line samples, predict the unknown statuses with the batch predictor,
+/// and compare the predictions with knnPredictionOfUnknownLineSample and with the actual statuses.
+/// </summary>
+/// <param name="numberOfSamplesWithKnownStatuses">The number of samples with known line statuses</param>
+/// <param name="numberOfSamplesWithUnknownStatuses">The number of samples with unknown line statuses</param>
+/// <param name="numberOfNearestNeighbors">The number of nearest neighbors the unknown line statuses are compared to</param>
+/// <param name="percentOfFailureCases">The percentage of the samples that have the line failing</param>
+void TestKnnBatchClass(int numberOfSamplesWithKnownStatuses = 100, int numberOfSamplesWithUnknownStatuses = 50,
+    int numberOfNearestNeighbors = 5, double percentOfFailureCases = 20)
+{
+    lineSample** samplesWithKnownStatuses = new lineSample*[numberOfSamplesWithKnownStatuses];
+    lineSample** samplesWithUnknownStatuses = new lineSample*[numberOfSamplesWithUnknownStatuses];
+    if ((samplesWithKnownStatuses == NULL) || (samplesWithUnknownStatuses == NULL)) {
+        cout << "Error: TestKnnBatchClass() failed to allocate memory for the line samples.\n";
+        if (samplesWithKnownStatuses != NULL) delete[] samplesWithKnownStatuses;
+        if (samplesWithUnknownStatuses != NULL) delete[] samplesWithUnknownStatuses;
+        return;
+    }
+
+    int numberOfNotWorkingSamples = (int)((double)numberOfSamplesWithKnownStatuses * percentOfFailureCases) / 100;
+    for (int sampleIndex = 0; sampleIndex < numberOfSamplesWithKnownStatuses; sampleIndex++) {
+        samplesWithKnownStatuses[sampleIndex] =
+            TestKnnClassRandomLineSample(sampleIndex >= numberOfSamplesWithKnownStatuses - numberOfNotWorkingSamples);
+    }
+    for (int sampleIndex = 0; sampleIndex < numberOfSamplesWithUnknownStatuses; sampleIndex++) {
+        samplesWithUnknownStatuses[sampleIndex] = TestKnnClassRandomLineSample(RandomDouble(0, 100) < percentOfFailureCases);
+    }
+
+    knnBatchPredictionOfUnknownLineSamples testBatchKNN(samplesWithKnownStatuses, numberOfSamplesWithKnownStatuses,
+        numberOfNearestNeighbors);
+    vector<bool> predictedStatuses = testBatchKNN.PredictStatuses(samplesWithUnknownStatuses, numberOfSamplesWithUnknownStatuses);
+
+    int numberOfMatchingPredictions = 0;
+    int numberOfCorrectPredictions = 0;
+    for (int sampleIndex = 0; sampleIndex < (int)predictedStatuses.size(); sampleIndex++) {
+        knnPredictionOfUnknownLineSample singleKNN(samplesWithKnownStatuses, numberOfSamplesWithKnownStatuses,
+            samplesWithUnknownStatuses[sampleIndex], numberOfNearestNeighbors);
+        if (singleKNN.PredictedStatus == predictedStatuses[sampleIndex]) numberOfMatchingPredictions++;
+        if (samplesWithUnknownStatuses[sampleIndex]->IsWorking == predictedStatuses[sampleIndex]) numberOfCorrectPredictions++;
+    }
+    cout << "\nBatch KNN Algorithm:\n";
+    cout << "Predictions matching knnPredictionOfUnknownLineSample: " << to_string(numberOfMatchingPredictions) << "/" <<
+        to_string(numberOfSamplesWithUnknownStatuses) << "\n";
+    cout << "Correct predictions: " << to_string(numberOfCorrectPredictions) << "/" <<
+        to_string(numberOfSamplesWithUnknownStatuses) << "\n";
+
+    TestKnnClassFreeLineSamples(samplesWithKnownStatuses, numberOfSamplesWithKnownStatuses);
+    TestKnnClassFreeLineSamples(samplesWithUnknownStatuses, numberOfSamplesWithUnknownStatuses);
+}
+/// <summary>
+/// Generate a line sample between two nodes with the same average phasors TestKnnClass() uses.
+/// </summary>
+/// <param name="isFailing">True if the line sample should be of the line failing</param>
+/// <param name="node1Number">The number of the first node of the line</param>
+/// <param name="node2Number">The number of the second node of the line</param>
+/// <returns>The line sample or NULL if the memory allocation failed</returns>
+lineSample* TestKnnClassRandomLineSample(bool isFailing, int node1Number, int node2Number)
+{
+    phasor node1AverageCurrentPhasors[2] = { phasor(25, -165), phasor(25, 15) };
+    phasor node2AverageCurrentPhasors[2] = { phasor(25, 15), phasor(25, -165) };
+    phasor node1AverageVoltagePhasor = phasor(250000, 15);
+    phasor node2AverageVoltagePhasor = phasor(250000, 15);
+    if (isFailing == true) {
+        node1AverageCurrentPhasors[0] = phasor(250, -135);
+        node1AverageCurrentPhasors[1] = phasor(250, 45);
+        node2AverageCurrentPhasors[0] = phasor(250, 45);
+        node2AverageCurrentPhasors[1] = phasor(250, -135);
+        node1AverageVoltagePhasor = phasor(50000, 90);
+        node2AverageVoltagePhasor = phasor(50000, 90);
+    }
+    int node1CurrentDestinationNodes[2] = { 0, node2Number };
+    int node2CurrentDestinationNodes[2] = { 0, node1Number };
+
+    shared_ptr<nodeSample> node1 = TestKnnClassRandomNodeSample(node1Number, node1AverageVoltagePhasor, node1AverageCurrentPhasors,
+        node1CurrentDestinationNodes, 2);
+    shared_ptr<nodeSample> node2 = TestKnnClassRandomNodeSample(node2Number, node2AverageVoltagePhasor, node2AverageCurrentPhasors,
+        node2CurrentDestinationNodes, 2);
+    if ((node1 == NULL) || (node2 == NULL)) return NULL;
+
+    return new lineSample(node1, node2, !isFailing);
+}
+/// <summary>
+/// Free an array of line samples created for the KNN tests.
+/// </summary>
+/// <param name="lineSamples">The array of line samples</param>
+/// <param name="numberOfLineSamples">The number of elements in the lineSamples array</param>
+void TestKnnClassFreeLineSamples(lineSample** lineSamples, int numberOfLineSamples)
+{
+    if (lineSamples != NULL) {
+        for (int deletingIndex = 0; deletingIndex < numberOfLineSamples; deletingIndex++) {
+            if (lineSamples[deletingIndex] != NULL) {
+                delete lineSamples[deletingIndex];
+                lineSamples[deletingIndex] = NULL;
+            }
+        }
+        delete[] lineSamples;
+        lineSamples = NULL;
+    }
+}
+
+
+/// <summary>
+/// Predict a set of unknown line samples with and without a thread pool and check the parallel scan gives the same predictions.
+/// </summary>
+/// <param name="numberOfSamplesWithKnownStatuses">The number of samples with known line statuses</param>
+/// <param name="numberOfSamplesWithUnknownStatuses">The number of samples with unknown line statuses</param>
+/// <param name="numberOfThreads">The number of threads in the thread pool</param>
+/// <param name="percentOfFailureCases">The percentage of the samples that have the line failing</param>
+void TestKnnParallelClass(int numberOfSamplesWithKnownStatuses = 5000, int numberOfSamplesWithUnknownStatuses = 20,
+    int numberOfThreads = 4, double percentOfFailureCases = 20)
+{
+    lineSample** samplesWithKnownStatuses = new lineSample*[numberOfSamplesWithKnownStatuses];
+    if (samplesWithKnownStatuses == NULL) {
+        cout << "Error: TestKnnParallelClass() failed to allocate memory for samplesWithKnownStatuses.\n";
+        return;
+    }
+    int numberOfNotWorkingSamples = (int)((double)numberOfSamplesWithKnownStatuses * percentOfFailureCases) / 100;
+    for (int sampleIndex = 0; sampleIndex < numberOfSamplesWithKnownStatuses; sampleIndex++) {
+        samplesWithKnownStatuses[sampleIndex] =
+            TestKnnClassRandomLineSample(sampleIndex >= numberOfSamplesWithKnownStatuses - numberOfNotWorkingSamples);
+    }
+
+    lineFeatureMatrix knownFeatures(samplesWithKnownStatuses, numberOfSamplesWithKnownStatuses);
+    threadPool pool(numberOfThreads);
+    int numberOfMatchingPredictions = 0;
+    for (int sampleIndex = 0; sampleIndex < numberOfSamplesWithUnknownStatuses; sampleIndex++) {
+        lineSample* sampleWithUnknownStatus = TestKnnClassRandomLineSample(RandomDouble(0, 100) < percentOfFailureCases);
+        if (sampleWithUnknownStatus == NULL) continue;
+
+        knnPredictionOfUnknownLineSample serialKNN(&knownFeatures, sampleWithUnknownStatus);
+        knnPredictionOfUnknownLineSample parallelKNN(&knownFeatures, sampleWithUnknownStatus, 5, &pool);
+        if (serialKNN.PredictedStatus == parallelKNN.PredictedStatus) numberOfMatchingPredictions++;
+        delete sampleWithUnknownStatus;
+    }
+    cout << "\nParallel KNN Algorithm (" << to_string(pool.NumberOfThreads()) << " threads):\n";
+    cout << "Predictions matching the serial scan: " << to_string(numberOfMatchingPredictions) << "/" <<
+        to_string(numberOfSamplesWithUnknownStatuses) << "\n";
+
+    TestKnnClassFreeLineSamples(samplesWithKnownStatuses, numberOfSamplesWithKnownStatuses);
+}
+
+
+/// <summary>
+/// Predict a set of unknown line samples with a KD-tree index and with the brute force scan and compare the predictions, then
+/// again after the weights of the feature matrix change under the tree.
+/// </summary>
+/// <param name="numberOfSamplesWithKnownStatuses">The number of samples with known line statuses</param>
+/// <param name="numberOfSamplesWithUnknownStatuses">The number of samples with unknown line statuses</param>
+/// <param name="percentOfFailureCases">The percentage of the samples that have the line failing</param>
+void TestKdTreeClass(int numberOfSamplesWithKnownStatuses = 2000, int numberOfSamplesWithUnknownStatuses = 20,
+    double percentOfFailureCases = 20)
+{
+    lineSample** samplesWithKnownStatuses = new lineSample*[numberOfSamplesWithKnownStatuses];
+    if (samplesWithKnownStatuses == NULL) {
+        cout << "Error: TestKdTreeClass() failed to allocate memory for samplesWithKnownStatuses.\n";
+        return;
+    }
+    int numberOfNotWorkingSamples = (int)((double)numberOfSamplesWithKnownStatuses * percentOfFailureCases) / 100;
+    for (int sampleIndex = 0; sampleIndex < numberOfSamplesWithKnownStatuses; sampleIndex++) {
+        samplesWithKnownStatuses[sampleIndex] =
+            TestKnnClassRandomLineSample(sampleIndex >= numberOfSamplesWithKnownStatuses - numberOfNotWorkingSamples);
+    }
+
+    lineFeatureMatrix knownFeatures(samplesWithKnownStatuses, numberOfSamplesWithKnownStatuses);
+    kdTreeIndex tree(&knownFeatures);
+    cout << "\nKD-tree KNN Algorithm (" << to_string(tree.NumberOfNodes()) << " nodes):\n";
+    for (int passIndex = 0; passIndex < 2; passIndex++) {
+        // The second pass reweights the matrix the tree was built over, which leaves the tree stale
+        if (passIndex == 1) knownFeatures.SetWeights(distanceWeights(1, 4, 20));
+
+        int numberOfMatchingPredictions = 0;
+        int numberOfMatchingNeighbors = 0;
+        for (int sampleIndex = 0; sampleIndex < numberOfSamplesWithUnknownStatuses; sampleIndex++) {
+            lineSample* sampleWithUnknownStatus = TestKnnClassRandomLineSample(RandomDouble(0, 100) < percentOfFailureCases);
+            if (sampleWithUnknownStatus == NULL) continue;
+
+            knnPredictionOfUnknownLineSample bruteForceKNN(&knownFeatures, sampleWithUnknownStatus);
+            knnPredictionOfUnknownLineSample treeKNN(&tree, sampleWithUnknownStatus);
+            if (bruteForceKNN.PredictedStatus == treeKNN.PredictedStatus) numberOfMatchingPredictions++;
+            if (bruteForceKNN.Result().NeighborIndices == treeKNN.Result().NeighborIndices) numberOfMatchingNeighbors++;
+            delete sampleWithUnknownStatus;
+        }
+        cout << (passIndex == 0 ? "Built weights" : "After SetWeights()") << " (stale: " << (tree.IsStale() ? "yes" : "no") <<
+            "): predictions matching the brute force scan " << to_string(numberOfMatchingPredictions) << "/" <<
+            to_string(numberOfSamplesWithUnknownStatuses) << ", nearest neighbors " << to_string(numberOfMatchingNeighbors) << "/" <<
+            to_string(numberOfSamplesWithUnknownStatuses) << "\n";
+    }
+
+    TestKnnClassFreeLineSamples(samplesWithKnownStatuses, numberOfSamplesWithKnownStatuses);
+}
+
+
+/// <summary>
+/// Measure the recall of an IVF index for an increasing number of probed lists and compare its predictions with the brute force
+/// scan.
+/// </summary>
+/// <param name="numberOfSamplesWithKnownStatuses">The number of samples with known line statuses</param>
+/// <param name="numberOfSamplesWithUnknownStatuses">The number of samples with unknown line statuses</param>
+/// <param name="percentOfFailureCases">The percentage of the samples that have the line failing</param>
+void TestIvfClass(int numberOfSamplesWithKnownStatuses = 5000, int numberOfSamplesWithUnknownStatuses = 50,
+    double percentOfFailureCases = 20)
+{
+    lineSample** samplesWithKnownStatuses = new lineSample*[numberOfSamplesWithKnownStatuses];
+    lineSample** samplesWithUnknownStatuses = new lineSample*[numberOfSamplesWithUnknownStatuses];
+    if ((samplesWithKnownStatuses == NULL) || (samplesWithUnknownStatuses == NULL)) {
+        cout << "Error: TestIvfClass() failed to allocate memory for the line samples.\n";
+        if (samplesWithKnownStatuses != NULL) delete[] samplesWithKnownStatuses;
+        if (samplesWithUnknownStatuses != NULL) delete[] samplesWithUnknownStatuses;
+        return;
+    }
+    int numberOfNotWorkingSamples = (int)((double)numberOfSamplesWithKnownStatuses * percentOfFailureCases) / 100;
+    for (int sampleIndex = 0; sampleIndex < numberOfSamplesWithKnownStatuses; sampleIndex++) {
+        samplesWithKnownStatuses[sampleIndex] =
+            TestKnnClassRandomLineSample(sampleIndex >= numberOfSamplesWithKnownStatuses - numberOfNotWorkingSamples);
+    }
+    for (int sampleIndex = 0; sampleIndex < numberOfSamplesWithUnknownStatuses; sampleIndex++) {
+        samplesWithUnknownStatuses[sampleIndex] = TestKnnClassRandomLineSample(RandomDouble(0, 100) < percentOfFailureCases);
+    }
+
+    lineFeatureMatrix knownFeatures(samplesWithKnownStatuses, numberOfSamplesWithKnownStatuses);
+    ivfIndex ivf(&knownFeatures);
+    cout << "\nIVF KNN Algorithm (" << to_string(ivf.NumberOfLists()) << " lists):\n";
+    for (int numberOfProbes = 1; numberOfProbes <= 8; numberOfProbes *= 2) {
+        ivf.NumberOfProbes = numberOfProbes;
+        int numberOfMatchingPredictions = 0;
+        for (int sampleIndex = 0; sampleIndex < numberOfSamplesWithUnknownStatuses; sampleIndex++) {
+            knnPredictionOfUnknownLineSample bruteForceKNN(&knownFeatures, samplesWithUnknownStatuses[sampleIndex]);
+            knnPredictionOfUnknownLineSample ivfKNN(&ivf, samplesWithUnknownStatuses[sampleIndex]);
+            if (bruteForceKNN.PredictedStatus == ivfKNN.PredictedStatus) numberOfMatchingPredictions++;
+        }
+        cout << to_string(numberOfProbes) << " probes: recall = " <<
+            to_string(ivf.MeasureRecall(samplesWithUnknownStatuses, numberOfSamplesWithUnknownStatuses, 5)) <<
+            ", predictions matching the brute force scan: " << to_string(numberOfMatchingPredictions) << "/" <<
+            to_string(numberOfSamplesWithUnknownStatuses) << "\n";
+    }
+
+    TestKnnClassFreeLineSamples(samplesWithKnownStatuses, numberOfSamplesWithKnownStatuses);
+    TestKnnClassFreeLineSamples(samplesWithUnknownStatuses, numberOfSamplesWithUnknownStatuses);
+}
+
+
+/// <summary>
+/// Register the known line samples of several lines in one registry, predict a snapshot of every line in parallel, and compare
+/// the predictions with knnPredictionOfUnknownLineSample on each line's own line samples.
+/// </summary>
+/// <param name="numberOfLines">The number of lines in the grid</param>
+/// <param name="numberOfSamplesPerLine">The number of samples with known line statuses per line</param>
+/// <param name="numberOfThreads">The number of threads in the thread pool</param>
+/// <param name="percentOfFailureCases">The percentage of the samples that have the line failing</param>
+void TestLineModelRegistryClass(int numberOfLines = 20, int numberOfSamplesPerLine = 200, int numberOfThreads = 4,
+    double percentOfFailureCases = 20)
+{
+    int numberOfSamplesWithKnownStatuses = numberOfLines * numberOfSamplesPerLine;
+    lineSample** samplesWithKnownStatuses = new lineSample*[numberOfSamplesWithKnownStatuses];
+    lineSample** samplesOfOneLine = new lineSample*[numberOfSamplesPerLine];
+    lineSample** snapshot = new lineSample*[numberOfLines];
+    if ((samplesWithKnownStatuses == NULL) || (samplesOfOneLine == NULL) || (snapshot == NULL)) {
+        cout << "Error: TestLineModelRegistryClass() failed to allocate memory for the line samples.\n";
+        if (samplesWithKnownStatuses != NULL) delete[] samplesWithKnownStatuses;
+        if (samplesOfOneLine != NULL) delete[] samplesOfOneLine;
+        if (snapshot != NULL) delete[] snapshot;
+        return;
+    }
+
+    // The lines are interleaved so the registry has to group them, and line l connects nodes 2l + 1 and 2l + 2
+    for (int sampleIndex = 0; sampleIndex < numberOfSamplesWithKnownStatuses; sampleIndex++) {
+        int lineIndex = sampleIndex % numberOfLines;
+        samplesWithKnownStatuses[sampleIndex] = TestKnnClassRandomLineSample(RandomDouble(0, 100) < percentOfFailureCases,
+            2 * lineIndex + 1, 2 * lineIndex + 2);
+    }
+    for (int lineIndex = 0; lineIndex < numberOfLines; lineIndex++) {
+        snapshot[lineIndex] = TestKnnClassRandomLineSample(RandomDouble(0, 100) < percentOfFailureCases,
+            2 * lineIndex + 1, 2 * lineIndex + 2);
+    }
+
+    threadPool pool(numberOfThreads);
+    lineModelRegistry registry(5, &pool);
+    registry.AddTrainingSamples(samplesWithKnownStatuses, numberOfSamplesWithKnownStatuses);
+    vector<bool> predictedStatuses = registry.PredictStatuses(snapshot, numberOfLines);
+
+    int numberOfMatchingPredictions = 0;
+    for (int lineIndex = 0; lineIndex < (int)predictedStatuses.size(); lineIndex++) {
+        for (int sampleIndex = 0; sampleIndex < numberOfSamplesPerLine; sampleIndex++) {
+            samplesOfOneLine[sampleIndex] = samplesWithKnownStatuses[sampleIndex * numberOfLines + lineIndex];
+        }
+        knnPredictionOfUnknownLineSample singleKNN(samplesOfOneLine, numberOfSamplesPerLine, snapshot[lineIndex]);
+        if (singleKNN.PredictedStatus == predictedStatuses[lineIndex]) numberOfMatchingPredictions++;
+    }
+    cout << "\nLine Model Registry (" << to_string(registry.NumberOfLines()) << " lines, " << to_string(pool.NumberOfThreads()) <<
+        " threads):\n";
+    cout << "Predictions matching knnPredictionOfUnknownLineSample: " << to_string(numberOfMatchingPredictions) << "/" <<
+        to_string(numberOfLines) << "\n";
+
+    delete[] samplesOfOneLine;
+    TestKnnClassFreeLineSamples(samplesWithKnownStatuses, numberOfSamplesWithKnownStatuses);
+    TestKnnClassFreeLineSamples(snapshot, numberOfLines);
+}
+
+
+shared_ptr<nodeSample> TestGridSnapshotRandomRingNode(int, int, bool);
+/// <summary>
+/// Build a ring of nodes where node n is connected to nodes n - 1 and n + 1, register line samples of every line, and check the
+/// predictions from a gridSnapshot match the predictions from line samples built from the same nodes.
+/// </summary>
+/// <param name="numberOfNodes">The number of nodes (and lines) in the ring</param>
+/// <param name="numberOfSamplesPerLine">The number of samples with known line statuses per line</param>
+/// <param name="numberOfThreads">The number of threads in the thread pool</param>
+/// <param name="percentOfFailureCases">The percentage of the samples that have the line failing</param>
+void TestGridSnapshotClass(int numberOfNodes = 30, int numberOfSamplesPerLine = 100, int numberOfThreads = 4,
+    double percentOfFailureCases = 20)
+{
+    int numberOfSamplesWithKnownStatuses = numberOfNodes * numberOfSamplesPerLine;
+    lineSample** samplesWithKnownStatuses = new lineSample*[numberOfSamplesWithKnownStatuses];
+    shared_ptr<nodeSample>* nodes = new shared_ptr<nodeSample>[numberOfNodes];
+    lineSample** samplesOfTheSnapshot = new lineSample*[numberOfNodes];
+    if ((samplesWithKnownStatuses == NULL) || (nodes == NULL) || (samplesOfTheSnapshot == NULL)) {
+        cout << "Error: TestGridSnapshotClass() failed to allocate memory for the samples.\n";
+        if (samplesWithKnownStatuses != NULL) delete[] samplesWithKnownStatuses;
+        if (nodes != NULL) delete[] nodes;
+        if (samplesOfTheSnapshot != NULL) delete[] samplesOfTheSnapshot;
+        return;
+    }
+
+    // Line l goes from node l to the next node in the ring
+    for (int sampleIndex = 0; sampleIndex < numberOfSamplesWithKnownStatuses; sampleIndex++) {
+        int node1Number = sampleIndex % numberOfNodes + 1;
+        int node2Number = node1Number % numberOfNodes + 1;
+        bool isFailing = RandomDouble(0, 100) < percentOfFailureCases;
+        samplesWithKnownStatuses[sampleIndex] = new lineSample(TestGridSnapshotRandomRingNode(node1Number, numberOfNodes, isFailing),
+            TestGridSnapshotRandomRingNode(node2Number, numberOfNodes, isFailing), !isFailing);
+    }
+    for (int nodeIndex = 0; nodeIndex < numberOfNodes; nodeIndex++) {
+        nodes[nodeIndex] = TestGridSnapshotRandomRingNode(nodeIndex + 1, numberOfNodes, RandomDouble(0, 100) < percentOfFailureCases);
+    }
+
+    threadPool pool(numberOfThreads);
+    lineModelRegistry registry(5, &pool);
+    registry.AddTrainingSamples(samplesWithKnownStatuses, numberOfSamplesWithKnownStatuses);
+    gridSnapshot snapshot(nodes, numberOfNodes);
+    vector<bool> snapshotStatuses = registry.PredictStatuses(&snapshot);
+
+    // The same lines built as line samples in the snapshot's line order
+    for (int lineIndex = 0; lineIndex < snapshot.NumberOfLines(); lineIndex++) {
+        int node1Number = snapshot.Node1Number(lineIndex);
+        int node2Number = snapshot.Node2Number(lineIndex);
+        if ((node1Number == 1) && (node2Number == numberOfNodes)) swap(node1Number, node2Number);  // Registered as node N to node 1
+        samplesOfTheSnapshot[lineIndex] = new lineSample(nodes[node1Number - 1], nodes[node2Number - 1], true);
+    }
+    vector<bool> lineSampleStatuses = registry.PredictStatuses(samplesOfTheSnapshot, snapshot.NumberOfLines());
+
+    int numberOfMatchingPredictions = 0;
+    for (int lineIndex = 0; lineIndex < (int)snapshotStatuses.size(); lineIndex++) {
+        if ((lineIndex < (int)lineSampleStatuses.size()) && (snapshotStatuses[lineIndex] == lineSampleStatuses[lineIndex])) {
+            numberOfMatchingPredictions++;
+        }
+    }
+    cout << "\nGrid Snapshot (" << to_string(snapshot.NumberOfNodes()) << " nodes, " << to_string(snapshot.NumberOfLines()) <<
+        " lines):\n";
+    cout << "Predictions matching the line samples of the same nodes: " << to_string(numberOfMatchingPredictions) << "/" <<
+        to_string(snapshot.NumberOfLines()) << "\n";
+
+    TestKnnClassFreeLineSamples(samplesWithKnownStatuses, numberOfSamplesWithKnownStatuses);
+    TestKnnClassFreeLineSamples(samplesOfTheSnapshot, snapshot.NumberOfLines());
+    delete[] nodes;
+}
+/// <summary>
+/// Generate a node of the ring with currents to the previous and next nodes and the same average phasors TestKnnClass() uses.
+/// </summary>
+/// <param name="nodeNumber">The number of the node between 1 and numberOfNodes</param>
+/// <param name="numberOfNodes">The number of nodes in the ring</param>
+/// <param name="isFailing">True if the node should be of a failing line</param>
+/// <returns>The node sample or NULL if the memory allocation failed</returns>
+shared_ptr<nodeSample> TestGridSnapshotRandomRingNode(int nodeNumber, int numberOfNodes, bool isFailing)
+{
+    phasor averageCurrentPhasors[2] = { phasor(25, -165), phasor(25, 15) };
+    phasor averageVoltagePhasor = phasor(250000, 15);
+    if (isFailing == true) {
+        averageCurrentPhasors[0] = phasor(250, -135);
+        averageCurrentPhasors[1] = phasor(250, 45);
+        averageVoltagePhasor = phasor(50000, 90);
+    }
+    int currentDestinationNodes[2] = { (nodeNumber + numberOfNodes - 2) % numberOfNodes + 1, nodeNumber % numberOfNodes + 1 };
+
+    return TestKnnClassRandomNodeSample(nodeNumber, averageVoltagePhasor, averageCurrentPhasors, currentDestinationNodes, 2);
+}
+
+
+/// <summary>
+/// Write a feature matrix to a training set file, map the file back, and check the predictions over the mapped pages match the
+/// predictions over the original feature matrix.
+/// </summary>
+/// <param name="numberOfSamplesWithKnownStatuses">The number of samples with known line statuses</param>
+/// <param name="numberOfSamplesWithUnknownStatuses">The number of samples with unknown line statuses</param>
+/// <param name="percentOfFailureCases">The percentage of the samples that have the line failing</param>
+void TestTrainingSetFileClass(int numberOfSamplesWithKnownStatuses = 2000, int numberOfSamplesWithUnknownStatuses = 20,
+    double percentOfFailureCases = 20)
+{
+    string path = "knnTrainingSetTest.bin";
+    lineSample** samplesWithKnownStatuses = new lineSample*[numberOfSamplesWithKnownStatuses];
+    if (samplesWithKnownStatuses == NULL) {
+        cout << "Error: TestTrainingSetFileClass() failed to allocate memory for samplesWithKnownStatuses.\n";
+        return;
+    }
+    int numberOfNotWorkingSamples = (int)((double)numberOfSamplesWithKnownStatuses * percentOfFailureCases) / 100;
+    for (int sampleIndex = 0; sampleIndex < numberOfSamplesWithKnownStatuses; sampleIndex++) {
+        samplesWithKnownStatuses[sampleIndex] =
+            TestKnnClassRandomLineSample(sampleIndex >= numberOfSamplesWithKnownStatuses - numberOfNotWorkingSamples);
+    }
+
+    lineFeatureMatrix knownFeatures(samplesWithKnownStatuses, numberOfSamplesWithKnownStatuses);
+    if (trainingSetFile::Write(&knownFeatures, path) == false) {
+        TestKnnClassFreeLineSamples(samplesWithKnownStatuses, numberOfSamplesWithKnownStatuses);
+        return;
+    }
+    trainingSetFile* file = new trainingSetFile(path);
+    if ((file == NULL) || (file->Features() == NULL)) {
+        cout << "Error: TestTrainingSetFileClass() failed to load " << path << "\n";
+        if (file != NULL) delete file;
+        remove(path.c_str());
+        TestKnnClassFreeLineSamples(samplesWithKnownStatuses, numberOfSamplesWithKnownStatuses);
+        return;
+    }
+
+    int numberOfMatchingPredictions = 0;
+    for (int sampleIndex = 0; sampleIndex < numberOfSamplesWithUnknownStatuses; sampleIndex++) {
+        lineSample* sampleWithUnknownStatus = TestKnnClassRandomLineSample(RandomDouble(0, 100) < percentOfFailureCases);
+        if (sampleWithUnknownStatus == NULL) continue;
+
+        knnPredictionOfUnknownLineSample heapKNN(&knownFeatures, sampleWithUnknownStatus);
+        knnPredictionOfUnknownLineSample mappedKNN(file->Features(), sampleWithUnknownStatus);
+        if (heapKNN.PredictedStatus == mappedKNN.PredictedStatus) numberOfMatchingPredictions++;
+        delete sampleWithUnknownStatus;
+    }
+    cout << "\nMapped Training Set File (" << to_string(file->Features()->NumberOfSamples) << " line samples):\n";
+    cout << "Predictions matching the feature matrix it was written from: " << to_string(numberOfMatchingPredictions) << "/" <<
+        to_string(numberOfSamplesWithUnknownStatuses) << "\n";
+    delete file;
+
+    // Corrupt copies: an offset that wraps around past the end, a misaligned section, and a status that isn't 0 or 1
+    ifstream original(path, ios::binary);
+    vector<char> bytes((istreambuf_iterator<char>(original)), istreambuf_iterator<char>());
+    original.close();
+    const trainingSetFileHeader* header = (const trainingSetFileHeader*)bytes.data();
+    uint64_t corruptValues[3] = { ~(uint64_t)0 - 7, header->NodeNumbersOffset + 2, 2 };
+    size_t corruptOffsets[3] = { offsetof(trainingSetFileHeader, WeightsOffset), offsetof(trainingSetFileHeader, NodeNumbersOffset),
+        (size_t)header->StatusesOffset };
+    size_t corruptSizes[3] = { sizeof(uint64_t), sizeof(uint64_t), 1 };
+    int numberOfRejectedFiles = 0;
+    for (int corruptionIndex = 0; corruptionIndex < 3; corruptionIndex++) {
+        vector<char> corruptBytes = bytes;
+        memcpy(corruptBytes.data() + corruptOffsets[corruptionIndex], &corruptValues[corruptionIndex], corruptSizes[corruptionIndex]);
+        ofstream corruptFile(path, ios::binary | ios::trunc);
+        corruptFile.write(corruptBytes.data(), corruptBytes.size());
+        corruptFile.close();
+        trainingSetFile corruptTrainingSet(path);
+        if (corruptTrainingSet.Features() == NULL) numberOfRejectedFiles++;
+    }
+    cout << "Corrupt files rejected: " << to_string(numberOfRejectedFiles) << "/3\n";
+
+    remove(path.c_str());
+    TestKnnClassFreeLineSamples(samplesWithKnownStatuses, numberOfSamplesWithKnownStatuses);
+}
+
+
+/// <summary>
+/// Write snapshots of the ring of TestGridSnapshotClass() to a CSV file, read them back in small chunks on a thread pool, and check
+/// every snapshot comes back with every node and line of the ring.
+/// </summary>
+/// <param name="numberOfSnapshots">The number of snapshots in the file</param>
+/// <param name="numberOfNodes">The number of nodes (and lines) in the ring</param>
+/// <param name="numberOfThreads">The number of threads in the thread pool</param>
+/// <param name="chunkBytes">The number of bytes the reader reads per chunk</param>
+void TestNodeCsvReaderClass(int numberOfSnapshots = 200, int numberOfNodes = 30, int numberOfThreads = 4, int chunkBytes = 1 << 16)
+{
+    string path = "knnNodeCsvTest.csv";
+    ofstream file(path);
+    if (file.is_open() == false) {
+        cout << "Error: TestNodeCsvReaderClass() couldn't create " << path << "\n";
+        return;
+    }
+    file << setprecision(12);
+    file << "snapshot,node,ratedVoltage,ratedCurrent,voltageRms,voltageDeg,destination,currentRms,currentDeg,...\n";
+    double firstVoltageRMSvalue = 0;
+    for (int snapshotIndex = 0; snapshotIndex < numberOfSnapshots; snapshotIndex++) {
+        for (int nodeIndex = 0; nodeIndex < numberOfNodes; nodeIndex++) {
+            shared_ptr<nodeSample> node = TestGridSnapshotRandomRingNode(nodeIndex + 1, numberOfNodes, false);
+            if ((snapshotIndex == 0) && (nodeIndex == 0)) firstVoltageRMSvalue = node->Voltage->Phasor.RMSvalue();
+            file << snapshotIndex << "," << node->NodeNumber << "," << node->RatedVoltage << "," << node->RatedCurrent << "," <<
+                node->Voltage->Phasor.RMSvalue() << "," << node->Voltage->Phasor.PhaseAngleDegrees();
+            for (int currentIndex = 0; currentIndex < node->NumberOfCurrents; currentIndex++) {
+                file << "," << node->Currents[currentIndex]->DestinationNodeNumber << "," <<
+                    node->Currents[currentIndex]->Phasor.RMSvalue() << "," << node->Currents[currentIndex]->Phasor.PhaseAngleDegrees();
+            }
+            file << "\n";
+        }
+    }
+    file.close();
+
+    threadPool pool(numberOfThreads);
+    nodeCsvReader reader(path, &pool, chunkBytes);
+    int numberOfSnapshotsRead = 0;
+    int numberOfCompleteSnapshots = 0;
+    double readVoltageRMSvalue = 0;
+    reader.Read([&](long long snapshotNumber, shared_ptr<nodeSample>* nodes, int numberOfNodesRead) {
+        if (numberOfSnapshotsRead == 0) readVoltageRMSvalue = nodes[0]->Voltage->Phasor.RMSvalue();
+        gridSnapshot snapshot(nodes, numberOfNodesRead);
+        if ((snapshotNumber == numberOfSnapshotsRead) && (snapshot.NumberOfNodes() == numberOfNodes) &&
+            (snapshot.NumberOfLines() == numberOfNodes)) numberOfCompleteSnapshots++;
+        numberOfSnapshotsRead++;
+    });
+
+    cout << "\nNode CSV Reader (" << to_string(reader.NumberOfRows) << " rows, " << to_string(reader.NumberOfSkippedRows) <<
+        " skipped):\n";
+    cout << "Snapshots with every node and line of the ring: " << to_string(numberOfCompleteSnapshots) << "/" <<
+        to_string(numberOfSnapshots) << "\n";
+    cout << "First voltage written and read: " << to_string(firstVoltageRMSvalue) << " V, " << to_string(readVoltageRMSvalue) << " V\n";
+    cout << "Rows per second: " << to_string((long long)reader.RowsPerSecond) << "\n";
+
+    remove(path.c_str());
+}
+
+
+/// <summary>
+/// Build the same line samples on the heap and in a sampleArena and check the arena line samples give the same distances.
+/// </summary>
+/// <param name="numberOfSamples">The number of line samples</param>
+void TestSampleArenaClass(int numberOfSamples = 1000)
+{
+    lineSample** heapSamples = new lineSample*[numberOfSamples];
+    lineSample** arenaSamples = new lineSample*[numberOfSamples];
+    if ((heapSamples == NULL) || (arenaSamples == NULL)) {
+        cout << "Error: TestSampleArenaClass() failed to allocate memory for the samples.\n";
+        if (heapSamples != NULL) delete[] heapSamples;
+        if (arenaSamples != NULL) delete[] arenaSamples;
+        return;
+    }
+
+    sampleArena arena;
+    for (int sampleIndex = 0; sampleIndex < numberOfSamples; sampleIndex++) {
+        shared_ptr<nodeSample> heapNodes[2] = { TestGridSnapshotRandomRingNode(1, 3, sampleIndex % 5 == 0),
+            TestGridSnapshotRandomRingNode(2, 3, sampleIndex % 5 == 0) };
+        heapSamples[sampleIndex] = new lineSample(heapNodes[0], heapNodes[1], sampleIndex % 5 != 0);
+
+        // The same phasors with the nodes, parameters, and pointer arrays all in the arena
+        shared_ptr<nodeSample> arenaNodes[2];
+        for (int nodeIndex = 0; nodeIndex < 2; nodeIndex++) {
+            phasor currents[2] = { heapNodes[nodeIndex]->Currents[0]->Phasor, heapNodes[nodeIndex]->Currents[1]->Phasor };
+            int currentDestinationNodes[2] = { heapNodes[nodeIndex]->Currents[0]->DestinationNodeNumber,
+                heapNodes[nodeIndex]->Currents[1]->DestinationNodeNumber };
+            arenaNodes[nodeIndex] = arena.NewShared<nodeSample>(heapNodes[nodeIndex]->NodeNumber, heapNodes[nodeIndex]->Voltage->Phasor,
+                currents, currentDestinationNodes, 2, &arena);
+        }
+        arenaSamples[sampleIndex] = arena.New<lineSample>(arenaNodes[0], arenaNodes[1], sampleIndex % 5 != 0, &arena);
+    }
+
+    int numberOfMatchingDistances = 0;
+    for (int sampleIndex = 1; sampleIndex < numberOfSamples; sampleIndex++) {
+        distanceSample heapDistance(heapSamples[0], heapSamples[sampleIndex]);
+        distanceSample arenaDistance(arenaSamples[0], arenaSamples[sampleIndex]);
+        if (heapDistance.Distance == arenaDistance.Distance) numberOfMatchingDistances++;
+    }
+    cout << "\nSample Arena (" << to_string(numberOfSamples) << " line samples in " << to_string(arena.NumberOfBytes()) << " bytes, " <<
+        to_string(arena.NumberOfChunks()) << " chunks):\n";
+    cout << "Distances matching the heap line samples: " << to_string(numberOfMatchingDistances) << "/" <<
+        to_string(numberOfSamples - 1) << "\n";
+    cout << "Distinct names and units shared by every parameter: " << to_string(internedString::NumberOfStrings()) << "\n";
+
+    // The arena line samples hold the arena nodes, so they go before the arena is released
+    TestKnnClassFreeLineSamples(heapSamples, numberOfSamples);
+    delete[] arenaSamples;
+    arena.Release();
+}
+
+
+/// <summary>
+/// Count the heap allocations of building line samples on the heap and in a sampleArena and of moving them through a vector, and
+/// check the moved line samples still give the same distances.
+/// </summary>
+/// <param name="numberOfSamples">The number of line samples of each kind</param>
+void TestLineSampleAllocations(int numberOfSamples = 1000)
+{
+    vector<shared_ptr<nodeSample>> nodes;
+    for (int sampleIndex = 0; sampleIndex < numberOfSamples; sampleIndex++) {
+        nodes.push_back(TestGridSnapshotRandomRingNode(1, 3, sampleIndex % 5 == 0));
+        nodes.push_back(TestGridSnapshotRandomRingNode(2, 3, sampleIndex % 5 == 0));
+    }
+    lineSample** heapSamples = new lineSample*[numberOfSamples];
+    if (heapSamples == NULL) {
+        cout << "Error: TestLineSampleAllocations() failed to allocate memory for heapSamples.\n";
+        return;
+    }
+
+    long long firstAllocation = allocationCounter::NumberOfAllocations();
+    for (int sampleIndex = 0; sampleIndex < numberOfSamples; sampleIndex++) {
+        heapSamples[sampleIndex] = new lineSample(nodes[2 * sampleIndex], nodes[2 * sampleIndex + 1], sampleIndex % 5 != 0);
+    }
+    double heapAllocationsPerSample = (double)(allocationCounter::NumberOfAllocations() - firstAllocation) / numberOfSamples;
+
+    sampleArena arena;
+    firstAllocation = allocationCounter::NumberOfAllocations();
+    for (int sampleIndex = 0; sampleIndex < numberOfSamples; sampleIndex++) {
+        arena.New<lineSample>(nodes[2 * sampleIndex], nodes[2 * sampleIndex + 1], sampleIndex % 5 != 0, &arena);
+    }
+    double arenaAllocationsPerSample = (double)(allocationCounter::NumberOfAllocations() - firstAllocation) / numberOfSamples;
+
+    // Moving takes the parameters along, so only the growth of the vectors allocates
+    vector<lineSample> builtSamples;
+    builtSamples.reserve(numberOfSamples);
+    for (int sampleIndex = 0; sampleIndex < numberOfSamples; sampleIndex++) {
+        builtSamples.emplace_back(nodes[2 * sampleIndex], nodes[2 * sampleIndex + 1], sampleIndex % 5 != 0);
+    }
+    firstAllocation = allocationCounter::NumberOfAllocations();
+    vector<lineSample> movedSamples;
+    for (int sampleIndex = 0; sampleIndex < numberOfSamples; sampleIndex++) movedSamples.push_back(move(builtSamples[sampleIndex]));
+    double moveAllocationsPerSample = (double)(allocationCounter::NumberOfAllocations() - firstAllocation) / numberOfSamples;
+
+    // Copies take the normalized parameters as they are, so a moved-from line sample copies to an empty one
+    vector<lineSample> copiedSamples(movedSamples);
+    lineSample copyOfMovedFrom(builtSamples[0]);
+
+    int numberOfMatchingDistances = 0;
+    int numberOfMatchingCopyDistances = 0;
+    for (int sampleIndex = 1; sampleIndex < numberOfSamples; sampleIndex++) {
+        distanceSample heapDistance(heapSamples[0], heapSamples[sampleIndex]);
+        distanceSample movedDistance(&movedSamples[0], &movedSamples[sampleIndex]);
+        distanceSample copyDistance(&copiedSamples[0], &copiedSamples[sampleIndex]);
+        if (heapDistance.Distance == movedDistance.Distance) numberOfMatchingDistances++;
+        if (heapDistance.Distance == copyDistance.Distance) numberOfMatchingCopyDistances++;
+    }
+
+    cout << "\nLine Sample Allocations (" << to_string(numberOfSamples) << " line samples):\n";
+    if (allocationCounter::IsCounting() == true) {
+        cout << "Heap allocations per line sample built with new: " << to_string(heapAllocationsPerSample) << "\n";
+        cout << "Heap allocations per line sample built in a sampleArena: " << to_string(arenaAllocationsPerSample) << "\n";
+        cout << "Heap allocations per line sample moved into a growing vector: " << to_string(moveAllocationsPerSample) << "\n";
+    }
+    else cout << "Heap allocations aren't counted (compile with KNN_INSTRUMENTATION defined to count them)\n";
+    cout << "Distances of the moved line samples matching the heap line samples: " << to_string(numberOfMatchingDistances) << "/" <<
+        to_string(numberOfSamples - 1) << "\n";
+    cout << "Distances of the copied line samples matching the heap line samples: " << to_string(numberOfMatchingCopyDistances) <<
+        "/" << to_string(numberOfSamples - 1) << "\n";
+    cout << "Topology key of a copy of a moved-from line sample: " << to_string(copyOfMovedFrom.TopologyKey()) << "\n";
+
+    TestKnnClassFreeLineSamples(heapSamples, numberOfSamples);
+    arena.Release();
+}
+
+
+/// <summary>
+/// Append labeled line samples to an onlineTrainingStore while another thread keeps predicting from it, then check the store kept
+/// only the newest line samples and predicts the same as a feature matrix of those line samples.
+/// </summary>
+/// <param name="numberOfAppends">The number of labeled line samples appended</param>
+/// <param name="maximumNumberOfSamples">The largest number of line samples the store keeps</param>
+/// <param name="samplesPerSegment">The number of line samples per segment of the store</param>
+/// <param name="numberOfSamplesWithUnknownStatuses">The number of samples with unknown line statuses</param>
+/// <param name="percentOfFailureCases">The percentage of the samples that have the line failing</param>
+void TestOnlineTrainingStoreClass(int numberOfAppends = 3000, int maximumNumberOfSamples = 1000, int samplesPerSegment = 256,
+    int numberOfSamplesWithUnknownStatuses = 20, double percentOfFailureCases = 20)
+{
+    lineSample** appendedSamples = new lineSample*[numberOfAppends];
+    lineSample** samplesWithUnknownStatuses = new lineSample*[numberOfSamplesWithUnknownStatuses];
+    if ((appendedSamples == NULL) || (samplesWithUnknownStatuses == NULL)) {
+        cout << "Error: TestOnlineTrainingStoreClass() failed to allocate memory for the samples.\n";
+        if (appendedSamples != NULL) delete[] appendedSamples;
+        if (samplesWithUnknownStatuses != NULL) delete[] samplesWithUnknownStatuses;
+        return;
+    }
+    for (int sampleIndex = 0; sampleIndex < numberOfAppends; sampleIndex++) {
+        appendedSamples[sampleIndex] = TestKnnClassRandomLineSample(RandomDouble(0, 100) < percentOfFailureCases);
+    }
+    for (int sampleIndex = 0; sampleIndex < numberOfSamplesWithUnknownStatuses; sampleIndex++) {
+        samplesWithUnknownStatuses[sampleIndex] = TestKnnClassRandomLineSample(RandomDouble(0, 100) < percentOfFailureCases);
+    }
+
+    // The reader predicts from whichever view is newest while the writer appends
+    onlineTrainingStore store(5, maximumNumberOfSamples, 0, samplesPerSegment);
+    atomic<bool> isAppending(true);
+    atomic<int> numberOfConcurrentPredictions(0);
+    store.Append(appendedSamples[0], 0);
+    for (int sampleIndex = 1; sampleIndex < 5; sampleIndex++) store.Append(appendedSamples[sampleIndex], sampleIndex);
+    thread reader([&]() {
+        int unknownIndex = 0;
+        while (isAppending == true) {
+            bool predictedStatus = true;
+            if (store.PredictStatus(samplesWithUnknownStatuses[unknownIndex], &predictedStatus) == true) numberOfConcurrentPredictions++;
+            unknownIndex = (unknownIndex + 1) % numberOfSamplesWithUnknownStatuses;
+        }
+    });
+    while (numberOfConcurrentPredictions == 0) this_thread::yield();   // Wait for the reader to start so they overlap
+    for (int sampleIndex = 5; sampleIndex < numberOfAppends; sampleIndex++) store.Append(appendedSamples[sampleIndex], sampleIndex);
+    isAppending = false;
+    reader.join();
+
+    int numberOfKeptSamples = min(numberOfAppends, maximumNumberOfSamples);
+    lineFeatureMatrix keptFeatures(appendedSamples + numberOfAppends - numberOfKeptSamples, numberOfKeptSamples);
+    int numberOfMatchingPredictions = 0;
+    for (int sampleIndex = 0; sampleIndex < numberOfSamplesWithUnknownStatuses; sampleIndex++) {
+        bool storeStatus = true;
+        store.PredictStatus(samplesWithUnknownStatuses[sampleIndex], &storeStatus);
+        knnPredictionOfUnknownLineSample matrixKNN(&keptFeatures, samplesWithUnknownStatuses[sampleIndex]);
+        if (storeStatus == matrixKNN.PredictedStatus) numberOfMatchingPredictions++;
+    }
+
+    // A sliding window of 100 time units keeps the newest line sample and the 100 before it
+    onlineTrainingStore windowStore(5, 0, 100, samplesPerSegment);
+    for (int sampleIndex = 0; sampleIndex < numberOfAppends; sampleIndex++) windowStore.Append(appendedSamples[sampleIndex], sampleIndex);
+
+    cout << "\nOnline Training Store (" << to_string(numberOfAppends) << " appends, at most " << to_string(maximumNumberOfSamples) <<
+        " kept):\n";
+    cout << "Line samples kept: " << to_string(store.NumberOfSamples()) << " in " << to_string(store.View()->NumberOfSegments()) <<
+        " segments\n";
+    cout << "Predictions made while appending: " << to_string(numberOfConcurrentPredictions) << "\n";
+    cout << "Predictions matching a feature matrix of the kept line samples: " << to_string(numberOfMatchingPredictions) << "/" <<
+        to_string(numberOfSamplesWithUnknownStatuses) << "\n";
+    cout << "Line samples kept by a window of 100 time units: " << to_string(windowStore.NumberOfSamples()) << "\n";
+
+    TestKnnClassFreeLineSamples(appendedSamples, numberOfAppends);
+    TestKnnClassFreeLineSamples(samplesWithUnknownStatuses, numberOfSamplesWithUnknownStatuses);
+}
+
+
+/// <summary>
+/// Share one knnQueryEngine between 1, 2, and 4 request threads, check every prediction matches knnPredictionOfUnknownLineSample,
+/// and print the throughput of each number of threads.
+/// </summary>
+/// <param name="numberOfSamplesWithKnownStatuses">The number of samples with known line statuses</param>
+/// <param name="numberOfSamplesWithUnknownStatuses">The number of queries</param>
+/// <param name="maximumNumberOfThreads">The largest number of request threads</param>
+/// <param name="percentOfFailureCases">The percentage of the samples that have the line failing</param>
+void TestKnnQueryEngineClass(int numberOfSamplesWithKnownStatuses = 5000, int numberOfSamplesWithUnknownStatuses = 2000,
+    int maximumNumberOfThreads = 4, double percentOfFailureCases = 20)
+{
+    lineSample** samplesWithKnownStatuses = new lineSample*[numberOfSamplesWithKnownStatuses];
+    lineSample** samplesWithUnknownStatuses = new lineSample*[numberOfSamplesWithUnknownStatuses];
+    if ((samplesWithKnownStatuses == NULL) || (samplesWithUnknownStatuses == NULL)) {
+        cout << "Error: TestKnnQueryEngineClass() failed to allocate memory for the samples.\n";
+        if (samplesWithKnownStatuses != NULL) delete[] samplesWithKnownStatuses;
+        if (samplesWithUnknownStatuses != NULL) delete[] samplesWithUnknownStatuses;
+        return;
+    }
+    for (int sampleIndex = 0; sampleIndex < numberOfSamplesWithKnownStatuses; sampleIndex++) {
+        samplesWithKnownStatuses[sampleIndex] = TestKnnClassRandomLineSample(RandomDouble(0, 100) < percentOfFailureCases);
+    }
+    for (int sampleIndex = 0; sampleIndex < numberOfSamplesWithUnknownStatuses; sampleIndex++) {
+        samplesWithUnknownStatuses[sampleIndex] = TestKnnClassRandomLineSample(RandomDouble(0, 100) < percentOfFailureCases);
+    }
+
+    lineFeatureMatrix knownFeatures(samplesWithKnownStatuses, numberOfSamplesWithKnownStatuses);
+    vector<bool> expectedStatuses;
+    for (int sampleIndex = 0; sampleIndex < numberOfSamplesWithUnknownStatuses; sampleIndex++) {
+        knnPredictionOfUnknownLineSample testKNN(&knownFeatures, samplesWithUnknownStatuses[sampleIndex]);
+        expectedStatuses.push_back(testKNN.PredictedStatus);
+    }
+
+    const knnQueryEngine engine(&knownFeatures, 5);
+    cout << "\nKNN Query Engine (" << to_string(numberOfSamplesWithKnownStatuses) << " known, " <<
+        to_string(numberOfSamplesWithUnknownStatuses) << " queries):\n";
+    for (int numberOfThreads = 1; numberOfThreads <= maximumNumberOfThreads; numberOfThreads *= 2) {
+        vector<char> predictedStatuses(numberOfSamplesWithUnknownStatuses, 0);
+        vector<thread> requestThreads;
+        chrono::steady_clock::time_point startTime = chrono::steady_clock::now();
+        for (int threadIndex = 0; threadIndex < numberOfThreads; threadIndex++) {
+            requestThreads.push_back(thread([&, threadIndex]() {
+                int firstIndex = threadIndex * numberOfSamplesWithUnknownStatuses / numberOfThreads;
+                int lastIndex = (threadIndex + 1) * numberOfSamplesWithUnknownStatuses / numberOfThreads;
+                for (int sampleIndex = firstIndex; sampleIndex < lastIndex; sampleIndex++) {
+                    bool predictedStatus = true;
+                    if (engine.PredictStatus(samplesWithUnknownStatuses[sampleIndex], &predictedStatus) == true) {
+                        predictedStatuses[sampleIndex] = (predictedStatus == true) ? 1 : 2;
+                    }
+                }
+            }));
+        }
+        for (int threadIndex = 0; threadIndex < numberOfThreads; threadIndex++) requestThreads[threadIndex].join();
+        double seconds = chrono::duration<double>(chrono::steady_clock::now() - startTime).count();
+
+        int numberOfMatchingPredictions = 0;
+        for (int sampleIndex = 0; sampleIndex < numberOfSamplesWithUnknownStatuses; sampleIndex++) {
+            if (predictedStatuses[sampleIndex] == (expectedStatuses[sampleIndex] == true ? 1 : 2)) numberOfMatchingPredictions++;
+        }
+        cout << to_string(numberOfThreads) << " request threads: " << to_string(numberOfMatchingPredictions) << "/" <<
+            to_string(numberOfSamplesWithUnknownStatuses) << " matching, " <<
+            to_string((long long)(numberOfSamplesWithUnknownStatuses / seconds)) << " queries per second\n";
+    }
+
+    TestKnnClassFreeLineSamples(samplesWithKnownStatuses, numberOfSamplesWithKnownStatuses);
+    TestKnnClassFreeLineSamples(samplesWithUnknownStatuses, numberOfSamplesWithUnknownStatuses);
+}
+
+
+/// <summary>
+/// Sweep the number of nearest neighbors over odd k from 1 to the maximum with one cached scan per unknown line sample and check
+/// it predicts the same as a new predictor for every k.
+/// </summary>
+/// <param name="numberOfSamplesWithKnownStatuses">The number of samples with known line statuses</param>
+/// <param name="numberOfSamplesWithUnknownStatuses">The number of samples with unknown line statuses</param>
+/// <param name="maximumNumberOfNearestNeighbors">The largest k of the sweep</param>
+/// <param name="percentOfFailureCases">The percentage of the samples that have the line failing</param>
+void TestKnnNearestNeighborSweep(int numberOfSamplesWithKnownStatuses = 2000, int numberOfSamplesWithUnknownStatuses = 20,
+    int maximumNumberOfNearestNeighbors = 51, double percentOfFailureCases = 20)
+{
+    lineSample** samplesWithKnownStatuses = new lineSample*[numberOfSamplesWithKnownStatuses];
+    if (samplesWithKnownStatuses == NULL) {
+        cout << "Error: TestKnnNearestNeighborSweep() failed to allocate memory for samplesWithKnownStatuses.\n";
+        return;
+    }
+    for (int sampleIndex = 0; sampleIndex < numberOfSamplesWithKnownStatuses; sampleIndex++) {
+        samplesWithKnownStatuses[sampleIndex] = TestKnnClassRandomLineSample(RandomDouble(0, 100) < percentOfFailureCases);
+    }
+    lineFeatureMatrix knownFeatures(samplesWithKnownStatuses, numberOfSamplesWithKnownStatuses);
+
+    int numberOfPredictions = 0;
+    int numberOfMatchingPredictions = 0;
+    int numberOfSweepScans = 0;
+    for (int unknownIndex = 0; unknownIndex < numberOfSamplesWithUnknownStatuses; unknownIndex++) {
+        lineSample* sampleWithUnknownStatus = TestKnnClassRandomLineSample(RandomDouble(0, 100) < percentOfFailureCases);
+        if (sampleWithUnknownStatus == NULL) continue;
+
+        knnPredictionOfUnknownLineSample sweepKNN(&knownFeatures, sampleWithUnknownStatus, 1);
+        sweepKNN.CacheNearestNeighbors(maximumNumberOfNearestNeighbors);
+        for (int numberOfNearestNeighbors = 1; numberOfNearestNeighbors <= maximumNumberOfNearestNeighbors; numberOfNearestNeighbors += 2) {
+            sweepKNN.ChangeNumberOfNearestNeighbors(numberOfNearestNeighbors);
+            knnPredictionOfUnknownLineSample freshKNN(&knownFeatures, sampleWithUnknownStatus, numberOfNearestNeighbors);
+            if (sweepKNN.PredictedStatus == freshKNN.PredictedStatus) numberOfMatchingPredictions++;
+            numberOfPredictions++;
+        }
+        numberOfSweepScans += sweepKNN.NumberOfScans();
+        delete sampleWithUnknownStatus;
+    }
+
+    cout << "\nNearest Neighbor Sweep (k = 1, 3, ..., " << to_string(maximumNumberOfNearestNeighbors) << "):\n";
+    cout << "Predictions matching a new predictor per k: " << to_string(numberOfMatchingPredictions) << "/" <<
+        to_string(numberOfPredictions) << "\n";
+    cout << "Scans: " << to_string(numberOfSweepScans) << " for the sweep, " << to_string(numberOfPredictions) <<
+        " with a new predictor per k\n";
+
+    TestKnnClassFreeLineSamples(samplesWithKnownStatuses, numberOfSamplesWithKnownStatuses);
+}
+
+
+/// <summary>
+/// Build a training set and predict unknown line samples between two instrumentation snapshots and check the counters match the
+/// work done. Nothing is recorded unless the program is compiled with KNN_INSTRUMENTATION defined.
+/// </summary>
+/// <param name="numberOfSamplesWithKnownStatuses">The number of samples with known line statuses</param>
+/// <param name="numberOfSamplesWithUnknownStatuses">The number of samples with unknown line statuses</param>
+/// <param name="numberOfNearestNeighbors">The number of nearest neighbors the unknown line statuses are compared to</param>
+/// <param name="percentOfFailureCases">The percentage of the samples that have the line failing</param>
+void TestKnnInstrumentation(int numberOfSamplesWithKnownStatuses = 1000, int numberOfSamplesWithUnknownStatuses = 100,
+    int numberOfNearestNeighbors = 5, double percentOfFailureCases = 20)
+{
+    cout << "\nKNN Instrumentation:\n";
+    if (knnInstrumentation::IsEnabled() == false) {
+        cout << "Disabled (compile with KNN_INSTRUMENTATION defined to record the stages)\n";
+        return;
+    }
+
+    knnInstrumentationSnapshot before = knnInstrumentation::Snapshot();
+    lineSample** samplesWithKnownStatuses = new lineSample*[numberOfSamplesWithKnownStatuses];
+    lineSample** samplesWithUnknownStatuses = new lineSample*[numberOfSamplesWithUnknownStatuses];
+    if ((samplesWithKnownStatuses == NULL) || (samplesWithUnknownStatuses == NULL)) {
+        cout << "Error: TestKnnInstrumentation() failed to allocate memory for the line samples.\n";
+        if (samplesWithKnownStatuses != NULL) delete[] samplesWithKnownStatuses;
+        if (samplesWithUnknownStatuses != NULL) delete[] samplesWithUnknownStatuses;
+        return;
+    }
+    for (int sampleIndex = 0; sampleIndex < numberOfSamplesWithKnownStatuses; sampleIndex++) {
+        samplesWithKnownStatuses[sampleIndex] = TestKnnClassRandomLineSample(RandomDouble(0, 100) < percentOfFailureCases);
+    }
+    for (int sampleIndex = 0; sampleIndex < numberOfSamplesWithUnknownStatuses; sampleIndex++) {
+        samplesWithUnknownStatuses[sampleIndex] = TestKnnClassRandomLineSample(RandomDouble(0, 100) < percentOfFailureCases);
+    }
+
+    lineFeatureMatrix knownFeatures(samplesWithKnownStatuses, numberOfSamplesWithKnownStatuses);
+    knnQueryEngine engine(&knownFeatures, numberOfNearestNeighbors);
+    for (int sampleIndex = 0; sampleIndex < numberOfSamplesWithUnknownStatuses; sampleIndex++) {
+        bool predictedStatus = true;
+        engine.PredictStatus(samplesWithUnknownStatuses[sampleIndex], &predictedStatus);
+    }
+    knnInstrumentationSnapshot difference = knnInstrumentation::Snapshot().Since(before);
+
+    difference.Print();
+    cout << "Line samples counted: " << to_string(difference.Latencies(knnStage::LineSampleConstruction).Count) << "/" <<
+        to_string(numberOfSamplesWithKnownStatuses + numberOfSamplesWithUnknownStatuses) << "\n";
+    cout << "Distances counted: " << to_string(difference.Counter(knnCounter::DistancesCalculated)) << "/" <<
+        to_string((long long)numberOfSamplesWithKnownStatuses * numberOfSamplesWithUnknownStatuses) << "\n";
+    cout << "JSON export: " << to_string(difference.ToJson().size()) << " characters\n";
+
+    TestKnnClassFreeLineSamples(samplesWithKnownStatuses, numberOfSamplesWithKnownStatuses);
+    TestKnnClassFreeLineSamples(samplesWithUnknownStatuses, numberOfSamplesWithUnknownStatuses);
+}
+
+
+/// <summary>
+/// Generate a line sample between nodes 1 and 2 with a number of other currents on each node and the averages TestKnnClass() uses.
+/// </summary>
+/// <param name="isFailing">True if the line sample should be of the line failing</param>
+/// <param name="numberOfNode1OtherCurrents">The number of currents on node 1 not counting the line current</param>
+/// <param name="numberOfNode2OtherCurrents">The number of currents on node 2 not counting the line current</param>
+/// <returns>The line sample or NULL if the memory allocation failed</returns>
+lineSample* TestDistanceKernelRandomLineSample(bool isFailing, int numberOfNode1OtherCurrents, int numberOfNode2OtherCurrents)
+{
+    int numberOfNode1Currents = 1 + numberOfNode1OtherCurrents;
+    int numberOfNode2Currents = 1 + numberOfNode2OtherCurrents;
+    vector<phasor> node1AverageCurrentPhasors(numberOfNode1Currents, isFailing ? phasor(250, -135) : phasor(25, -165));
+    vector<phasor> node2AverageCurrentPhasors(numberOfNode2Currents, isFailing ? phasor(250, 45) : phasor(25, 15));
+    node1AverageCurrentPhasors[0] = isFailing ? phasor(250, 45) : phasor(25, 15);
+    node2AverageCurrentPhasors[0] = isFailing ? phasor(250, -135) : phasor(25, -165);
+    phasor averageVoltagePhasor = isFailing ? phasor(50000, 90) : phasor(250000, 15);
+
+    vector<int> node1CurrentDestinationNodes(numberOfNode1Currents);
+    vector<int> node2CurrentDestinationNodes(numberOfNode2Currents);
+    node1CurrentDestinationNodes[0] = 2;
+    node2CurrentDestinationNodes[0] = 1;
+    for (int currentIndex = 1; currentIndex < numberOfNode1Currents; currentIndex++) {
+        node1CurrentDestinationNodes[currentIndex] = 2 + currentIndex;
+    }
+    for (int currentIndex = 1; currentIndex < numberOfNode2Currents; currentIndex++) {
+        node2CurrentDestinationNodes[currentIndex] = 2 + numberOfNode1OtherCurrents + currentIndex;
+    }
+
+    shared_ptr<nodeSample> node1 = TestKnnClassRandomNodeSample(1, averageVoltagePhasor, node1AverageCurrentPhasors.data(),
+        node1CurrentDestinationNodes.data(), numberOfNode1Currents);
+    shared_ptr<nodeSample> node2 = TestKnnClassRandomNodeSample(2, averageVoltagePhasor, node2AverageCurrentPhasors.data(),
+        node2CurrentDestinationNodes.data(), numberOfNode2Currents);
+    if ((node1 == NULL) || (node2 == NULL)) return NULL;
+
+    return new lineSample(node1, node2, !isFailing);
+}
+/// <summary>
+/// Check the kernels specialized for lines between 2- and 3-current nodes give the same squared distances as the generic kernel and
+/// time both.
+/// </summary>
+/// <param name="numberOfSamplesWithKnownStatuses">The number of samples with known line statuses</param>
+/// <param name="numberOfSamplesWithUnknownStatuses">The number of samples with unknown line statuses</param>
+/// <param name="numberOfPasses">The number of times the distances to every unknown line sample are timed</param>
+void TestDistanceKernelSpecializations(int numberOfSamplesWithKnownStatuses = 4096, int numberOfSamplesWithUnknownStatuses = 20,
+    int numberOfPasses = 20)
+{
+    cout << "\nSpecialized Distance Kernels (" << distanceKernel::InstructionSet() << "):\n";
+    for (int numberOfOtherCurrents = 1; numberOfOtherCurrents <= 3; numberOfOtherCurrents++) {
+        vector<lineSample*> samplesWithKnownStatuses(numberOfSamplesWithKnownStatuses);
+        vector<lineSample*> samplesWithUnknownStatuses(numberOfSamplesWithUnknownStatuses);
+        for (int sampleIndex = 0; sampleIndex < numberOfSamplesWithKnownStatuses; sampleIndex++) {
+            samplesWithKnownStatuses[sampleIndex] =
+                TestDistanceKernelRandomLineSample(RandomDouble(0, 100) < 20, numberOfOtherCurrents, numberOfOtherCurrents);
+        }
+        for (int sampleIndex = 0; sampleIndex < numberOfSamplesWithUnknownStatuses; sampleIndex++) {
+            samplesWithUnknownStatuses[sampleIndex] =
+                TestDistanceKernelRandomLineSample(RandomDouble(0, 100) < 20, numberOfOtherCurrents, numberOfOtherCurrents);
+        }
+        lineFeatureMatrix knownFeatures(samplesWithKnownStatuses.data(), numberOfSamplesWithKnownStatuses);
+
+        vector<double> realParts(knownFeatures.NumberOfFeatures);
+        vector<double> imaginaryParts(knownFeatures.NumberOfFeatures);
+        vector<double> specializedDistances(numberOfSamplesWithKnownStatuses);
+        vector<double> genericDistances(numberOfSamplesWithKnownStatuses);
+        int numberOfMatchingDistances = 0;
+        double specializedSeconds = 0;
+        double genericSeconds = 0;
+        for (int unknownIndex = 0; unknownIndex < numberOfSamplesWithUnknownStatuses; unknownIndex++) {
+            knownFeatures.ExtractFeatures(samplesWithUnknownStatuses[unknownIndex], realParts.data(), imaginaryParts.data());
+
+            chrono::steady_clock::time_point startTime = chrono::steady_clock::now();
+            for (int passIndex = 0; passIndex < numberOfPasses; passIndex++) {
+                distanceKernel::SquaredDistances(&knownFeatures, 0, numberOfSamplesWithKnownStatuses, realParts.data(),
+                    imaginaryParts.data(), specializedDistances.data());
+            }
+            specializedSeconds += chrono::duration<double>(chrono::steady_clock::now() - startTime).count();
+            startTime = chrono::steady_clock::now();
+            for (int passIndex = 0; passIndex < numberOfPasses; passIndex++) {
+                distanceKernel::GenericSquaredDistances(&knownFeatures, 0, numberOfSamplesWithKnownStatuses, realParts.data(),
+                    imaginaryParts.data(), genericDistances.data());
+            }
+            genericSeconds += chrono::duration<double>(chrono::steady_clock::now() - startTime).count();
+
+            for (int sampleIndex = 0; sampleIndex < numberOfSamplesWithKnownStatuses; sampleIndex++) {
+                if (specializedDistances[sampleIndex] == genericDistances[sampleIndex]) numberOfMatchingDistances++;
+            }
+        }
+
+        bool isSpecialized = knownFeatures.SquaredDistancesKernel != distanceKernel::GenericSquaredDistances;
+        cout << to_string(1 + numberOfOtherCurrents) << "/" << to_string(1 + numberOfOtherCurrents) << "-current line: " <<
+            (isSpecialized ? "specialized" : "generic") << ", " << to_string(numberOfMatchingDistances) << "/" <<
+            to_string(numberOfSamplesWithKnownStatuses * numberOfSamplesWithUnknownStatuses) << " matching distances, " <<
+            to_string(genericSeconds / specializedSeconds) << "x the generic kernel's speed\n";
+
+        for (int sampleIndex = 0; sampleIndex < numberOfSamplesWithKnownStatuses; sampleIndex++) {
+            delete samplesWithKnownStatuses[sampleIndex];
+        }
+        for (int sampleIndex = 0; sampleIndex < numberOfSamplesWithUnknownStatuses; sampleIndex++) {
+            delete samplesWithUnknownStatuses[sampleIndex];
+        }
+    }
+}
+
+
+/// <summary>
+/// Measure the recall and footprint of the single precision and 8-bit compact scans for an increasing number of re-ranked candidates
+/// and compare their predictions with the brute force scan.
+/// </summary>
+/// <param name="numberOfSamplesWithKnownStatuses">The number of samples with known line statuses</param>
+/// <param name="numberOfSamplesWithUnknownStatuses">The number of samples with unknown line statuses</param>
+/// <param name="percentOfFailureCases">The percentage of the samples that have the line failing</param>
+void TestCompactFeatureIndexClass(int numberOfSamplesWithKnownStatuses = 5000, int numberOfSamplesWithUnknownStatuses = 50,
+    double percentOfFailureCases = 20)
+{
+    lineSample** samplesWithKnownStatuses = new lineSample*[numberOfSamplesWithKnownStatuses];
+    lineSample** samplesWithUnknownStatuses = new lineSample*[numberOfSamplesWithUnknownStatuses];
+    if ((samplesWithKnownStatuses == NULL) || (samplesWithUnknownStatuses == NULL)) {
+        cout << "Error: TestCompactFeatureIndexClass() failed to allocate memory for the line samples.\n";
+        if (samplesWithKnownStatuses != NULL) delete[] samplesWithKnownStatuses;
+        if (samplesWithUnknownStatuses != NULL) delete[] samplesWithUnknownStatuses;
+        return;
+    }
+    for (int sampleIndex = 0; sampleIndex < numberOfSamplesWithKnownStatuses; sampleIndex++) {
+        samplesWithKnownStatuses[sampleIndex] = TestKnnClassRandomLineSample(RandomDouble(0, 100) < percentOfFailureCases);
+    }
+    for (int sampleIndex = 0; sampleIndex < numberOfSamplesWithUnknownStatuses; sampleIndex++) {
+        samplesWithUnknownStatuses[sampleIndex] = TestKnnClassRandomLineSample(RandomDouble(0, 100) < percentOfFailureCases);
+    }
+
+    lineFeatureMatrix knownFeatures(samplesWithKnownStatuses, numberOfSamplesWithKnownStatuses);
+    size_t numberOfDoubleBytes = 2 * (size_t)knownFeatures.NumberOfFeatures * knownFeatures.Stride * sizeof(double);
+    featureStorage storages[2] = { featureStorage::Float32, featureStorage::Int8 };
+    cout << "\nCompact Feature Scans (the double columns take " << to_string(numberOfDoubleBytes) << " bytes):\n";
+    for (int storageIndex = 0; storageIndex < 2; storageIndex++) {
+        compactFeatureIndex compactIndex(&knownFeatures, storages[storageIndex]);
+        cout << compactIndex.Name().substr(0, compactIndex.Name().find(' ')) << " columns: " <<
+            to_string(compactIndex.NumberOfBytes()) << " bytes\n";
+        for (int numberOfCandidatesPerNeighbor = 1; numberOfCandidatesPerNeighbor <= 4; numberOfCandidatesPerNeighbor *= 2) {
+            compactIndex.NumberOfCandidatesPerNeighbor = numberOfCandidatesPerNeighbor;
+            int numberOfMatchingPredictions = 0;
+            for (int sampleIndex = 0; sampleIndex < numberOfSamplesWithUnknownStatuses; sampleIndex++) {
+                knnPredictionOfUnknownLineSample bruteForceKNN(&knownFeatures, samplesWithUnknownStatuses[sampleIndex]);
+                knnPredictionOfUnknownLineSample compactKNN(&compactIndex, samplesWithUnknownStatuses[sampleIndex]);
+                if (bruteForceKNN.PredictedStatus == compactKNN.PredictedStatus) numberOfMatchingPredictions++;
+            }
+            cout << to_string(numberOfCandidatesPerNeighbor) << " candidates per neighbor: recall = " <<
+                to_string(compactIndex.MeasureRecall(samplesWithUnknownStatuses, numberOfSamplesWithUnknownStatuses, 5)) <<
+                ", predictions matching the brute force scan: " << to_string(numberOfMatchingPredictions) << "/" <<
+                to_string(numberOfSamplesWithUnknownStatuses) << "\n";
+        }
+    }
+
+    TestKnnClassFreeLineSamples(samplesWithKnownStatuses, numberOfSamplesWithKnownStatuses);
+    TestKnnClassFreeLineSamples(samplesWithUnknownStatuses, numberOfSamplesWithUnknownStatuses);
+}
+
+
+/// <summary>
+/// Predict unknown line samples with knnPredictionOfUnknownLineSample and knnQueryEngine and check the scored results agree with
+/// the bool predictions without any extra scans, then compare how often the high and low confidence predictions are right.
+/// </summary>
+/// <param name="numberOfSamplesWithKnownStatuses">The number of samples with known line statuses</param>
+/// <param name="numberOfSamplesWithUnknownStatuses">The number of samples with unknown line statuses</param>
+/// <param name="numberOfNearestNeighbors">The number of nearest neighbors the unknown line statuses are compared to</param>
+/// <param name="confidenceThreshold">The weighted vote fraction at or above which a prediction is high confidence</param>
+/// <param name="percentOfFailureCases">The percentage of the samples that have the line failing</param>
+void TestKnnPredictionResult(int numberOfSamplesWithKnownStatuses = 2000, int numberOfSamplesWithUnknownStatuses = 500,
+    int numberOfNearestNeighbors = 9, double confidenceThreshold = 0.9, double percentOfFailureCases = 20)
+{
+    lineSample** samplesWithKnownStatuses = new lineSample*[numberOfSamplesWithKnownStatuses];
+    if (samplesWithKnownStatuses == NULL) {
+        cout << "Error: TestKnnPredictionResult() failed to allocate memory for samplesWithKnownStatuses.\n";
+        return;
+    }
+    for (int sampleIndex = 0; sampleIndex < numberOfSamplesWithKnownStatuses; sampleIndex++) {
+        samplesWithKnownStatuses[sampleIndex] = TestKnnClassRandomLineSample(RandomDouble(0, 100) < percentOfFailureCases);
+    }
+    lineFeatureMatrix knownFeatures(samplesWithKnownStatuses, numberOfSamplesWithKnownStatuses);
+    const knnQueryEngine engine(&knownFeatures, numberOfNearestNeighbors);
+
+    int numberOfPredictions = 0;
+    int numberOfMatchingStatuses = 0;
+    int numberOfMatchingEngineResults = 0;
+    int numberOfScans = 0;
+    int numberOfHighConfidencePredictions = 0;
+    int numberOfCorrectHighConfidencePredictions = 0;
+    int numberOfCorrectLowConfidencePredictions = 0;
+    for (int unknownIndex = 0; unknownIndex < numberOfSamplesWithUnknownStatuses; unknownIndex++) {
+        lineSample* sampleWithUnknownStatus = TestKnnClassRandomLineSample(RandomDouble(0, 100) < percentOfFailureCases);
+        if (sampleWithUnknownStatus == NULL) continue;
+
+        knnPredictionOfUnknownLineSample testKNN(&knownFeatures, sampleWithUnknownStatus, numberOfNearestNeighbors);
+        knnPredictionResult result = testKNN.Result();
+        knnPredictionResult engineResult;
+        engine.PredictResult(sampleWithUnknownStatus, &engineResult);
+
+        numberOfPredictions++;
+        if ((result.PredictedStatus == testKNN.PredictedStatus) && (result.NumberOfNearestNeighbors == numberOfNearestNeighbors)) {
+            numberOfMatchingStatuses++;
+        }
+        if ((engineResult.PredictedStatus == result.PredictedStatus) && (engineResult.NeighborIndices == result.NeighborIndices) &&
+            (engineResult.WeightedVoteFraction == result.WeightedVoteFraction)) numberOfMatchingEngineResults++;
+        numberOfScans += testKNN.NumberOfScans();
+
+        bool isCorrect = result.PredictedStatus == sampleWithUnknownStatus->IsWorking;
+        if (result.WeightedVoteFraction >= confidenceThreshold) {
+            numberOfHighConfidencePredictions++;
+            if (isCorrect == true) numberOfCorrectHighConfidencePredictions++;
+        }
+        else if (isCorrect == true) numberOfCorrectLowConfidencePredictions++;
+        delete sampleWithUnknownStatus;
+    }
+    int numberOfLowConfidencePredictions = numberOfPredictions - numberOfHighConfidencePredictions;
+
+    cout << "\nKNN Prediction Result (k = " << to_string(numberOfNearestNeighbors) << "):\n";
+    cout << "Results matching the predicted status: " << to_string(numberOfMatchingStatuses) << "/" <<
+        to_string(numberOfPredictions) << "\n";
+    cout << "Query engine results matching: " << to_string(numberOfMatchingEngineResults) << "/" << to_string(numberOfPredictions) << "\n";
+    cout << "Scans: " << to_string(numberOfScans) << " for " << to_string(numberOfPredictions) << " scored predictions\n";
+    cout << "High confidence (weighted vote fraction >= " << to_string(confidenceThreshold) << "): " <<
+        to_string(numberOfCorrectHighConfidencePredictions) << "/" << to_string(numberOfHighConfidencePredictions) << " correct\n";
+    cout << "Low confidence: " << to_string(numberOfCorrectLowConfidencePredictions) << "/" <<
+        to_string(numberOfLowConfidencePredictions) << " correct\n";
+
+    TestKnnClassFreeLineSamples(samplesWithKnownStatuses, numberOfSamplesWithKnownStatuses);
+}
+
+
+/// <summary>
+/// Check the early abandoning distance kernel keeps the same nearest neighbors and squared distances as scoring every term for the
+/// default weights and for weights where the other currents are the heaviest on a line between 3-current nodes, and for the default
+/// weights on a line between a 3- and a 2-current node, and measure how many known line samples the k-th nearest distance rules out
+/// before every term is added and how much faster that is.
+/// </summary>
+/// <param name="numberOfSamplesWithKnownStatuses">The number of samples with known line statuses</param>
+/// <param name="numberOfSamplesWithUnknownStatuses">The number of samples with unknown line statuses</param>
+/// <param name="numberOfNearestNeighbors">The number of nearest neighbors the unknown line statuses are compared to</param>
+/// <param name="numberOfPasses">The number of times each kernel is timed per unknown line sample</param>
+void TestBoundedDistanceKernel(int numberOfSamplesWithKnownStatuses = 4096, int numberOfSamplesWithUnknownStatuses = 50,
+    int numberOfNearestNeighbors = 5, int numberOfPasses = 20)
+{
+    cout << "\nEarly Abandoning Distance Kernel (k = " << to_string(numberOfNearestNeighbors) << "):\n";
+    distanceWeights weightsToTest[3] = { distanceWeights(), distanceWeights(1, 4, 20), distanceWeights() };
+    int numbersOfNode2OtherCurrents[3] = { 2, 2, 1 };
+    string caseNames[3] = { "2/2-current line, default weights", "2/2-current line, other currents heaviest",
+        "2/1-current line, default weights" };
+    for (int caseIndex = 0; caseIndex < 3; caseIndex++) {
+        vector<lineSample*> samplesWithKnownStatuses(numberOfSamplesWithKnownStatuses);
+        vector<lineSample*> samplesWithUnknownStatuses(numberOfSamplesWithUnknownStatuses);
+        for (int sampleIndex = 0; sampleIndex < numberOfSamplesWithKnownStatuses; sampleIndex++) {
+            samplesWithKnownStatuses[sampleIndex] =
+                TestDistanceKernelRandomLineSample(RandomDouble(0, 100) < 20, 2, numbersOfNode2OtherCurrents[caseIndex]);
+        }
+        for (int sampleIndex = 0; sampleIndex < numberOfSamplesWithUnknownStatuses; sampleIndex++) {
+            samplesWithUnknownStatuses[sampleIndex] =
+                TestDistanceKernelRandomLineSample(RandomDouble(0, 100) < 20, 2, numbersOfNode2OtherCurrents[caseIndex]);
+        }
+
+        lineFeatureMatrix knownFeatures(samplesWithKnownStatuses.data(), numberOfSamplesWithKnownStatuses, weightsToTest[caseIndex]);
+        vector<double> realParts(knownFeatures.NumberOfFeatures);
+        vector<double> imaginaryParts(knownFeatures.NumberOfFeatures);
+        vector<double> fullDistances(numberOfSamplesWithKnownStatuses);
+        vector<double> boundedDistances(numberOfSamplesWithKnownStatuses);
+        vector<nearestNeighbor> candidates(numberOfSamplesWithKnownStatuses);
+        int numberOfMatchingNeighbors = 0;
+        int numberOfExactDistances = 0;
+        int numberOfCloseDistances = 0;
+        int numberOfDistancesWithinBound = 0;
+        long long numberOfAbandonedSamples = 0;
+        double fullSeconds = 0;
+        double boundedSeconds = 0;
+        knnInstrumentationSnapshot before = knnInstrumentation::Snapshot();
+        for (int unknownIndex = 0; unknownIndex < numberOfSamplesWithUnknownStatuses; unknownIndex++) {
+            knownFeatures.ExtractFeatures(samplesWithUnknownStatuses[unknownIndex], realParts.data(), imaginaryParts.data());
+            distanceKernel::SquaredDistances(&knownFeatures, 0, numberOfSamplesWithKnownStatuses, realParts.data(),
+                imaginaryParts.data(), fullDistances.data());
+            for (int sampleIndex = 0; sampleIndex < numberOfSamplesWithKnownStatuses; sampleIndex++) {
+                candidates[sampleIndex].SquaredDistance = fullDistances[sampleIndex];
+                candidates[sampleIndex].Index = sampleIndex;
+                candidates[sampleIndex].IsWorking = knownFeatures.IsWorking(sampleIndex);
+            }
+            nearestNeighborHeap::SelectNearest(candidates.data(), numberOfSamplesWithKnownStatuses, numberOfNearestNeighbors);
+
+            // The scan abandons against the k-th nearest distance found so far, so the final one shows the most it can rule out
+            knnPredictionOfUnknownLineSample testKNN(&knownFeatures, samplesWithUnknownStatuses[unknownIndex], numberOfNearestNeighbors);
+            vector<int> neighborIndices = testKNN.Result().NeighborIndices;
+            bool isMatching = (int)neighborIndices.size() == numberOfNearestNeighbors;
+            for (int neighborIndex = 0; (isMatching == true) && (neighborIndex < numberOfNearestNeighbors); neighborIndex++) {
+                isMatching = neighborIndices[neighborIndex] == candidates[neighborIndex].Index;
+            }
+            if (isMatching == true) numberOfMatchingNeighbors++;
+
+            double bound = candidates[numberOfNearestNeighbors - 1].SquaredDistance;
+            chrono::steady_clock::time_point startTime = chrono::steady_clock::now();
+            for (int passIndex = 0; passIndex < numberOfPasses; passIndex++) {
+                distanceKernel::SquaredDistances(&knownFeatures, 0, numberOfSamplesWithKnownStatuses, realParts.data(),
+                    imaginaryParts.data(), fullDistances.data());
+            }
+            fullSeconds += chrono::duration<double>(chrono::steady_clock::now() - startTime).count();
+            startTime = chrono::steady_clock::now();
+            for (int passIndex = 0; passIndex < numberOfPasses; passIndex++) {
+                distanceKernel::BoundedSquaredDistances(&knownFeatures, 0, numberOfSamplesWithKnownStatuses, realParts.data(),
+                    imaginaryParts.data(), bound, boundedDistances.data());
+            }
+            boundedSeconds += chrono::duration<double>(chrono::steady_clock::now() - startTime).count();
+
+            for (int sampleIndex = 0; sampleIndex < numberOfSamplesWithKnownStatuses; sampleIndex++) {
+                if (boundedDistances[sampleIndex] > bound) {
+                    if (boundedDistances[sampleIndex] < fullDistances[sampleIndex]) numberOfAbandonedSamples++;
+                    continue;
+                }
+                numberOfDistancesWithinBound++;
+                if (boundedDistances[sampleIndex] == fullDistances[sampleIndex]) numberOfExactDistances++;
+                if (abs(boundedDistances[sampleIndex] - fullDistances[sampleIndex]) <= 1e-12 * fullDistances[sampleIndex]) {
+                    numberOfCloseDistances++;
+                }
+            }
+        }
+
+        long long numberOfCountedAbandons = knnInstrumentation::Snapshot().Since(before).Counter(knnCounter::DistancesAbandoned);
+
+        cout << caseNames[caseIndex] << ": nearest neighbors matching the full kernel " << to_string(numberOfMatchingNeighbors) << "/" <<
+            to_string(numberOfSamplesWithUnknownStatuses) << ", exact distances within the bound " << to_string(numberOfExactDistances) <<
+            "/" << to_string(numberOfDistancesWithinBound) << ", within a relative 1e-12 " << to_string(numberOfCloseDistances) << "/" <<
+            to_string(numberOfDistancesWithinBound) << "\n";
+        cout << "Abandoned at the k-th nearest distance: " <<
+            to_string((double)numberOfAbandonedSamples / ((double)numberOfSamplesWithKnownStatuses * numberOfSamplesWithUnknownStatuses)) <<
+            " of the known line samples, " << to_string(fullSeconds / boundedSeconds) << "x the full kernel's speed\n";
+        if (knnInstrumentation::IsEnabled() == true) {
+            cout << "Abandoned line samples counted by the instrumentation: " << to_string(numberOfCountedAbandons) << "\n";
+        }
+
+        for (int sampleIndex = 0; sampleIndex < numberOfSamplesWithKnownStatuses; sampleIndex++) {
+            delete samplesWithKnownStatuses[sampleIndex];
+        }
+        for (int sampleIndex = 0; sampleIndex < numberOfSamplesWithUnknownStatuses; sampleIndex++) {
+            delete samplesWithUnknownStatuses[sampleIndex];
+        }
+    }
+}
+
+
+/// <summary>
+/// Reduce a training set with a few mislabeled line samples by each condensation method and compare the leave-one-out accuracy
+/// before and after and how well the kept line samples predict new line samples.
+/// </summary>
+/// <param name="numberOfSamplesWithKnownStatuses">The number of samples with known line statuses</param>
+/// <param name="numberOfSamplesWithUnknownStatuses">The number of samples with unknown line statuses</param>
+/// <param name="numberOfNearestNeighbors">The number of nearest neighbors the unknown line statuses are compared to</param>
+/// <param name="percentOfMislabeledSamples">The percentage of the known line samples with the wrong status</param>
+/// <param name="percentOfFailureCases">The percentage of the samples that have the line failing</param>
+void TestTrainingSetCondenser(int numberOfSamplesWithKnownStatuses = 4000, int numberOfSamplesWithUnknownStatuses = 500,
+    int numberOfNearestNeighbors = 3, double percentOfMislabeledSamples = 2, double percentOfFailureCases = 20)
+{
+    lineSample** samplesWithKnownStatuses = new lineSample*[numberOfSamplesWithKnownStatuses];
+    lineSample** samplesWithUnknownStatuses = new lineSample*[numberOfSamplesWithUnknownStatuses];
+    if ((samplesWithKnownStatuses == NULL) || (samplesWithUnknownStatuses == NULL)) {
+        cout << "Error: TestTrainingSetCondenser() failed to allocate memory for the line samples.\n";
+        if (samplesWithKnownStatuses != NULL) delete[] samplesWithKnownStatuses;
+        if (samplesWithUnknownStatuses != NULL) delete[] samplesWithUnknownStatuses;
+        return;
+    }
+    for (int sampleIndex = 0; sampleIndex < numberOfSamplesWithKnownStatuses; sampleIndex++) {
+        samplesWithKnownStatuses[sampleIndex] = TestKnnClassRandomLineSample(RandomDouble(0, 100) < percentOfFailureCases);
+        if (RandomDouble(0, 100) < percentOfMislabeledSamples) {
+            samplesWithKnownStatuses[sampleIndex]->IsWorking = !samplesWithKnownStatuses[sampleIndex]->IsWorking;
+        }
+    }
+    for (int sampleIndex = 0; sampleIndex < numberOfSamplesWithUnknownStatuses; sampleIndex++) {
+        samplesWithUnknownStatuses[sampleIndex] = TestKnnClassRandomLineSample(RandomDouble(0, 100) < percentOfFailureCases);
+    }
+
+    threadPool pool(4);
+    lineFeatureMatrix knownFeatures(samplesWithKnownStatuses, numberOfSamplesWithKnownStatuses);
+    int numberOfCorrectPredictions = 0;
+    for (int sampleIndex = 0; sampleIndex < numberOfSamplesWithUnknownStatuses; sampleIndex++) {
+        knnPredictionOfUnknownLineSample testKNN(&knownFeatures, samplesWithUnknownStatuses[sampleIndex], numberOfNearestNeighbors);
+        if (testKNN.PredictedStatus == samplesWithUnknownStatuses[sampleIndex]->IsWorking) numberOfCorrectPredictions++;
+    }
+
+    cout << "\nTraining Set Condensation (" << to_string(percentOfMislabeledSamples) << "% mislabeled):\n";
+    cout << "Full training set: " << to_string(numberOfCorrectPredictions) << "/" << to_string(numberOfSamplesWithUnknownStatuses) <<
+        " new line samples predicted correctly\n";
+    condensationMethod methods[3] = { condensationMethod::Condensed, condensationMethod::Edited, condensationMethod::EditedThenCondensed };
+    for (int methodIndex = 0; methodIndex < 3; methodIndex++) {
+        trainingSetCondenser condenser(&knownFeatures, methods[methodIndex], numberOfNearestNeighbors, &pool);
+        condenser.Print();
+        if (condenser.CondensedFeatures() == NULL) continue;
+
+        numberOfCorrectPredictions = 0;
+        for (int sampleIndex = 0; sampleIndex < numberOfSamplesWithUnknownStatuses; sampleIndex++) {
+            knnPredictionOfUnknownLineSample testKNN(condenser.CondensedFeatures(), samplesWithUnknownStatuses[sampleIndex],
+                numberOfNearestNeighbors);
+            if (testKNN.PredictedStatus == samplesWithUnknownStatuses[sampleIndex]->IsWorking) numberOfCorrectPredictions++;
+        }
+        cout << "New line samples predicted correctly: " << to_string(numberOfCorrectPredictions) << "/" <<
+            to_string(numberOfSamplesWithUnknownStatuses) << "\n";
+    }
+
+    // The line sample constructor hands back the kept line samples for the lineSample** predictor
+    trainingSetCondenser sampleCondenser(samplesWithKnownStatuses, numberOfSamplesWithKnownStatuses,
+        condensationMethod::EditedThenCondensed, numberOfNearestNeighbors, &pool);
+    numberOfCorrectPredictions = 0;
+    for (int sampleIndex = 0; sampleIndex < numberOfSamplesWithUnknownStatuses; sampleIndex++) {
+        knnPredictionOfUnknownLineSample testKNN(sampleCondenser.CondensedSamples.data(), (int)sampleCondenser.CondensedSamples.size(),
+            samplesWithUnknownStatuses[sampleIndex], numberOfNearestNeighbors);
+        if (testKNN.PredictedStatus == samplesWithUnknownStatuses[sampleIndex]->IsWorking) numberOfCorrectPredictions++;
+    }
+    cout << "Kept line samples (" << to_string(sampleCondenser.CondensedSamples.size()) << ") predicting from lineSample**: " <<
+        to_string(numberOfCorrectPredictions) << "/" << to_string(numberOfSamplesWithUnknownStatuses) << " correct\n";
+
+    TestKnnClassFreeLineSamples(samplesWithKnownStatuses, numberOfSamplesWithKnownStatuses);
+    TestKnnClassFreeLineSamples(samplesWithUnknownStatuses, numberOfSamplesWithUnknownStatuses);
+}
+
+
+/// <summary>
+/// Tune the weights and the number of nearest neighbors of a training set with a few mislabeled line samples by leave-one-out
+/// and 5-fold cross-validation, check the tuned leave-one-out accuracy against scans of a feature matrix with the same weights,
+/// and write the best configuration into a line model registry.
+/// </summary>
+/// <param name="numberOfSamplesWithKnownStatuses">The number of samples with known line statuses</param>
+/// <param name="numberOfSamplesWithUnknownStatuses">The number of samples with unknown line statuses</param>
+/// <param name="percentOfMislabeledSamples">The percentage of the known line samples with the wrong status</param>
+/// <param name="percentOfFailureCases">The percentage of the samples that have the line failing</param>
+void TestKnnTuner(int numberOfSamplesWithKnownStatuses = 1500, int numberOfSamplesWithUnknownStatuses = 200,
+    double percentOfMislabeledSamples = 5, double percentOfFailureCases = 20)
+{
+    lineSample** samplesWithKnownStatuses = new lineSample*[numberOfSamplesWithKnownStatuses];
+    lineSample** samplesWithUnknownStatuses = new lineSample*[numberOfSamplesWithUnknownStatuses];
+    if ((samplesWithKnownStatuses == NULL) || (samplesWithUnknownStatuses == NULL)) {
+        cout << "Error: TestKnnTuner() failed to allocate memory for the line samples.\n";
+        if (samplesWithKnownStatuses != NULL) delete[] samplesWithKnownStatuses;
+        if (samplesWithUnknownStatuses != NULL) delete[] samplesWithUnknownStatuses;
+        return;
+    }
+    for (int sampleIndex = 0; sampleIndex < numberOfSamplesWithKnownStatuses; sampleIndex++) {
+        samplesWithKnownStatuses[sampleIndex] = TestKnnClassRandomLineSample(RandomDouble(0, 100) < percentOfFailureCases);
+        if (RandomDouble(0, 100) < percentOfMislabeledSamples) {
+            samplesWithKnownStatuses[sampleIndex]->IsWorking = !samplesWithKnownStatuses[sampleIndex]->IsWorking;
+        }
+    }
+    for (int sampleIndex = 0; sampleIndex < numberOfSamplesWithUnknownStatuses; sampleIndex++) {
+        samplesWithUnknownStatuses[sampleIndex] = TestKnnClassRandomLineSample(RandomDouble(0, 100) < percentOfFailureCases);
+    }
+
+    threadPool pool(4);
+    lineFeatureMatrix knownFeatures(samplesWithKnownStatuses, numberOfSamplesWithKnownStatuses);
+    vector<distanceWeights> weightGrid = knnTuner::WeightGrid({ 5, 20, 40 }, { 1, 4, 8 }, { 0.25, 1, 4 });
+    vector<int> neighborGrid = { 1, 3, 5, 9, 15 };
+
+    cout << "\nKNN Tuner (" << to_string(weightGrid.size() * neighborGrid.size()) << " configurations, " <<
+        to_string(percentOfMislabeledSamples) << "% mislabeled):\n";
+    chrono::steady_clock::time_point startTime = chrono::steady_clock::now();
+    knnTuner leaveOneOutTuner(&knownFeatures, 0, &pool);
+    vector<knnTuningResult> results = leaveOneOutTuner.Evaluate(weightGrid, neighborGrid);
+    double tuningSeconds = chrono::duration<double>(chrono::steady_clock::now() - startTime).count();
+    knnTuningResult bestResult = leaveOneOutTuner.Tune(weightGrid, neighborGrid);
+    cout << "Leave-one-out in " << to_string(tuningSeconds) << " seconds, best: ";
+    bestResult.Print();
+    knnTuner foldTuner(&knownFeatures, 5, &pool);
+    cout << "5-fold best: ";
+    foldTuner.Tune(weightGrid, neighborGrid).Print();
+
+    // Check a few configurations against leave-one-out scans of a feature matrix built with their weights
+    int numberOfMatchingAccuracies = 0;
+    int numberOfCheckedAccuracies = 0;
+    for (int resultIndex = 0; resultIndex < (int)results.size(); resultIndex += 7) {
+        lineFeatureMatrix weightedFeatures(samplesWithKnownStatuses, numberOfSamplesWithKnownStatuses, results[resultIndex].Weights);
+        nearestNeighborHeap heap(results[resultIndex].NumberOfNearestNeighbors);
+        vector<double> realParts(weightedFeatures.NumberOfFeatures);
+        vector<double> imaginaryParts(weightedFeatures.NumberOfFeatures);
+        int numberOfCorrectPredictions = 0;
+        for (int sampleIndex = 0; sampleIndex < numberOfSamplesWithKnownStatuses; sampleIndex++) {
+            weightedFeatures.ExtractFeatures(samplesWithKnownStatuses[sampleIndex], realParts.data(), imaginaryParts.data());
+            heap.Clear();
+            for (int otherSampleIndex = 0; otherSampleIndex < numberOfSamplesWithKnownStatuses; otherSampleIndex++) {
+                if (otherSampleIndex == sampleIndex) continue;
+                heap.Push(weightedFeatures.SquaredDistance(otherSampleIndex, realParts.data(), imaginaryParts.data()), otherSampleIndex,
+                    weightedFeatures.IsWorking(otherSampleIndex));
+            }
+            int numOfWorkingLines = 0;
+            for (int heapIndex = 0; heapIndex < heap.Size(); heapIndex++) numOfWorkingLines += heap.Neighbor(heapIndex).IsWorking ? 1 : 0;
+            if ((numOfWorkingLines > heap.Size() - numOfWorkingLines) == weightedFeatures.IsWorking(sampleIndex)) numberOfCorrectPredictions++;
+        }
+        double accuracy = (double)numberOfCorrectPredictions / numberOfSamplesWithKnownStatuses;
+        if (abs(accuracy - results[resultIndex].Accuracy) <= 1.0 / numberOfSamplesWithKnownStatuses) numberOfMatchingAccuracies++;
+        numberOfCheckedAccuracies++;
+    }
+    cout << "Accuracies matching a full leave-one-out scan: " << to_string(numberOfMatchingAccuracies) << "/" <<
+        to_string(numberOfCheckedAccuracies) << "\n";
+
+    // Write the best configuration into the line's model and compare with a predictor built with it
+    lineModelRegistry registry(5, &pool);
+    registry.AddTrainingSamples(samplesWithKnownStatuses, numberOfSamplesWithKnownStatuses);
+    int node1Number = samplesWithKnownStatuses[0]->Node1LineCurrentNorm->StartNodeNumber;
+    int node2Number = samplesWithKnownStatuses[0]->Node1LineCurrentNorm->DestinationNodeNumber;
+    bool isWritten = bestResult.WriteTo(&registry, node1Number, node2Number);
+    vector<bool> registryStatuses = registry.PredictStatuses(samplesWithUnknownStatuses, numberOfSamplesWithUnknownStatuses);
+    lineFeatureMatrix tunedFeatures(samplesWithKnownStatuses, numberOfSamplesWithKnownStatuses, bestResult.Weights);
+    int numberOfMatchingPredictions = 0;
+    for (int sampleIndex = 0; (sampleIndex < numberOfSamplesWithUnknownStatuses) && (registryStatuses.size() > 0); sampleIndex++) {
+        knnPredictionOfUnknownLineSample testKNN(&tunedFeatures, samplesWithUnknownStatuses[sampleIndex],
+            bestResult.NumberOfNearestNeighbors);
+        if (testKNN.PredictedStatus == registryStatuses[sampleIndex]) numberOfMatchingPredictions++;
+    }
+    cout << "Written into the registry: " << (isWritten ? "yes" : "no") << ", predictions matching the tuned predictor " <<
+        to_string(numberOfMatchingPredictions) << "/" << to_string(numberOfSamplesWithUnknownStatuses) << "\n";
+
+    // A configuration with more nearest neighbors than the line has known line samples mustn't reweight the line
+    knnTuningResult tooManyNeighbors = bestResult;
+    tooManyNeighbors.Weights = distanceWeights(bestResult.Weights.WLine + 1, bestResult.Weights.WNode, bestResult.Weights.WOther);
+    tooManyNeighbors.NumberOfNearestNeighbors = numberOfSamplesWithKnownStatuses + 1;
+    long long weightsVersion = registry.Features(node1Number, node2Number)->WeightsVersion();
+    bool isTooManyWritten = tooManyNeighbors.WriteTo(&registry, node1Number, node2Number);
+    cout << "Written with k above the number of known line samples: " << (isTooManyWritten ? "yes" : "no") << ", weights kept: " <<
+        ((registry.Features(node1Number, node2Number)->WeightsVersion() == weightsVersion) ? "yes" : "no") << ", k kept: " <<
+        ((registry.NumberOfNearestNeighbors() == bestResult.NumberOfNearestNeighbors) ? "yes" : "no") << "\n";
+
+    TestKnnClassFreeLineSamples(samplesWithKnownStatuses, numberOfSamplesWithKnownStatuses);
+    TestKnnClassFreeLineSamples(samplesWithUnknownStatuses, numberOfSamplesWithUnknownStatuses);
+}
+
+
+/// <summary>
+/// Predict unknown line samples with gpuBatchPredictionOfUnknownLineSamples and check its statuses match the CPU batch predictor
+/// and its nearest neighbors match knnQueryEngine, whichever backend this build runs on.
+/// </summary>
+/// <param name="numberOfSamplesWithKnownStatuses">The number of samples with known line statuses</param>
+/// <param name="numberOfSamplesWithUnknownStatuses">The number of samples with unknown line statuses</param>
+/// <param name="numberOfNearestNeighbors">The number of nearest neighbors the unknown line statuses are compared to</param>
+/// <param name="percentOfFailureCases">The percentage of the samples that have the line failing</param>
+void TestGpuBatchPrediction(int numberOfSamplesWithKnownStatuses = 5000, int numberOfSamplesWithUnknownStatuses = 500,
+    int numberOfNearestNeighbors = 7, double percentOfFailureCases = 20)
+{
+    lineSample** samplesWithKnownStatuses = new lineSample*[numberOfSamplesWithKnownStatuses];
+    lineSample** samplesWithUnknownStatuses = new lineSample*[numberOfSamplesWithUnknownStatuses];
+    if ((samplesWithKnownStatuses == NULL) || (samplesWithUnknownStatuses == NULL)) {
+        cout << "Error: TestGpuBatchPrediction() failed to allocate memory for the line samples.\n";
+        if (samplesWithKnownStatuses != NULL) delete[] samplesWithKnownStatuses;
+        if (samplesWithUnknownStatuses != NULL) delete[] samplesWithUnknownStatuses;
+        return;
+    }
+    for (int sampleIndex = 0; sampleIndex < numberOfSamplesWithKnownStatuses; sampleIndex++) {
+        samplesWithKnownStatuses[sampleIndex] = TestKnnClassRandomLineSample(RandomDouble(0, 100) < percentOfFailureCases);
+    }
+    for (int sampleIndex = 0; sampleIndex < numberOfSamplesWithUnknownStatuses; sampleIndex++) {
+        samplesWithUnknownStatuses[sampleIndex] = TestKnnClassRandomLineSample(RandomDouble(0, 100) < percentOfFailureCases);
+    }
+    lineFeatureMatrix knownFeatures(samplesWithKnownStatuses, numberOfSamplesWithKnownStatuses);
+    knnBatchPredictionOfUnknownLineSamples cpuBatch(&knownFeatures, numberOfNearestNeighbors);
+    gpuBatchPredictionOfUnknownLineSamples gpuBatch(&knownFeatures, numberOfNearestNeighbors);
+    const knnQueryEngine engine(&knownFeatures, numberOfNearestNeighbors);
+
+    chrono::steady_clock::time_point startTime = chrono::steady_clock::now();
+    vector<bool> gpuStatuses = gpuBatch.PredictStatuses(samplesWithUnknownStatuses, numberOfSamplesWithUnknownStatuses);
+    double gpuSeconds = chrono::duration<double>(chrono::steady_clock::now() - startTime).count();
+    vector<bool> cpuStatuses = cpuBatch.PredictStatuses(samplesWithUnknownStatuses, numberOfSamplesWithUnknownStatuses);
+
+    vector<nearestNeighbor> gpuNeighbors((size_t)numberOfSamplesWithUnknownStatuses * numberOfNearestNeighbors);
+    vector<nearestNeighbor> engineNeighbors(numberOfNearestNeighbors);
+    bool isPredicted = gpuBatch.PredictNearestNeighbors(samplesWithUnknownStatuses, numberOfSamplesWithUnknownStatuses,
+        gpuNeighbors.data());
+    int numberOfMatchingStatuses = 0;
+    int numberOfMatchingNeighbors = 0;
+    for (int sampleIndex = 0; (sampleIndex < numberOfSamplesWithUnknownStatuses) && (gpuStatuses.size() > 0) &&
+        (cpuStatuses.size() > 0) && (isPredicted == true); sampleIndex++) {
+        if (gpuStatuses[sampleIndex] == cpuStatuses[sampleIndex]) numberOfMatchingStatuses++;
+
+        // The device adds the terms in column order, so its distances may differ from the CPU kernels' in the last bits
+        bool predictedStatus = true;
+        engine.PredictStatus(samplesWithUnknownStatuses[sampleIndex], &predictedStatus, numberOfNearestNeighbors,
+            engineNeighbors.data());
+        bool isMatching = true;
+        for (int neighborIndex = 0; neighborIndex < numberOfNearestNeighbors; neighborIndex++) {
+            const nearestNeighbor& gpuNeighbor = gpuNeighbors[(size_t)sampleIndex * numberOfNearestNeighbors + neighborIndex];
+            const nearestNeighbor& engineNeighbor = engineNeighbors[neighborIndex];
+            if ((gpuNeighbor.Index != engineNeighbor.Index) || (gpuNeighbor.IsWorking != engineNeighbor.IsWorking) ||
+                (abs(gpuNeighbor.SquaredDistance - engineNeighbor.SquaredDistance) > 1e-9 * (1 + engineNeighbor.SquaredDistance))) {
+                isMatching = false;
+            }
+        }
+        if (isMatching == true) numberOfMatchingNeighbors++;
+    }
+
+    cout << "\nGPU Batch Prediction (k = " << to_string(numberOfNearestNeighbors) << "):\n";
+    cout << "Backend: " << gpuBatch.BackendName() << "\n";
+    cout << "Statuses matching the CPU batch predictor: " << to_string(numberOfMatchingStatuses) << "/" <<
+        to_string(numberOfSamplesWithUnknownStatuses) << "\n";
+    cout << "Nearest neighbors matching the query engine: " << to_string(numberOfMatchingNeighbors) << "/" <<
+        to_string(numberOfSamplesWithUnknownStatuses) << "\n";
+    cout << "Predictions per second: " << to_string(numberOfSamplesWithUnknownStatuses / gpuSeconds) << "\n";
+
+    TestKnnClassFreeLineSamples(samplesWithKnownStatuses, numberOfSamplesWithKnownStatuses);
+    TestKnnClassFreeLineSamples(samplesWithUnknownStatuses, numberOfSamplesWithUnknownStatuses);
+}
+
+
+nodeCapture* TestIngestPipelineNodeCapture(int, phasor, phasor*, int*, int, double, int);
+void TestIngestPipelineLineCapture(bool, int, int, nodeCapture**, nodeCapture**);
+/// <summary>
+/// Stream line captures through ingestPipeline from two threads and check every prediction matches estimating, normalizing, and
+/// predicting the same capture synchronously with lineModelRegistry, then flood a pipeline with a small first queue through
+/// TrySubmit() to see the backpressure refuse captures instead of queueing them without bound, check a burst on one substation
+/// doesn't get the captures of another one refused, and check Finish() called while two threads keep submitting still predicts
+/// every capture it accepted.
+/// </summary>
+/// <param name="numberOfSamplesWithKnownStatuses">The number of samples with known line statuses per line</param>
+/// <param name="numberOfCaptures">The number of line captures streamed through the pipeline</param>
+/// <param name="burstQueueCapacity">The capacity of the queues of the flooded pipeline</param>
+/// <param name="percentOfFailureCases">The percentage of the samples that have the line failing</param>
+void TestIngestPipeline(int numberOfSamplesWithKnownStatuses = 1000, int numberOfCaptures = 600, int burstQueueCapacity = 8,
+    double percentOfFailureCases = 20)
+{
+    int lineNodeNumbers[3][2] = { { 1, 2 }, { 3, 4 }, { 5, 6 } };    // The last line isn't registered
+
+    lineSample** samplesWithKnownStatuses = new lineSample*[2 * numberOfSamplesWithKnownStatuses];
+    nodeCapture** node1Captures = new nodeCapture*[numberOfCaptures];
+    nodeCapture** node2Captures = new nodeCapture*[numberOfCaptures];
+    if ((samplesWithKnownStatuses == NULL) || (node1Captures == NULL) || (node2Captures == NULL)) {
+        cout << "Error: TestIngestPipeline() failed to allocate memory for the line samples and the captures.\n";
+        if (samplesWithKnownStatuses != NULL) delete[] samplesWithKnownStatuses;
+        if (node1Captures != NULL) delete[] node1Captures;
+        if (node2Captures != NULL) delete[] node2Captures;
+        return;
+    }
+    for (int sampleIndex = 0; sampleIndex < 2 * numberOfSamplesWithKnownStatuses; sampleIndex++) {
+        int lineIndex = sampleIndex % 2;
+        samplesWithKnownStatuses[sampleIndex] = TestKnnClassRandomLineSample(RandomDouble(0, 100) < percentOfFailureCases,
+            lineNodeNumbers[lineIndex][0], lineNodeNumbers[lineIndex][1]);
+    }
+    lineModelRegistry registry(5);
+    registry.AddTrainingSamples(samplesWithKnownStatuses, 2 * numberOfSamplesWithKnownStatuses);
+
+    // The synchronous predictions of the same captures
+    vector<bool> actualStatuses(numberOfCaptures);
+    vector<int> expectedStatuses(numberOfCaptures, -1);
+    unordered_map<const nodeCapture*, int> captureIndices;
+    for (int captureIndex = 0; captureIndex < numberOfCaptures; captureIndex++) {
+        int lineIndex = (captureIndex % 50 == 49) ? 2 : captureIndex % 2;
+        actualStatuses[captureIndex] = !(RandomDouble(0, 100) < percentOfFailureCases);
+        TestIngestPipelineLineCapture(!actualStatuses[captureIndex], lineNodeNumbers[lineIndex][0], lineNodeNumbers[lineIndex][1],
+            &node1Captures[captureIndex], &node2Captures[captureIndex]);
+        captureIndices[node1Captures[captureIndex]] = captureIndex;
+
+        lineSample sample(node1Captures[captureIndex]->EstimateNode(), node2Captures[captureIndex]->EstimateNode(), true);
+        bool predictedStatus = true;
+        if ((registry.Features(lineNodeNumbers[lineIndex][0], lineNodeNumbers[lineIndex][1]) != NULL) &&
+            (registry.PredictStatus(&sample, &predictedStatus) == true)) expectedStatuses[captureIndex] = predictedStatus ? 1 : 0;
+    }
+
+    // Two threads submit half of the captures each while the stages drain them
+    vector<int> pipelineStatuses(numberOfCaptures, -2);
+    chrono::steady_clock::time_point startTime = chrono::steady_clock::now();
+    {
+        ingestPipeline pipeline(&registry, [&](const pipelineItem* item) {
+            pipelineStatuses[captureIndices[item->Node1Capture]] = (item->IsFailed == true) ? -1 : (item->PredictedStatus ? 1 : 0);
+        }, 64, 2, 1, 2, 16);
+        thread submitter([&]() {
+            for (int captureIndex = 1; captureIndex < numberOfCaptures; captureIndex += 2) {
+                pipeline.Submit(node1Captures[captureIndex], node2Captures[captureIndex]);
+            }
+        });
+        for (int captureIndex = 0; captureIndex < numberOfCaptures; captureIndex += 2) {
+            pipeline.Submit(node1Captures[captureIndex], node2Captures[captureIndex]);
+        }
+        submitter.join();
+        pipeline.Finish();
+        double seconds = chrono::duration<double>(chrono::steady_clock::now() - startTime).count();
+
+        int numberOfMatchingPredictions = 0;
+        int numberOfCorrectPredictions = 0;
+        for (int captureIndex = 0; captureIndex < numberOfCaptures; captureIndex++) {
+            if (pipelineStatuses[captureIndex] == expectedStatuses[captureIndex]) numberOfMatchingPredictions++;
+            if (pipelineStatuses[captureIndex] == (actualStatuses[captureIndex] ? 1 : 0)) numberOfCorrectPredictions++;
+        }
+        cout << "\nIngest Pipeline:\n";
+        cout << "Predictions matching the synchronous path: " << to_string(numberOfMatchingPredictions) << "/" <<
+            to_string(numberOfCaptures) << "\n";
+        cout << "Correct predictions: " << to_string(numberOfCorrectPredictions) << "/" << to_string(numberOfCaptures) <<
+            " (the captures of the unregistered line fail)\n";
+        cout << "Captures per second: " << to_string(numberOfCaptures / seconds) << "\n";
+        pipeline.PrintStatistics();
+    }
+
+    // A burst into a pipeline with small queues and one slow estimation worker
+    int numberOfRefusedCaptures = 0;
+    int maximumDepth = 0;
+    {
+        ingestPipeline pipeline(&registry, NULL, burstQueueCapacity, 1, 1, 1, 4);
+        for (int captureIndex = 0; captureIndex < numberOfCaptures; captureIndex++) {
+            nodeCapture* node1Capture = NULL;
+            nodeCapture* node2Capture = NULL;
+            TestIngestPipelineLineCapture(RandomDouble(0, 100) < percentOfFailureCases, 1, 2, &node1Capture, &node2Capture);
+            if (pipeline.TrySubmit(node1Capture, node2Capture) == false) {
+                numberOfRefusedCaptures++;
+                delete node1Capture;
+                delete node2Capture;
+            }
+        }
+        pipeline.Finish();
+        maximumDepth = pipeline.MaximumQueueDepth(pipelineStage::PhasorEstimation);
+        cout << "Burst of " << to_string(numberOfCaptures) << " captures into queues of " << to_string(burstQueueCapacity) <<
+            ": refused " << to_string(numberOfRefusedCaptures) << " (counted " << to_string(pipeline.NumberOfRejectedCaptures()) <<
+            "), predicted " << to_string(pipeline.NumberOfPredictions()) << ", maximum depth within the capacity: " <<
+            (maximumDepth <= burstQueueCapacity ? "yes" : "no") << "\n";
+    }
+
+    // The same burst while another substation submits a capture whenever its last one was predicted
+    {
+        atomic<bool> isOtherLineIdle(true);
+        int numberOfOtherCaptures = 0;
+        int numberOfRefusedOtherCaptures = 0;
+        int numberOfRefusedBurstCaptures = 0;
+        ingestPipeline pipeline(&registry, [&](const pipelineItem* item) {
+            if (item->Node1Capture->NodeNumber == lineNodeNumbers[1][0]) isOtherLineIdle.store(true);
+        }, burstQueueCapacity, 1, 1, 1, 4);
+        for (int captureIndex = 0; captureIndex < numberOfCaptures; captureIndex++) {
+            nodeCapture* node1Capture = NULL;
+            nodeCapture* node2Capture = NULL;
+            if (isOtherLineIdle.exchange(false) == true) {
+                TestIngestPipelineLineCapture(RandomDouble(0, 100) < percentOfFailureCases, lineNodeNumbers[1][0],
+                    lineNodeNumbers[1][1], &node1Capture, &node2Capture);
+                numberOfOtherCaptures++;
+                if (pipeline.TrySubmit(node1Capture, node2Capture) == false) {
+                    numberOfRefusedOtherCaptures++;
+                    isOtherLineIdle.store(true);
+                    delete node1Capture;
+                    delete node2Capture;
+                }
+            }
+            TestIngestPipelineLineCapture(RandomDouble(0, 100) < percentOfFailureCases, lineNodeNumbers[0][0],
+                lineNodeNumbers[0][1], &node1Capture, &node2Capture);
+            if (pipeline.TrySubmit(node1Capture, node2Capture) == false) {
+                numberOfRefusedBurstCaptures++;
+                delete node1Capture;
+                delete node2Capture;
+            }
+        }
+        pipeline.Finish();
+        cout << "Burst with at most " << to_string(pipeline.MaximumInFlightPerSource()) << " captures per substation in flight: " <<
+            "refused " << to_string(numberOfRefusedBurstCaptures) << "/" << to_string(numberOfCaptures) <<
+            " of the bursting substation, " << to_string(numberOfRefusedOtherCaptures) << "/" << to_string(numberOfOtherCaptures) <<
+            " of the other one\n";
+    }
+
+    // Finish() while Submit() and TrySubmit() keep going on two threads
+    {
+        atomic<bool> isFinishing(false);
+        atomic<long long> numberOfAcceptedCaptures(0);
+        atomic<long long> numberOfFinishedCaptures(0);
+        ingestPipeline pipeline(&registry, [&](const pipelineItem* item) {
+            numberOfFinishedCaptures.fetch_add(1);
+        }, burstQueueCapacity, 1, 1, 1, 4, burstQueueCapacity);
+        auto submitUntilFinished = [&](bool isWaiting) {
+            while (true) {
+                bool wasFinishing = isFinishing.load();
+                nodeCapture* node1Capture = NULL;
+                nodeCapture* node2Capture = NULL;
+                TestIngestPipelineLineCapture(false, lineNodeNumbers[0][0], lineNodeNumbers[0][1], &node1Capture, &node2Capture);
+                bool isSubmitted = isWaiting ? pipeline.Submit(node1Capture, node2Capture) : pipeline.TrySubmit(node1Capture, node2Capture);
+                if (isSubmitted == true) {
+                    numberOfAcceptedCaptures.fetch_add(1);
+                    continue;
+                }
+                delete node1Capture;
+                delete node2Capture;
+
+                // Submit() only refuses after Finish(), and TrySubmit() refuses every capture once it's done
+                if ((isWaiting == true) || (wasFinishing == true)) break;
+            }
+        };
+        thread waitingSubmitter(submitUntilFinished, true);
+        thread tryingSubmitter(submitUntilFinished, false);
+        this_thread::sleep_for(chrono::milliseconds(20));
+        isFinishing.store(true);
+        pipeline.Finish();
+        waitingSubmitter.join();
+        tryingSubmitter.join();
+        cout << "Finish() while two threads submit: predicted " << to_string(numberOfFinishedCaptures.load()) << "/" <<
+            to_string(numberOfAcceptedCaptures.load()) << " accepted captures\n";
+    }
+
+    // The pipeline freed the captures it adopted
+    delete[] node1Captures;
+    delete[] node2Captures;
+    TestKnnClassFreeLineSamples(samplesWithKnownStatuses, 2 * numberOfSamplesWithKnownStatuses);
+}
+/// <summary>
+/// Create the waveforms of a node with phasors within 10% of the average phasors, sampled over whole cycles at 60 Hz.
+/// </summary>
+/// <param name="nodeNumber">The unique identifying number for the node</param>
+/// <param name="averageVoltage">The average voltage phasor</param>
+/// <param name="averageCurrents">The array of average current phasors</param>
+/// <param name="currentDestinationNodes">The array of current destination node numbers</param>
+/// <param name="numberOfCurrents">The number of currents</param>
+/// <param name="samplesPerSecond">The sample rate</param>
+/// <param name="numberOfSamples">The number of samples per waveform</param>
+/// <returns>The capture of the node (NULL if the memory allocation failed)</returns>
+nodeCapture* TestIngestPipelineNodeCapture(int nodeNumber, phasor averageVoltage, phasor* averageCurrents,
+    int* currentDestinationNodes, int numberOfCurrents, double samplesPerSecond, int numberOfSamples)
+{
+    double frequency = 60;  // sine wave frequency in Hz
+    vector<double> values(numberOfSamples);
+    waveform** channels = new waveform*[numberOfCurrents + 1];
+    if (channels == NULL) return NULL;
+
+    // The first channel is the voltage and the rest are the currents
+    for (int channelIndex = 0; channelIndex <= numberOfCurrents; channelIndex++) {
+        phasor average = (channelIndex == 0) ? averageVoltage : averageCurrents[channelIndex - 1];
+        double rms = RandomDouble(0.9 * average.RMSvalue(), 1.1 * average.RMSvalue());
+        for (int sampleIndex = 0; sampleIndex < numberOfSamples; sampleIndex++) {
+            values[sampleIndex] = sqrt(2) * rms *
+                sin(2 * M_PI * frequency * sampleIndex / samplesPerSecond + M_PI / 180 * average.PhaseAngleDegrees());
+        }
+        channels[channelIndex] = new waveform(values.data(), numberOfSamples, samplesPerSecond);
+    }
+
+    waveform** currents = new waveform*[numberOfCurrents];
+    if (currents == NULL) {
+        for (int channelIndex = 0; channelIndex <= numberOfCurrents; channelIndex++) delete channels[channelIndex];
+        delete[] channels;
+        return NULL;
+    }
+    for (int currentIndex = 0; currentIndex < numberOfCurrents; currentIndex++) currents[currentIndex] = channels[currentIndex + 1];
+    nodeCapture* node = new nodeCapture(nodeNumber, channels[0], currents, currentDestinationNodes, numberOfCurrents);
+    delete[] channels;
+    return node;
+}
+/// <summary>
+/// Create the captures of the two nodes of a line with the same average phasors as TestKnnClassRandomLineSample().
+/// </summary>
+/// <param name="isFailing">True if the line is failing</param>
+/// <param name="node1Number">The number of the first node of the line</param>
+/// <param name="node2Number">The number of the second node of the line</param>
+/// <param name="node1Capture">The capture of the first node</param>
+/// <param name="node2Capture">The capture of the second node</param>
+void TestIngestPipelineLineCapture(bool isFailing, int node1Number, int node2Number, nodeCapture** node1Capture,
+    nodeCapture** node2Capture)
+{
+    double samplesPerSecond = 7680;
+    int numberOfSamples = 256;  // 2 cycles
+
+    phasor node1AverageCurrentPhasors[2] = { phasor(25, -165), phasor(25, 15) };
+    phasor node2AverageCurrentPhasors[2] = { phasor(25, 15), phasor(25, -165) };
+    phasor node1AverageVoltagePhasor = phasor(250000, 15);
+    phasor node2AverageVoltagePhasor = phasor(250000, 15);
+    if (isFailing == true) {
+        node1AverageCurrentPhasors[0] = phasor(250, -135);
+        node1AverageCurrentPhasors[1] = phasor(250, 45);
+        node2AverageCurrentPhasors[0] = phasor(250, 45);
+        node2AverageCurrentPhasors[1] = phasor(250, -135);
+        node1AverageVoltagePhasor = phasor(50000, 90);
+        node2AverageVoltagePhasor = phasor(50000, 90);
+    }
+    int node1CurrentDestinationNodes[2] = { 0, node2Number };
+    int node2CurrentDestinationNodes[2] = { 0, node1Number };
+
+    *node1Capture = TestIngestPipelineNodeCapture(node1Number, node1AverageVoltagePhasor, node1AverageCurrentPhasors,
+        node1CurrentDestinationNodes, 2, samplesPerSecond, numberOfSamples);
+    *node2Capture = TestIngestPipelineNodeCapture(node2Number, node2AverageVoltagePhasor, node2AverageCurrentPhasors,
+        node2CurrentDestinationNodes, 2, samplesPerSecond, numberOfSamples);
+}
+
+
 int main()
 {
     TestDivideByZeroPhasorException();
     TestZeroToNonPositivePowerException();
     TestParameterPhasorCalcAccuracy();
+    TestPhasorEstimatorClass();
+    TestWaveformClass();
     TestNodeClass();
     TestLineClass();
     TestDistanceClass();
     TestKnnClass();
+    TestKnnBatchClass();
+    TestKnnParallelClass();
+    TestKdTreeClass();
+    TestIvfClass();
+    TestLineModelRegistryClass();
+    TestGridSnapshotClass();
+    TestTrainingSetFileClass();
+    TestNodeCsvReaderClass();
+    TestSampleArenaClass();
+    TestLineSampleAllocations();
+    TestOnlineTrainingStoreClass();
+    TestKnnQueryEngineClass();
+    TestKnnNearestNeighborSweep();
+    TestKnnInstrumentation();
+    TestDistanceKernelSpecializations();
+    TestCompactFeatureIndexClass();
+    TestKnnPredictionResult();
+    TestBoundedDistanceKernel();
+    TestTrainingSetCondenser();
+    TestKnnTuner();
+    TestGpuBatchPrediction();
+    TestIngestPipeline();
 }
\ No newline at end of file
@@ -0,0 +1,89 @@
+#define _USE_MATH_DEFINES
+
+using namespace std;
+
+#include <atomic>
+#include <cmath>
+#include <cstdlib>
+#include <exception>
+#include <iostream>
+#include <new>
+#include <string>
+#include "allocationCounter.h"
+
+
+#ifdef KNN_INSTRUMENTATION
+/// <summary>
+/// The number of calls to the global operator new (the default array and nothrow forms go through the unaligned form, and the
+/// aligned forms are replaced below)
+/// </summary>
+static atomic<long long> numberOfAllocations(0);
+/// <summary>
+/// The number of calls to the global operator new made by each thread
+/// </summary>
+static thread_local long long numberOfAllocationsOnThisThread = 0;
+
+void* operator new(size_t bytes)
+{
+    numberOfAllocations.fetch_add(1, memory_order_relaxed);
+    numberOfAllocationsOnThisThread++;
+    void* memory = malloc(bytes == 0 ? 1 : bytes);
+    if (memory == NULL) throw bad_alloc();
+    return memory;
+}
+void* operator new(size_t bytes, align_val_t alignment)
+{
+    numberOfAllocations.fetch_add(1, memory_order_relaxed);
+    numberOfAllocationsOnThisThread++;
+
+    // aligned_alloc() needs the size to be a multiple of the alignment
+    size_t alignmentBytes = (size_t)alignment;
+    if (alignmentBytes < sizeof(void*)) alignmentBytes = sizeof(void*);
+    size_t alignedBytes = (bytes + alignmentBytes - 1) / alignmentBytes * alignmentBytes;
+    void* memory = aligned_alloc(alignmentBytes, alignedBytes == 0 ? alignmentBytes : alignedBytes);
+    if (memory == NULL) throw bad_alloc();
+    return memory;
+}
+void operator delete(void* memory) noexcept
+{
+    free(memory);
+}
+void operator delete(void* memory, size_t) noexcept
+{
+    free(memory);
+}
+void operator delete(void* memory, align_val_t) noexcept
+{
+    free(memory);
+}
+void operator delete(void* memory, size_t, align_val_t) noexcept
+{
+    free(memory);
+}
+#endif
+
+
+const bool allocationCounter::IsCounting()
+{
+#ifdef KNN_INSTRUMENTATION
+    return true;
+#else
+    return false;
+#endif
+}
+const long long allocationCounter::NumberOfAllocations()
+{
+#ifdef KNN_INSTRUMENTATION
+    return numberOfAllocations.load(memory_order_relaxed);
+#else
+    return 0;
+#endif
+}
+const long long allocationCounter::NumberOfAllocationsOnThisThread()
+{
+#ifdef KNN_INSTRUMENTATION
+    return numberOfAllocationsOnThisThread;
+#else
+    return 0;
+#endif
+}
\ No newline at end of file
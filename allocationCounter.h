@@ -0,0 +1,33 @@
+#pragma once
+
+#define _USE_MATH_DEFINES
+
+using namespace std;
+
+#include <atomic>
+#include <cmath>
+#include <exception>
+#include <iostream>
+#include <string>
+
+
+/// <summary>
+/// Counts the calls to the global operator new so the allocations of building a sample can be measured by reading the count before
+/// and after. allocationCounter.cpp only replaces operator new when KNN_INSTRUMENTATION is defined, so a default build leaves the
+/// host program's allocator alone and every count reads 0.
+/// </summary>
+class allocationCounter {
+public:
+    /// <summary>
+    /// True if the program was compiled with KNN_INSTRUMENTATION defined and operator new is counted
+    /// </summary>
+    static const bool IsCounting();
+    /// <summary>
+    /// The number of calls to the global operator new since the program started
+    /// </summary>
+    static const long long NumberOfAllocations();
+    /// <summary>
+    /// The number of calls to the global operator new made by the calling thread
+    /// </summary>
+    static const long long NumberOfAllocationsOnThisThread();
+};
\ No newline at end of file
@@ -0,0 +1,226 @@
+#pragma once
+
+#define _USE_MATH_DEFINES
+
+using namespace std;
+
+#include <atomic>
+#include <chrono>
+#include <exception>
+#include <iostream>
+#include <string>
+#include <thread>
+
+
+/// <summary>
+/// A bounded lock-free multi-producer multi-consumer queue (Vyukov's ring of sequenced cells) that connects the stages of
+/// ingestPipeline. A full queue is the backpressure: TryPush() fails and Push() waits until a consumer makes room. Push() and Pop()
+/// spin with yields and then short sleeps instead of locking, so an idle stage costs little and a busy one never blocks on a mutex.
+/// </summary>
+/// <typeparam name="T">The type of the elements (a pointer or another cheaply copied type)</typeparam>
+template <class T>
+class boundedQueue {
+private:
+    /// <summary>
+    /// The number of failed attempts Push() and Pop() yield for before sleeping between attempts
+    /// </summary>
+    static const int yieldsBeforeSleeping = 64;
+    /// <summary>
+    /// The number of cells (a power of 2 so the position of a cell is a mask away)
+    /// </summary>
+    size_t capacity = 0;
+    /// <summary>
+    /// The sequence of each cell. A cell is free for the push at position p when its sequence is p and holds the element for the
+    /// pop at position p when its sequence is p + 1.
+    /// </summary>
+    atomic<size_t>* sequences = NULL;
+    /// <summary>
+    /// The element of each cell
+    /// </summary>
+    T* elements = NULL;
+    /// <summary>
+    /// The position of the next push (on its own cache line so producers and consumers don't false share)
+    /// </summary>
+    alignas(64) atomic<size_t> pushPosition;
+    /// <summary>
+    /// The position of the next pop
+    /// </summary>
+    alignas(64) atomic<size_t> popPosition;
+    /// <summary>
+    /// True once every producer is done, so Pop() returns false instead of waiting once the queue is empty
+    /// </summary>
+    alignas(64) atomic<bool> isClosed;
+    /// <summary>
+    /// The largest number of elements the queue held after a push
+    /// </summary>
+    atomic<size_t> maximumSize;
+
+
+    /// <summary>
+    /// Wait before another attempt at a push or a pop.
+    /// </summary>
+    /// <param name="numberOfAttempts">The number of failed attempts so far</param>
+    static const void Backoff(int numberOfAttempts)
+    {
+        if (numberOfAttempts < yieldsBeforeSleeping) this_thread::yield();
+        else this_thread::sleep_for(chrono::microseconds(50));
+    }
+
+
+public:
+    /// <summary>
+    /// The constructor
+    /// </summary>
+    /// <param name="capacity">The number of elements the queue holds (rounded up to a power of 2)</param>
+    explicit boundedQueue(int capacity)
+    {
+        pushPosition.store(0);
+        popPosition.store(0);
+        isClosed.store(false);
+        maximumSize.store(0);
+
+        this->capacity = 2;
+        while ((int)this->capacity < capacity) this->capacity *= 2;
+        sequences = new atomic<size_t>[this->capacity];
+        elements = new T[this->capacity];
+        if ((sequences == NULL) || (elements == NULL)) {
+            cout << "Error: boundedQueue() failed to allocate memory for the cells\n";
+            this->capacity = 0;
+            return;
+        }
+        for (size_t cellIndex = 0; cellIndex < this->capacity; cellIndex++) sequences[cellIndex].store(cellIndex, memory_order_relaxed);
+    }
+
+    /// <summary>
+    /// The deconstructor frees the cells but not what the elements point to
+    /// </summary>
+    ~boundedQueue()
+    {
+        if (sequences != NULL) delete[] sequences;
+        if (elements != NULL) delete[] elements;
+        sequences = NULL;
+        elements = NULL;
+    }
+
+
+    /// <summary>
+    /// Add an element if the queue isn't full. It's safe to call from any number of threads at once.
+    /// </summary>
+    /// <param name="element">The element</param>
+    /// <returns>True if the element was added</returns>
+    const bool TryPush(const T& element)
+    {
+        if (capacity == 0) return false;
+        size_t position = pushPosition.load(memory_order_relaxed);
+        while (true) {
+            size_t sequence = sequences[position & (capacity - 1)].load(memory_order_acquire);
+            long long difference = (long long)sequence - (long long)position;
+            if (difference == 0) {
+                if (pushPosition.compare_exchange_weak(position, position + 1, memory_order_relaxed) == true) break;
+            }
+            else if (difference < 0) return false;    // The cell still holds the element from a lap ago
+            else position = pushPosition.load(memory_order_relaxed);
+        }
+        elements[position & (capacity - 1)] = element;
+        sequences[position & (capacity - 1)].store(position + 1, memory_order_release);
+
+        size_t size = Size();
+        size_t largestSize = maximumSize.load(memory_order_relaxed);
+        while ((size > largestSize) && (maximumSize.compare_exchange_weak(largestSize, size, memory_order_relaxed) == false));
+        return true;
+    }
+    /// <summary>
+    /// Take the oldest element if the queue isn't empty. It's safe to call from any number of threads at once.
+    /// </summary>
+    /// <param name="element">The element taken</param>
+    /// <returns>True if an element was taken</returns>
+    const bool TryPop(T* element)
+    {
+        if (capacity == 0) return false;
+        size_t position = popPosition.load(memory_order_relaxed);
+        while (true) {
+            size_t sequence = sequences[position & (capacity - 1)].load(memory_order_acquire);
+            long long difference = (long long)sequence - (long long)(position + 1);
+            if (difference == 0) {
+                if (popPosition.compare_exchange_weak(position, position + 1, memory_order_relaxed) == true) break;
+            }
+            else if (difference < 0) return false;    // The cell wasn't pushed to yet
+            else position = popPosition.load(memory_order_relaxed);
+        }
+        *element = elements[position & (capacity - 1)];
+        sequences[position & (capacity - 1)].store(position + capacity, memory_order_release);
+        return true;
+    }
+    /// <summary>
+    /// Add an element and wait for room while the queue is full.
+    /// </summary>
+    /// <param name="element">The element</param>
+    /// <returns>True if the element was added (false if the queue was closed)</returns>
+    const bool Push(const T& element)
+    {
+        for (int numberOfAttempts = 0; TryPush(element) == false; numberOfAttempts++) {
+            if ((isClosed.load(memory_order_acquire) == true) || (capacity == 0)) return false;
+            Backoff(numberOfAttempts);
+        }
+        return true;
+    }
+    /// <summary>
+    /// Take the oldest element and wait for one while the queue is empty.
+    /// </summary>
+    /// <param name="element">The element taken</param>
+    /// <returns>True if an element was taken (false once the queue is closed and empty)</returns>
+    const bool Pop(T* element)
+    {
+        for (int numberOfAttempts = 0; TryPop(element) == false; numberOfAttempts++) {
+            // Every push happened before the close, so one more attempt after seeing it drains whatever is left
+            if (isClosed.load(memory_order_acquire) == true) return TryPop(element);
+            Backoff(numberOfAttempts);
+        }
+        return true;
+    }
+    /// <summary>
+    /// Wait for at least one element and take up to a batch of them without waiting for more.
+    /// </summary>
+    /// <param name="elements">The array of at least maximumNumberOfElements elements to fill</param>
+    /// <param name="maximumNumberOfElements">The largest number of elements to take</param>
+    /// <returns>The number of elements taken (0 once the queue is closed and empty)</returns>
+    const int PopBatch(T* elements, int maximumNumberOfElements)
+    {
+        if ((maximumNumberOfElements <= 0) || (Pop(elements) == false)) return 0;
+        int numberOfElements = 1;
+        while ((numberOfElements < maximumNumberOfElements) && (TryPop(elements + numberOfElements) == true)) numberOfElements++;
+        return numberOfElements;
+    }
+    /// <summary>
+    /// Mark that nothing more will be pushed. It must only be called once every producer is done pushing.
+    /// </summary>
+    const void Close()
+    {
+        isClosed.store(true, memory_order_release);
+    }
+
+    /// <summary>
+    /// The number of elements the queue holds (a snapshot that can be stale by the time it's read)
+    /// </summary>
+    const size_t Size() const
+    {
+        size_t pushes = pushPosition.load(memory_order_relaxed);
+        size_t pops = popPosition.load(memory_order_relaxed);
+        if (pops >= pushes) return 0;
+        return pushes - pops;
+    }
+    /// <summary>
+    /// The largest number of elements the queue held after a push
+    /// </summary>
+    const size_t MaximumSize() const
+    {
+        return maximumSize.load(memory_order_relaxed);
+    }
+    /// <summary>
+    /// The number of elements the queue holds when it's full
+    /// </summary>
+    const size_t Capacity() const
+    {
+        return capacity;
+    }
+};
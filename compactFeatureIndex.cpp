@@ -0,0 +1,229 @@
+#define _USE_MATH_DEFINES
+
+using namespace std;
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <exception>
+#include <iostream>
+#include <memory>
+#include <new>
+#include <string>
+#include <vector>
+#include "lineSample.h"
+#include "lineFeatureMatrix.h"
+#include "nearestNeighbor.h"
+#include "nearestNeighborHeap.h"
+#include "nearestNeighborIndex.h"
+#include "knnQueryScratch.h"
+#include "compactFeatureIndex.h"
+
+
+const bool compactFeatureIndex::BuildFloatColumns()
+{
+    int numberOfColumns = 2 * features->NumberOfFeatures;
+    floatColumns = (float*)::operator new[]((size_t)numberOfColumns * stride * sizeof(float), align_val_t(columnAlignment), nothrow);
+    if (floatColumns == NULL) {
+        MemoryAllocationFailure("floatColumns");
+        return false;
+    }
+
+    for (int columnIndex = 0; columnIndex < numberOfColumns; columnIndex++) {
+        const double* column = (columnIndex % 2 == 0) ? features->RealColumn(columnIndex / 2) :
+            features->ImaginaryColumn(columnIndex / 2);
+        float* floatColumn = floatColumns + (size_t)columnIndex * stride;
+        for (int sampleIndex = 0; sampleIndex < stride; sampleIndex++) {
+            floatColumn[sampleIndex] = (sampleIndex < features->NumberOfSamples) ? (float)column[sampleIndex] : 0;
+        }
+    }
+    return true;
+}
+const bool compactFeatureIndex::BuildQuantizedColumns()
+{
+    int numberOfColumns = 2 * features->NumberOfFeatures;
+    quantizedColumns = (int8_t*)::operator new[]((size_t)numberOfColumns * stride, align_val_t(columnAlignment), nothrow);
+    if (quantizedColumns == NULL) {
+        MemoryAllocationFailure("quantizedColumns");
+        return false;
+    }
+    columnScales = new float[numberOfColumns];
+    if (columnScales == NULL) {
+        MemoryAllocationFailure("columnScales");
+        return false;
+    }
+    columnOffsets = new float[numberOfColumns];
+    if (columnOffsets == NULL) {
+        MemoryAllocationFailure("columnOffsets");
+        return false;
+    }
+
+    for (int columnIndex = 0; columnIndex < numberOfColumns; columnIndex++) {
+        const double* column = (columnIndex % 2 == 0) ? features->RealColumn(columnIndex / 2) :
+            features->ImaginaryColumn(columnIndex / 2);
+        double minimum = *min_element(column, column + features->NumberOfSamples);
+        double maximum = *max_element(column, column + features->NumberOfSamples);
+
+        // -127 to 127 spans the column, and a column with one value is stored as its offset
+        columnOffsets[columnIndex] = (float)((minimum + maximum) / 2);
+        columnScales[columnIndex] = (float)((maximum - minimum) / 254);
+        int8_t* quantizedColumn = quantizedColumns + (size_t)columnIndex * stride;
+        for (int sampleIndex = 0; sampleIndex < stride; sampleIndex++) {
+            long quantizedValue = 0;
+            if ((sampleIndex < features->NumberOfSamples) && (columnScales[columnIndex] > 0)) {
+                quantizedValue = lround((column[sampleIndex] - columnOffsets[columnIndex]) / columnScales[columnIndex]);
+            }
+            quantizedColumn[sampleIndex] = (int8_t)max(-127L, min(127L, quantizedValue));
+        }
+    }
+    return true;
+}
+const void compactFeatureIndex::ApproximateSquaredDistances(int firstSampleIndex, int numberOfSamples, const double* realParts,
+    const double* imaginaryParts, float* squaredDistances) const
+{
+    for (int sampleIndex = 0; sampleIndex < numberOfSamples; sampleIndex++) squaredDistances[sampleIndex] = 0;
+
+    // Column by column so the inner loops run over contiguous compact values
+    for (int featureIndex = 0; featureIndex < features->NumberOfFeatures; featureIndex++) {
+        float weight = featureWeights[featureIndex];
+        int realColumnIndex = 2 * featureIndex;
+        int imaginaryColumnIndex = 2 * featureIndex + 1;
+
+        if (storage == featureStorage::Float32) {
+            const float* realColumn = floatColumns + (size_t)realColumnIndex * stride + firstSampleIndex;
+            const float* imaginaryColumn = floatColumns + (size_t)imaginaryColumnIndex * stride + firstSampleIndex;
+            float realPart = (float)realParts[featureIndex];
+            float imaginaryPart = (float)imaginaryParts[featureIndex];
+            for (int sampleIndex = 0; sampleIndex < numberOfSamples; sampleIndex++) {
+                float realDifference = realColumn[sampleIndex] - realPart;
+                float imaginaryDifference = imaginaryColumn[sampleIndex] - imaginaryPart;
+                squaredDistances[sampleIndex] += weight * (realDifference * realDifference + imaginaryDifference * imaginaryDifference);
+            }
+        }
+        else {
+            const int8_t* realColumn = quantizedColumns + (size_t)realColumnIndex * stride + firstSampleIndex;
+            const int8_t* imaginaryColumn = quantizedColumns + (size_t)imaginaryColumnIndex * stride + firstSampleIndex;
+            // The difference is scale * stored value + (offset - query), so the offset is folded in once per column
+            float realScale = columnScales[realColumnIndex];
+            float imaginaryScale = columnScales[imaginaryColumnIndex];
+            float realShift = columnOffsets[realColumnIndex] - (float)realParts[featureIndex];
+            float imaginaryShift = columnOffsets[imaginaryColumnIndex] - (float)imaginaryParts[featureIndex];
+            for (int sampleIndex = 0; sampleIndex < numberOfSamples; sampleIndex++) {
+                float realDifference = realScale * (float)realColumn[sampleIndex] + realShift;
+                float imaginaryDifference = imaginaryScale * (float)imaginaryColumn[sampleIndex] + imaginaryShift;
+                squaredDistances[sampleIndex] += weight * (realDifference * realDifference + imaginaryDifference * imaginaryDifference);
+            }
+        }
+    }
+}
+
+
+const void compactFeatureIndex::FreeMemory()
+{
+    if (floatColumns != NULL) {
+        ::operator delete[](floatColumns, align_val_t(columnAlignment));
+        floatColumns = NULL;
+    }
+    if (quantizedColumns != NULL) {
+        ::operator delete[](quantizedColumns, align_val_t(columnAlignment));
+        quantizedColumns = NULL;
+    }
+    if (columnScales != NULL) {
+        delete[] columnScales;
+        columnScales = NULL;
+    }
+    if (columnOffsets != NULL) {
+        delete[] columnOffsets;
+        columnOffsets = NULL;
+    }
+    if (featureWeights != NULL) {
+        delete[] featureWeights;
+        featureWeights = NULL;
+    }
+}
+
+const void compactFeatureIndex::MemoryAllocationFailure(string variableName)
+{
+    cout << "Error: compactFeatureIndex() failed to allocate memory for " << variableName << "\n";
+    FreeMemory();
+}
+
+
+
+compactFeatureIndex::compactFeatureIndex(lineFeatureMatrix* features, featureStorage storage, int numberOfCandidatesPerNeighbor)
+{
+    this->features = features;
+    this->storage = storage;
+    NumberOfCandidatesPerNeighbor = numberOfCandidatesPerNeighbor;
+    if ((features == NULL) || (features->NumberOfSamples == 0)) {
+        cout << "Error: compactFeatureIndex() needs a feature matrix with at least one line sample.\n";
+        return;
+    }
+
+    int elementsPerAlignment = (int)(columnAlignment / sizeof(float));
+    stride = (features->NumberOfSamples + elementsPerAlignment - 1) / elementsPerAlignment * elementsPerAlignment;
+    featureWeights = new float[features->NumberOfFeatures];
+    if (featureWeights == NULL) {
+        MemoryAllocationFailure("featureWeights");
+        return;
+    }
+    for (int featureIndex = 0; featureIndex < features->NumberOfFeatures; featureIndex++) {
+        featureWeights[featureIndex] = (float)features->FeatureWeights[featureIndex];
+    }
+
+    if (storage == featureStorage::Float32) BuildFloatColumns();
+    else BuildQuantizedColumns();
+}
+
+compactFeatureIndex::~compactFeatureIndex()
+{
+    FreeMemory();
+}
+
+
+lineFeatureMatrix* compactFeatureIndex::Features() const
+{
+    return features;
+}
+const void compactFeatureIndex::Search(const double* realParts, const double* imaginaryParts, nearestNeighborHeap* heap) const
+{
+    heap->Clear();
+    if ((floatColumns == NULL) && (quantizedColumns == NULL)) return;
+
+    int numberOfCandidates = heap->Capacity() * max(1, NumberOfCandidatesPerNeighbor);
+    if (numberOfCandidates > features->NumberOfSamples) numberOfCandidates = features->NumberOfSamples;
+
+    // Screen every known line sample with the approximate distance into a heap kept in the thread's scratch space
+    nearestNeighborHeap& candidates = *knnQueryScratch::ReserveHeap(knnQueryScratch::OfThisThread().CandidateHeap, numberOfCandidates);
+    float squaredDistances[knownSamplesPerBlock];
+    for (int firstKnownIndex = 0; firstKnownIndex < features->NumberOfSamples; firstKnownIndex += knownSamplesPerBlock) {
+        int numberOfKnownsInBlock = knownSamplesPerBlock;
+        if (features->NumberOfSamples - firstKnownIndex < knownSamplesPerBlock) {
+            numberOfKnownsInBlock = features->NumberOfSamples - firstKnownIndex;
+        }
+        ApproximateSquaredDistances(firstKnownIndex, numberOfKnownsInBlock, realParts, imaginaryParts, squaredDistances);
+        for (int blockIndex = 0; blockIndex < numberOfKnownsInBlock; blockIndex++) {
+            if (squaredDistances[blockIndex] > candidates.WorstSquaredDistance()) continue;
+            candidates.Push(squaredDistances[blockIndex], firstKnownIndex + blockIndex, true);
+        }
+    }
+
+    // Re-rank the candidates with the exact distance
+    for (int candidateIndex = 0; candidateIndex < candidates.Size(); candidateIndex++) {
+        int sampleIndex = candidates.Neighbor(candidateIndex).Index;
+        double squaredDistance = features->SquaredDistance(sampleIndex, realParts, imaginaryParts);
+        if (squaredDistance > heap->WorstSquaredDistance()) continue;
+        heap->Push(squaredDistance, sampleIndex, features->IsWorking(sampleIndex));
+    }
+}
+const string compactFeatureIndex::Name() const
+{
+    return string(storage == featureStorage::Float32 ? "Float32" : "Int8") + " scan (" + to_string(NumberOfCandidatesPerNeighbor) +
+        " candidates per neighbor)";
+}
+const size_t compactFeatureIndex::NumberOfBytes() const
+{
+    if (features == NULL) return 0;
+    size_t bytesPerValue = (storage == featureStorage::Float32) ? sizeof(float) : sizeof(int8_t);
+    return 2 * (size_t)features->NumberOfFeatures * stride * bytesPerValue;
+}
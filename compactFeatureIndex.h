@@ -0,0 +1,159 @@
+#pragma once
+
+#define _USE_MATH_DEFINES
+
+using namespace std;
+
+#include <cmath>
+#include <cstdint>
+#include <exception>
+#include <iostream>
+#include <string>
+#include "lineSample.h"
+#include "lineFeatureMatrix.h"
+#include "nearestNeighborHeap.h"
+#include "nearestNeighborIndex.h"
+
+
+/// <summary>
+/// How the compact copy of the features of a compactFeatureIndex is stored
+/// </summary>
+enum class featureStorage {
+    /// <summary>
+    /// 4 bytes per value rounded to single precision
+    /// </summary>
+    Float32,
+    /// <summary>
+    /// 1 byte per value quantized with the per-column scale and offset (value = offset + scale * stored value)
+    /// </summary>
+    Int8
+};
+
+
+/// <summary>
+/// A reduced-precision copy of the columns of a feature matrix. A query scans the compact columns for the nearest candidates and
+/// then re-ranks only the candidates with the exact double precision distance of the feature matrix. The normalized phasors sit
+/// near 1 per unit, so single precision or 8 bits per value rarely change which samples are the nearest, and the scan reads 2x or
+/// 8x fewer bytes. NumberOfCandidatesPerNeighbor trades latency for recall.
+/// </summary>
+class compactFeatureIndex : public nearestNeighborIndex {
+private:
+    /// <summary>
+    /// The alignment of every compact column in bytes
+    /// </summary>
+    static const size_t columnAlignment = 64;
+    /// <summary>
+    /// The number of known line samples scored together
+    /// </summary>
+    static const int knownSamplesPerBlock = 256;
+    /// <summary>
+    /// The feature matrix the index was built over and re-ranks with
+    /// </summary>
+    lineFeatureMatrix* features = NULL;
+    /// <summary>
+    /// How the compact columns are stored
+    /// </summary>
+    featureStorage storage = featureStorage::Float32;
+    /// <summary>
+    /// The number of elements per compact column (the number of known line samples rounded up to the column alignment)
+    /// </summary>
+    int stride = 0;
+    /// <summary>
+    /// The 2 * NumberOfFeatures single precision columns in the order of the feature matrix (NULL for Int8)
+    /// </summary>
+    float* floatColumns = NULL;
+    /// <summary>
+    /// The 2 * NumberOfFeatures quantized columns in the order of the feature matrix (NULL for Float32)
+    /// </summary>
+    int8_t* quantizedColumns = NULL;
+    /// <summary>
+    /// The scale of each quantized column
+    /// </summary>
+    float* columnScales = NULL;
+    /// <summary>
+    /// The offset of each quantized column
+    /// </summary>
+    float* columnOffsets = NULL;
+    /// <summary>
+    /// The weight of each feature in single precision
+    /// </summary>
+    float* featureWeights = NULL;
+
+
+    /// <summary>
+    /// Copy the columns of the feature matrix in single precision.
+    /// </summary>
+    /// <returns>True if the memory allocation succeeded</returns>
+    const bool BuildFloatColumns();
+    /// <summary>
+    /// Quantize each column of the feature matrix to 8 bits between its smallest and largest value.
+    /// </summary>
+    /// <returns>True if the memory allocation succeeded</returns>
+    const bool BuildQuantizedColumns();
+    /// <summary>
+    /// Calculate the approximate squared distances of a block of known line samples from the compact columns.
+    /// </summary>
+    /// <param name="firstSampleIndex">The index of the first line sample in the block</param>
+    /// <param name="numberOfSamples">The number of line samples in the block</param>
+    /// <param name="realParts">The real parts of the features of the unknown line sample</param>
+    /// <param name="imaginaryParts">The imaginary parts of the features of the unknown line sample</param>
+    /// <param name="squaredDistances">The array of numberOfSamples approximate squared distances to fill</param>
+    const void ApproximateSquaredDistances(int firstSampleIndex, int numberOfSamples, const double* realParts,
+        const double* imaginaryParts, float* squaredDistances) const;
+
+    /// <summary>
+    /// Free the dynamically allocated memory and set their pointers to NULL. Notice that the feature matrix isn't freed.
+    /// </summary>
+    const void FreeMemory();
+
+    /// <summary>
+    /// Display an error message and call FreeMemory().
+    /// </summary>
+    /// <param=variableName>The name of the variable that failed to get memory allocation</param>
+    const void MemoryAllocationFailure(string variableName);
+
+
+public:
+    /// <summary>
+    /// The number of candidates per nearest neighbor re-ranked with the exact distance (raise it for recall and lower it for
+    /// latency)
+    /// </summary>
+    int NumberOfCandidatesPerNeighbor = 4;
+
+
+    /// <summary>
+    /// The constructor copies the columns of the feature matrix in the compact storage.
+    /// </summary>
+    /// <param name="features">The feature matrix of the line samples with known statuses (not freed on the deconstructor)</param>
+    /// <param name="storage">How the compact columns are stored</param>
+    /// <param name="numberOfCandidatesPerNeighbor">The number of candidates per nearest neighbor re-ranked</param>
+    explicit compactFeatureIndex(lineFeatureMatrix* features, featureStorage storage = featureStorage::Float32,
+        int numberOfCandidatesPerNeighbor = 4);
+
+    /// <summary>
+    /// The deconstructor
+    /// </summary>
+    ~compactFeatureIndex();
+
+
+    /// <summary>
+    /// The feature matrix the index was built over
+    /// </summary>
+    /// <returns>The pointer to the feature matrix</returns>
+    lineFeatureMatrix* Features() const override;
+    /// <summary>
+    /// Scan the compact columns for the nearest candidates and keep the nearest of them by the exact distance.
+    /// </summary>
+    /// <param name="realParts">The real parts of the features from lineFeatureMatrix::ExtractFeatures()</param>
+    /// <param name="imaginaryParts">The imaginary parts of the features from lineFeatureMatrix::ExtractFeatures()</param>
+    /// <param name="heap">The heap to fill with as many nearest neighbors as its capacity (cleared first)</param>
+    const void Search(const double* realParts, const double* imaginaryParts, nearestNeighborHeap* heap) const override;
+    /// <summary>
+    /// The name of the index for printing
+    /// </summary>
+    const string Name() const override;
+    /// <summary>
+    /// The number of bytes of the compact columns a query scans
+    /// </summary>
+    const size_t NumberOfBytes() const;
+};
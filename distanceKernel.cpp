@@ -0,0 +1,297 @@
+#define _USE_MATH_DEFINES
+
+using namespace std;
+
+#include <cmath>
+#include <exception>
+#include <iostream>
+#include <string>
+#include "lineFeatureMatrix.h"
+#include "allocationCounter.h"
+#include "latencyHistogram.h"
+#include "knnInstrumentationSnapshot.h"
+#include "knnInstrumentation.h"
+#include "knnStageTimer.h"
+#include "distanceKernel.h"
+
+#if defined(__AVX512F__) || defined(__AVX2__)
+#include <immintrin.h>
+#elif defined(__ARM_NEON) && defined(__aarch64__)
+#include <arm_neon.h>
+#endif
+
+
+/// <summary>
+/// The body of every kernel. A fixedNumberOfFeatures above 0 makes the number of features a compile-time constant, so the feature
+/// loops are fully unrolled and the broadcasts of the unknown line sample's features and the weights are hoisted out of the sample
+/// loop. 0 reads the number of features from the matrix. The terms are added in the same order either way, so every width gives
+/// the same squared distances to the bit.
+/// </summary>
+template <int fixedNumberOfFeatures>
+static const void SquaredDistancesOfWidth(const lineFeatureMatrix* features, int firstSampleIndex, int numberOfSamples,
+    const double* realParts, const double* imaginaryParts, double* squaredDistances)
+{
+    const int numberOfFeatures = (fixedNumberOfFeatures > 0) ? fixedNumberOfFeatures : features->NumberOfFeatures;
+    const double* featureWeights = features->FeatureWeights;
+    // The columns are interleaved real, imaginary, real, ... with 'Stride' elements each
+    const double* firstRealColumn = features->RealColumn(0) + firstSampleIndex;
+    const size_t stride = (size_t)features->Stride;
+    int sampleIndex = 0;
+
+#if defined(__AVX512F__)
+    for (; sampleIndex + 8 <= numberOfSamples; sampleIndex += 8) {
+        __m512d squaredDistance = _mm512_setzero_pd();
+        for (int featureIndex = 0; featureIndex < numberOfFeatures; featureIndex++) {
+            __m512d realDifference = _mm512_sub_pd(
+                _mm512_loadu_pd(firstRealColumn + 2 * featureIndex * stride + sampleIndex),
+                _mm512_set1_pd(realParts[featureIndex]));
+            __m512d imaginaryDifference = _mm512_sub_pd(
+                _mm512_loadu_pd(firstRealColumn + (2 * featureIndex + 1) * stride + sampleIndex),
+                _mm512_set1_pd(imaginaryParts[featureIndex]));
+            __m512d magnitudeSquared = _mm512_add_pd(_mm512_mul_pd(realDifference, realDifference),
+                _mm512_mul_pd(imaginaryDifference, imaginaryDifference));
+            squaredDistance = _mm512_add_pd(squaredDistance,
+                _mm512_mul_pd(_mm512_set1_pd(featureWeights[featureIndex]), magnitudeSquared));
+        }
+        _mm512_storeu_pd(squaredDistances + sampleIndex, squaredDistance);
+    }
+#elif defined(__AVX2__)
+    for (; sampleIndex + 4 <= numberOfSamples; sampleIndex += 4) {
+        __m256d squaredDistance = _mm256_setzero_pd();
+        for (int featureIndex = 0; featureIndex < numberOfFeatures; featureIndex++) {
+            __m256d realDifference = _mm256_sub_pd(
+                _mm256_loadu_pd(firstRealColumn + 2 * featureIndex * stride + sampleIndex),
+                _mm256_set1_pd(realParts[featureIndex]));
+            __m256d imaginaryDifference = _mm256_sub_pd(
+                _mm256_loadu_pd(firstRealColumn + (2 * featureIndex + 1) * stride + sampleIndex),
+                _mm256_set1_pd(imaginaryParts[featureIndex]));
+            __m256d magnitudeSquared = _mm256_add_pd(_mm256_mul_pd(realDifference, realDifference),
+                _mm256_mul_pd(imaginaryDifference, imaginaryDifference));
+            squaredDistance = _mm256_add_pd(squaredDistance,
+                _mm256_mul_pd(_mm256_set1_pd(featureWeights[featureIndex]), magnitudeSquared));
+        }
+        _mm256_storeu_pd(squaredDistances + sampleIndex, squaredDistance);
+    }
+#elif defined(__ARM_NEON) && defined(__aarch64__)
+    for (; sampleIndex + 2 <= numberOfSamples; sampleIndex += 2) {
+        float64x2_t squaredDistance = vdupq_n_f64(0);
+        for (int featureIndex = 0; featureIndex < numberOfFeatures; featureIndex++) {
+            float64x2_t realDifference = vsubq_f64(
+                vld1q_f64(firstRealColumn + 2 * featureIndex * stride + sampleIndex), vdupq_n_f64(realParts[featureIndex]));
+            float64x2_t imaginaryDifference = vsubq_f64(
+                vld1q_f64(firstRealColumn + (2 * featureIndex + 1) * stride + sampleIndex),
+                vdupq_n_f64(imaginaryParts[featureIndex]));
+            float64x2_t magnitudeSquared = vaddq_f64(vmulq_f64(realDifference, realDifference),
+                vmulq_f64(imaginaryDifference, imaginaryDifference));
+            squaredDistance = vaddq_f64(squaredDistance, vmulq_f64(vdupq_n_f64(featureWeights[featureIndex]), magnitudeSquared));
+        }
+        vst1q_f64(squaredDistances + sampleIndex, squaredDistance);
+    }
+#endif
+
+    // The samples that don't fill a whole vector
+    for (; sampleIndex < numberOfSamples; sampleIndex++) {
+        double squaredDistance = 0;
+        for (int featureIndex = 0; featureIndex < numberOfFeatures; featureIndex++) {
+            double realDifference = firstRealColumn[2 * featureIndex * stride + sampleIndex] - realParts[featureIndex];
+            double imaginaryDifference =
+                firstRealColumn[(2 * featureIndex + 1) * stride + sampleIndex] - imaginaryParts[featureIndex];
+            squaredDistance += featureWeights[featureIndex] *
+                (realDifference * realDifference + imaginaryDifference * imaginaryDifference);
+        }
+        squaredDistances[sampleIndex] = squaredDistance;
+    }
+}
+/// <summary>
+/// The kernel of a line with a fixed number of other currents on each node
+/// </summary>
+template <int numberOfNode1OtherCurrents, int numberOfNode2OtherCurrents>
+static const void FixedSquaredDistances(const lineFeatureMatrix* features, int firstSampleIndex, int numberOfSamples,
+    const double* realParts, const double* imaginaryParts, double* squaredDistances)
+{
+    SquaredDistancesOfWidth<4 + numberOfNode1OtherCurrents + numberOfNode2OtherCurrents>(features, firstSampleIndex, numberOfSamples,
+        realParts, imaginaryParts, squaredDistances);
+}
+
+/// <summary>
+/// The body of every early abandoning kernel. The features are added in the column order and a vector of samples stops as soon as
+/// every lane's partial sum is over the bound, leaving the partial sums (which are over the bound too, since no weight is negative)
+/// in place of the squared distances. The terms are added in the same order as SquaredDistancesOfWidth(), so the squared distances
+/// within the bound are the same to the bit.
+/// </summary>
+/// <returns>The number of samples abandoned</returns>
+template <int fixedNumberOfFeatures>
+static const int BoundedSquaredDistancesOfWidth(const lineFeatureMatrix* features, int firstSampleIndex, int numberOfSamples,
+    const double* realParts, const double* imaginaryParts, double bound, double* squaredDistances)
+{
+    const int numberOfFeatures = (fixedNumberOfFeatures > 0) ? fixedNumberOfFeatures : features->NumberOfFeatures;
+    const double* featureWeights = features->FeatureWeights;
+    const double* firstRealColumn = features->RealColumn(0) + firstSampleIndex;
+    const size_t stride = (size_t)features->Stride;
+    int numberOfAbandonedSamples = 0;
+    int sampleIndex = 0;
+
+#if defined(__AVX512F__)
+    const __m512d boundVector = _mm512_set1_pd(bound);
+    for (; sampleIndex + 8 <= numberOfSamples; sampleIndex += 8) {
+        __m512d squaredDistance = _mm512_setzero_pd();
+        for (int featureIndex = 0; featureIndex < numberOfFeatures; featureIndex++) {
+            __m512d realDifference = _mm512_sub_pd(
+                _mm512_loadu_pd(firstRealColumn + 2 * featureIndex * stride + sampleIndex),
+                _mm512_set1_pd(realParts[featureIndex]));
+            __m512d imaginaryDifference = _mm512_sub_pd(
+                _mm512_loadu_pd(firstRealColumn + (2 * featureIndex + 1) * stride + sampleIndex),
+                _mm512_set1_pd(imaginaryParts[featureIndex]));
+            __m512d magnitudeSquared = _mm512_add_pd(_mm512_mul_pd(realDifference, realDifference),
+                _mm512_mul_pd(imaginaryDifference, imaginaryDifference));
+            squaredDistance = _mm512_add_pd(squaredDistance,
+                _mm512_mul_pd(_mm512_set1_pd(featureWeights[featureIndex]), magnitudeSquared));
+            if ((featureIndex + 1 < numberOfFeatures) && (_mm512_cmp_pd_mask(squaredDistance, boundVector, _CMP_GT_OQ) == 0xFF)) {
+                numberOfAbandonedSamples += 8;
+                break;
+            }
+        }
+        _mm512_storeu_pd(squaredDistances + sampleIndex, squaredDistance);
+    }
+#elif defined(__AVX2__)
+    const __m256d boundVector = _mm256_set1_pd(bound);
+    for (; sampleIndex + 4 <= numberOfSamples; sampleIndex += 4) {
+        __m256d squaredDistance = _mm256_setzero_pd();
+        for (int featureIndex = 0; featureIndex < numberOfFeatures; featureIndex++) {
+            __m256d realDifference = _mm256_sub_pd(
+                _mm256_loadu_pd(firstRealColumn + 2 * featureIndex * stride + sampleIndex),
+                _mm256_set1_pd(realParts[featureIndex]));
+            __m256d imaginaryDifference = _mm256_sub_pd(
+                _mm256_loadu_pd(firstRealColumn + (2 * featureIndex + 1) * stride + sampleIndex),
+                _mm256_set1_pd(imaginaryParts[featureIndex]));
+            __m256d magnitudeSquared = _mm256_add_pd(_mm256_mul_pd(realDifference, realDifference),
+                _mm256_mul_pd(imaginaryDifference, imaginaryDifference));
+            squaredDistance = _mm256_add_pd(squaredDistance,
+                _mm256_mul_pd(_mm256_set1_pd(featureWeights[featureIndex]), magnitudeSquared));
+            if ((featureIndex + 1 < numberOfFeatures) &&
+                (_mm256_movemask_pd(_mm256_cmp_pd(squaredDistance, boundVector, _CMP_GT_OQ)) == 0xF)) {
+                numberOfAbandonedSamples += 4;
+                break;
+            }
+        }
+        _mm256_storeu_pd(squaredDistances + sampleIndex, squaredDistance);
+    }
+#elif defined(__ARM_NEON) && defined(__aarch64__)
+    const float64x2_t boundVector = vdupq_n_f64(bound);
+    for (; sampleIndex + 2 <= numberOfSamples; sampleIndex += 2) {
+        float64x2_t squaredDistance = vdupq_n_f64(0);
+        for (int featureIndex = 0; featureIndex < numberOfFeatures; featureIndex++) {
+            float64x2_t realDifference = vsubq_f64(
+                vld1q_f64(firstRealColumn + 2 * featureIndex * stride + sampleIndex), vdupq_n_f64(realParts[featureIndex]));
+            float64x2_t imaginaryDifference = vsubq_f64(
+                vld1q_f64(firstRealColumn + (2 * featureIndex + 1) * stride + sampleIndex),
+                vdupq_n_f64(imaginaryParts[featureIndex]));
+            float64x2_t magnitudeSquared = vaddq_f64(vmulq_f64(realDifference, realDifference),
+                vmulq_f64(imaginaryDifference, imaginaryDifference));
+            squaredDistance = vaddq_f64(squaredDistance, vmulq_f64(vdupq_n_f64(featureWeights[featureIndex]), magnitudeSquared));
+            uint64x2_t isOverBound = vcgtq_f64(squaredDistance, boundVector);
+            if ((featureIndex + 1 < numberOfFeatures) && ((vgetq_lane_u64(isOverBound, 0) & vgetq_lane_u64(isOverBound, 1)) != 0)) {
+                numberOfAbandonedSamples += 2;
+                break;
+            }
+        }
+        vst1q_f64(squaredDistances + sampleIndex, squaredDistance);
+    }
+#endif
+
+    // The samples that don't fill a whole vector
+    for (; sampleIndex < numberOfSamples; sampleIndex++) {
+        double squaredDistance = 0;
+        for (int featureIndex = 0; featureIndex < numberOfFeatures; featureIndex++) {
+            double realDifference = firstRealColumn[2 * featureIndex * stride + sampleIndex] - realParts[featureIndex];
+            double imaginaryDifference =
+                firstRealColumn[(2 * featureIndex + 1) * stride + sampleIndex] - imaginaryParts[featureIndex];
+            squaredDistance += featureWeights[featureIndex] *
+                (realDifference * realDifference + imaginaryDifference * imaginaryDifference);
+            if ((featureIndex + 1 < numberOfFeatures) && (squaredDistance > bound)) {
+                numberOfAbandonedSamples++;
+                break;
+            }
+        }
+        squaredDistances[sampleIndex] = squaredDistance;
+    }
+    return numberOfAbandonedSamples;
+}
+/// <summary>
+/// The early abandoning kernel of a line with a fixed number of other currents on each node
+/// </summary>
+template <int numberOfNode1OtherCurrents, int numberOfNode2OtherCurrents>
+static const int FixedBoundedSquaredDistances(const lineFeatureMatrix* features, int firstSampleIndex, int numberOfSamples,
+    const double* realParts, const double* imaginaryParts, double bound, double* squaredDistances)
+{
+    return BoundedSquaredDistancesOfWidth<4 + numberOfNode1OtherCurrents + numberOfNode2OtherCurrents>(features, firstSampleIndex,
+        numberOfSamples, realParts, imaginaryParts, bound, squaredDistances);
+}
+
+const void distanceKernel::SquaredDistances(const lineFeatureMatrix* features, int firstSampleIndex, int numberOfSamples,
+    const double* realParts, const double* imaginaryParts, double* squaredDistances)
+{
+    KNN_TIME_STAGE(knnStage::DistanceCalculation);
+    KNN_COUNT(knnCounter::DistancesCalculated, numberOfSamples);
+    if (features->SquaredDistancesKernel != NULL) {
+        features->SquaredDistancesKernel(features, firstSampleIndex, numberOfSamples, realParts, imaginaryParts, squaredDistances);
+    }
+    else GenericSquaredDistances(features, firstSampleIndex, numberOfSamples, realParts, imaginaryParts, squaredDistances);
+}
+const void distanceKernel::GenericSquaredDistances(const lineFeatureMatrix* features, int firstSampleIndex, int numberOfSamples,
+    const double* realParts, const double* imaginaryParts, double* squaredDistances)
+{
+    SquaredDistancesOfWidth<0>(features, firstSampleIndex, numberOfSamples, realParts, imaginaryParts, squaredDistances);
+}
+const squaredDistancesFunction distanceKernel::Select(int numberOfNode1OtherCurrents, int numberOfNode2OtherCurrents)
+{
+    // The 2- and 3-current nodes nodeSample has constructors for
+    if ((numberOfNode1OtherCurrents == 1) && (numberOfNode2OtherCurrents == 1)) return FixedSquaredDistances<1, 1>;
+    if ((numberOfNode1OtherCurrents == 1) && (numberOfNode2OtherCurrents == 2)) return FixedSquaredDistances<1, 2>;
+    if ((numberOfNode1OtherCurrents == 2) && (numberOfNode2OtherCurrents == 1)) return FixedSquaredDistances<2, 1>;
+    if ((numberOfNode1OtherCurrents == 2) && (numberOfNode2OtherCurrents == 2)) return FixedSquaredDistances<2, 2>;
+    return GenericSquaredDistances;
+}
+const void distanceKernel::BoundedSquaredDistances(const lineFeatureMatrix* features, int firstSampleIndex, int numberOfSamples,
+    const double* realParts, const double* imaginaryParts, double bound, double* squaredDistances)
+{
+    // Nothing can be abandoned before the heap is full
+    if ((isinf(bound) == true) || (features->BoundedSquaredDistancesKernel == NULL)) {
+        SquaredDistances(features, firstSampleIndex, numberOfSamples, realParts, imaginaryParts, squaredDistances);
+        return;
+    }
+
+    KNN_TIME_STAGE(knnStage::DistanceCalculation);
+    KNN_COUNT(knnCounter::DistancesCalculated, numberOfSamples);
+    int numberOfAbandonedSamples = features->BoundedSquaredDistancesKernel(features, firstSampleIndex, numberOfSamples, realParts,
+        imaginaryParts, bound, squaredDistances);
+    KNN_COUNT(knnCounter::DistancesAbandoned, numberOfAbandonedSamples);
+    (void)numberOfAbandonedSamples;
+}
+const int distanceKernel::GenericBoundedSquaredDistances(const lineFeatureMatrix* features, int firstSampleIndex,
+    int numberOfSamples, const double* realParts, const double* imaginaryParts, double bound, double* squaredDistances)
+{
+    return BoundedSquaredDistancesOfWidth<0>(features, firstSampleIndex, numberOfSamples, realParts, imaginaryParts, bound,
+        squaredDistances);
+}
+const boundedSquaredDistancesFunction distanceKernel::SelectBounded(int numberOfNode1OtherCurrents, int numberOfNode2OtherCurrents)
+{
+    if ((numberOfNode1OtherCurrents == 1) && (numberOfNode2OtherCurrents == 1)) return FixedBoundedSquaredDistances<1, 1>;
+    if ((numberOfNode1OtherCurrents == 1) && (numberOfNode2OtherCurrents == 2)) return FixedBoundedSquaredDistances<1, 2>;
+    if ((numberOfNode1OtherCurrents == 2) && (numberOfNode2OtherCurrents == 1)) return FixedBoundedSquaredDistances<2, 1>;
+    if ((numberOfNode1OtherCurrents == 2) && (numberOfNode2OtherCurrents == 2)) return FixedBoundedSquaredDistances<2, 2>;
+    return GenericBoundedSquaredDistances;
+}
+
+const string distanceKernel::InstructionSet()
+{
+#if defined(__AVX512F__)
+    return "AVX-512";
+#elif defined(__AVX2__)
+    return "AVX2";
+#elif defined(__ARM_NEON) && defined(__aarch64__)
+    return "NEON";
+#else
+    return "Scalar";
+#endif
+}
\ No newline at end of file
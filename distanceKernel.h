@@ -0,0 +1,96 @@
+#pragma once
+
+#define _USE_MATH_DEFINES
+
+using namespace std;
+
+#include <cmath>
+#include <exception>
+#include <iostream>
+#include <string>
+#include "lineFeatureMatrix.h"
+
+
+/// <summary>
+/// The vectorized squared weighted euclidean distance between one line sample's features and a block of line samples in a feature
+/// matrix. The instruction set is picked at compile time (AVX-512, AVX2, NEON, or plain C++ when none are enabled) and the squared
+/// magnitude of each complex difference is (real difference)^2 + (imaginary difference)^2, so there is no trigonometry or square
+/// root in the loop.
+/// </summary>
+class distanceKernel {
+public:
+    /// <summary>
+    /// Calculate the squared weighted euclidean distance of every line sample in a block of the feature matrix with the kernel the
+    /// matrix picked for its line layout.
+    /// </summary>
+    /// <param name="features">The feature matrix of the line samples with known statuses</param>
+    /// <param name="firstSampleIndex">The index of the first line sample in the block</param>
+    /// <param name="numberOfSamples">The number of line samples in the block</param>
+    /// <param name="realParts">The real parts of the features of the unknown line sample</param>
+    /// <param name="imaginaryParts">The imaginary parts of the features of the unknown line sample</param>
+    /// <param name="squaredDistances">The array of numberOfSamples squared distances to fill</param>
+    static const void SquaredDistances(const lineFeatureMatrix* features, int firstSampleIndex, int numberOfSamples,
+        const double* realParts, const double* imaginaryParts, double* squaredDistances);
+    /// <summary>
+    /// SquaredDistances() for any number of features, reading the number from the matrix. The specialized kernels give the same
+    /// squared distances.
+    /// </summary>
+    /// <param name="features">The feature matrix of the line samples with known statuses</param>
+    /// <param name="firstSampleIndex">The index of the first line sample in the block</param>
+    /// <param name="numberOfSamples">The number of line samples in the block</param>
+    /// <param name="realParts">The real parts of the features of the unknown line sample</param>
+    /// <param name="imaginaryParts">The imaginary parts of the features of the unknown line sample</param>
+    /// <param name="squaredDistances">The array of numberOfSamples squared distances to fill</param>
+    static const void GenericSquaredDistances(const lineFeatureMatrix* features, int firstSampleIndex, int numberOfSamples,
+        const double* realParts, const double* imaginaryParts, double* squaredDistances);
+    /// <summary>
+    /// Pick the kernel for a line layout. Lines between 2- and 3-current nodes (1 or 2 other currents per node) get a kernel with
+    /// the number of features fixed at compile time, and every other layout gets GenericSquaredDistances().
+    /// </summary>
+    /// <param name="numberOfNode1OtherCurrents">The number of currents flowing from node 1 not counting the line current</param>
+    /// <param name="numberOfNode2OtherCurrents">The number of currents flowing from node 2 not counting the line current</param>
+    /// <returns>The kernel</returns>
+    static const squaredDistancesFunction Select(int numberOfNode1OtherCurrents, int numberOfNode2OtherCurrents);
+    /// <summary>
+    /// SquaredDistances() for a scan that only keeps line samples within a bound (like the k-th nearest neighbor so far). The
+    /// features are added in the column order, so with the default weights the line currents usually rule a far line sample out
+    /// before the voltages and other currents are read, and any line sample whose partial sum passes the bound is abandoned with
+    /// that partial sum in place of its squared distance. A squared distance under or at the bound is the same to the bit as
+    /// SquaredDistances() gives.
+    /// </summary>
+    /// <param name="features">The feature matrix of the line samples with known statuses</param>
+    /// <param name="firstSampleIndex">The index of the first line sample in the block</param>
+    /// <param name="numberOfSamples">The number of line samples in the block</param>
+    /// <param name="realParts">The real parts of the features of the unknown line sample</param>
+    /// <param name="imaginaryParts">The imaginary parts of the features of the unknown line sample</param>
+    /// <param name="bound">The squared distance past which a line sample isn't needed (infinity scores every term)</param>
+    /// <param name="squaredDistances">The array of numberOfSamples squared distances (or partial sums over the bound) to fill</param>
+    static const void BoundedSquaredDistances(const lineFeatureMatrix* features, int firstSampleIndex, int numberOfSamples,
+        const double* realParts, const double* imaginaryParts, double bound, double* squaredDistances);
+    /// <summary>
+    /// The early abandoning kernel for any number of features, reading the number from the matrix
+    /// </summary>
+    /// <param name="features">The feature matrix of the line samples with known statuses</param>
+    /// <param name="firstSampleIndex">The index of the first line sample in the block</param>
+    /// <param name="numberOfSamples">The number of line samples in the block</param>
+    /// <param name="realParts">The real parts of the features of the unknown line sample</param>
+    /// <param name="imaginaryParts">The imaginary parts of the features of the unknown line sample</param>
+    /// <param name="bound">The squared distance past which a line sample isn't needed</param>
+    /// <param name="squaredDistances">The array of numberOfSamples squared distances (or partial sums over the bound) to fill</param>
+    /// <returns>The number of line samples abandoned</returns>
+    static const int GenericBoundedSquaredDistances(const lineFeatureMatrix* features, int firstSampleIndex, int numberOfSamples,
+        const double* realParts, const double* imaginaryParts, double bound, double* squaredDistances);
+    /// <summary>
+    /// Pick the early abandoning kernel for a line layout the same way as Select().
+    /// </summary>
+    /// <param name="numberOfNode1OtherCurrents">The number of currents flowing from node 1 not counting the line current</param>
+    /// <param name="numberOfNode2OtherCurrents">The number of currents flowing from node 2 not counting the line current</param>
+    /// <returns>The kernel</returns>
+    static const boundedSquaredDistancesFunction SelectBounded(int numberOfNode1OtherCurrents, int numberOfNode2OtherCurrents);
+
+    /// <summary>
+    /// The name of the instruction set SquaredDistances() was compiled for
+    /// </summary>
+    /// <returns>"AVX-512", "AVX2", "NEON", or "Scalar"</returns>
+    static const string InstructionSet();
+};
\ No newline at end of file
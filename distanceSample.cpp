@@ -10,13 +10,17 @@ using namespace std;
 #include "parameter.h"
 #include "nodeSample.h"
 #include "lineSample.h"
+#include "distanceWeights.h"
+#include "allocationCounter.h"
+#include "latencyHistogram.h"
+#include "knnInstrumentationSnapshot.h"
+#include "knnInstrumentation.h"
+#include "knnStageTimer.h"
 #include "distanceSample.h"
 
 
 const bool distanceSample::AreSamplesOfTheSameLine(lineSample* sampleWithKnownStatus, lineSample* sampleWithUnknownStatus)
 {
-    bool areSamplesOfTheSameLine = true;
-
     if ((sampleWithKnownStatus == NULL) || (sampleWithUnknownStatus == NULL)) {
         if (sampleWithKnownStatus == NULL) {
             cout << "Error in distanceSample(): lineSample* sampleWithKnownStatus = NULL!\n";
@@ -27,81 +31,46 @@ const bool distanceSample::AreSamplesOfTheSameLine(lineSample* sampleWithKnownSt
         return false;
     }
 
-    // Check Line Currents
-    if (sampleWithKnownStatus->Node1LineCurrentNorm->StartNodeNumber !=
-        sampleWithUnknownStatus->Node1LineCurrentNorm->StartNodeNumber) areSamplesOfTheSameLine = false;
-    if (sampleWithKnownStatus->Node1LineCurrentNorm->DestinationNodeNumber !=
-        sampleWithUnknownStatus->Node1LineCurrentNorm->DestinationNodeNumber) areSamplesOfTheSameLine = false;
-    if (sampleWithKnownStatus->Node2LineCurrentNorm->StartNodeNumber !=
-        sampleWithUnknownStatus->Node2LineCurrentNorm->StartNodeNumber) areSamplesOfTheSameLine = false;
-    if (sampleWithKnownStatus->Node2LineCurrentNorm->DestinationNodeNumber !=
-        sampleWithUnknownStatus->Node2LineCurrentNorm->DestinationNodeNumber) areSamplesOfTheSameLine = false;
-
-    // Check Node Voltages
-    if (sampleWithKnownStatus->Node1VoltageNorm->StartNodeNumber !=
-        sampleWithUnknownStatus->Node1VoltageNorm->StartNodeNumber) areSamplesOfTheSameLine = false;
-    if (sampleWithKnownStatus->Node2VoltageNorm->StartNodeNumber !=
-        sampleWithUnknownStatus->Node2VoltageNorm->StartNodeNumber) areSamplesOfTheSameLine = false;
-
-    // Check Other Currents
-    if (sampleWithKnownStatus->NumberOfNode1OtherCurrents !=
-        sampleWithUnknownStatus->NumberOfNode1OtherCurrents) areSamplesOfTheSameLine = false;
-    else for (int comparingIndex = 0; comparingIndex < sampleWithKnownStatus->NumberOfNode1OtherCurrents; comparingIndex++) {
-        if (sampleWithKnownStatus->Node1OtherCurrentsNorm[comparingIndex]->StartNodeNumber !=
-            sampleWithUnknownStatus->Node1OtherCurrentsNorm[comparingIndex]->StartNodeNumber) {
-            areSamplesOfTheSameLine = false;
-            break;
-        }
-        if (sampleWithKnownStatus->Node1OtherCurrentsNorm[comparingIndex]->DestinationNodeNumber !=
-            sampleWithUnknownStatus->Node1OtherCurrentsNorm[comparingIndex]->DestinationNodeNumber) {
-            areSamplesOfTheSameLine = false;
-            break;
-        }
-    }
-    if (sampleWithKnownStatus->NumberOfNode2OtherCurrents !=
-        sampleWithUnknownStatus->NumberOfNode2OtherCurrents) areSamplesOfTheSameLine = false;
-    else for (int comparingIndex = 0; comparingIndex < sampleWithKnownStatus->NumberOfNode2OtherCurrents; comparingIndex++) {
-        if (sampleWithKnownStatus->Node2OtherCurrentsNorm[comparingIndex]->StartNodeNumber !=
-            sampleWithUnknownStatus->Node2OtherCurrentsNorm[comparingIndex]->StartNodeNumber) {
-            areSamplesOfTheSameLine = false;
-            break;
-        }
-        if (sampleWithKnownStatus->Node2OtherCurrentsNorm[comparingIndex]->DestinationNodeNumber !=
-            sampleWithUnknownStatus->Node2OtherCurrentsNorm[comparingIndex]->DestinationNodeNumber) {
-            areSamplesOfTheSameLine = false;
-            break;
-        }
-    }
-
-    return areSamplesOfTheSameLine;
+    // The node numbers were hashed into the topology key when the line samples were constructed, so one integer compare stands
+    // in for walking them. Keys that collide across lines are ruled out once per training set by lineFeatureMatrix, but
+    // CalculateDistance() indexes both line samples' other currents with the known one's counts, so those still have to match.
+    if (sampleWithKnownStatus->TopologyKey() == 0) return false;
+    if (sampleWithKnownStatus->TopologyKey() != sampleWithUnknownStatus->TopologyKey()) return false;
+    return (sampleWithKnownStatus->NumberOfNode1OtherCurrents == sampleWithUnknownStatus->NumberOfNode1OtherCurrents) &&
+        (sampleWithKnownStatus->NumberOfNode2OtherCurrents == sampleWithUnknownStatus->NumberOfNode2OtherCurrents);
 }
 
 const double distanceSample::CalculateDistance(lineSample* sampleWithKnownStatus, lineSample* sampleWithUnknownStatus)
 {
+    KNN_TIME_STAGE(knnStage::DistanceCalculation);
+    KNN_COUNT(knnCounter::DistancesCalculated, 1);
     double dist = 0;
 
     // The line currents
-    dist += wLine / 2 * pow((sampleWithKnownStatus->Node1LineCurrentNorm->Phasor -
-        sampleWithUnknownStatus->Node1LineCurrentNorm->Phasor).RMSvalue, 2);
-    dist += wLine / 2 * pow((sampleWithKnownStatus->Node2LineCurrentNorm->Phasor -
-        sampleWithUnknownStatus->Node2LineCurrentNorm->Phasor).RMSvalue, 2);
+    dist += weights.WLine / 2 * (sampleWithKnownStatus->Node1LineCurrentNorm->Phasor -
+        sampleWithUnknownStatus->Node1LineCurrentNorm->Phasor).SquaredMagnitude();
+    dist += weights.WLine / 2 * (sampleWithKnownStatus->Node2LineCurrentNorm->Phasor -
+        sampleWithUnknownStatus->Node2LineCurrentNorm->Phasor).SquaredMagnitude();
 
     // The node voltages
-    dist += wNode / 2 * pow((sampleWithKnownStatus->Node1VoltageNorm->Phasor -
-        sampleWithUnknownStatus->Node1VoltageNorm->Phasor).RMSvalue, 2);
-    dist += wNode / 2 * pow((sampleWithKnownStatus->Node2VoltageNorm->Phasor -
-        sampleWithUnknownStatus->Node2VoltageNorm->Phasor).RMSvalue, 2);
+    dist += weights.WNode / 2 * (sampleWithKnownStatus->Node1VoltageNorm->Phasor -
+        sampleWithUnknownStatus->Node1VoltageNorm->Phasor).SquaredMagnitude();
+    dist += weights.WNode / 2 * (sampleWithKnownStatus->Node2VoltageNorm->Phasor -
+        sampleWithUnknownStatus->Node2VoltageNorm->Phasor).SquaredMagnitude();
 
     // The other currents
-    double numberOfCurrents = (double)sampleWithKnownStatus->NumberOfNode1OtherCurrents;
+    // The weight of each other current is divided once per node instead of once per term
+    double otherCurrentWeight = weights.WOther / (2 * (double)sampleWithKnownStatus->NumberOfNode1OtherCurrents);
     for (int currentIndex = 0; currentIndex < sampleWithKnownStatus->NumberOfNode1OtherCurrents; currentIndex++) {
-        dist += wOther / (2 * numberOfCurrents) * pow((sampleWithKnownStatus->Node1OtherCurrentsNorm[currentIndex]->Phasor -
-            sampleWithUnknownStatus->Node1OtherCurrentsNorm[currentIndex]->Phasor).RMSvalue, 2);
+        dist += otherCurrentWeight *
+            (sampleWithKnownStatus->Node1OtherCurrentsNorm[currentIndex]->Phasor -
+            sampleWithUnknownStatus->Node1OtherCurrentsNorm[currentIndex]->Phasor).SquaredMagnitude();
     }
-    numberOfCurrents = (double)sampleWithKnownStatus->NumberOfNode2OtherCurrents;
+    otherCurrentWeight = weights.WOther / (2 * (double)sampleWithKnownStatus->NumberOfNode2OtherCurrents);
     for (int currentIndex = 0; currentIndex < sampleWithKnownStatus->NumberOfNode2OtherCurrents; currentIndex++) {
-        dist += wOther / (2 * numberOfCurrents) * pow((sampleWithKnownStatus->Node2OtherCurrentsNorm[currentIndex]->Phasor -
-            sampleWithUnknownStatus->Node2OtherCurrentsNorm[currentIndex]->Phasor).RMSvalue, 2);
+        dist += otherCurrentWeight *
+            (sampleWithKnownStatus->Node2OtherCurrentsNorm[currentIndex]->Phasor -
+            sampleWithUnknownStatus->Node2OtherCurrentsNorm[currentIndex]->Phasor).SquaredMagnitude();
     }
 
     return sqrt(dist);
@@ -127,9 +96,7 @@ distanceSample::~distanceSample() {}
 
 const void distanceSample::Print() {
     line->PrintLine();
-    cout << "Wline = " << to_string(wLine) << "\n";
-    cout << "Wnode = " << to_string(wNode) << "\n";
-    cout << "Wother = " << to_string(wOther) << "\n";
+    weights.Print();
     cout << "distance = " << to_string(Distance) << "\n";
     cout << "isWorking = " << to_string(IsWorking) << "\n";
 }
\ No newline at end of file
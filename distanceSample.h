@@ -12,6 +12,7 @@ using namespace std;
 #include "parameter.h"
 #include "nodeSample.h"
 #include "lineSample.h"
+#include "distanceWeights.h"
 
 
 /// <summary>
@@ -24,21 +25,15 @@ private:
     /// </summary>
     lineSample* line = NULL;
     /// <summary>
-    /// The weight of the line currents
+    /// The weights of the line currents, node voltages, and other currents
     /// </summary>
-    double wLine = 20;
-    /// <summary>
-    /// The weight of the node voltages
-    /// </summary>
-    double wNode = 4;
-    /// <summary>
-    /// The weight of the other currents flowing from the nodes not counting the line currents
-    /// </summary>
-    double wOther = 1;
+    distanceWeights weights;
 
 
     /// <summary>
-    /// Verify if the line samples are samples of the same line.
+    /// Verify if the line samples are samples of the same line by comparing their topology keys and their numbers of other currents.
+    /// Different lines that collide on a key with the same layout aren't told apart here, since lineFeatureMatrix compares the node
+    /// numbers once per training set and once per query.
     /// </summary>
     /// <param name="known">The line sample with the status known</param>
     /// <param name="unknown">The line sample with the status unknown</param>
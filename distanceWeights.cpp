@@ -0,0 +1,27 @@
+#define _USE_MATH_DEFINES
+
+using namespace std;
+
+#include <cmath>
+#include <exception>
+#include <iostream>
+#include <string>
+#include "distanceWeights.h"
+
+
+
+distanceWeights::distanceWeights() {}
+distanceWeights::distanceWeights(double wLine, double wNode, double wOther)
+{
+    WLine = wLine;
+    WNode = wNode;
+    WOther = wOther;
+}
+
+
+const void distanceWeights::Print()
+{
+    cout << "Wline = " << to_string(WLine) << "\n";
+    cout << "Wnode = " << to_string(WNode) << "\n";
+    cout << "Wother = " << to_string(WOther) << "\n";
+}
\ No newline at end of file
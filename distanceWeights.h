@@ -0,0 +1,49 @@
+#pragma once
+
+#define _USE_MATH_DEFINES
+
+using namespace std;
+
+#include <cmath>
+#include <exception>
+#include <iostream>
+#include <string>
+
+
+/// <summary>
+/// The weights of the weighted euclidean distance between two line samples
+/// </summary>
+class distanceWeights {
+public:
+    /// <summary>
+    /// The weight of the line currents
+    /// </summary>
+    double WLine = 20;
+    /// <summary>
+    /// The weight of the node voltages
+    /// </summary>
+    double WNode = 4;
+    /// <summary>
+    /// The weight of the other currents flowing from the nodes not counting the line currents
+    /// </summary>
+    double WOther = 1;
+
+
+    /// <summary>
+    /// Set the weights to their default values.
+    /// </summary>
+    distanceWeights();
+    /// <summary>
+    /// Set the weights to custom values.
+    /// </summary>
+    /// <param name="wLine">The weight of the line currents</param>
+    /// <param name="wNode">The weight of the node voltages</param>
+    /// <param name="wOther">The weight of the other currents flowing from the nodes not counting the line currents</param>
+    explicit distanceWeights(double wLine, double wNode, double wOther);
+
+
+    /// <summary>
+    /// Print the weights.
+    /// </summary>
+    const void Print();
+};
\ No newline at end of file
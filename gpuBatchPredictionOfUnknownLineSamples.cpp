@@ -0,0 +1,217 @@
+#define _USE_MATH_DEFINES
+
+using namespace std;
+
+#include <cmath>
+#include <exception>
+#include <iostream>
+#include <string>
+#include <vector>
+#include "phasor.h"
+#include "parameter.h"
+#include "nodeSample.h"
+#include "lineSample.h"
+#include "distanceWeights.h"
+#include "lineFeatureMatrix.h"
+#include "distanceKernel.h"
+#include "nearestNeighbor.h"
+#include "nearestNeighborHeap.h"
+#include "nearestNeighborIndex.h"
+#include "knnQueryScratch.h"
+#include "knnPredictionResult.h"
+#include "knnQueryEngine.h"
+#include "gpuFeatureMatrix.h"
+#include "allocationCounter.h"
+#include "latencyHistogram.h"
+#include "knnInstrumentationSnapshot.h"
+#include "knnInstrumentation.h"
+#include "knnStageTimer.h"
+#include "gpuBatchPredictionOfUnknownLineSamples.h"
+
+
+const void gpuBatchPredictionOfUnknownLineSamples::Upload()
+{
+    if ((knownFeatures == NULL) || (NumberOfKnownStatuses == 0)) return;
+
+    cpuEngine = new knnQueryEngine(knownFeatures, numberOfNearestNeighbors);
+    if (cpuEngine == NULL) {
+        MemoryAllocationFailure("cpuEngine");
+        return;
+    }
+
+#if defined(KNN_CUDA)
+    if (numberOfNearestNeighbors > gpuFeatureMatrix::MaximumNumberOfNearestNeighbors()) return;
+    if (gpuFeatureMatrix::DeviceName().empty() == true) return;
+    device = new gpuFeatureMatrix(knownFeatures);
+    if (device == NULL) {
+        MemoryAllocationFailure("device");
+        return;
+    }
+    // A failed upload already printed its error, and the CPU fallback takes over
+    if (device->IsUploaded() == false) {
+        delete device;
+        device = NULL;
+    }
+#endif
+}
+const bool gpuBatchPredictionOfUnknownLineSamples::CpuNearestNeighbors(lineSample** samplesWithUnknownStatuses,
+    int numberOfUnknownStatuses, nearestNeighbor* nearestNeighbors) const
+{
+    bool predictedStatus = true;
+    for (int unknownSampleIndex = 0; unknownSampleIndex < numberOfUnknownStatuses; unknownSampleIndex++) {
+        if (cpuEngine->PredictStatus(samplesWithUnknownStatuses[unknownSampleIndex], &predictedStatus, numberOfNearestNeighbors,
+            nearestNeighbors + (size_t)unknownSampleIndex * numberOfNearestNeighbors) == false) return false;
+    }
+    return true;
+}
+const bool gpuBatchPredictionOfUnknownLineSamples::PredictStatus(const nearestNeighbor* nearestNeighbors) const
+{
+    int numOfWorkingLines = 0;
+    int numOfNotWorkingLines = 0;
+
+    for (int nearestNeighborIndex = 0; nearestNeighborIndex < numberOfNearestNeighbors; nearestNeighborIndex++) {
+        if (nearestNeighbors[nearestNeighborIndex].IsWorking == true) numOfWorkingLines += 1;
+        else numOfNotWorkingLines += 1;
+    }
+
+    if (numOfWorkingLines > numOfNotWorkingLines) return true;
+    else return false;
+}
+
+
+const void gpuBatchPredictionOfUnknownLineSamples::FreeMemory()
+{
+#if defined(KNN_CUDA)
+    if (device != NULL) {
+        delete device;
+        device = NULL;
+    }
+#endif
+    if (cpuEngine != NULL) {
+        delete cpuEngine;
+        cpuEngine = NULL;
+    }
+}
+
+const void gpuBatchPredictionOfUnknownLineSamples::MemoryAllocationFailure(string variableName)
+{
+    cout << "Error: gpuBatchPredictionOfUnknownLineSamples() failed to allocate memory for " << variableName << "\n";
+    FreeMemory();
+}
+
+
+
+gpuBatchPredictionOfUnknownLineSamples::gpuBatchPredictionOfUnknownLineSamples(lineSample** samplesWithKnownStatuses,
+    int numberOfKnownStatuses, int numberOfNearestNeighbors)
+{
+    this->numberOfNearestNeighbors = numberOfNearestNeighbors;
+
+    knownFeatures = new lineFeatureMatrix(samplesWithKnownStatuses, numberOfKnownStatuses);
+    if (knownFeatures == NULL) {
+        MemoryAllocationFailure("knownFeatures");
+        return;
+    }
+    ownsKnownFeatures = true;
+    NumberOfKnownStatuses = knownFeatures->NumberOfSamples;
+    Upload();
+}
+gpuBatchPredictionOfUnknownLineSamples::gpuBatchPredictionOfUnknownLineSamples(lineFeatureMatrix* knownFeatures,
+    int numberOfNearestNeighbors)
+{
+    this->numberOfNearestNeighbors = numberOfNearestNeighbors;
+    this->knownFeatures = knownFeatures;
+    if (knownFeatures != NULL) NumberOfKnownStatuses = knownFeatures->NumberOfSamples;
+    Upload();
+}
+
+gpuBatchPredictionOfUnknownLineSamples::~gpuBatchPredictionOfUnknownLineSamples()
+{
+    FreeMemory();
+    if ((ownsKnownFeatures == true) && (knownFeatures != NULL)) {
+        delete knownFeatures;
+        knownFeatures = NULL;
+    }
+}
+
+
+const bool gpuBatchPredictionOfUnknownLineSamples::IsAvailable()
+{
+#if defined(KNN_CUDA)
+    return true;
+#else
+    return false;
+#endif
+}
+const bool gpuBatchPredictionOfUnknownLineSamples::IsOnDevice() const
+{
+    return device != NULL;
+}
+const string gpuBatchPredictionOfUnknownLineSamples::BackendName() const
+{
+#if defined(KNN_CUDA)
+    if (device != NULL) return "CUDA (" + gpuFeatureMatrix::DeviceName() + ")";
+    return "CPU fallback (no CUDA device or more than " + to_string(gpuFeatureMatrix::MaximumNumberOfNearestNeighbors()) +
+        " nearest neighbors)";
+#else
+    return "CPU fallback (compile gpuFeatureMatrix.cu with nvcc and define KNN_CUDA)";
+#endif
+}
+const bool gpuBatchPredictionOfUnknownLineSamples::PredictNearestNeighbors(lineSample** samplesWithUnknownStatuses,
+    int numberOfUnknownStatuses, nearestNeighbor* nearestNeighbors)
+{
+    KNN_TIME_STAGE(knnStage::Prediction);
+    if ((knownFeatures == NULL) || (NumberOfKnownStatuses == 0) || (cpuEngine == NULL)) {
+        cout << "Error: There are no known statuses to compare to.\n";
+        return false;
+    }
+    if (numberOfNearestNeighbors > NumberOfKnownStatuses) {
+        cout << "Error: The number of nearest neighbors is larger than the number of known statuses.\n";
+        return false;
+    }
+    if ((samplesWithUnknownStatuses == NULL) || (nearestNeighbors == NULL)) {
+        cout << "Error in PredictNearestNeighbors(): lineSample** samplesWithUnknownStatuses = NULL or " <<
+            "nearestNeighbor* nearestNeighbors = NULL!\n";
+        return false;
+    }
+    for (int unknownSampleIndex = 0; unknownSampleIndex < numberOfUnknownStatuses; unknownSampleIndex++) {
+        if (knownFeatures->IsSampleOfTheSameLine(samplesWithUnknownStatuses[unknownSampleIndex]) == false) {
+            cout << "Error in PredictNearestNeighbors(): samplesWithUnknownStatuses[" << to_string(unknownSampleIndex) <<
+                "] is not a sample of the same line as the known line samples.\n";
+            return false;
+        }
+    }
+
+#if defined(KNN_CUDA)
+    if (device != NULL) {
+        int numberOfFeatures = knownFeatures->NumberOfFeatures;
+        vector<double> unknownRealParts((size_t)numberOfUnknownStatuses * numberOfFeatures);
+        vector<double> unknownImaginaryParts((size_t)numberOfUnknownStatuses * numberOfFeatures);
+        for (int unknownSampleIndex = 0; unknownSampleIndex < numberOfUnknownStatuses; unknownSampleIndex++) {
+            knownFeatures->ExtractFeatures(samplesWithUnknownStatuses[unknownSampleIndex],
+                unknownRealParts.data() + (size_t)unknownSampleIndex * numberOfFeatures,
+                unknownImaginaryParts.data() + (size_t)unknownSampleIndex * numberOfFeatures);
+        }
+        if (device->NearestNeighbors(unknownRealParts.data(), unknownImaginaryParts.data(), numberOfUnknownStatuses,
+            numberOfNearestNeighbors, nearestNeighbors) == true) return true;
+        // A failed launch already printed its error, so this batch is predicted on the CPU
+    }
+#endif
+    return CpuNearestNeighbors(samplesWithUnknownStatuses, numberOfUnknownStatuses, nearestNeighbors);
+}
+const vector<bool> gpuBatchPredictionOfUnknownLineSamples::PredictStatuses(lineSample** samplesWithUnknownStatuses,
+    int numberOfUnknownStatuses)
+{
+    vector<bool> predictedStatuses;
+    vector<nearestNeighbor> nearestNeighbors((size_t)numberOfUnknownStatuses * numberOfNearestNeighbors);
+    if (PredictNearestNeighbors(samplesWithUnknownStatuses, numberOfUnknownStatuses, nearestNeighbors.data()) == false) {
+        return predictedStatuses;
+    }
+
+    predictedStatuses.reserve(numberOfUnknownStatuses);
+    for (int unknownSampleIndex = 0; unknownSampleIndex < numberOfUnknownStatuses; unknownSampleIndex++) {
+        predictedStatuses.push_back(PredictStatus(nearestNeighbors.data() + (size_t)unknownSampleIndex * numberOfNearestNeighbors));
+    }
+    KNN_COUNT(knnCounter::Predictions, numberOfUnknownStatuses);
+
+    return predictedStatuses;
+}
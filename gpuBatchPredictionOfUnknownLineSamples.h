@@ -0,0 +1,152 @@
+#pragma once
+
+#define _USE_MATH_DEFINES
+
+using namespace std;
+
+#include <cmath>
+#include <exception>
+#include <iostream>
+#include <string>
+#include <vector>
+#include "phasor.h"
+#include "parameter.h"
+#include "nodeSample.h"
+#include "lineSample.h"
+#include "distanceWeights.h"
+#include "lineFeatureMatrix.h"
+#include "distanceKernel.h"
+#include "nearestNeighbor.h"
+#include "nearestNeighborHeap.h"
+#include "nearestNeighborIndex.h"
+#include "knnQueryScratch.h"
+#include "knnPredictionResult.h"
+#include "knnQueryEngine.h"
+#include "gpuFeatureMatrix.h"
+
+
+/// <summary>
+/// This contains a set of known line samples and predicts the statuses of many unknown line samples on a GPU. The feature matrix
+/// is uploaded once by the constructor, the distances and the selection of the k nearest neighbors run on the device, and only
+/// the k nearest neighbors of each unknown line sample come back. Builds without KNN_CUDA (or without a device, or with more
+/// nearest neighbors than the device selects) predict on the CPU with knnQueryEngine instead, so the API is the same either way.
+/// </summary>
+class gpuBatchPredictionOfUnknownLineSamples {
+private:
+    /// <summary>
+    /// The number of nearest neighbors to consider
+    /// </summary>
+    int numberOfNearestNeighbors = 5;
+    /// <summary>
+    /// The normalized parameters of the line samples with a known line status
+    /// </summary>
+    lineFeatureMatrix* knownFeatures = NULL;
+    /// <summary>
+    /// True if knownFeatures was built by the constructor and is freed with this class
+    /// </summary>
+    bool ownsKnownFeatures = false;
+    /// <summary>
+    /// The copy of the feature matrix on the device (NULL predicts on the CPU)
+    /// </summary>
+    gpuFeatureMatrix* device = NULL;
+    /// <summary>
+    /// The engine the CPU predictions go through
+    /// </summary>
+    knnQueryEngine* cpuEngine = NULL;
+
+
+    /// <summary>
+    /// Upload the feature matrix if this build has the CUDA backend and there is a device that can take it.
+    /// </summary>
+    const void Upload();
+    /// <summary>
+    /// Find the k nearest neighbors of every unknown line sample on the CPU.
+    /// </summary>
+    /// <param name="samplesWithUnknownStatuses">The array of line samples with unknown line statuses</param>
+    /// <param name="numberOfUnknownStatuses">The number of elements in the samplesWithUnknownStatuses array</param>
+    /// <param name="nearestNeighbors">The array of numberOfUnknownStatuses * k neighbors to fill</param>
+    /// <returns>True if every prediction succeeded</returns>
+    const bool CpuNearestNeighbors(lineSample** samplesWithUnknownStatuses, int numberOfUnknownStatuses,
+        nearestNeighbor* nearestNeighbors) const;
+    /// <summary>
+    /// Predicts the line status of an unknown line sample from its nearest neighbors the same way knnPredictionOfUnknownLineSample
+    /// does.
+    /// </summary>
+    /// <param name="nearestNeighbors">The k nearest neighbors of the unknown line sample</param>
+    /// <returns>The predicted status of the unknown line sample</returns>
+    const bool PredictStatus(const nearestNeighbor* nearestNeighbors) const;
+
+    /// <summary>
+    /// Free the dynamically allocated memory and set their pointers to NULL. Notice that the known line samples aren't freed and
+    /// knownFeatures is only freed if this class built it.
+    /// </summary>
+    const void FreeMemory();
+
+    /// <summary>
+    /// Display an error message and call FreeMemory().
+    /// </summary>
+    /// <param=variableName>The name of the variable that failed to get memory allocation</param>
+    const void MemoryAllocationFailure(string variableName);
+
+
+public:
+    /// <summary>
+    /// The number of known line samples
+    /// </summary>
+    int NumberOfKnownStatuses = 0;
+
+
+    /// <summary>
+    /// This constructor builds the feature matrix of the known line samples and uploads it.
+    /// </summary>
+    /// <param name="samplesWithKnownStatuses">The array of line samples with known line statuses</param>
+    /// <param name="numberOfKnownStatuses">The number of elements in the samplesWithKnownStatuses array</param>
+    /// <param name="numberOfNearestNeighbors">
+    /// The number of nearest neighbors each unknown sample is compared to for the prediction</param>
+    explicit gpuBatchPredictionOfUnknownLineSamples(lineSample** samplesWithKnownStatuses, int numberOfKnownStatuses,
+        int numberOfNearestNeighbors = 5);
+    /// <summary>
+    /// This constructor uploads a previously built feature matrix that won't be freed on the deconstructor. The CPU fallback
+    /// scans the matrix, so it must not change while this class is used.
+    /// </summary>
+    /// <param name="knownFeatures">The feature matrix of the line samples with known line statuses</param>
+    /// <param name="numberOfNearestNeighbors">
+    /// The number of nearest neighbors each unknown sample is compared to for the prediction</param>
+    explicit gpuBatchPredictionOfUnknownLineSamples(lineFeatureMatrix* knownFeatures, int numberOfNearestNeighbors = 5);
+
+    /// <summary>
+    /// The deconstructor
+    /// </summary>
+    ~gpuBatchPredictionOfUnknownLineSamples();
+
+
+    /// <summary>
+    /// True if this build has the CUDA backend (gpuFeatureMatrix.cu compiled with nvcc and KNN_CUDA defined)
+    /// </summary>
+    static const bool IsAvailable();
+    /// <summary>
+    /// True if the predictions run on the device rather than the CPU fallback
+    /// </summary>
+    const bool IsOnDevice() const;
+    /// <summary>
+    /// The name of the backend the predictions run on
+    /// </summary>
+    const string BackendName() const;
+    /// <summary>
+    /// Find the k nearest neighbors of an array of unknown line samples.
+    /// </summary>
+    /// <param name="samplesWithUnknownStatuses">The array of line samples with unknown line statuses</param>
+    /// <param name="numberOfUnknownStatuses">The number of elements in the samplesWithUnknownStatuses array</param>
+    /// <param name="nearestNeighbors">
+    /// The array of numberOfUnknownStatuses * numberOfNearestNeighbors neighbors to fill, closest first for each line sample</param>
+    /// <returns>True if the unknown line samples were valid and every prediction succeeded</returns>
+    const bool PredictNearestNeighbors(lineSample** samplesWithUnknownStatuses, int numberOfUnknownStatuses,
+        nearestNeighbor* nearestNeighbors);
+    /// <summary>
+    /// Predict the line statuses of an array of unknown line samples.
+    /// </summary>
+    /// <param name="samplesWithUnknownStatuses">The array of line samples with unknown line statuses</param>
+    /// <param name="numberOfUnknownStatuses">The number of elements in the samplesWithUnknownStatuses array</param>
+    /// <returns>The predicted statuses in the same order as the unknown line samples (empty on failure)</returns>
+    const vector<bool> PredictStatuses(lineSample** samplesWithUnknownStatuses, int numberOfUnknownStatuses);
+};
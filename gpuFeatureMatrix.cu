@@ -0,0 +1,269 @@
+#define _USE_MATH_DEFINES
+
+using namespace std;
+
+#include <cmath>
+#include <climits>
+#include <exception>
+#include <iostream>
+#include <string>
+#include <vector>
+#include <cuda_runtime.h>
+#include "phasor.h"
+#include "parameter.h"
+#include "nodeSample.h"
+#include "lineSample.h"
+#include "lineFeatureMatrix.h"
+#include "nearestNeighbor.h"
+#include "gpuFeatureMatrix.h"
+
+
+/// <summary>
+/// The number of threads scoring each unknown line sample
+/// </summary>
+static const int threadsPerUnknownSample = 64;
+/// <summary>
+/// The largest number of nearest neighbors of the kernel (the same as gpuFeatureMatrix::MaximumNumberOfNearestNeighbors())
+/// </summary>
+static const int kernelMaximumNumberOfNearestNeighbors = 32;
+
+
+/// <summary>
+/// Compare two neighbors by squared distance and then by index like nearestNeighborHeap::IsNearer().
+/// </summary>
+__device__ static bool IsNearer(double squaredDistance, int index, double otherSquaredDistance, int otherIndex)
+{
+    if (squaredDistance != otherSquaredDistance) return squaredDistance < otherSquaredDistance;
+    return index < otherIndex;
+}
+/// <summary>
+/// One thread block per unknown line sample. Each thread scores every threadsPerUnknownSample-th known line sample (so the threads
+/// of a warp read consecutive elements of each column) and keeps its own sorted k nearest, then the sorted lists are merged
+/// pairwise in shared memory until the first thread holds the k nearest of the block.
+/// </summary>
+__global__ static void NearestNeighborsKernel(const double* values, const double* weights, int numberOfSamples, int stride,
+    int numberOfFeatures, const double* unknownRealParts, const double* unknownImaginaryParts, int numberOfNearestNeighbors,
+    double* nearestDistances, int* nearestIndices)
+{
+    __shared__ double sharedDistances[threadsPerUnknownSample * kernelMaximumNumberOfNearestNeighbors];
+    __shared__ int sharedIndices[threadsPerUnknownSample * kernelMaximumNumberOfNearestNeighbors];
+    const double* realParts = unknownRealParts + (size_t)blockIdx.x * numberOfFeatures;
+    const double* imaginaryParts = unknownImaginaryParts + (size_t)blockIdx.x * numberOfFeatures;
+    const int k = numberOfNearestNeighbors;
+
+    // The empty places hold an infinite distance so they sort after every known line sample
+    double localDistances[kernelMaximumNumberOfNearestNeighbors];
+    int localIndices[kernelMaximumNumberOfNearestNeighbors];
+    for (int neighborIndex = 0; neighborIndex < k; neighborIndex++) {
+        localDistances[neighborIndex] = INFINITY;
+        localIndices[neighborIndex] = INT_MAX;
+    }
+    for (int sampleIndex = threadIdx.x; sampleIndex < numberOfSamples; sampleIndex += threadsPerUnknownSample) {
+        double squaredDistance = 0;
+        for (int featureIndex = 0; featureIndex < numberOfFeatures; featureIndex++) {
+            double realDifference = values[(size_t)(2 * featureIndex) * stride + sampleIndex] - realParts[featureIndex];
+            double imaginaryDifference = values[(size_t)(2 * featureIndex + 1) * stride + sampleIndex] - imaginaryParts[featureIndex];
+            squaredDistance += weights[featureIndex] * (realDifference * realDifference + imaginaryDifference * imaginaryDifference);
+        }
+        if (IsNearer(squaredDistance, sampleIndex, localDistances[k - 1], localIndices[k - 1]) == false) continue;
+
+        int neighborIndex = k - 1;
+        while ((neighborIndex > 0) &&
+            (IsNearer(squaredDistance, sampleIndex, localDistances[neighborIndex - 1], localIndices[neighborIndex - 1]) == true)) {
+            localDistances[neighborIndex] = localDistances[neighborIndex - 1];
+            localIndices[neighborIndex] = localIndices[neighborIndex - 1];
+            neighborIndex--;
+        }
+        localDistances[neighborIndex] = squaredDistance;
+        localIndices[neighborIndex] = sampleIndex;
+    }
+    for (int neighborIndex = 0; neighborIndex < k; neighborIndex++) {
+        sharedDistances[threadIdx.x * k + neighborIndex] = localDistances[neighborIndex];
+        sharedIndices[threadIdx.x * k + neighborIndex] = localIndices[neighborIndex];
+    }
+    __syncthreads();
+
+    for (int otherThreadOffset = threadsPerUnknownSample / 2; otherThreadOffset > 0; otherThreadOffset /= 2) {
+        if (threadIdx.x < otherThreadOffset) {
+            const double* otherDistances = sharedDistances + (threadIdx.x + otherThreadOffset) * k;
+            const int* otherIndices = sharedIndices + (threadIdx.x + otherThreadOffset) * k;
+            double mergedDistances[kernelMaximumNumberOfNearestNeighbors];
+            int mergedIndices[kernelMaximumNumberOfNearestNeighbors];
+            int localIndex = 0;
+            int otherIndex = 0;
+            for (int neighborIndex = 0; neighborIndex < k; neighborIndex++) {
+                if (IsNearer(localDistances[localIndex], localIndices[localIndex], otherDistances[otherIndex],
+                    otherIndices[otherIndex]) == true) {
+                    mergedDistances[neighborIndex] = localDistances[localIndex];
+                    mergedIndices[neighborIndex] = localIndices[localIndex];
+                    localIndex++;
+                }
+                else {
+                    mergedDistances[neighborIndex] = otherDistances[otherIndex];
+                    mergedIndices[neighborIndex] = otherIndices[otherIndex];
+                    otherIndex++;
+                }
+            }
+            for (int neighborIndex = 0; neighborIndex < k; neighborIndex++) {
+                localDistances[neighborIndex] = mergedDistances[neighborIndex];
+                localIndices[neighborIndex] = mergedIndices[neighborIndex];
+            }
+        }
+        __syncthreads();
+        if (threadIdx.x < otherThreadOffset) {
+            for (int neighborIndex = 0; neighborIndex < k; neighborIndex++) {
+                sharedDistances[threadIdx.x * k + neighborIndex] = localDistances[neighborIndex];
+                sharedIndices[threadIdx.x * k + neighborIndex] = localIndices[neighborIndex];
+            }
+        }
+        __syncthreads();
+    }
+
+    if (threadIdx.x == 0) {
+        for (int neighborIndex = 0; neighborIndex < k; neighborIndex++) {
+            nearestDistances[(size_t)blockIdx.x * k + neighborIndex] = localDistances[neighborIndex];
+            nearestIndices[(size_t)blockIdx.x * k + neighborIndex] = localIndices[neighborIndex];
+        }
+    }
+}
+
+
+const bool gpuFeatureMatrix::Check(int status, string callName)
+{
+    if ((cudaError_t)status == cudaSuccess) return true;
+    cout << "Error: gpuFeatureMatrix: " << callName << " failed: " << cudaGetErrorString((cudaError_t)status) << "\n";
+    return false;
+}
+
+const void gpuFeatureMatrix::FreeMemory()
+{
+    if (deviceValues != NULL) {
+        cudaFree(deviceValues);
+        deviceValues = NULL;
+    }
+    if (deviceWeights != NULL) {
+        cudaFree(deviceWeights);
+        deviceWeights = NULL;
+    }
+    if (deviceUnknownRealParts != NULL) {
+        cudaFree(deviceUnknownRealParts);
+        deviceUnknownRealParts = NULL;
+    }
+    if (deviceUnknownImaginaryParts != NULL) {
+        cudaFree(deviceUnknownImaginaryParts);
+        deviceUnknownImaginaryParts = NULL;
+    }
+    if (deviceNearestDistances != NULL) {
+        cudaFree(deviceNearestDistances);
+        deviceNearestDistances = NULL;
+    }
+    if (deviceNearestIndices != NULL) {
+        cudaFree(deviceNearestIndices);
+        deviceNearestIndices = NULL;
+    }
+    numberOfSamples = 0;
+}
+
+
+
+gpuFeatureMatrix::gpuFeatureMatrix(const lineFeatureMatrix* features)
+{
+    if ((features == NULL) || (features->NumberOfSamples == 0)) {
+        cout << "Error: gpuFeatureMatrix() needs a feature matrix with at least one line sample.\n";
+        return;
+    }
+    numberOfFeatures = features->NumberOfFeatures;
+    stride = features->Stride;
+
+    // RealColumn(0) is the start of the one block holding every column
+    size_t valuesSize = 2 * (size_t)numberOfFeatures * stride * sizeof(double);
+    size_t unknownsSize = (size_t)unknownSamplesPerLaunch * numberOfFeatures * sizeof(double);
+    size_t nearestSize = (size_t)unknownSamplesPerLaunch * maximumNumberOfNearestNeighbors;
+    if ((Check(cudaMalloc((void**)&deviceValues, valuesSize), "cudaMalloc(deviceValues)") == false) ||
+        (Check(cudaMalloc((void**)&deviceWeights, numberOfFeatures * sizeof(double)), "cudaMalloc(deviceWeights)") == false) ||
+        (Check(cudaMalloc((void**)&deviceUnknownRealParts, unknownsSize), "cudaMalloc(deviceUnknownRealParts)") == false) ||
+        (Check(cudaMalloc((void**)&deviceUnknownImaginaryParts, unknownsSize), "cudaMalloc(deviceUnknownImaginaryParts)") == false) ||
+        (Check(cudaMalloc((void**)&deviceNearestDistances, nearestSize * sizeof(double)), "cudaMalloc(deviceNearestDistances)") == false) ||
+        (Check(cudaMalloc((void**)&deviceNearestIndices, nearestSize * sizeof(int)), "cudaMalloc(deviceNearestIndices)") == false)) {
+        FreeMemory();
+        return;
+    }
+    if ((Check(cudaMemcpy(deviceValues, features->RealColumn(0), valuesSize, cudaMemcpyHostToDevice), "cudaMemcpy(values)") == false) ||
+        (Check(cudaMemcpy(deviceWeights, features->FeatureWeights, numberOfFeatures * sizeof(double), cudaMemcpyHostToDevice),
+            "cudaMemcpy(weights)") == false)) {
+        FreeMemory();
+        return;
+    }
+
+    statuses.resize(features->NumberOfSamples);
+    for (int sampleIndex = 0; sampleIndex < features->NumberOfSamples; sampleIndex++) statuses[sampleIndex] = features->IsWorking(sampleIndex);
+    numberOfSamples = features->NumberOfSamples;
+}
+
+gpuFeatureMatrix::~gpuFeatureMatrix()
+{
+    FreeMemory();
+}
+
+
+const bool gpuFeatureMatrix::IsUploaded() const
+{
+    return numberOfSamples > 0;
+}
+const int gpuFeatureMatrix::MaximumNumberOfNearestNeighbors()
+{
+    return maximumNumberOfNearestNeighbors;
+}
+const string gpuFeatureMatrix::DeviceName()
+{
+    int deviceIndex = 0;
+    cudaDeviceProp properties;
+    if ((cudaGetDevice(&deviceIndex) != cudaSuccess) || (cudaGetDeviceProperties(&properties, deviceIndex) != cudaSuccess)) return "";
+    return string(properties.name);
+}
+const bool gpuFeatureMatrix::NearestNeighbors(const double* realParts, const double* imaginaryParts, int numberOfUnknownSamples,
+    int numberOfNearestNeighbors, nearestNeighbor* nearestNeighbors)
+{
+    if (IsUploaded() == false) return false;
+    if ((numberOfNearestNeighbors <= 0) || (numberOfNearestNeighbors > maximumNumberOfNearestNeighbors) ||
+        (numberOfNearestNeighbors > numberOfSamples)) {
+        cout << "Error in gpuFeatureMatrix::NearestNeighbors(): the number of nearest neighbors has to be between 1 and " <<
+            to_string(maximumNumberOfNearestNeighbors) << " and at most the number of known line samples.\n";
+        return false;
+    }
+
+    vector<double> nearestDistances((size_t)unknownSamplesPerLaunch * numberOfNearestNeighbors);
+    vector<int> nearestIndices((size_t)unknownSamplesPerLaunch * numberOfNearestNeighbors);
+    for (int firstUnknownIndex = 0; firstUnknownIndex < numberOfUnknownSamples; firstUnknownIndex += unknownSamplesPerLaunch) {
+        int numberOfUnknownsInLaunch = unknownSamplesPerLaunch;
+        if (numberOfUnknownSamples - firstUnknownIndex < unknownSamplesPerLaunch) {
+            numberOfUnknownsInLaunch = numberOfUnknownSamples - firstUnknownIndex;
+        }
+        size_t unknownsSize = (size_t)numberOfUnknownsInLaunch * numberOfFeatures * sizeof(double);
+        size_t nearestCount = (size_t)numberOfUnknownsInLaunch * numberOfNearestNeighbors;
+
+        if ((Check(cudaMemcpy(deviceUnknownRealParts, realParts + (size_t)firstUnknownIndex * numberOfFeatures, unknownsSize,
+            cudaMemcpyHostToDevice), "cudaMemcpy(unknownRealParts)") == false) ||
+            (Check(cudaMemcpy(deviceUnknownImaginaryParts, imaginaryParts + (size_t)firstUnknownIndex * numberOfFeatures, unknownsSize,
+                cudaMemcpyHostToDevice), "cudaMemcpy(unknownImaginaryParts)") == false)) return false;
+
+        NearestNeighborsKernel<<<numberOfUnknownsInLaunch, threadsPerUnknownSample>>>(deviceValues, deviceWeights, numberOfSamples,
+            stride, numberOfFeatures, deviceUnknownRealParts, deviceUnknownImaginaryParts, numberOfNearestNeighbors,
+            deviceNearestDistances, deviceNearestIndices);
+        if (Check(cudaGetLastError(), "NearestNeighborsKernel") == false) return false;
+
+        // Only the k nearest neighbors of each unknown line sample come back
+        if ((Check(cudaMemcpy(nearestDistances.data(), deviceNearestDistances, nearestCount * sizeof(double), cudaMemcpyDeviceToHost),
+            "cudaMemcpy(nearestDistances)") == false) ||
+            (Check(cudaMemcpy(nearestIndices.data(), deviceNearestIndices, nearestCount * sizeof(int), cudaMemcpyDeviceToHost),
+                "cudaMemcpy(nearestIndices)") == false)) return false;
+
+        for (size_t neighborIndex = 0; neighborIndex < nearestCount; neighborIndex++) {
+            nearestNeighbor& neighbor = nearestNeighbors[(size_t)firstUnknownIndex * numberOfNearestNeighbors + neighborIndex];
+            neighbor.SquaredDistance = nearestDistances[neighborIndex];
+            neighbor.Index = nearestIndices[neighborIndex];
+            neighbor.IsWorking = statuses[neighbor.Index] == 1;
+        }
+    }
+    return true;
+}
@@ -0,0 +1,131 @@
+#pragma once
+
+#define _USE_MATH_DEFINES
+
+using namespace std;
+
+#include <cmath>
+#include <exception>
+#include <iostream>
+#include <string>
+#include <vector>
+#include "phasor.h"
+#include "parameter.h"
+#include "nodeSample.h"
+#include "lineSample.h"
+#include "lineFeatureMatrix.h"
+#include "nearestNeighbor.h"
+
+
+/// <summary>
+/// A copy of a feature matrix in GPU memory that scores batches of unknown line samples and selects their k nearest neighbors on
+/// the device, so only the k nearest neighbors of each unknown line sample are copied back. It's implemented in gpuFeatureMatrix.cu,
+/// which is only compiled (with nvcc) into builds that define KNN_CUDA.
+/// </summary>
+class gpuFeatureMatrix {
+private:
+    /// <summary>
+    /// The largest number of nearest neighbors the device selects (the shared memory of a thread block holds this many per thread)
+    /// </summary>
+    static const int maximumNumberOfNearestNeighbors = 32;
+    /// <summary>
+    /// The number of unknown line samples scored per kernel launch, which bounds the device memory of the unknown line samples
+    /// </summary>
+    static const int unknownSamplesPerLaunch = 4096;
+    /// <summary>
+    /// The columns of the feature matrix on the device (2 * numberOfFeatures columns of 'stride' elements)
+    /// </summary>
+    double* deviceValues = NULL;
+    /// <summary>
+    /// The feature weights on the device
+    /// </summary>
+    double* deviceWeights = NULL;
+    /// <summary>
+    /// The real parts of the features of the unknown line samples of a launch on the device
+    /// </summary>
+    double* deviceUnknownRealParts = NULL;
+    /// <summary>
+    /// The imaginary parts of the features of the unknown line samples of a launch on the device
+    /// </summary>
+    double* deviceUnknownImaginaryParts = NULL;
+    /// <summary>
+    /// The squared distances of the k nearest neighbors of each unknown line sample of a launch on the device
+    /// </summary>
+    double* deviceNearestDistances = NULL;
+    /// <summary>
+    /// The indices of the k nearest neighbors of each unknown line sample of a launch on the device
+    /// </summary>
+    int* deviceNearestIndices = NULL;
+    /// <summary>
+    /// The statuses of the known line samples (kept on the host since only the indices come back)
+    /// </summary>
+    vector<char> statuses;
+    /// <summary>
+    /// The number of known line samples
+    /// </summary>
+    int numberOfSamples = 0;
+    /// <summary>
+    /// The number of elements per column
+    /// </summary>
+    int stride = 0;
+    /// <summary>
+    /// The number of normalized phasors per line sample
+    /// </summary>
+    int numberOfFeatures = 0;
+
+
+    /// <summary>
+    /// Display an error message if a CUDA call failed.
+    /// </summary>
+    /// <param name="status">The cudaError_t the call returned</param>
+    /// <param name="callName">The name of the call</param>
+    /// <returns>True if the call succeeded</returns>
+    static const bool Check(int status, string callName);
+
+    /// <summary>
+    /// Free the device memory and set their pointers to NULL.
+    /// </summary>
+    const void FreeMemory();
+
+
+public:
+    /// <summary>
+    /// The constructor uploads the columns, the weights, and the statuses of a feature matrix once. The feature matrix isn't
+    /// needed afterwards.
+    /// </summary>
+    /// <param name="features">The feature matrix of the line samples with known statuses</param>
+    explicit gpuFeatureMatrix(const lineFeatureMatrix* features);
+
+    /// <summary>
+    /// The deconstructor frees the device memory
+    /// </summary>
+    ~gpuFeatureMatrix();
+
+
+    /// <summary>
+    /// True if the feature matrix was uploaded
+    /// </summary>
+    const bool IsUploaded() const;
+    /// <summary>
+    /// The largest number of nearest neighbors NearestNeighbors() selects
+    /// </summary>
+    static const int MaximumNumberOfNearestNeighbors();
+    /// <summary>
+    /// The name of the device the feature matrices are uploaded to
+    /// </summary>
+    /// <returns>The device name (empty if there is no CUDA device)</returns>
+    static const string DeviceName();
+    /// <summary>
+    /// Find the k nearest known line samples of each unknown line sample on the device. Ties are broken by the known line sample
+    /// index like nearestNeighborHeap.
+    /// </summary>
+    /// <param name="realParts">The real parts of the features of every unknown line sample (numberOfFeatures per line sample)</param>
+    /// <param name="imaginaryParts">The imaginary parts of the features of every unknown line sample</param>
+    /// <param name="numberOfUnknownSamples">The number of unknown line samples</param>
+    /// <param name="numberOfNearestNeighbors">The number of nearest neighbors (at most MaximumNumberOfNearestNeighbors())</param>
+    /// <param name="nearestNeighbors">
+    /// The array of numberOfUnknownSamples * numberOfNearestNeighbors neighbors to fill, closest first for each line sample</param>
+    /// <returns>True if every launch succeeded</returns>
+    const bool NearestNeighbors(const double* realParts, const double* imaginaryParts, int numberOfUnknownSamples,
+        int numberOfNearestNeighbors, nearestNeighbor* nearestNeighbors);
+};
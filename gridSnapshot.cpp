@@ -0,0 +1,273 @@
+#define _USE_MATH_DEFINES
+
+using namespace std;
+
+#include <cmath>
+#include <exception>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "phasor.h"
+#include "parameter.h"
+#include "nodeSample.h"
+#include "topologyHash.h"
+#include "gridSnapshot.h"
+
+
+const int gridSnapshot::LineCurrentIndex(int nodeIndex, int destinationNodeNumber) const
+{
+    for (int currentIndex = currentOffsets[nodeIndex]; currentIndex < currentOffsets[nodeIndex + 1]; currentIndex++) {
+        if (currentDestinationNodeNumbers[currentIndex] == destinationNodeNumber) return currentIndex;
+    }
+    return -1;
+}
+const bool gridSnapshot::FindLine(int node1Number, int node2Number, int* node1Index, int* node2Index) const
+{
+    auto node1 = nodeIndices.find(node1Number);
+    auto node2 = nodeIndices.find(node2Number);
+    if ((node1 == nodeIndices.end()) || (node2 == nodeIndices.end())) return false;
+
+    *node1Index = node1->second;
+    *node2Index = node2->second;
+    if (LineCurrentIndex(*node1Index, node2Number) < 0) return false;
+    if (LineCurrentIndex(*node2Index, node1Number) < 0) return false;
+    return true;
+}
+
+
+const void gridSnapshot::FreeMemory()
+{
+    if (nodeNumbers != NULL) {
+        delete[] nodeNumbers;
+        nodeNumbers = NULL;
+    }
+    if (voltageStartNodeNumbers != NULL) {
+        delete[] voltageStartNodeNumbers;
+        voltageStartNodeNumbers = NULL;
+    }
+    if (voltageRealParts != NULL) {
+        delete[] voltageRealParts;
+        voltageRealParts = NULL;
+    }
+    if (voltageImaginaryParts != NULL) {
+        delete[] voltageImaginaryParts;
+        voltageImaginaryParts = NULL;
+    }
+    if (currentOffsets != NULL) {
+        delete[] currentOffsets;
+        currentOffsets = NULL;
+    }
+    if (currentStartNodeNumbers != NULL) {
+        delete[] currentStartNodeNumbers;
+        currentStartNodeNumbers = NULL;
+    }
+    if (currentDestinationNodeNumbers != NULL) {
+        delete[] currentDestinationNodeNumbers;
+        currentDestinationNodeNumbers = NULL;
+    }
+    if (currentRealParts != NULL) {
+        delete[] currentRealParts;
+        currentRealParts = NULL;
+    }
+    if (currentImaginaryParts != NULL) {
+        delete[] currentImaginaryParts;
+        currentImaginaryParts = NULL;
+    }
+    nodeIndices.clear();
+    lineNode1Numbers.clear();
+    lineNode2Numbers.clear();
+    numberOfNodes = 0;
+}
+
+const void gridSnapshot::MemoryAllocationFailure(string variableName)
+{
+    cout << "Error: gridSnapshot() failed to allocate memory for " << variableName << "\n";
+    FreeMemory();
+}
+
+
+
+gridSnapshot::gridSnapshot(shared_ptr<nodeSample>* nodes, int numberOfNodes)
+{
+    if ((nodes == NULL) || (numberOfNodes <= 0)) {
+        cout << "Error: gridSnapshot() needs at least one node.\n";
+        return;
+    }
+    int numberOfCurrents = 0;
+    for (int nodeIndex = 0; nodeIndex < numberOfNodes; nodeIndex++) {
+        if ((nodes[nodeIndex] == NULL) || (nodes[nodeIndex]->Voltage == NULL)) {
+            cout << "Error: gridSnapshot(): nodes[" << to_string(nodeIndex) << "] is NULL or has no voltage.\n";
+            return;
+        }
+        numberOfCurrents += nodes[nodeIndex]->NumberOfCurrents;
+    }
+
+    nodeNumbers = new int[numberOfNodes];
+    if (nodeNumbers == NULL) {
+        MemoryAllocationFailure("nodeNumbers");
+        return;
+    }
+    voltageStartNodeNumbers = new int[numberOfNodes];
+    if (voltageStartNodeNumbers == NULL) {
+        MemoryAllocationFailure("voltageStartNodeNumbers");
+        return;
+    }
+    voltageRealParts = new double[numberOfNodes];
+    if (voltageRealParts == NULL) {
+        MemoryAllocationFailure("voltageRealParts");
+        return;
+    }
+    voltageImaginaryParts = new double[numberOfNodes];
+    if (voltageImaginaryParts == NULL) {
+        MemoryAllocationFailure("voltageImaginaryParts");
+        return;
+    }
+    currentOffsets = new int[numberOfNodes + 1];
+    if (currentOffsets == NULL) {
+        MemoryAllocationFailure("currentOffsets");
+        return;
+    }
+    currentStartNodeNumbers = new int[numberOfCurrents];
+    if (currentStartNodeNumbers == NULL) {
+        MemoryAllocationFailure("currentStartNodeNumbers");
+        return;
+    }
+    currentDestinationNodeNumbers = new int[numberOfCurrents];
+    if (currentDestinationNodeNumbers == NULL) {
+        MemoryAllocationFailure("currentDestinationNodeNumbers");
+        return;
+    }
+    currentRealParts = new double[numberOfCurrents];
+    if (currentRealParts == NULL) {
+        MemoryAllocationFailure("currentRealParts");
+        return;
+    }
+    currentImaginaryParts = new double[numberOfCurrents];
+    if (currentImaginaryParts == NULL) {
+        MemoryAllocationFailure("currentImaginaryParts");
+        return;
+    }
+
+    // Normalize every node once with the same phasor division lineSample uses
+    currentOffsets[0] = 0;
+    for (int nodeIndex = 0; nodeIndex < numberOfNodes; nodeIndex++) {
+        nodeSample* node = nodes[nodeIndex].get();
+        nodeNumbers[nodeIndex] = node->NodeNumber;
+        nodeIndices[node->NodeNumber] = nodeIndex;
+
+        phasor voltage = node->Voltage->Phasor / phasor(node->RatedVoltage, 0);
+        voltageStartNodeNumbers[nodeIndex] = node->Voltage->StartNodeNumber;
+        voltageRealParts[nodeIndex] = voltage.RealPart();
+        voltageImaginaryParts[nodeIndex] = voltage.ImaginaryPart();
+
+        int firstCurrentIndex = currentOffsets[nodeIndex];
+        for (int currentIndex = 0; currentIndex < node->NumberOfCurrents; currentIndex++) {
+            phasor current = node->Currents[currentIndex]->Phasor / phasor(node->RatedCurrent, 0);
+            currentStartNodeNumbers[firstCurrentIndex + currentIndex] = node->Currents[currentIndex]->StartNodeNumber;
+            currentDestinationNodeNumbers[firstCurrentIndex + currentIndex] = node->Currents[currentIndex]->DestinationNodeNumber;
+            currentRealParts[firstCurrentIndex + currentIndex] = current.RealPart();
+            currentImaginaryParts[firstCurrentIndex + currentIndex] = current.ImaginaryPart();
+        }
+        currentOffsets[nodeIndex + 1] = firstCurrentIndex + node->NumberOfCurrents;
+    }
+    this->numberOfNodes = numberOfNodes;
+
+    // A line is a pair of nodes with currents flowing to each other
+    for (int nodeIndex = 0; nodeIndex < numberOfNodes; nodeIndex++) {
+        for (int currentIndex = currentOffsets[nodeIndex]; currentIndex < currentOffsets[nodeIndex + 1]; currentIndex++) {
+            int destinationNodeNumber = currentDestinationNodeNumbers[currentIndex];
+            if (destinationNodeNumber <= nodeNumbers[nodeIndex]) continue;
+            int node1Index = 0;
+            int node2Index = 0;
+            if (FindLine(nodeNumbers[nodeIndex], destinationNodeNumber, &node1Index, &node2Index) == false) continue;
+            lineNode1Numbers.push_back(nodeNumbers[nodeIndex]);
+            lineNode2Numbers.push_back(destinationNodeNumber);
+        }
+    }
+}
+
+gridSnapshot::~gridSnapshot()
+{
+    FreeMemory();
+}
+
+
+const int gridSnapshot::NumberOfNodes() const
+{
+    return numberOfNodes;
+}
+const int gridSnapshot::NumberOfLines() const
+{
+    return (int)lineNode1Numbers.size();
+}
+const int gridSnapshot::Node1Number(int lineIndex) const
+{
+    return lineNode1Numbers[lineIndex];
+}
+const int gridSnapshot::Node2Number(int lineIndex) const
+{
+    return lineNode2Numbers[lineIndex];
+}
+
+const size_t gridSnapshot::LineTopologyKey(int node1Number, int node2Number) const
+{
+    int node1Index = 0;
+    int node2Index = 0;
+    if (FindLine(node1Number, node2Number, &node1Index, &node2Index) == false) return 0;
+    int node1LineCurrentIndex = LineCurrentIndex(node1Index, node2Number);
+    int node2LineCurrentIndex = LineCurrentIndex(node2Index, node1Number);
+
+    // The same sequence of node numbers as lineSample::SetTopologyKey()
+    topologyHash hash;
+    hash.Add(currentStartNodeNumbers[node1LineCurrentIndex]);
+    hash.Add(currentDestinationNodeNumbers[node1LineCurrentIndex]);
+    hash.Add(currentStartNodeNumbers[node2LineCurrentIndex]);
+    hash.Add(currentDestinationNodeNumbers[node2LineCurrentIndex]);
+    hash.Add(voltageStartNodeNumbers[node1Index]);
+    hash.Add(voltageStartNodeNumbers[node2Index]);
+    hash.Add(currentOffsets[node1Index + 1] - currentOffsets[node1Index] - 1);
+    for (int currentIndex = currentOffsets[node1Index]; currentIndex < currentOffsets[node1Index + 1]; currentIndex++) {
+        if (currentIndex == node1LineCurrentIndex) continue;
+        hash.Add(currentStartNodeNumbers[currentIndex]);
+        hash.Add(currentDestinationNodeNumbers[currentIndex]);
+    }
+    hash.Add(currentOffsets[node2Index + 1] - currentOffsets[node2Index] - 1);
+    for (int currentIndex = currentOffsets[node2Index]; currentIndex < currentOffsets[node2Index + 1]; currentIndex++) {
+        if (currentIndex == node2LineCurrentIndex) continue;
+        hash.Add(currentStartNodeNumbers[currentIndex]);
+        hash.Add(currentDestinationNodeNumbers[currentIndex]);
+    }
+    return hash.Key();
+}
+const void gridSnapshot::ExtractLineFeatures(int node1Number, int node2Number, double* realParts, double* imaginaryParts) const
+{
+    int node1Index = nodeIndices.at(node1Number);
+    int node2Index = nodeIndices.at(node2Number);
+    int node1LineCurrentIndex = LineCurrentIndex(node1Index, node2Number);
+    int node2LineCurrentIndex = LineCurrentIndex(node2Index, node1Number);
+
+    realParts[0] = currentRealParts[node1LineCurrentIndex];
+    imaginaryParts[0] = currentImaginaryParts[node1LineCurrentIndex];
+    realParts[1] = currentRealParts[node2LineCurrentIndex];
+    imaginaryParts[1] = currentImaginaryParts[node2LineCurrentIndex];
+    realParts[2] = voltageRealParts[node1Index];
+    imaginaryParts[2] = voltageImaginaryParts[node1Index];
+    realParts[3] = voltageRealParts[node2Index];
+    imaginaryParts[3] = voltageImaginaryParts[node2Index];
+
+    int featureIndex = 4;
+    for (int currentIndex = currentOffsets[node1Index]; currentIndex < currentOffsets[node1Index + 1]; currentIndex++) {
+        if (currentIndex == node1LineCurrentIndex) continue;
+        realParts[featureIndex] = currentRealParts[currentIndex];
+        imaginaryParts[featureIndex] = currentImaginaryParts[currentIndex];
+        featureIndex++;
+    }
+    for (int currentIndex = currentOffsets[node2Index]; currentIndex < currentOffsets[node2Index + 1]; currentIndex++) {
+        if (currentIndex == node2LineCurrentIndex) continue;
+        realParts[featureIndex] = currentRealParts[currentIndex];
+        imaginaryParts[featureIndex] = currentImaginaryParts[currentIndex];
+        featureIndex++;
+    }
+}
\ No newline at end of file
@@ -0,0 +1,159 @@
+#pragma once
+
+#define _USE_MATH_DEFINES
+
+using namespace std;
+
+#include <cmath>
+#include <exception>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "phasor.h"
+#include "parameter.h"
+#include "nodeSample.h"
+#include "topologyHash.h"
+
+
+/// <summary>
+/// The normalized voltages and currents of every node of the grid at one point in time. Each node is normalized once and every
+/// line between two nodes of the snapshot reads its features from the nodes without building a lineSample, so the memory of a
+/// snapshot scales with the number of nodes and currents instead of the number of lines times their currents.
+/// </summary>
+class gridSnapshot {
+private:
+    /// <summary>
+    /// The number of nodes in the snapshot
+    /// </summary>
+    int numberOfNodes = 0;
+    /// <summary>
+    /// The node number of each node
+    /// </summary>
+    int* nodeNumbers = NULL;
+    /// <summary>
+    /// The starting node number of each node's voltage parameter
+    /// </summary>
+    int* voltageStartNodeNumbers = NULL;
+    /// <summary>
+    /// The real part of each node's normalized voltage
+    /// </summary>
+    double* voltageRealParts = NULL;
+    /// <summary>
+    /// The imaginary part of each node's normalized voltage
+    /// </summary>
+    double* voltageImaginaryParts = NULL;
+    /// <summary>
+    /// The index of the first current of each node in the current arrays (numberOfNodes + 1 elements)
+    /// </summary>
+    int* currentOffsets = NULL;
+    /// <summary>
+    /// The starting node number of every current
+    /// </summary>
+    int* currentStartNodeNumbers = NULL;
+    /// <summary>
+    /// The destination node number of every current
+    /// </summary>
+    int* currentDestinationNodeNumbers = NULL;
+    /// <summary>
+    /// The real part of every normalized current
+    /// </summary>
+    double* currentRealParts = NULL;
+    /// <summary>
+    /// The imaginary part of every normalized current
+    /// </summary>
+    double* currentImaginaryParts = NULL;
+    /// <summary>
+    /// The index of each node keyed by its node number
+    /// </summary>
+    unordered_map<int, int> nodeIndices;
+    /// <summary>
+    /// The first node number of each line found between the nodes
+    /// </summary>
+    vector<int> lineNode1Numbers;
+    /// <summary>
+    /// The second node number of each line found between the nodes
+    /// </summary>
+    vector<int> lineNode2Numbers;
+
+
+    /// <summary>
+    /// Find the current of a node flowing to another node, the way lineSample finds its line currents.
+    /// </summary>
+    /// <param name="nodeIndex">The index of the node the current flows from</param>
+    /// <param name="destinationNodeNumber">The number of the node the current flows to</param>
+    /// <returns>The index of the current in the current arrays (-1 if there is none)</returns>
+    const int LineCurrentIndex(int nodeIndex, int destinationNodeNumber) const;
+    /// <summary>
+    /// Find the indices of both nodes of a line.
+    /// </summary>
+    /// <param name="node1Number">The number of the first node of the line</param>
+    /// <param name="node2Number">The number of the second node of the line</param>
+    /// <param name="node1Index">The index of the first node</param>
+    /// <param name="node2Index">The index of the second node</param>
+    /// <returns>True if both nodes are in the snapshot and have a current flowing to each other</returns>
+    const bool FindLine(int node1Number, int node2Number, int* node1Index, int* node2Index) const;
+
+    /// <summary>
+    /// Free the dynamically allocated memory and set their pointers to NULL. Notice that the nodes aren't freed.
+    /// </summary>
+    const void FreeMemory();
+
+    /// <summary>
+    /// Display an error message and call FreeMemory().
+    /// </summary>
+    /// <param=variableName>The name of the variable that failed to get memory allocation</param>
+    const void MemoryAllocationFailure(string variableName);
+
+
+public:
+    /// <summary>
+    /// The constructor normalizes the voltage and currents of every node once. The nodes can be freed afterwards.
+    /// </summary>
+    /// <param name="nodes">The array of the nodes of the grid</param>
+    /// <param name="numberOfNodes">The number of elements in the nodes array</param>
+    explicit gridSnapshot(shared_ptr<nodeSample>* nodes, int numberOfNodes);
+
+    /// <summary>
+    /// The deconstructor
+    /// </summary>
+    ~gridSnapshot();
+
+
+    /// <summary>
+    /// The number of nodes in the snapshot
+    /// </summary>
+    const int NumberOfNodes() const;
+    /// <summary>
+    /// The number of lines found between the nodes of the snapshot (each line once with the lower node number first)
+    /// </summary>
+    const int NumberOfLines() const;
+    /// <summary>
+    /// The first node number of a line
+    /// </summary>
+    /// <param name="lineIndex">The index of the line between 0 and NumberOfLines() - 1</param>
+    const int Node1Number(int lineIndex) const;
+    /// <summary>
+    /// The second node number of a line
+    /// </summary>
+    /// <param name="lineIndex">The index of the line between 0 and NumberOfLines() - 1</param>
+    const int Node2Number(int lineIndex) const;
+
+    /// <summary>
+    /// The topology key a lineSample between the two nodes would have (see lineSample::TopologyKey()).
+    /// </summary>
+    /// <param name="node1Number">The number of the first node of the line</param>
+    /// <param name="node2Number">The number of the second node of the line</param>
+    /// <returns>The topology key (0 if the line isn't in the snapshot)</returns>
+    const size_t LineTopologyKey(int node1Number, int node2Number) const;
+    /// <summary>
+    /// Copy the normalized phasors of a line in the feature order of lineFeatureMatrix. This method assumes the line was checked
+    /// with LineTopologyKey() beforehand.
+    /// </summary>
+    /// <param name="node1Number">The number of the first node of the line</param>
+    /// <param name="node2Number">The number of the second node of the line</param>
+    /// <param name="realParts">The array of real parts to fill</param>
+    /// <param name="imaginaryParts">The array of imaginary parts to fill</param>
+    const void ExtractLineFeatures(int node1Number, int node2Number, double* realParts, double* imaginaryParts) const;
+};
\ No newline at end of file
@@ -0,0 +1,337 @@
+#define _USE_MATH_DEFINES
+
+using namespace std;
+
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <condition_variable>
+#include <exception>
+#include <functional>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+#include "phasor.h"
+#include "instantaneousMeasurement.h"
+#include "waveform.h"
+#include "parameter.h"
+#include "nodeSample.h"
+#include "lineSample.h"
+#include "distanceWeights.h"
+#include "lineFeatureMatrix.h"
+#include "distanceKernel.h"
+#include "nearestNeighbor.h"
+#include "nearestNeighborHeap.h"
+#include "nearestNeighborIndex.h"
+#include "threadPool.h"
+#include "gridSnapshot.h"
+#include "lineModelRegistry.h"
+#include "knnQueryScratch.h"
+#include "knnPredictionResult.h"
+#include "knnQueryEngine.h"
+#include "latencyHistogram.h"
+#include "nodeCapture.h"
+#include "pipelineItem.h"
+#include "boundedQueue.h"
+#include "ingestPipeline.h"
+
+
+const void ingestPipeline::WorkerLoop(pipelineStage stage)
+{
+    int stageIndex = (int)stage;
+    vector<pipelineItem*> batch(batchSize);
+
+    int numberOfItems = 0;
+    while ((numberOfItems = stageQueues[stageIndex]->PopBatch(batch.data(), batchSize)) > 0) {
+        for (int batchIndex = 0; batchIndex < numberOfItems; batchIndex++) {
+            pipelineItem* item = batch[batchIndex];
+
+            // A failed item is passed on untouched so every item reaches the callback on a prediction worker
+            if (item->IsFailed == false) {
+                if (stage == pipelineStage::PhasorEstimation) item->IsFailed = !EstimatePhasors(item);
+                else if (stage == pipelineStage::LineAssembly) item->IsFailed = !AssembleLine(item);
+                else item->IsFailed = !Predict(item);
+            }
+            if (stageIndex + 1 < numberOfStages) stageQueues[stageIndex + 1]->Push(item);
+            else Complete(item);
+        }
+    }
+
+    // Every item of this stage was pushed on once its last worker is done, so the next stage can drain and stop
+    if ((numberOfRunningWorkers[stageIndex].fetch_sub(1) == 1) && (stageIndex + 1 < numberOfStages)) {
+        stageQueues[stageIndex + 1]->Close();
+    }
+}
+const bool ingestPipeline::EstimatePhasors(pipelineItem* item) const
+{
+    if ((item->Node1Capture == NULL) || (item->Node2Capture == NULL)) return false;
+    item->Node1 = item->Node1Capture->EstimateNode();
+    item->Node2 = item->Node2Capture->EstimateNode();
+    return (item->Node1 != NULL) && (item->Node2 != NULL);
+}
+const bool ingestPipeline::AssembleLine(pipelineItem* item) const
+{
+    item->Sample = new lineSample(item->Node1, item->Node2, true);
+    if (item->Sample == NULL) return false;
+    return item->Sample->TopologyKey() != 0;
+}
+const bool ingestPipeline::Predict(pipelineItem* item) const
+{
+    const lineFeatureMatrix* knownFeatures = registry->Features(item->Sample->Node1LineCurrentNorm->StartNodeNumber,
+        item->Sample->Node1LineCurrentNorm->DestinationNodeNumber);
+    if ((knownFeatures == NULL) || (knownFeatures->IsSampleOfTheSameLine(item->Sample) == false)) return false;
+
+    // The engine only holds pointers, and each prediction worker scores into its own thread local scratch space
+    const knnQueryEngine engine(knownFeatures, registry->NumberOfNearestNeighbors());
+    return engine.PredictStatus(item->Sample, &item->PredictedStatus);
+}
+const int ingestPipeline::SourceOf(const nodeCapture* node1Capture)
+{
+    if (node1Capture == NULL) return 0;
+    return node1Capture->NodeNumber;
+}
+const bool ingestPipeline::Admit(int source, bool isWaiting)
+{
+    unique_lock<mutex> lock(admissionMutex);
+    if (isWaiting == true) {
+        admissionChanged.wait(lock, [&]() {
+            return (isFinished.load() == true) || (inFlightPerSource[source] < maximumInFlightPerSource);
+        });
+    }
+    if ((isFinished.load() == true) || (inFlightPerSource[source] >= maximumInFlightPerSource)) {
+        if (inFlightPerSource[source] == 0) inFlightPerSource.erase(source);
+        return false;
+    }
+    inFlightPerSource[source]++;
+    numberOfSubmissions++;
+    return true;
+}
+const void ingestPipeline::EndSubmission()
+{
+    {
+        lock_guard<mutex> lock(admissionMutex);
+        numberOfSubmissions--;
+    }
+    admissionChanged.notify_all();
+}
+const void ingestPipeline::Release(int source)
+{
+    {
+        lock_guard<mutex> lock(admissionMutex);
+        if (--inFlightPerSource[source] <= 0) inFlightPerSource.erase(source);
+    }
+    admissionChanged.notify_all();
+}
+const void ingestPipeline::Complete(pipelineItem* item)
+{
+    item->LatencyNanoseconds = chrono::duration_cast<chrono::nanoseconds>(chrono::steady_clock::now() - item->SubmitTime).count();
+    {
+        lock_guard<mutex> lock(statisticsMutex);
+        latencies.Record(item->LatencyNanoseconds);
+        if (item->IsFailed == false) numberOfPredictions++;
+        else numberOfFailures++;
+    }
+
+    // The source gets its place back before the callback so a feed waiting on its own prediction can submit right away
+    Release(SourceOf(item->Node1Capture));
+    if (onPrediction) onPrediction(item);
+    delete item;
+}
+
+
+const void ingestPipeline::FreeMemory()
+{
+    for (int stageIndex = 0; stageIndex < numberOfStages; stageIndex++) {
+        if (stageQueues[stageIndex] != NULL) {
+            // Only items of a pipeline that never started its workers can be left in a queue
+            pipelineItem* item = NULL;
+            while (stageQueues[stageIndex]->TryPop(&item) == true) delete item;
+            delete stageQueues[stageIndex];
+            stageQueues[stageIndex] = NULL;
+        }
+    }
+}
+
+const void ingestPipeline::MemoryAllocationFailure(string variableName)
+{
+    cout << "Error: ingestPipeline() failed to allocate memory for " << variableName << "\n";
+    FreeMemory();
+}
+
+
+
+ingestPipeline::ingestPipeline(const lineModelRegistry* registry, const function<void(const pipelineItem*)>& onPrediction,
+    int queueCapacity, int numberOfEstimationWorkers, int numberOfAssemblyWorkers, int numberOfPredictionWorkers, int batchSize,
+    int maximumInFlightPerSource)
+{
+    this->registry = registry;
+    this->onPrediction = onPrediction;
+    if (batchSize > 0) this->batchSize = batchSize;
+    this->maximumInFlightPerSource = (maximumInFlightPerSource > 0) ? maximumInFlightPerSource : queueCapacity / 4;
+    if (this->maximumInFlightPerSource < 1) this->maximumInFlightPerSource = 1;
+    nextSequence.store(0);
+    numberOfRejectedCaptures.store(0);
+    isFinished.store(false);
+
+    if (registry == NULL) {
+        cout << "Error: ingestPipeline() needs a registry of line models.\n";
+        isFinished.store(true);
+        return;
+    }
+    for (int stageIndex = 0; stageIndex < numberOfStages; stageIndex++) {
+        stageQueues[stageIndex] = new boundedQueue<pipelineItem*>(queueCapacity);
+        if ((stageQueues[stageIndex] == NULL) || (stageQueues[stageIndex]->Capacity() == 0)) {
+            MemoryAllocationFailure("stageQueues[" + to_string(stageIndex) + "]");
+            isFinished.store(true);
+            return;
+        }
+    }
+
+    int numberOfWorkers[numberOfStages] = { numberOfEstimationWorkers, numberOfAssemblyWorkers, numberOfPredictionWorkers };
+    for (int stageIndex = 0; stageIndex < numberOfStages; stageIndex++) {
+        if (numberOfWorkers[stageIndex] < 1) numberOfWorkers[stageIndex] = 1;
+        numberOfRunningWorkers[stageIndex].store(numberOfWorkers[stageIndex]);
+    }
+    for (int stageIndex = 0; stageIndex < numberOfStages; stageIndex++) {
+        for (int workerIndex = 0; workerIndex < numberOfWorkers[stageIndex]; workerIndex++) {
+            workers.push_back(thread(&ingestPipeline::WorkerLoop, this, (pipelineStage)stageIndex));
+        }
+    }
+}
+
+ingestPipeline::~ingestPipeline()
+{
+    Finish();
+    FreeMemory();
+}
+
+
+const string ingestPipeline::StageName(pipelineStage stage)
+{
+    if (stage == pipelineStage::PhasorEstimation) return "phasorEstimation";
+    if (stage == pipelineStage::LineAssembly) return "lineAssembly";
+    return "prediction";
+}
+const bool ingestPipeline::Submit(nodeCapture* node1Capture, nodeCapture* node2Capture)
+{
+    if (isFinished.load() == true) return false;
+    int source = SourceOf(node1Capture);
+    if (Admit(source, true) == false) return false;
+
+    pipelineItem* item = new pipelineItem(nextSequence.fetch_add(1), node1Capture, node2Capture);
+    if (item == NULL) {
+        cout << "Error: ingestPipeline::Submit() failed to allocate memory for item\n";
+        Release(source);
+        EndSubmission();
+        return false;
+    }
+    if (stageQueues[0]->Push(item) == true) {
+        EndSubmission();
+        return true;
+    }
+
+    // The captures stay the caller's
+    Release(source);
+    EndSubmission();
+    item->Node1Capture = NULL;
+    item->Node2Capture = NULL;
+    delete item;
+    return false;
+}
+const bool ingestPipeline::TrySubmit(nodeCapture* node1Capture, nodeCapture* node2Capture)
+{
+    if (isFinished.load() == true) return false;
+    int source = SourceOf(node1Capture);
+    if (Admit(source, false) == false) {
+        if (isFinished.load() == false) numberOfRejectedCaptures.fetch_add(1);
+        return false;
+    }
+
+    pipelineItem* item = new pipelineItem(nextSequence.fetch_add(1), node1Capture, node2Capture);
+    if (item == NULL) {
+        cout << "Error: ingestPipeline::TrySubmit() failed to allocate memory for item\n";
+        Release(source);
+        EndSubmission();
+        return false;
+    }
+    if (stageQueues[0]->TryPush(item) == true) {
+        EndSubmission();
+        return true;
+    }
+
+    Release(source);
+    EndSubmission();
+    numberOfRejectedCaptures.fetch_add(1);
+    item->Node1Capture = NULL;
+    item->Node2Capture = NULL;
+    delete item;
+    return false;
+}
+const void ingestPipeline::Finish()
+{
+    if (isFinished.exchange(true) == false) {
+        // A submission admitted before isFinished was set still pushes its item, so the first queue closes once none are left.
+        // Submissions waiting in Admit() see isFinished once they're woken and give up.
+        unique_lock<mutex> lock(admissionMutex);
+        admissionChanged.notify_all();
+        admissionChanged.wait(lock, [&]() { return numberOfSubmissions == 0; });
+        lock.unlock();
+        stageQueues[0]->Close();
+    }
+    for (int workerIndex = 0; workerIndex < (int)workers.size(); workerIndex++) {
+        if (workers[workerIndex].joinable() == true) workers[workerIndex].join();
+    }
+    workers.clear();
+}
+
+const int ingestPipeline::QueueDepth(pipelineStage stage) const
+{
+    if (stageQueues[(int)stage] == NULL) return 0;
+    return (int)stageQueues[(int)stage]->Size();
+}
+const int ingestPipeline::MaximumQueueDepth(pipelineStage stage) const
+{
+    if (stageQueues[(int)stage] == NULL) return 0;
+    return (int)stageQueues[(int)stage]->MaximumSize();
+}
+const long long ingestPipeline::NumberOfPredictions() const
+{
+    lock_guard<mutex> lock(statisticsMutex);
+    return numberOfPredictions;
+}
+const long long ingestPipeline::NumberOfFailures() const
+{
+    lock_guard<mutex> lock(statisticsMutex);
+    return numberOfFailures;
+}
+const long long ingestPipeline::NumberOfRejectedCaptures() const
+{
+    return numberOfRejectedCaptures.load();
+}
+const int ingestPipeline::MaximumInFlightPerSource() const
+{
+    return maximumInFlightPerSource;
+}
+const latencyHistogram ingestPipeline::Latencies() const
+{
+    lock_guard<mutex> lock(statisticsMutex);
+    return latencies;
+}
+
+const void ingestPipeline::PrintStatistics() const
+{
+    latencyHistogram endToEndLatencies = Latencies();
+    cout << "End to end: " << to_string(endToEndLatencies.Count) << " items, p50 " << to_string(endToEndLatencies.Percentile(50)) <<
+        " ns, p99 " << to_string(endToEndLatencies.Percentile(99)) << " ns, max " << to_string(endToEndLatencies.MaximumNanoseconds) <<
+        " ns\n";
+    cout << "Predicted: " << to_string(NumberOfPredictions()) << ", failed: " << to_string(NumberOfFailures()) << ", rejected: " <<
+        to_string(NumberOfRejectedCaptures()) << "\n";
+    for (int stageIndex = 0; stageIndex < numberOfStages; stageIndex++) {
+        cout << StageName((pipelineStage)stageIndex) << " queue: depth " << to_string(QueueDepth((pipelineStage)stageIndex)) <<
+            ", maximum depth " << to_string(MaximumQueueDepth((pipelineStage)stageIndex)) << "\n";
+    }
+}
\ No newline at end of file
@@ -0,0 +1,304 @@
+#pragma once
+
+#define _USE_MATH_DEFINES
+
+using namespace std;
+
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <condition_variable>
+#include <exception>
+#include <functional>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+#include "phasor.h"
+#include "instantaneousMeasurement.h"
+#include "waveform.h"
+#include "parameter.h"
+#include "nodeSample.h"
+#include "lineSample.h"
+#include "distanceWeights.h"
+#include "lineFeatureMatrix.h"
+#include "distanceKernel.h"
+#include "nearestNeighbor.h"
+#include "nearestNeighborHeap.h"
+#include "nearestNeighborIndex.h"
+#include "threadPool.h"
+#include "gridSnapshot.h"
+#include "lineModelRegistry.h"
+#include "knnQueryScratch.h"
+#include "knnPredictionResult.h"
+#include "knnQueryEngine.h"
+#include "latencyHistogram.h"
+#include "nodeCapture.h"
+#include "pipelineItem.h"
+#include "boundedQueue.h"
+
+
+/// <summary>
+/// The stages of ingestPipeline in the order a capture goes through them
+/// </summary>
+enum class pipelineStage {
+    /// <summary>
+    /// Estimating the phasor of every waveform of both nodes and building the nodes
+    /// </summary>
+    PhasorEstimation,
+    /// <summary>
+    /// Normalizing the nodes into a line sample
+    /// </summary>
+    LineAssembly,
+    /// <summary>
+    /// Predicting the line status with the model of the line in the registry
+    /// </summary>
+    Prediction
+};
+
+
+/// <summary>
+/// An asynchronous pipeline from the waveforms captured at the two nodes of a line to its predicted status. Each stage runs on its
+/// own worker threads and takes batches of items from a bounded lock-free queue filled by the stage before it, so a slow stage
+/// fills its queue and pushes back on the stages before it instead of growing without bound. Every source (the substation at the
+/// first node of a capture) can only have a limited number of captures in the pipeline at once: Submit() waits and TrySubmit()
+/// refuses a capture while its source is at the limit or the first queue is full. A bursting substation therefore sheds or waits
+/// on its own captures while the other substations keep being admitted, as long as the sources at their limit together leave room
+/// in the queues, since every source still shares them.
+/// </summary>
+class ingestPipeline {
+private:
+    /// <summary>
+    /// The number of stages
+    /// </summary>
+    static const int numberOfStages = 3;
+    /// <summary>
+    /// The models of the lines. It must not change while the pipeline runs.
+    /// </summary>
+    const lineModelRegistry* registry = NULL;
+    /// <summary>
+    /// Called with every finished item on a prediction worker
+    /// </summary>
+    function<void(const pipelineItem*)> onPrediction;
+    /// <summary>
+    /// The largest number of items a worker takes from its queue at once
+    /// </summary>
+    int batchSize = 16;
+    /// <summary>
+    /// The largest number of captures of one source in the pipeline at once
+    /// </summary>
+    int maximumInFlightPerSource = 1;
+    /// <summary>
+    /// The queue feeding each stage
+    /// </summary>
+    boundedQueue<pipelineItem*>* stageQueues[numberOfStages] = {};
+    /// <summary>
+    /// The number of workers of each stage still running (the last one to finish closes the queue of the next stage)
+    /// </summary>
+    atomic<int> numberOfRunningWorkers[numberOfStages];
+    /// <summary>
+    /// The worker threads of every stage
+    /// </summary>
+    vector<thread> workers;
+    /// <summary>
+    /// The sequence of the next capture submitted
+    /// </summary>
+    atomic<long long> nextSequence;
+    /// <summary>
+    /// The number of captures TrySubmit() refused because their source was at its limit or the first queue was full
+    /// </summary>
+    atomic<long long> numberOfRejectedCaptures;
+    /// <summary>
+    /// Guards inFlightPerSource and numberOfSubmissions
+    /// </summary>
+    mutex admissionMutex;
+    /// <summary>
+    /// Signaled when a capture leaves the pipeline, a submission ends, or Finish() is called
+    /// </summary>
+    condition_variable admissionChanged;
+    /// <summary>
+    /// The number of Submit() and TrySubmit() calls admitted but not done pushing their item, which Finish() waits for before it
+    /// closes the first queue
+    /// </summary>
+    int numberOfSubmissions = 0;
+    /// <summary>
+    /// The number of captures of each source in the pipeline (sources without any are removed)
+    /// </summary>
+    unordered_map<int, int> inFlightPerSource;
+    /// <summary>
+    /// True once Finish() closed the first queue
+    /// </summary>
+    atomic<bool> isFinished;
+    /// <summary>
+    /// Guards every member below it
+    /// </summary>
+    mutable mutex statisticsMutex;
+    /// <summary>
+    /// The time from submission to prediction of every finished item
+    /// </summary>
+    latencyHistogram latencies;
+    /// <summary>
+    /// The number of items predicted
+    /// </summary>
+    long long numberOfPredictions = 0;
+    /// <summary>
+    /// The number of items a stage failed on
+    /// </summary>
+    long long numberOfFailures = 0;
+
+
+    /// <summary>
+    /// The loop each worker runs until the queue of its stage is closed and empty
+    /// </summary>
+    /// <param name="stage">The stage of the worker</param>
+    const void WorkerLoop(pipelineStage stage);
+    /// <summary>
+    /// Estimate the nodes of an item from its captures.
+    /// </summary>
+    /// <param name="item">The item</param>
+    /// <returns>True if both nodes were built</returns>
+    const bool EstimatePhasors(pipelineItem* item) const;
+    /// <summary>
+    /// Normalize the nodes of an item into its line sample.
+    /// </summary>
+    /// <param name="item">The item</param>
+    /// <returns>True if the line sample was constructed</returns>
+    const bool AssembleLine(pipelineItem* item) const;
+    /// <summary>
+    /// Predict the status of the line sample of an item.
+    /// </summary>
+    /// <param name="item">The item</param>
+    /// <returns>True if the line is registered and the prediction succeeded</returns>
+    const bool Predict(pipelineItem* item) const;
+    /// <summary>
+    /// The source a capture is admitted under
+    /// </summary>
+    /// <param name="node1Capture">The waveforms captured at the first node of the line</param>
+    /// <returns>The node number of the capture (0 if it's NULL)</returns>
+    static const int SourceOf(const nodeCapture* node1Capture);
+    /// <summary>
+    /// Take a place in the pipeline for a capture of a source and count the submission until EndSubmission().
+    /// </summary>
+    /// <param name="source">The source of the capture</param>
+    /// <param name="isWaiting">True to wait while the source is at its limit, else give up right away</param>
+    /// <returns>True if the capture was admitted (false if the source is at its limit and isn't waiting, or after Finish())</returns>
+    const bool Admit(int source, bool isWaiting);
+    /// <summary>
+    /// Stop counting a submission Admit() let in once its item was pushed or given up on.
+    /// </summary>
+    const void EndSubmission();
+    /// <summary>
+    /// Give back the place a capture of a source took in the pipeline.
+    /// </summary>
+    /// <param name="source">The source of the capture</param>
+    const void Release(int source);
+    /// <summary>
+    /// Record the latency of a finished item, hand it to the callback, and free it.
+    /// </summary>
+    /// <param name="item">The finished item</param>
+    const void Complete(pipelineItem* item);
+
+    /// <summary>
+    /// Free the queues and set their pointers to NULL. Notice that the workers have to be stopped first.
+    /// </summary>
+    const void FreeMemory();
+
+    /// <summary>
+    /// Display an error message and call FreeMemory().
+    /// </summary>
+    /// <param=variableName>The name of the variable that failed to get memory allocation</param>
+    const void MemoryAllocationFailure(string variableName);
+
+
+public:
+    /// <summary>
+    /// The constructor starts the workers of every stage.
+    /// </summary>
+    /// <param name="registry">The models of the lines (it isn't freed on the deconstructor and must not change until Finish())</param>
+    /// <param name="onPrediction">
+    /// Called with every finished item on a prediction worker (the item is freed when it returns)</param>
+    /// <param name="queueCapacity">The number of items each queue between the stages holds</param>
+    /// <param name="numberOfEstimationWorkers">The number of threads estimating phasors</param>
+    /// <param name="numberOfAssemblyWorkers">The number of threads building line samples</param>
+    /// <param name="numberOfPredictionWorkers">The number of threads predicting line statuses</param>
+    /// <param name="batchSize">The largest number of items a worker takes from its queue at once</param>
+    /// <param name="maximumInFlightPerSource">
+    /// The largest number of captures of one source in the pipeline at once (0 for a quarter of the queue capacity)</param>
+    explicit ingestPipeline(const lineModelRegistry* registry, const function<void(const pipelineItem*)>& onPrediction,
+        int queueCapacity = 256, int numberOfEstimationWorkers = 2, int numberOfAssemblyWorkers = 1, int numberOfPredictionWorkers = 1,
+        int batchSize = 16, int maximumInFlightPerSource = 0);
+
+    /// <summary>
+    /// The deconstructor finishes the items still in the pipeline and stops the workers
+    /// </summary>
+    ~ingestPipeline();
+
+
+    /// <summary>
+    /// The name of a stage
+    /// </summary>
+    /// <param name="stage">The stage</param>
+    /// <returns>The name in camel case</returns>
+    static const string StageName(pipelineStage stage);
+    /// <summary>
+    /// Submit the captures of the two nodes of a line and wait for room while their source is at its limit or the first queue is
+    /// full. The pipeline adopts the captures. It's safe to call from any number of threads at once and at the same time as
+    /// Finish(), which wakes a waiting call to return false and lets an admitted one push its item before the first queue closes.
+    /// </summary>
+    /// <param name="node1Capture">The waveforms captured at the first node of the line</param>
+    /// <param name="node2Capture">The waveforms captured at the second node of the line</param>
+    /// <returns>True if the captures were submitted (false after Finish(), and the captures stay the caller's)</returns>
+    const bool Submit(nodeCapture* node1Capture, nodeCapture* node2Capture);
+    /// <summary>
+    /// Submit the captures of the two nodes of a line if their source is under its limit and the first queue has room. The
+    /// pipeline only adopts the captures when it returns true. It's safe to call the same way as Submit().
+    /// </summary>
+    /// <param name="node1Capture">The waveforms captured at the first node of the line</param>
+    /// <param name="node2Capture">The waveforms captured at the second node of the line</param>
+    /// <returns>True if the captures were submitted (false when the source or the first queue is full, or after Finish())</returns>
+    const bool TrySubmit(nodeCapture* node1Capture, nodeCapture* node2Capture);
+    /// <summary>
+    /// Stop taking captures, wait for the submissions already admitted to push their items and for every submitted capture to be
+    /// predicted, and stop the workers. Calling it again does nothing.
+    /// </summary>
+    const void Finish();
+
+    /// <summary>
+    /// The number of items waiting in the queue of a stage
+    /// </summary>
+    /// <param name="stage">The stage</param>
+    const int QueueDepth(pipelineStage stage) const;
+    /// <summary>
+    /// The largest number of items that waited in the queue of a stage
+    /// </summary>
+    /// <param name="stage">The stage</param>
+    const int MaximumQueueDepth(pipelineStage stage) const;
+    /// <summary>
+    /// The number of items predicted
+    /// </summary>
+    const long long NumberOfPredictions() const;
+    /// <summary>
+    /// The number of items a stage failed on
+    /// </summary>
+    const long long NumberOfFailures() const;
+    /// <summary>
+    /// The number of captures TrySubmit() refused because their source was at its limit or the first queue was full
+    /// </summary>
+    const long long NumberOfRejectedCaptures() const;
+    /// <summary>
+    /// The largest number of captures of one source in the pipeline at once
+    /// </summary>
+    const int MaximumInFlightPerSource() const;
+    /// <summary>
+    /// The time from submission to prediction of every finished item
+    /// </summary>
+    const latencyHistogram Latencies() const;
+
+    /// <summary>
+    /// Print the end-to-end latency and the depth of every queue.
+    /// </summary>
+    const void PrintStatistics() const;
+};
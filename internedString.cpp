@@ -0,0 +1,81 @@
+#define _USE_MATH_DEFINES
+
+using namespace std;
+
+#include <cmath>
+#include <exception>
+#include <iostream>
+#include <mutex>
+#include <string>
+#include <unordered_set>
+#include "internedString.h"
+
+
+/// <summary>
+/// The pool of shared copies (the elements of an unordered_set never move, so the pointers stay valid while it grows)
+/// </summary>
+static unordered_set<string>& Pool()
+{
+    static unordered_set<string> pool;
+    return pool;
+}
+/// <summary>
+/// Guards the pool since line samples and nodes can be built on several threads
+/// </summary>
+static mutex& PoolMutex()
+{
+    static mutex poolMutex;
+    return poolMutex;
+}
+
+const string* internedString::Intern(const string& text)
+{
+    lock_guard<mutex> lock(PoolMutex());
+    return &*Pool().insert(text).first;
+}
+
+
+
+internedString::internedString()
+{
+    // Default constructed parameters are common enough to skip the lock
+    static const string* emptyString = Intern("");
+    value = emptyString;
+}
+internedString::internedString(const string& text)
+{
+    value = Intern(text);
+}
+internedString::internedString(const char* text)
+{
+    value = Intern(string(text));
+}
+
+
+const string& internedString::String() const
+{
+    return *value;
+}
+internedString::operator const string&() const
+{
+    return *value;
+}
+const bool internedString::operator==(const internedString& other) const
+{
+    return value == other.value;
+}
+const bool internedString::operator!=(const internedString& other) const
+{
+    return value != other.value;
+}
+
+const int internedString::NumberOfStrings()
+{
+    lock_guard<mutex> lock(PoolMutex());
+    return (int)Pool().size();
+}
+
+ostream& operator<<(ostream& stream, const internedString& text)
+{
+    return stream << text.String();
+}
\ No newline at end of file
@@ -0,0 +1,86 @@
+#pragma once
+
+#define _USE_MATH_DEFINES
+
+using namespace std;
+
+#include <cmath>
+#include <exception>
+#include <iostream>
+#include <mutex>
+#include <string>
+#include <unordered_set>
+
+
+/// <summary>
+/// A handle to one shared copy of a string like a parameter name or unit. Every equal string is stored once in a process wide pool
+/// that is never freed, so copying or assigning the handle copies a pointer instead of allocating, and equal handles compare by
+/// pointer.
+/// </summary>
+class internedString {
+private:
+    /// <summary>
+    /// The shared copy of the string in the pool
+    /// </summary>
+    const string* value = NULL;
+
+
+    /// <summary>
+    /// Find the shared copy of a string and add it to the pool if it's new.
+    /// </summary>
+    /// <param name="text">The string to intern</param>
+    /// <returns>The pointer to the shared copy</returns>
+    static const string* Intern(const string& text);
+
+
+public:
+    /// <summary>
+    /// The default constructor for the empty string
+    /// </summary>
+    internedString();
+    /// <summary>
+    /// This constructor interns a string.
+    /// </summary>
+    /// <param name="text">The string to intern</param>
+    internedString(const string& text);
+    /// <summary>
+    /// This constructor interns a string literal.
+    /// </summary>
+    /// <param name="text">The string to intern</param>
+    internedString(const char* text);
+
+
+    /// <summary>
+    /// The shared copy of the string
+    /// </summary>
+    const string& String() const;
+    /// <summary>
+    /// The shared copy of the string, so the handle can be passed where a string is expected
+    /// </summary>
+    operator const string&() const;
+    /// <summary>
+    /// Compare two handles by their shared copies.
+    /// </summary>
+    /// <param name="other">The other handle</param>
+    /// <returns>True if the strings are equal</returns>
+    const bool operator==(const internedString& other) const;
+    /// <summary>
+    /// Compare two handles by their shared copies.
+    /// </summary>
+    /// <param name="other">The other handle</param>
+    /// <returns>True if the strings are different</returns>
+    const bool operator!=(const internedString& other) const;
+
+    /// <summary>
+    /// The number of distinct strings in the pool
+    /// </summary>
+    static const int NumberOfStrings();
+};
+
+/// <summary>
+/// Print the string of a handle.
+/// </summary>
+/// <param name="stream">The stream to print to</param>
+/// <param name="text">The handle</param>
+/// <returns>The stream</returns>
+ostream& operator<<(ostream& stream, const internedString& text);
\ No newline at end of file
@@ -0,0 +1,233 @@
+#define _USE_MATH_DEFINES
+
+using namespace std;
+
+#include <cmath>
+#include <exception>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <vector>
+#include "lineSample.h"
+#include "lineFeatureMatrix.h"
+#include "distanceKernel.h"
+#include "nearestNeighborHeap.h"
+#include "nearestNeighborIndex.h"
+#include "knnQueryScratch.h"
+#include "ivfIndex.h"
+
+
+const double ivfIndex::CentroidSquaredDistance(int listIndex, const double* realParts, const double* imaginaryParts) const
+{
+    int numberOfFeatures = features->NumberOfFeatures;
+    const double* realCentroid = centroidRealParts + (size_t)listIndex * numberOfFeatures;
+    const double* imaginaryCentroid = centroidImaginaryParts + (size_t)listIndex * numberOfFeatures;
+
+    double squaredDistance = 0;
+    for (int featureIndex = 0; featureIndex < numberOfFeatures; featureIndex++) {
+        double realDifference = realCentroid[featureIndex] - realParts[featureIndex];
+        double imaginaryDifference = imaginaryCentroid[featureIndex] - imaginaryParts[featureIndex];
+        squaredDistance += features->FeatureWeights[featureIndex] *
+            (realDifference * realDifference + imaginaryDifference * imaginaryDifference);
+    }
+    return squaredDistance;
+}
+const int ivfIndex::NearestList(int sampleIndex, double* realParts, double* imaginaryParts) const
+{
+    for (int featureIndex = 0; featureIndex < features->NumberOfFeatures; featureIndex++) {
+        realParts[featureIndex] = features->RealColumn(featureIndex)[sampleIndex];
+        imaginaryParts[featureIndex] = features->ImaginaryColumn(featureIndex)[sampleIndex];
+    }
+
+    int nearestList = 0;
+    double nearestSquaredDistance = CentroidSquaredDistance(0, realParts, imaginaryParts);
+    for (int listIndex = 1; listIndex < numberOfLists; listIndex++) {
+        double squaredDistance = CentroidSquaredDistance(listIndex, realParts, imaginaryParts);
+        if (squaredDistance < nearestSquaredDistance) {
+            nearestSquaredDistance = squaredDistance;
+            nearestList = listIndex;
+        }
+    }
+    return nearestList;
+}
+const bool ivfIndex::Cluster(int numberOfIterations)
+{
+    int numberOfSamples = features->NumberOfSamples;
+    int numberOfFeatures = features->NumberOfFeatures;
+
+    centroidRealParts = new double[(size_t)numberOfLists * numberOfFeatures];
+    if (centroidRealParts == NULL) {
+        MemoryAllocationFailure("centroidRealParts");
+        return false;
+    }
+    centroidImaginaryParts = new double[(size_t)numberOfLists * numberOfFeatures];
+    if (centroidImaginaryParts == NULL) {
+        MemoryAllocationFailure("centroidImaginaryParts");
+        return false;
+    }
+    listOffsets = new int[numberOfLists + 1];
+    if (listOffsets == NULL) {
+        MemoryAllocationFailure("listOffsets");
+        return false;
+    }
+    listMembers = new int[numberOfSamples];
+    if (listMembers == NULL) {
+        MemoryAllocationFailure("listMembers");
+        return false;
+    }
+
+    // Scratch space for the k-means iterations
+    int* assignments = new int[numberOfSamples];
+    double* realParts = new double[numberOfFeatures];
+    double* imaginaryParts = new double[numberOfFeatures];
+    if ((assignments == NULL) || (realParts == NULL) || (imaginaryParts == NULL)) {
+        if (assignments != NULL) delete[] assignments;
+        if (realParts != NULL) delete[] realParts;
+        if (imaginaryParts != NULL) delete[] imaginaryParts;
+        MemoryAllocationFailure("the k-means scratch space");
+        return false;
+    }
+
+    // Start from evenly spaced line samples
+    for (int listIndex = 0; listIndex < numberOfLists; listIndex++) {
+        int sampleIndex = (int)((long long)listIndex * numberOfSamples / numberOfLists);
+        for (int featureIndex = 0; featureIndex < numberOfFeatures; featureIndex++) {
+            centroidRealParts[(size_t)listIndex * numberOfFeatures + featureIndex] = features->RealColumn(featureIndex)[sampleIndex];
+            centroidImaginaryParts[(size_t)listIndex * numberOfFeatures + featureIndex] =
+                features->ImaginaryColumn(featureIndex)[sampleIndex];
+        }
+    }
+
+    for (int iteration = 0; iteration <= numberOfIterations; iteration++) {
+        for (int sampleIndex = 0; sampleIndex < numberOfSamples; sampleIndex++) {
+            assignments[sampleIndex] = NearestList(sampleIndex, realParts, imaginaryParts);
+        }
+        if (iteration == numberOfIterations) break;   // The last pass only assigns
+
+        // Move each centroid to the mean of its line samples (an empty cluster keeps its centroid)
+        for (int listIndex = 0; listIndex <= numberOfLists; listIndex++) listOffsets[listIndex] = 0;
+        for (int sampleIndex = 0; sampleIndex < numberOfSamples; sampleIndex++) listOffsets[assignments[sampleIndex]]++;
+        for (int listIndex = 0; listIndex < numberOfLists; listIndex++) {
+            if (listOffsets[listIndex] == 0) continue;
+            for (int featureIndex = 0; featureIndex < numberOfFeatures; featureIndex++) {
+                centroidRealParts[(size_t)listIndex * numberOfFeatures + featureIndex] = 0;
+                centroidImaginaryParts[(size_t)listIndex * numberOfFeatures + featureIndex] = 0;
+            }
+        }
+        for (int sampleIndex = 0; sampleIndex < numberOfSamples; sampleIndex++) {
+            size_t centroidOffset = (size_t)assignments[sampleIndex] * numberOfFeatures;
+            double share = 1.0 / listOffsets[assignments[sampleIndex]];
+            for (int featureIndex = 0; featureIndex < numberOfFeatures; featureIndex++) {
+                centroidRealParts[centroidOffset + featureIndex] += share * features->RealColumn(featureIndex)[sampleIndex];
+                centroidImaginaryParts[centroidOffset + featureIndex] += share * features->ImaginaryColumn(featureIndex)[sampleIndex];
+            }
+        }
+    }
+
+    // Group the line sample indices by cluster
+    for (int listIndex = 0; listIndex <= numberOfLists; listIndex++) listOffsets[listIndex] = 0;
+    for (int sampleIndex = 0; sampleIndex < numberOfSamples; sampleIndex++) listOffsets[assignments[sampleIndex] + 1]++;
+    for (int listIndex = 0; listIndex < numberOfLists; listIndex++) listOffsets[listIndex + 1] += listOffsets[listIndex];
+    for (int sampleIndex = 0; sampleIndex < numberOfSamples; sampleIndex++) {
+        // listOffsets[list] is used as the insertion point and restored below
+        listMembers[listOffsets[assignments[sampleIndex]]++] = sampleIndex;
+    }
+    for (int listIndex = numberOfLists; listIndex > 0; listIndex--) listOffsets[listIndex] = listOffsets[listIndex - 1];
+    listOffsets[0] = 0;
+
+    delete[] assignments;
+    delete[] realParts;
+    delete[] imaginaryParts;
+    return true;
+}
+
+
+const void ivfIndex::FreeMemory()
+{
+    if (centroidRealParts != NULL) {
+        delete[] centroidRealParts;
+        centroidRealParts = NULL;
+    }
+    if (centroidImaginaryParts != NULL) {
+        delete[] centroidImaginaryParts;
+        centroidImaginaryParts = NULL;
+    }
+    if (listOffsets != NULL) {
+        delete[] listOffsets;
+        listOffsets = NULL;
+    }
+    if (listMembers != NULL) {
+        delete[] listMembers;
+        listMembers = NULL;
+    }
+    numberOfLists = 0;
+}
+
+const void ivfIndex::MemoryAllocationFailure(string variableName)
+{
+    cout << "Error: ivfIndex() failed to allocate memory for " << variableName << "\n";
+    FreeMemory();
+}
+
+
+
+ivfIndex::ivfIndex(lineFeatureMatrix* features, int numberOfLists, int numberOfProbes, int numberOfIterations)
+{
+    this->features = features;
+    NumberOfProbes = numberOfProbes;
+    if ((features == NULL) || (features->NumberOfSamples == 0)) {
+        cout << "Error: ivfIndex() needs a feature matrix with at least one line sample.\n";
+        return;
+    }
+
+    if (numberOfLists <= 0) numberOfLists = (int)sqrt((double)features->NumberOfSamples);
+    if (numberOfLists > features->NumberOfSamples) numberOfLists = features->NumberOfSamples;
+    if (numberOfLists < 1) numberOfLists = 1;
+    this->numberOfLists = numberOfLists;
+
+    Cluster(numberOfIterations);
+}
+
+ivfIndex::~ivfIndex()
+{
+    FreeMemory();
+}
+
+
+lineFeatureMatrix* ivfIndex::Features() const
+{
+    return features;
+}
+const void ivfIndex::Search(const double* realParts, const double* imaginaryParts, nearestNeighborHeap* heap) const
+{
+    heap->Clear();
+    if (listMembers == NULL) return;
+
+    int numberOfProbes = NumberOfProbes;
+    if (numberOfProbes > numberOfLists) numberOfProbes = numberOfLists;
+    if (numberOfProbes < 1) numberOfProbes = 1;
+
+    // Find the nearest centroids with a heap of their own, kept in the thread's scratch space so a query doesn't allocate
+    nearestNeighborHeap* probes = knnQueryScratch::ReserveHeap(knnQueryScratch::OfThisThread().ProbeHeap, numberOfProbes);
+    for (int listIndex = 0; listIndex < numberOfLists; listIndex++) {
+        probes->Push(CentroidSquaredDistance(listIndex, realParts, imaginaryParts), listIndex, true);
+    }
+
+    for (int probeIndex = 0; probeIndex < probes->Size(); probeIndex++) {
+        int listIndex = probes->Neighbor(probeIndex).Index;
+        for (int memberIndex = listOffsets[listIndex]; memberIndex < listOffsets[listIndex + 1]; memberIndex++) {
+            int sampleIndex = listMembers[memberIndex];
+            double squaredDistance = features->SquaredDistance(sampleIndex, realParts, imaginaryParts);
+            if (squaredDistance > heap->WorstSquaredDistance()) continue;
+            heap->Push(squaredDistance, sampleIndex, features->IsWorking(sampleIndex));
+        }
+    }
+}
+const string ivfIndex::Name() const
+{
+    return "IVF (" + to_string(numberOfLists) + " lists, " + to_string(NumberOfProbes) + " probes)";
+}
+const int ivfIndex::NumberOfLists() const
+{
+    return numberOfLists;
+}
\ No newline at end of file
@@ -0,0 +1,128 @@
+#pragma once
+
+#define _USE_MATH_DEFINES
+
+using namespace std;
+
+#include <cmath>
+#include <exception>
+#include <iostream>
+#include <string>
+#include "lineSample.h"
+#include "lineFeatureMatrix.h"
+#include "distanceKernel.h"
+#include "nearestNeighborHeap.h"
+#include "nearestNeighborIndex.h"
+
+
+/// <summary>
+/// An approximate inverted file index over a feature matrix. The known line samples are clustered with k-means and a query only
+/// scans the clusters with the nearest centroids, so the neighbors found are usually but not always the exact nearest neighbors.
+/// NumberOfProbes trades latency for recall.
+/// </summary>
+class ivfIndex : public nearestNeighborIndex {
+private:
+    /// <summary>
+    /// The feature matrix the index was built over
+    /// </summary>
+    lineFeatureMatrix* features = NULL;
+    /// <summary>
+    /// The number of clusters
+    /// </summary>
+    int numberOfLists = 0;
+    /// <summary>
+    /// The real parts of the features of each centroid (numberOfLists * NumberOfFeatures elements)
+    /// </summary>
+    double* centroidRealParts = NULL;
+    /// <summary>
+    /// The imaginary parts of the features of each centroid
+    /// </summary>
+    double* centroidImaginaryParts = NULL;
+    /// <summary>
+    /// Where each cluster starts in listMembers (numberOfLists + 1 elements)
+    /// </summary>
+    int* listOffsets = NULL;
+    /// <summary>
+    /// The indices of the known line samples grouped by cluster
+    /// </summary>
+    int* listMembers = NULL;
+
+
+    /// <summary>
+    /// The squared weighted distance between a centroid and a set of features
+    /// </summary>
+    /// <param name="listIndex">The index of the centroid</param>
+    /// <param name="realParts">The real parts of the features</param>
+    /// <param name="imaginaryParts">The imaginary parts of the features</param>
+    /// <returns>The squared weighted distance</returns>
+    const double CentroidSquaredDistance(int listIndex, const double* realParts, const double* imaginaryParts) const;
+    /// <summary>
+    /// The index of the centroid nearest to a known line sample
+    /// </summary>
+    /// <param name="sampleIndex">The index of the known line sample</param>
+    /// <param name="realParts">Scratch space for NumberOfFeatures real parts</param>
+    /// <param name="imaginaryParts">Scratch space for NumberOfFeatures imaginary parts</param>
+    /// <returns>The index of the nearest centroid</returns>
+    const int NearestList(int sampleIndex, double* realParts, double* imaginaryParts) const;
+    /// <summary>
+    /// Cluster the known line samples with Lloyd's k-means starting from evenly spaced samples.
+    /// </summary>
+    /// <param name="numberOfIterations">The number of k-means iterations</param>
+    /// <returns>True if the memory allocation succeeded</returns>
+    const bool Cluster(int numberOfIterations);
+
+    /// <summary>
+    /// Free the dynamically allocated memory and set their pointers to NULL. Notice that the feature matrix isn't freed.
+    /// </summary>
+    const void FreeMemory();
+
+    /// <summary>
+    /// Display an error message and call FreeMemory().
+    /// </summary>
+    /// <param=variableName>The name of the variable that failed to get memory allocation</param>
+    const void MemoryAllocationFailure(string variableName);
+
+
+public:
+    /// <summary>
+    /// The number of nearest clusters a query scans (raise it for recall and lower it for latency)
+    /// </summary>
+    int NumberOfProbes = 1;
+
+
+    /// <summary>
+    /// The constructor clusters the known line samples.
+    /// </summary>
+    /// <param name="features">The feature matrix of the line samples with known statuses (not freed on the deconstructor)</param>
+    /// <param name="numberOfLists">The number of clusters (0 uses the square root of the number of line samples)</param>
+    /// <param name="numberOfProbes">The number of nearest clusters a query scans</param>
+    /// <param name="numberOfIterations">The number of k-means iterations</param>
+    explicit ivfIndex(lineFeatureMatrix* features, int numberOfLists = 0, int numberOfProbes = 1, int numberOfIterations = 10);
+
+    /// <summary>
+    /// The deconstructor
+    /// </summary>
+    ~ivfIndex();
+
+
+    /// <summary>
+    /// The feature matrix the index was built over
+    /// </summary>
+    /// <returns>The pointer to the feature matrix</returns>
+    lineFeatureMatrix* Features() const override;
+    /// <summary>
+    /// Find approximately the nearest known line samples to the features of an unknown line sample.
+    /// </summary>
+    /// <param name="realParts">The real parts of the features from lineFeatureMatrix::ExtractFeatures()</param>
+    /// <param name="imaginaryParts">The imaginary parts of the features from lineFeatureMatrix::ExtractFeatures()</param>
+    /// <param name="heap">The heap to fill with as many nearest neighbors as its capacity (cleared first)</param>
+    const void Search(const double* realParts, const double* imaginaryParts, nearestNeighborHeap* heap) const override;
+    /// <summary>
+    /// The name of the index for printing
+    /// </summary>
+    const string Name() const override;
+    /// <summary>
+    /// The number of clusters
+    /// </summary>
+    const int NumberOfLists() const;
+};
\ No newline at end of file
@@ -0,0 +1,215 @@
+#define _USE_MATH_DEFINES
+
+using namespace std;
+
+#include <algorithm>
+#include <cmath>
+#include <exception>
+#include <iostream>
+#include <string>
+#include <vector>
+#include "lineFeatureMatrix.h"
+#include "nearestNeighborHeap.h"
+#include "nearestNeighborIndex.h"
+#include "kdTreeNode.h"
+#include "kdTreeIndex.h"
+
+
+const double kdTreeIndex::Coordinate(int sampleIndex, int dimension) const
+{
+    if (dimension % 2 == 0) return dimensionScales[dimension] * features->RealColumn(dimension / 2)[sampleIndex];
+    return dimensionScales[dimension] * features->ImaginaryColumn(dimension / 2)[sampleIndex];
+}
+const int kdTreeIndex::BuildNode(int firstPoint, int lastPoint)
+{
+    kdTreeNode node;
+    node.FirstPoint = firstPoint;
+    node.LastPoint = lastPoint;
+    node.SplitDimension = -1;
+    node.SplitValue = 0;
+    node.LeftChild = -1;
+    node.RightChild = -1;
+    int nodeIndex = (int)nodes.size();
+    nodes.push_back(node);
+    if (lastPoint - firstPoint <= pointsPerLeaf) return nodeIndex;
+
+    // Split on the coordinate with the largest spread
+    int splitDimension = 0;
+    double largestSpread = -1;
+    for (int dimension = 0; dimension < numberOfDimensions; dimension++) {
+        double minimum = Coordinate(pointIndices[firstPoint], dimension);
+        double maximum = minimum;
+        for (int pointIndex = firstPoint + 1; pointIndex < lastPoint; pointIndex++) {
+            double coordinate = Coordinate(pointIndices[pointIndex], dimension);
+            if (coordinate < minimum) minimum = coordinate;
+            if (coordinate > maximum) maximum = coordinate;
+        }
+        if (maximum - minimum > largestSpread) {
+            largestSpread = maximum - minimum;
+            splitDimension = dimension;
+        }
+    }
+    if (largestSpread <= 0) return nodeIndex;   // Every point is identical so keep them in one leaf
+
+    int medianPoint = firstPoint + (lastPoint - firstPoint) / 2;
+    nth_element(pointIndices + firstPoint, pointIndices + medianPoint, pointIndices + lastPoint, [&](int lhs, int rhs) {
+        return Coordinate(lhs, splitDimension) < Coordinate(rhs, splitDimension);
+    });
+
+    double splitValue = Coordinate(pointIndices[medianPoint], splitDimension);
+    int leftChild = BuildNode(firstPoint, medianPoint);
+    int rightChild = BuildNode(medianPoint, lastPoint);
+    nodes[nodeIndex].SplitDimension = splitDimension;
+    nodes[nodeIndex].SplitValue = splitValue;
+    nodes[nodeIndex].LeftChild = leftChild;
+    nodes[nodeIndex].RightChild = rightChild;
+    return nodeIndex;
+}
+const void kdTreeIndex::SearchNode(int nodeIndex, const double* query, nearestNeighborHeap* heap) const
+{
+    const kdTreeNode& node = nodes[nodeIndex];
+
+    if (node.SplitDimension < 0) {
+        for (int pointIndex = node.FirstPoint; pointIndex < node.LastPoint; pointIndex++) {
+            const double* point = points + (size_t)pointIndex * numberOfDimensions;
+            double squaredDistance = 0;
+            for (int dimension = 0; dimension < numberOfDimensions; dimension++) {
+                double difference = point[dimension] - query[dimension];
+                squaredDistance += difference * difference;
+            }
+            if (squaredDistance > heap->WorstSquaredDistance()) continue;
+            heap->Push(squaredDistance, pointIndices[pointIndex], features->IsWorking(pointIndices[pointIndex]));
+        }
+        return;
+    }
+
+    double difference = query[node.SplitDimension] - node.SplitValue;
+    int nearChild = node.LeftChild;
+    int farChild = node.RightChild;
+    if (difference > 0) {
+        nearChild = node.RightChild;
+        farChild = node.LeftChild;
+    }
+
+    SearchNode(nearChild, query, heap);
+    // The far side can only hold a nearer point if the splitting plane is within the farthest neighbor's distance
+    if (difference * difference <= heap->WorstSquaredDistance()) SearchNode(farChild, query, heap);
+}
+
+
+const void kdTreeIndex::FreeMemory()
+{
+    if (dimensionScales != NULL) {
+        delete[] dimensionScales;
+        dimensionScales = NULL;
+    }
+    if (points != NULL) {
+        delete[] points;
+        points = NULL;
+    }
+    if (pointIndices != NULL) {
+        delete[] pointIndices;
+        pointIndices = NULL;
+    }
+    nodes.clear();
+}
+
+const void kdTreeIndex::MemoryAllocationFailure(string variableName)
+{
+    cout << "Error: kdTreeIndex() failed to allocate memory for " << variableName << "\n";
+    FreeMemory();
+}
+
+
+
+kdTreeIndex::kdTreeIndex(lineFeatureMatrix* features)
+{
+    this->features = features;
+    if ((features == NULL) || (features->NumberOfSamples == 0)) {
+        cout << "Error: kdTreeIndex() needs a feature matrix with at least one line sample.\n";
+        return;
+    }
+    numberOfDimensions = 2 * features->NumberOfFeatures;
+    if (numberOfDimensions > maximumNumberOfDimensions) {
+        cout << "Error: kdTreeIndex() supports at most " << to_string(maximumNumberOfDimensions / 2) << " features.\n";
+        return;
+    }
+    int numberOfSamples = features->NumberOfSamples;
+
+    dimensionScales = new double[numberOfDimensions];
+    if (dimensionScales == NULL) {
+        MemoryAllocationFailure("dimensionScales");
+        return;
+    }
+    for (int dimension = 0; dimension < numberOfDimensions; dimension++) {
+        dimensionScales[dimension] = sqrt(features->FeatureWeights[dimension / 2]);
+    }
+    weightsVersion = features->WeightsVersion();
+
+    pointIndices = new int[numberOfSamples];
+    if (pointIndices == NULL) {
+        MemoryAllocationFailure("pointIndices");
+        return;
+    }
+    for (int pointIndex = 0; pointIndex < numberOfSamples; pointIndex++) pointIndices[pointIndex] = pointIndex;
+
+    nodes.reserve(4 * (numberOfSamples / pointsPerLeaf + 1));
+    BuildNode(0, numberOfSamples);
+
+    // Store the points in tree order so each leaf is contiguous
+    points = new double[(size_t)numberOfSamples * numberOfDimensions];
+    if (points == NULL) {
+        MemoryAllocationFailure("points");
+        return;
+    }
+    for (int pointIndex = 0; pointIndex < numberOfSamples; pointIndex++) {
+        for (int dimension = 0; dimension < numberOfDimensions; dimension++) {
+            points[(size_t)pointIndex * numberOfDimensions + dimension] = Coordinate(pointIndices[pointIndex], dimension);
+        }
+    }
+}
+
+kdTreeIndex::~kdTreeIndex()
+{
+    FreeMemory();
+}
+
+
+lineFeatureMatrix* kdTreeIndex::Features() const
+{
+    return features;
+}
+const void kdTreeIndex::Search(const double* realParts, const double* imaginaryParts, nearestNeighborHeap* heap) const
+{
+    heap->Clear();
+    if (points == NULL) return;
+
+    // The points are scaled with the old weights, so only a scan with the matrix's current weights finds the right neighbors
+    if (IsStale() == true) {
+        for (int sampleIndex = 0; sampleIndex < features->NumberOfSamples; sampleIndex++) {
+            double squaredDistance = features->SquaredDistance(sampleIndex, realParts, imaginaryParts);
+            if (squaredDistance > heap->WorstSquaredDistance()) continue;
+            heap->Push(squaredDistance, sampleIndex, features->IsWorking(sampleIndex));
+        }
+        return;
+    }
+
+    double query[maximumNumberOfDimensions];
+    for (int featureIndex = 0; featureIndex < numberOfDimensions / 2; featureIndex++) {
+        query[2 * featureIndex] = dimensionScales[2 * featureIndex] * realParts[featureIndex];
+        query[2 * featureIndex + 1] = dimensionScales[2 * featureIndex + 1] * imaginaryParts[featureIndex];
+    }
+    SearchNode(0, query, heap);
+}
+const string kdTreeIndex::Name() const
+{
+    return "KD-tree";
+}
+const int kdTreeIndex::NumberOfNodes() const
+{
+    return (int)nodes.size();
+}
+const bool kdTreeIndex::IsStale() const
+{
+    return (features != NULL) && (features->WeightsVersion() != weightsVersion);
+}
\ No newline at end of file
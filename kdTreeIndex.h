@@ -0,0 +1,135 @@
+#pragma once
+
+#define _USE_MATH_DEFINES
+
+using namespace std;
+
+#include <cmath>
+#include <exception>
+#include <iostream>
+#include <string>
+#include <vector>
+#include "lineFeatureMatrix.h"
+#include "nearestNeighborHeap.h"
+#include "nearestNeighborIndex.h"
+#include "kdTreeNode.h"
+
+
+/// <summary>
+/// A KD-tree over the features of a feature matrix. Each real and imaginary part is a coordinate scaled by the square root of its
+/// feature weight, so the plain squared euclidean distance between points is the same squared weighted distance distanceSample
+/// uses and a query only visits the leaves that can hold a nearer neighbor. The scales are the weights when the tree was built, so
+/// once lineFeatureMatrix::SetWeights() changes them the tree is stale and Search() scans every line sample until it's rebuilt.
+/// </summary>
+class kdTreeIndex : public nearestNeighborIndex {
+private:
+    /// <summary>
+    /// The largest number of points a leaf holds
+    /// </summary>
+    const int pointsPerLeaf = 16;
+    /// <summary>
+    /// The largest number of coordinates a point can have
+    /// </summary>
+    static const int maximumNumberOfDimensions = 128;
+    /// <summary>
+    /// The feature matrix the tree was built over
+    /// </summary>
+    lineFeatureMatrix* features = NULL;
+    /// <summary>
+    /// The number of coordinates per point (2 * NumberOfFeatures)
+    /// </summary>
+    int numberOfDimensions = 0;
+    /// <summary>
+    /// The scale of each coordinate (the square root of its feature weight)
+    /// </summary>
+    double* dimensionScales = NULL;
+    /// <summary>
+    /// The weights version of the feature matrix the coordinates were scaled with
+    /// </summary>
+    long long weightsVersion = 0;
+    /// <summary>
+    /// The scaled coordinates of every point in tree order with the coordinates of a point next to each other
+    /// </summary>
+    double* points = NULL;
+    /// <summary>
+    /// The index in the feature matrix of each point in tree order
+    /// </summary>
+    int* pointIndices = NULL;
+    /// <summary>
+    /// The nodes of the tree with the root at index 0
+    /// </summary>
+    vector<kdTreeNode> nodes;
+
+
+    /// <summary>
+    /// The scaled coordinate of a line sample in the feature matrix
+    /// </summary>
+    /// <param name="sampleIndex">The index of the line sample in the feature matrix</param>
+    /// <param name="dimension">The coordinate</param>
+    /// <returns>The scaled coordinate</returns>
+    const double Coordinate(int sampleIndex, int dimension) const;
+    /// <summary>
+    /// Split a range of points at the median of the coordinate with the largest spread.
+    /// </summary>
+    /// <param name="firstPoint">The index of the first point</param>
+    /// <param name="lastPoint">The index after the last point</param>
+    /// <returns>The index of the node covering the range</returns>
+    const int BuildNode(int firstPoint, int lastPoint);
+    /// <summary>
+    /// Visit a node and the children that can hold a point nearer than the farthest neighbor in the heap.
+    /// </summary>
+    /// <param name="nodeIndex">The index of the node</param>
+    /// <param name="query">The scaled coordinates of the unknown line sample</param>
+    /// <param name="heap">The heap of nearest neighbors found so far</param>
+    const void SearchNode(int nodeIndex, const double* query, nearestNeighborHeap* heap) const;
+
+    /// <summary>
+    /// Free the dynamically allocated memory and set their pointers to NULL. Notice that the feature matrix isn't freed.
+    /// </summary>
+    const void FreeMemory();
+
+    /// <summary>
+    /// Display an error message and call FreeMemory().
+    /// </summary>
+    /// <param=variableName>The name of the variable that failed to get memory allocation</param>
+    const void MemoryAllocationFailure(string variableName);
+
+
+public:
+    /// <summary>
+    /// The constructor builds the tree.
+    /// </summary>
+    /// <param name="features">The feature matrix of the line samples with known statuses (not freed on the deconstructor)</param>
+    explicit kdTreeIndex(lineFeatureMatrix* features);
+
+    /// <summary>
+    /// The deconstructor
+    /// </summary>
+    ~kdTreeIndex();
+
+
+    /// <summary>
+    /// The feature matrix the tree was built over
+    /// </summary>
+    /// <returns>The pointer to the feature matrix</returns>
+    lineFeatureMatrix* Features() const override;
+    /// <summary>
+    /// Find the nearest known line samples to the features of an unknown line sample.
+    /// </summary>
+    /// <param name="realParts">The real parts of the features from lineFeatureMatrix::ExtractFeatures()</param>
+    /// <param name="imaginaryParts">The imaginary parts of the features from lineFeatureMatrix::ExtractFeatures()</param>
+    /// <param name="heap">The heap to fill with as many nearest neighbors as its capacity (cleared first)</param>
+    const void Search(const double* realParts, const double* imaginaryParts, nearestNeighborHeap* heap) const override;
+    /// <summary>
+    /// The name of the index for printing
+    /// </summary>
+    const string Name() const override;
+    /// <summary>
+    /// The number of nodes in the tree
+    /// </summary>
+    const int NumberOfNodes() const;
+    /// <summary>
+    /// True if the weights of the feature matrix changed since the tree was built (build a new tree to search it again)
+    /// </summary>
+    const bool IsStale() const;
+};
\ No newline at end of file
@@ -0,0 +1,32 @@
+#pragma once
+
+/// <summary>
+/// A node of kdTreeIndex covering a contiguous range of the points in tree order
+/// </summary>
+class kdTreeNode {
+public:
+    /// <summary>
+    /// The index of the first point of the node
+    /// </summary>
+    int FirstPoint;
+    /// <summary>
+    /// The index after the last point of the node
+    /// </summary>
+    int LastPoint;
+    /// <summary>
+    /// The coordinate the node is split on (-1 for a leaf)
+    /// </summary>
+    int SplitDimension;
+    /// <summary>
+    /// The points of the left child are at or below this value and the points of the right child are at or above it
+    /// </summary>
+    double SplitValue;
+    /// <summary>
+    /// The index of the left child node
+    /// </summary>
+    int LeftChild;
+    /// <summary>
+    /// The index of the right child node
+    /// </summary>
+    int RightChild;
+};
\ No newline at end of file
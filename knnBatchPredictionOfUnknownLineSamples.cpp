@@ -0,0 +1,246 @@
+#define _USE_MATH_DEFINES
+
+using namespace std;
+
+#include <cmath>
+#include <exception>
+#include <iostream>
+#include <limits>
+#include <string>
+#include <vector>
+#include "phasor.h"
+#include "parameter.h"
+#include "nodeSample.h"
+#include "lineSample.h"
+#include "distanceWeights.h"
+#include "lineFeatureMatrix.h"
+#include "distanceKernel.h"
+#include "allocationCounter.h"
+#include "latencyHistogram.h"
+#include "knnInstrumentationSnapshot.h"
+#include "knnInstrumentation.h"
+#include "knnStageTimer.h"
+#include "knnBatchPredictionOfUnknownLineSamples.h"
+
+
+const bool knnBatchPredictionOfUnknownLineSamples::AllocateTile()
+{
+    int numberOfFeatures = knownFeatures->NumberOfFeatures;
+
+    if (nearestDistances == NULL) {
+        nearestDistances = new double[unknownSamplesPerTile * numberOfNearestNeighbors];
+        if (nearestDistances == NULL) {
+            MemoryAllocationFailure("nearestDistances");
+            return false;
+        }
+    }
+    if (nearestStatuses == NULL) {
+        nearestStatuses = new bool[unknownSamplesPerTile * numberOfNearestNeighbors];
+        if (nearestStatuses == NULL) {
+            MemoryAllocationFailure("nearestStatuses");
+            return false;
+        }
+    }
+    if (unknownRealParts == NULL) {
+        unknownRealParts = new double[unknownSamplesPerTile * numberOfFeatures];
+        if (unknownRealParts == NULL) {
+            MemoryAllocationFailure("unknownRealParts");
+            return false;
+        }
+    }
+    if (unknownImaginaryParts == NULL) {
+        unknownImaginaryParts = new double[unknownSamplesPerTile * numberOfFeatures];
+        if (unknownImaginaryParts == NULL) {
+            MemoryAllocationFailure("unknownImaginaryParts");
+            return false;
+        }
+    }
+    if (blockDistances == NULL) {
+        blockDistances = new double[knownSamplesPerBlock];
+        if (blockDistances == NULL) {
+            MemoryAllocationFailure("blockDistances");
+            return false;
+        }
+    }
+    return true;
+}
+const void knnBatchPredictionOfUnknownLineSamples::ScoreTile(lineSample** samplesWithUnknownStatuses, int firstUnknownIndex,
+    int numberOfUnknownsInTile)
+{
+    int numberOfFeatures = knownFeatures->NumberOfFeatures;
+
+    for (int tileIndex = 0; tileIndex < numberOfUnknownsInTile; tileIndex++) {
+        knownFeatures->ExtractFeatures(samplesWithUnknownStatuses[firstUnknownIndex + tileIndex],
+            unknownRealParts + tileIndex * numberOfFeatures, unknownImaginaryParts + tileIndex * numberOfFeatures);
+    }
+
+    // The block of known line samples is the outer loop so its columns are loaded once for every unknown line sample in the tile.
+    for (int firstKnownIndex = 0; firstKnownIndex < NumberOfKnownStatuses; firstKnownIndex += knownSamplesPerBlock) {
+        int numberOfKnownsInBlock = knownSamplesPerBlock;
+        if (NumberOfKnownStatuses - firstKnownIndex < knownSamplesPerBlock) {
+            numberOfKnownsInBlock = NumberOfKnownStatuses - firstKnownIndex;
+        }
+
+        for (int tileIndex = 0; tileIndex < numberOfUnknownsInTile; tileIndex++) {
+            // The k-th nearest distance is only a bound once k known line samples were inserted
+            double bound = numeric_limits<double>::infinity();
+            if (firstKnownIndex >= numberOfNearestNeighbors) {
+                bound = nearestDistances[tileIndex * numberOfNearestNeighbors + numberOfNearestNeighbors - 1];
+            }
+            distanceKernel::BoundedSquaredDistances(knownFeatures, firstKnownIndex, numberOfKnownsInBlock,
+                unknownRealParts + tileIndex * numberOfFeatures, unknownImaginaryParts + tileIndex * numberOfFeatures, bound,
+                blockDistances);
+
+            KNN_TIME_STAGE(knnStage::NeighborSelection);
+            for (int blockIndex = 0; blockIndex < numberOfKnownsInBlock; blockIndex++) {
+                InsertDistance(tileIndex, firstKnownIndex + blockIndex, blockDistances[blockIndex],
+                    knownFeatures->IsWorking(firstKnownIndex + blockIndex));
+            }
+        }
+    }
+}
+const void knnBatchPredictionOfUnknownLineSamples::InsertDistance(int tileIndex, int numberOfNeighborsFound, double distance,
+    bool isWorking)
+{
+    double* distances = nearestDistances + tileIndex * numberOfNearestNeighbors;
+    bool* statuses = nearestStatuses + tileIndex * numberOfNearestNeighbors;
+
+    // Special case where not all elements of distances are filled
+    int nearestNeighborIndex = numberOfNeighborsFound;
+    if (nearestNeighborIndex >= numberOfNearestNeighbors) {
+        if (distance >= distances[numberOfNearestNeighbors - 1]) return;
+        nearestNeighborIndex = numberOfNearestNeighbors - 1;
+    }
+
+    // Shift the farther neighbors back by one and place the new entry on the proper place on the array
+    while ((nearestNeighborIndex > 0) && (distance < distances[nearestNeighborIndex - 1])) {
+        distances[nearestNeighborIndex] = distances[nearestNeighborIndex - 1];
+        statuses[nearestNeighborIndex] = statuses[nearestNeighborIndex - 1];
+        nearestNeighborIndex--;
+    }
+    distances[nearestNeighborIndex] = distance;
+    statuses[nearestNeighborIndex] = isWorking;
+}
+const bool knnBatchPredictionOfUnknownLineSamples::PredictStatus(int tileIndex)
+{
+    bool* statuses = nearestStatuses + tileIndex * numberOfNearestNeighbors;
+    int numOfWorkingLines = 0;
+    int numOfNotWorkingLines = 0;
+
+    for (int nearestNeighborIndex = 0; nearestNeighborIndex < numberOfNearestNeighbors; nearestNeighborIndex++) {
+        if (statuses[nearestNeighborIndex] == true) numOfWorkingLines += 1;
+        else numOfNotWorkingLines += 1;
+    }
+
+    if (numOfWorkingLines > numOfNotWorkingLines) return true;
+    else return false;
+}
+
+
+const void knnBatchPredictionOfUnknownLineSamples::FreeMemory()
+{
+    if (nearestDistances != NULL) {
+        delete[] nearestDistances;
+        nearestDistances = NULL;
+    }
+    if (nearestStatuses != NULL) {
+        delete[] nearestStatuses;
+        nearestStatuses = NULL;
+    }
+    if (unknownRealParts != NULL) {
+        delete[] unknownRealParts;
+        unknownRealParts = NULL;
+    }
+    if (unknownImaginaryParts != NULL) {
+        delete[] unknownImaginaryParts;
+        unknownImaginaryParts = NULL;
+    }
+    if (blockDistances != NULL) {
+        delete[] blockDistances;
+        blockDistances = NULL;
+    }
+}
+
+const void knnBatchPredictionOfUnknownLineSamples::MemoryAllocationFailure(string variableName)
+{
+    cout << "Error: knnBatchPredictionOfUnknownLineSamples() failed to allocate memory for " << variableName << "\n";
+    FreeMemory();
+}
+
+
+
+knnBatchPredictionOfUnknownLineSamples::knnBatchPredictionOfUnknownLineSamples(lineSample** samplesWithKnownStatuses,
+    int numberOfKnownStatuses, int numberOfNearestNeighbors)
+{
+    this->numberOfNearestNeighbors = numberOfNearestNeighbors;
+
+    knownFeatures = new lineFeatureMatrix(samplesWithKnownStatuses, numberOfKnownStatuses);
+    if (knownFeatures == NULL) {
+        MemoryAllocationFailure("knownFeatures");
+        return;
+    }
+    ownsKnownFeatures = true;
+    NumberOfKnownStatuses = knownFeatures->NumberOfSamples;
+}
+knnBatchPredictionOfUnknownLineSamples::knnBatchPredictionOfUnknownLineSamples(lineFeatureMatrix* knownFeatures,
+    int numberOfNearestNeighbors)
+{
+    this->numberOfNearestNeighbors = numberOfNearestNeighbors;
+    this->knownFeatures = knownFeatures;
+    if (knownFeatures != NULL) NumberOfKnownStatuses = knownFeatures->NumberOfSamples;
+}
+
+knnBatchPredictionOfUnknownLineSamples::~knnBatchPredictionOfUnknownLineSamples()
+{
+    FreeMemory();
+    if ((ownsKnownFeatures == true) && (knownFeatures != NULL)) {
+        delete knownFeatures;
+        knownFeatures = NULL;
+    }
+}
+
+
+const vector<bool> knnBatchPredictionOfUnknownLineSamples::PredictStatuses(lineSample** samplesWithUnknownStatuses,
+    int numberOfUnknownStatuses)
+{
+    vector<bool> predictedStatuses;
+
+    if ((knownFeatures == NULL) || (NumberOfKnownStatuses == 0)) {
+        cout << "Error: There are no known statuses to compare to.\n";
+        return predictedStatuses;
+    }
+    if (numberOfNearestNeighbors > NumberOfKnownStatuses) {
+        cout << "Error: The number of nearest neighbors is larger than the number of known statuses.\n";
+        return predictedStatuses;
+    }
+    if (samplesWithUnknownStatuses == NULL) {
+        cout << "Error in PredictStatuses(): lineSample** samplesWithUnknownStatuses = NULL!\n";
+        return predictedStatuses;
+    }
+    for (int unknownSampleIndex = 0; unknownSampleIndex < numberOfUnknownStatuses; unknownSampleIndex++) {
+        if (knownFeatures->IsSampleOfTheSameLine(samplesWithUnknownStatuses[unknownSampleIndex]) == false) {
+            cout << "Error in PredictStatuses(): samplesWithUnknownStatuses[" << to_string(unknownSampleIndex) <<
+                "] is not a sample of the same line as the known line samples.\n";
+            return predictedStatuses;
+        }
+    }
+
+    // The scratch space is sized for one tile and reused for every tile.
+    if (AllocateTile() == false) return predictedStatuses;
+
+    predictedStatuses.reserve(numberOfUnknownStatuses);
+    for (int firstUnknownIndex = 0; firstUnknownIndex < numberOfUnknownStatuses; firstUnknownIndex += unknownSamplesPerTile) {
+        int numberOfUnknownsInTile = unknownSamplesPerTile;
+        if (numberOfUnknownStatuses - firstUnknownIndex < unknownSamplesPerTile) {
+            numberOfUnknownsInTile = numberOfUnknownStatuses - firstUnknownIndex;
+        }
+
+        ScoreTile(samplesWithUnknownStatuses, firstUnknownIndex, numberOfUnknownsInTile);
+        for (int tileIndex = 0; tileIndex < numberOfUnknownsInTile; tileIndex++) {
+            predictedStatuses.push_back(PredictStatus(tileIndex));
+        }
+    }
+    KNN_COUNT(knnCounter::Predictions, numberOfUnknownStatuses);
+
+    return predictedStatuses;
+}
\ No newline at end of file
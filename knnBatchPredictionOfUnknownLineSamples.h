@@ -0,0 +1,147 @@
+#pragma once
+
+#define _USE_MATH_DEFINES
+
+using namespace std;
+
+#include <cmath>
+#include <exception>
+#include <iostream>
+#include <string>
+#include <vector>
+#include "phasor.h"
+#include "parameter.h"
+#include "nodeSample.h"
+#include "lineSample.h"
+#include "distanceWeights.h"
+#include "lineFeatureMatrix.h"
+#include "distanceKernel.h"
+
+
+/// <summary>
+/// This contains a set of known line samples and predicts the statuses of many unknown line samples in a single pass over the
+/// known line samples.
+/// </summary>
+class knnBatchPredictionOfUnknownLineSamples {
+private:
+    /// <summary>
+    /// The number of unknown line samples scored against each known line sample while it is loaded
+    /// </summary>
+    const int unknownSamplesPerTile = 32;
+    /// <summary>
+    /// The number of known line samples scored together for one unknown line sample by distanceKernel
+    /// </summary>
+    const int knownSamplesPerBlock = 256;
+    /// <summary>
+    /// The number of nearest neighbors to consider
+    /// </summary>
+    int numberOfNearestNeighbors = 5;
+    /// <summary>
+    /// The normalized parameters of the line samples with a known line status
+    /// </summary>
+    lineFeatureMatrix* knownFeatures = NULL;
+    /// <summary>
+    /// True if knownFeatures was built by the constructor and is freed with this class
+    /// </summary>
+    bool ownsKnownFeatures = false;
+    /// <summary>
+    /// The real parts of the features of every unknown line sample in the tile (unknownSamplesPerTile * NumberOfFeatures elements)
+    /// </summary>
+    double* unknownRealParts = NULL;
+    /// <summary>
+    /// The imaginary parts of the features of every unknown line sample in the tile
+    /// </summary>
+    double* unknownImaginaryParts = NULL;
+    /// <summary>
+    /// The squared distances of the block of known line samples currently loaded from one unknown line sample
+    /// </summary>
+    double* blockDistances = NULL;
+    /// <summary>
+    /// The k closest squared distances for each unknown line sample in the tile with the closest having the lowest index
+    /// (unknownSamplesPerTile * numberOfNearestNeighbors elements)
+    /// </summary>
+    double* nearestDistances = NULL;
+    /// <summary>
+    /// The statuses of the known line samples in 'nearestDistances'
+    /// </summary>
+    bool* nearestStatuses = NULL;
+
+
+    /// <summary>
+    /// Allocate the scratch space for one tile if it wasn't allocated by a previous call.
+    /// </summary>
+    /// <returns>True if the memory allocation succeeded</returns>
+    const bool AllocateTile();
+    /// <summary>
+    /// Find the k nearest neighbors of every unknown line sample in the tile by walking the known line samples once in blocks.
+    /// </summary>
+    /// <param name="samplesWithUnknownStatuses">The array of line samples with unknown line statuses</param>
+    /// <param name="firstUnknownIndex">The index of the first unknown line sample in the tile</param>
+    /// <param name="numberOfUnknownsInTile">The number of unknown line samples in the tile</param>
+    const void ScoreTile(lineSample** samplesWithUnknownStatuses, int firstUnknownIndex, int numberOfUnknownsInTile);
+    /// <summary>
+    /// Place a new distance into the sorted nearest neighbors of an unknown line sample in the tile if it is close enough.
+    /// </summary>
+    /// <param name="tileIndex">The index of the unknown line sample within the tile</param>
+    /// <param name="numberOfNeighborsFound">The number of known line samples scored so far</param>
+    /// <param name="distance">The squared distance of the known line sample from the unknown line sample</param>
+    /// <param name="isWorking">The status of the known line sample</param>
+    const void InsertDistance(int tileIndex, int numberOfNeighborsFound, double distance, bool isWorking);
+    /// <summary>
+    /// Predicts the line status of an unknown line sample in the tile the same way knnPredictionOfUnknownLineSample does.
+    /// </summary>
+    /// <param name="tileIndex">The index of the unknown line sample within the tile</param>
+    /// <returns>The predicted status of the unknown line sample</returns>
+    const bool PredictStatus(int tileIndex);
+
+    /// <summary>
+    /// Free the dynamically allocated memory and set their pointers to NULL. Notice that the known line samples aren't freed and
+    /// knownFeatures is only freed if this class built it.
+    /// </summary>
+    const void FreeMemory();
+
+    /// <summary>
+    /// Display an error message and call FreeMemory().
+    /// </summary>
+    /// <param=variableName>The name of the variable that failed to get memory allocation</param>
+    const void MemoryAllocationFailure(string variableName);
+
+
+public:
+    /// <summary>
+    /// The number of known line samples
+    /// </summary>
+    int NumberOfKnownStatuses = 0;
+
+
+    /// <summary>
+    /// This constructor builds the feature matrix of the known line samples.
+    /// </summary>
+    /// <param name="samplesWithKnownStatuses">The array of line samples with known line statuses</param>
+    /// <param name="numberOfKnownStatuses">The number of elements in the samplesWithKnownStatuses array</param>
+    /// <param name="numberOfNearestNeighbors">
+    /// The number of nearest neighbors each unknown sample is compared to for the prediction</param>
+    explicit knnBatchPredictionOfUnknownLineSamples(lineSample** samplesWithKnownStatuses, int numberOfKnownStatuses,
+        int numberOfNearestNeighbors = 5);
+    /// <summary>
+    /// This constructor uses a previously built feature matrix that won't be freed on the deconstructor.
+    /// </summary>
+    /// <param name="knownFeatures">The feature matrix of the line samples with known line statuses</param>
+    /// <param name="numberOfNearestNeighbors">
+    /// The number of nearest neighbors each unknown sample is compared to for the prediction</param>
+    explicit knnBatchPredictionOfUnknownLineSamples(lineFeatureMatrix* knownFeatures, int numberOfNearestNeighbors = 5);
+
+    /// <summary>
+    /// The deconstructor
+    /// </summary>
+    ~knnBatchPredictionOfUnknownLineSamples();
+
+
+    /// <summary>
+    /// Predict the line statuses of an array of unknown line samples.
+    /// </summary>
+    /// <param name="samplesWithUnknownStatuses">The array of line samples with unknown line statuses</param>
+    /// <param name="numberOfUnknownStatuses">The number of elements in the samplesWithUnknownStatuses array</param>
+    /// <returns>The predicted statuses in the same order as the unknown line samples (empty on failure)</returns>
+    const vector<bool> PredictStatuses(lineSample** samplesWithUnknownStatuses, int numberOfUnknownStatuses);
+};
\ No newline at end of file
@@ -0,0 +1,523 @@
+/// <summary>
+/// The benchmark executable times the KNN pipeline on synthetic training sets so throughput regressions show up between releases.
+/// It links every source file of the project except KNN_PowerGridCpp.cpp, which has the demo main().
+/// 
+/// The training sets are line samples generated the same way as TestKnnClassRandomLineSample() with a configurable number of other
+/// currents per node. For each number of other currents and each number of known line samples it times:
+/// 1. lineSample construction from node samples
+/// 2. kdTreeIndex and ivfIndex builds
+/// 3. Single-query prediction with knnPredictionOfUnknownLineSample for each k and each thread count
+/// 4. Batch prediction with knnBatchPredictionOfUnknownLineSamples for each k
+/// 5. Single-query prediction with the Float32 and Int8 compactFeatureIndex scans and their recall
+/// 
+/// Every measurement is written as one JSON object of the "results" array in the output file, followed by the stage latencies and
+/// counters of knnInstrumentation when compiled with KNN_INSTRUMENTATION defined.
+/// 
+/// Arguments:
+///     --max-samples N    The largest number of known line samples (default 10000000, the sizes are the powers of 10 from 1000)
+///     --queries Q        The largest number of unknown line samples per measurement (default 1000)
+///     --threads T        The largest thread count (default every hardware thread, the counts are the powers of 2 up to it)
+///     --output PATH      The JSON file to write (default knnBenchmark.json)
+/// </summary>
+
+#define _USE_MATH_DEFINES
+
+using namespace std;
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <exception>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <new>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <time.h>
+#include <vector>
+#include "phasor.h"
+#include "parameter.h"
+#include "nodeSample.h"
+#include "lineSample.h"
+#include "knnPredictionOfUnknownLineSample.h"
+#include "knnBatchPredictionOfUnknownLineSamples.h"
+#include "lineFeatureMatrix.h"
+#include "threadPool.h"
+#include "kdTreeIndex.h"
+#include "ivfIndex.h"
+#include "compactFeatureIndex.h"
+#include "knnQueryEngine.h"
+#include "latencyHistogram.h"
+#include "knnInstrumentationSnapshot.h"
+#include "knnInstrumentation.h"
+
+
+/// <summary>
+/// The number of line samples built at once before their features are copied into the training set's columns, so the largest
+/// training sets only keep the columns in memory
+/// </summary>
+const int samplesPerBatch = 1 << 16;
+/// <summary>
+/// The largest number of clusters of the ivfIndex builds (the square root of the number of samples is used below this)
+/// </summary>
+const int maximumNumberOfLists = 256;
+
+
+/// <summary>
+/// This method returns a random double between the minimum and maximum parameters.
+/// </summary>
+/// <param name="minimum">The lowest possible value of the random double</param>
+/// <param name="maximum">The highest possible value of the random double</param>
+/// <returns>A random double between the minimum and maximum parameters</returns>
+double RandomDouble(double minimum, double maximum)
+{
+    double randomMultiple = (double)(rand() % RAND_MAX) / (double)(RAND_MAX - 1);
+    return minimum + randomMultiple * (maximum - minimum);
+}
+
+/// <summary>
+/// The seconds elapsed since a starting time
+/// </summary>
+/// <param name="startTime">The starting time</param>
+/// <returns>The elapsed seconds</returns>
+double SecondsSince(chrono::steady_clock::time_point startTime)
+{
+    return chrono::duration<double>(chrono::steady_clock::now() - startTime).count();
+}
+
+
+/// <summary>
+/// Generate a node sample with parameter magnitudes between 90% and 110% of the average phasor magnitudes like
+/// TestKnnClassRandomNodeSample().
+/// </summary>
+/// <param name="nodeNumber">The node's unique identifying number</param>
+/// <param name="averageVoltage">The average voltage phasor</param>
+/// <param name="averageCurrents">The array of average current phasors</param>
+/// <param name="currentDestinationNodes">The destination node numbers of the currents</param>
+/// <param name="numberOfCurrents">The number of currents in the node</param>
+/// <returns>The node sample or NULL if the memory allocation failed</returns>
+shared_ptr<nodeSample> BenchmarkRandomNodeSample(int nodeNumber, phasor averageVoltage, const phasor* averageCurrents,
+    int* currentDestinationNodes, int numberOfCurrents)
+{
+    phasor voltage = phasor(RandomDouble(0.9 * averageVoltage.RMSvalue(), 1.1 * averageVoltage.RMSvalue()),
+        averageVoltage.PhaseAngleDegrees());
+
+    vector<phasor> currents(numberOfCurrents);
+    for (int currentIndex = 0; currentIndex < numberOfCurrents; currentIndex++) {
+        currents[currentIndex] = phasor(RandomDouble(0.9 * averageCurrents[currentIndex].RMSvalue(),
+            1.1 * averageCurrents[currentIndex].RMSvalue()), averageCurrents[currentIndex].PhaseAngleDegrees());
+    }
+
+    nodeSample* node = new nodeSample(nodeNumber, voltage, currents.data(), currentDestinationNodes, numberOfCurrents);
+    if (node == NULL) return NULL;
+    return shared_ptr<nodeSample>(node);
+}
+/// <summary>
+/// Generate the two node samples of a line sample between nodes 1 and 2 with the average phasors TestKnnClassRandomLineSample()
+/// uses. The first current of each node is the line current and every other current has the average of the node's other current.
+/// </summary>
+/// <param name="isFailing">True if the node samples should be of the line failing</param>
+/// <param name="numberOfOtherCurrents">The number of currents per node not counting the line current</param>
+/// <param name="node1">The node 1 sample to set</param>
+/// <param name="node2">The node 2 sample to set</param>
+void BenchmarkRandomNodeSamples(bool isFailing, int numberOfOtherCurrents, shared_ptr<nodeSample>* node1,
+    shared_ptr<nodeSample>* node2)
+{
+    int numberOfCurrents = 1 + numberOfOtherCurrents;
+    vector<phasor> node1AverageCurrentPhasors(numberOfCurrents, isFailing ? phasor(250, -135) : phasor(25, -165));
+    vector<phasor> node2AverageCurrentPhasors(numberOfCurrents, isFailing ? phasor(250, 45) : phasor(25, 15));
+    node1AverageCurrentPhasors[0] = isFailing ? phasor(250, 45) : phasor(25, 15);
+    node2AverageCurrentPhasors[0] = isFailing ? phasor(250, -135) : phasor(25, -165);
+    phasor averageVoltagePhasor = isFailing ? phasor(50000, 90) : phasor(250000, 15);
+
+    vector<int> node1CurrentDestinationNodes(numberOfCurrents);
+    vector<int> node2CurrentDestinationNodes(numberOfCurrents);
+    node1CurrentDestinationNodes[0] = 2;
+    node2CurrentDestinationNodes[0] = 1;
+    for (int currentIndex = 1; currentIndex < numberOfCurrents; currentIndex++) {
+        node1CurrentDestinationNodes[currentIndex] = 2 + currentIndex;
+        node2CurrentDestinationNodes[currentIndex] = 2 + numberOfOtherCurrents + currentIndex;
+    }
+
+    *node1 = BenchmarkRandomNodeSample(1, averageVoltagePhasor, node1AverageCurrentPhasors.data(),
+        node1CurrentDestinationNodes.data(), numberOfCurrents);
+    *node2 = BenchmarkRandomNodeSample(2, averageVoltagePhasor, node2AverageCurrentPhasors.data(),
+        node2CurrentDestinationNodes.data(), numberOfCurrents);
+}
+/// <summary>
+/// Generate line samples with 20% of them of the line failing.
+/// </summary>
+/// <param name="numberOfSamples">The number of line samples</param>
+/// <param name="numberOfOtherCurrents">The number of currents per node not counting the line current</param>
+/// <param name="constructionSeconds">Incremented by the seconds spent in the lineSample constructors (NULL isn't timed)</param>
+/// <returns>The line samples (NULL elements if the memory allocation failed)</returns>
+vector<lineSample*> BenchmarkRandomLineSamples(int numberOfSamples, int numberOfOtherCurrents, double* constructionSeconds = NULL)
+{
+    vector<shared_ptr<nodeSample>> node1Samples(numberOfSamples);
+    vector<shared_ptr<nodeSample>> node2Samples(numberOfSamples);
+    vector<bool> areFailing(numberOfSamples);
+    for (int sampleIndex = 0; sampleIndex < numberOfSamples; sampleIndex++) {
+        areFailing[sampleIndex] = RandomDouble(0, 100) < 20;
+        BenchmarkRandomNodeSamples(areFailing[sampleIndex], numberOfOtherCurrents, &node1Samples[sampleIndex],
+            &node2Samples[sampleIndex]);
+    }
+
+    vector<lineSample*> samples(numberOfSamples, NULL);
+    chrono::steady_clock::time_point startTime = chrono::steady_clock::now();
+    for (int sampleIndex = 0; sampleIndex < numberOfSamples; sampleIndex++) {
+        if ((node1Samples[sampleIndex] == NULL) || (node2Samples[sampleIndex] == NULL)) continue;
+        samples[sampleIndex] = new lineSample(node1Samples[sampleIndex], node2Samples[sampleIndex], !areFailing[sampleIndex]);
+    }
+    if (constructionSeconds != NULL) *constructionSeconds += SecondsSince(startTime);
+    return samples;
+}
+/// <summary>
+/// Free line samples generated for the benchmark.
+/// </summary>
+/// <param name="samples">The line samples</param>
+void BenchmarkFreeLineSamples(vector<lineSample*>& samples)
+{
+    for (int sampleIndex = 0; sampleIndex < (int)samples.size(); sampleIndex++) {
+        if (samples[sampleIndex] != NULL) delete samples[sampleIndex];
+    }
+    samples.clear();
+}
+
+
+/// <summary>
+/// A generated training set whose columns are filled one batch of line samples at a time and read by a borrowing lineFeatureMatrix
+/// </summary>
+class benchmarkTrainingSet {
+private:
+    /// <summary>
+    /// The aligned block of 2 * NumberOfFeatures columns
+    /// </summary>
+    double* values = NULL;
+    /// <summary>
+    /// The statuses of the line samples
+    /// </summary>
+    bool* statuses = NULL;
+
+
+public:
+    /// <summary>
+    /// The feature matrix borrowing the columns (NULL if the generation failed)
+    /// </summary>
+    lineFeatureMatrix* Features = NULL;
+    /// <summary>
+    /// The seconds spent in the lineSample constructors
+    /// </summary>
+    double ConstructionSeconds = 0;
+    /// <summary>
+    /// The seconds spent building the lineFeatureMatrix of each batch
+    /// </summary>
+    double FeatureMatrixSeconds = 0;
+
+
+    /// <summary>
+    /// The constructor generates the line samples in batches and copies their features into the columns.
+    /// </summary>
+    /// <param name="numberOfSamples">The number of line samples</param>
+    /// <param name="numberOfOtherCurrents">The number of currents per node not counting the line current</param>
+    explicit benchmarkTrainingSet(int numberOfSamples, int numberOfOtherCurrents)
+    {
+        int numberOfFeatures = 4 + 2 * numberOfOtherCurrents;
+        int elementsPerAlignment = (int)(lineFeatureMatrix::ColumnAlignment() / sizeof(double));
+        int stride = (numberOfSamples + elementsPerAlignment - 1) / elementsPerAlignment * elementsPerAlignment;
+        values = (double*)::operator new[](2 * (size_t)numberOfFeatures * stride * sizeof(double),
+            align_val_t(lineFeatureMatrix::ColumnAlignment()), nothrow);
+        statuses = new (nothrow) bool[numberOfSamples];
+        if ((values == NULL) || (statuses == NULL)) {
+            cout << "Error: benchmarkTrainingSet() failed to allocate memory for the columns of " << to_string(numberOfSamples) <<
+                " line samples\n";
+            return;
+        }
+        memset(values, 0, 2 * (size_t)numberOfFeatures * stride * sizeof(double));
+
+        for (int firstSampleIndex = 0; firstSampleIndex < numberOfSamples; firstSampleIndex += samplesPerBatch) {
+            int numberOfSamplesInBatch = min(samplesPerBatch, numberOfSamples - firstSampleIndex);
+            vector<lineSample*> batch = BenchmarkRandomLineSamples(numberOfSamplesInBatch, numberOfOtherCurrents,
+                &ConstructionSeconds);
+            if (find(batch.begin(), batch.end(), (lineSample*)NULL) != batch.end()) {
+                cout << "Error: benchmarkTrainingSet() failed to allocate memory for the line samples\n";
+                BenchmarkFreeLineSamples(batch);
+                return;
+            }
+
+            chrono::steady_clock::time_point startTime = chrono::steady_clock::now();
+            lineFeatureMatrix batchFeatures(batch.data(), numberOfSamplesInBatch);
+            FeatureMatrixSeconds += SecondsSince(startTime);
+            for (int columnIndex = 0; columnIndex < 2 * numberOfFeatures; columnIndex++) {
+                const double* batchColumn = (columnIndex % 2 == 0) ? batchFeatures.RealColumn(columnIndex / 2) :
+                    batchFeatures.ImaginaryColumn(columnIndex / 2);
+                memcpy(values + (size_t)columnIndex * stride + firstSampleIndex, batchColumn, numberOfSamplesInBatch * sizeof(double));
+            }
+            for (int sampleIndex = 0; sampleIndex < numberOfSamplesInBatch; sampleIndex++) {
+                statuses[firstSampleIndex + sampleIndex] = batchFeatures.IsWorking(sampleIndex);
+            }
+
+            // Every batch has the same layout, so the first batch gives the weights and node numbers of the training set
+            if (firstSampleIndex == 0) {
+                Features = new lineFeatureMatrix(values, statuses, numberOfSamples, stride, batchFeatures.NumberOfNode1OtherCurrents,
+                    batchFeatures.NumberOfNode2OtherCurrents, batchFeatures.FeatureWeights, batchFeatures.StartNodeNumbers,
+                    batchFeatures.DestinationNodeNumbers, batchFeatures.TopologyKey);
+            }
+            BenchmarkFreeLineSamples(batch);
+        }
+    }
+
+    /// <summary>
+    /// The deconstructor
+    /// </summary>
+    ~benchmarkTrainingSet()
+    {
+        if (Features != NULL) delete Features;
+        if (values != NULL) ::operator delete[](values, align_val_t(lineFeatureMatrix::ColumnAlignment()));
+        if (statuses != NULL) delete[] statuses;
+    }
+};
+
+
+/// <summary>
+/// Append one measurement to the JSON results.
+/// </summary>
+/// <param name="results">The JSON objects of the measurements so far</param>
+/// <param name="name">The name of the measurement</param>
+/// <param name="fields">The names and values of the measurement's fields</param>
+void BenchmarkRecord(vector<string>& results, string name, const vector<pair<string, double>>& fields)
+{
+    ostringstream result;
+    result << setprecision(10) << "    {\"name\": \"" << name << "\"";
+    for (int fieldIndex = 0; fieldIndex < (int)fields.size(); fieldIndex++) {
+        result << ", \"" << fields[fieldIndex].first << "\": " << fields[fieldIndex].second;
+    }
+    result << "}";
+    results.push_back(result.str());
+
+    cout << name;
+    for (int fieldIndex = 0; fieldIndex < (int)fields.size(); fieldIndex++) {
+        cout << " " << fields[fieldIndex].first << "=" << fields[fieldIndex].second;
+    }
+    cout << "\n";
+}
+
+/// <summary>
+/// Time the index builds over a training set.
+/// </summary>
+/// <param name="results">The JSON results to append to</param>
+/// <param name="trainingSet">The training set</param>
+/// <param name="numberOfOtherCurrents">The number of currents per node not counting the line current</param>
+void BenchmarkIndexBuilds(vector<string>& results, benchmarkTrainingSet& trainingSet, int numberOfOtherCurrents)
+{
+    int numberOfSamples = trainingSet.Features->NumberOfSamples;
+
+    chrono::steady_clock::time_point startTime = chrono::steady_clock::now();
+    kdTreeIndex* kdTree = new kdTreeIndex(trainingSet.Features);
+    double kdTreeSeconds = SecondsSince(startTime);
+    if (kdTree != NULL) delete kdTree;
+    BenchmarkRecord(results, "kdTreeIndexBuild", { { "numberOfSamples", numberOfSamples },
+        { "numberOfOtherCurrents", numberOfOtherCurrents }, { "seconds", kdTreeSeconds },
+        { "samplesPerSecond", numberOfSamples / kdTreeSeconds } });
+
+    int numberOfLists = min(maximumNumberOfLists, (int)sqrt((double)numberOfSamples));
+    startTime = chrono::steady_clock::now();
+    ivfIndex* ivf = new ivfIndex(trainingSet.Features, numberOfLists);
+    double ivfSeconds = SecondsSince(startTime);
+    if (ivf != NULL) delete ivf;
+    BenchmarkRecord(results, "ivfIndexBuild", { { "numberOfSamples", numberOfSamples },
+        { "numberOfOtherCurrents", numberOfOtherCurrents }, { "numberOfLists", numberOfLists }, { "seconds", ivfSeconds },
+        { "samplesPerSecond", numberOfSamples / ivfSeconds } });
+}
+/// <summary>
+/// Time the single-query and batch predictions of unknown line samples against a training set.
+/// </summary>
+/// <param name="results">The JSON results to append to</param>
+/// <param name="trainingSet">The training set</param>
+/// <param name="numberOfOtherCurrents">The number of currents per node not counting the line current</param>
+/// <param name="numbersOfNearestNeighbors">The values of k</param>
+/// <param name="threadCounts">The thread counts of the single-query scans</param>
+/// <param name="maximumNumberOfQueries">The largest number of unknown line samples per measurement</param>
+void BenchmarkPredictions(vector<string>& results, benchmarkTrainingSet& trainingSet, int numberOfOtherCurrents,
+    const vector<int>& numbersOfNearestNeighbors, const vector<int>& threadCounts, int maximumNumberOfQueries)
+{
+    int numberOfSamples = trainingSet.Features->NumberOfSamples;
+
+    // Scan about 10^7 known line samples per measurement so the largest training sets still finish in seconds
+    int numberOfQueries = max(10, min(maximumNumberOfQueries, 10000000 / numberOfSamples));
+    vector<lineSample*> samplesWithUnknownStatuses = BenchmarkRandomLineSamples(numberOfQueries, numberOfOtherCurrents);
+    if (find(samplesWithUnknownStatuses.begin(), samplesWithUnknownStatuses.end(), (lineSample*)NULL) !=
+        samplesWithUnknownStatuses.end()) {
+        cout << "Error: BenchmarkPredictions() failed to allocate memory for the unknown line samples\n";
+        BenchmarkFreeLineSamples(samplesWithUnknownStatuses);
+        return;
+    }
+
+    for (int threadCountIndex = 0; threadCountIndex < (int)threadCounts.size(); threadCountIndex++) {
+        threadPool* pool = NULL;
+        if (threadCounts[threadCountIndex] > 1) pool = new threadPool(threadCounts[threadCountIndex]);
+
+        for (int kIndex = 0; kIndex < (int)numbersOfNearestNeighbors.size(); kIndex++) {
+            int numberOfNearestNeighbors = numbersOfNearestNeighbors[kIndex];
+            if (numberOfNearestNeighbors > numberOfSamples) continue;
+
+            vector<double> latencies(numberOfQueries);
+            chrono::steady_clock::time_point startTime = chrono::steady_clock::now();
+            for (int queryIndex = 0; queryIndex < numberOfQueries; queryIndex++) {
+                chrono::steady_clock::time_point queryStartTime = chrono::steady_clock::now();
+                knnPredictionOfUnknownLineSample singleKNN(trainingSet.Features, samplesWithUnknownStatuses[queryIndex],
+                    numberOfNearestNeighbors, pool);
+                latencies[queryIndex] = SecondsSince(queryStartTime);
+            }
+            double seconds = SecondsSince(startTime);
+            sort(latencies.begin(), latencies.end());
+
+            BenchmarkRecord(results, "singleQueryPrediction", { { "numberOfSamples", numberOfSamples },
+                { "numberOfOtherCurrents", numberOfOtherCurrents }, { "numberOfNearestNeighbors", numberOfNearestNeighbors },
+                { "numberOfThreads", threadCounts[threadCountIndex] }, { "numberOfQueries", numberOfQueries },
+                { "queriesPerSecond", numberOfQueries / seconds },
+                { "medianLatencySeconds", latencies[latencies.size() / 2] },
+                { "p99LatencySeconds", latencies[(latencies.size() * 99) / 100] } });
+        }
+        if (pool != NULL) delete pool;
+    }
+
+    for (int kIndex = 0; kIndex < (int)numbersOfNearestNeighbors.size(); kIndex++) {
+        int numberOfNearestNeighbors = numbersOfNearestNeighbors[kIndex];
+        if (numberOfNearestNeighbors > numberOfSamples) continue;
+
+        chrono::steady_clock::time_point startTime = chrono::steady_clock::now();
+        knnBatchPredictionOfUnknownLineSamples batchKNN(trainingSet.Features, numberOfNearestNeighbors);
+        vector<bool> predictedStatuses = batchKNN.PredictStatuses(samplesWithUnknownStatuses.data(), numberOfQueries);
+        double seconds = SecondsSince(startTime);
+
+        BenchmarkRecord(results, "batchPrediction", { { "numberOfSamples", numberOfSamples },
+            { "numberOfOtherCurrents", numberOfOtherCurrents }, { "numberOfNearestNeighbors", numberOfNearestNeighbors },
+            { "numberOfQueries", numberOfQueries }, { "queriesPerSecond", numberOfQueries / seconds } });
+    }
+
+    BenchmarkFreeLineSamples(samplesWithUnknownStatuses);
+}
+
+
+/// <summary>
+/// Time the compact scans with exact re-ranking against a training set and measure their recall.
+/// </summary>
+/// <param name="results">The JSON results to append to</param>
+/// <param name="trainingSet">The training set</param>
+/// <param name="numberOfOtherCurrents">The number of currents per node not counting the line current</param>
+/// <param name="maximumNumberOfQueries">The largest number of unknown line samples per measurement</param>
+void BenchmarkCompactScans(vector<string>& results, benchmarkTrainingSet& trainingSet, int numberOfOtherCurrents,
+    int maximumNumberOfQueries)
+{
+    int numberOfSamples = trainingSet.Features->NumberOfSamples;
+    int numberOfNearestNeighbors = min(5, numberOfSamples);
+    int numberOfQueries = max(10, min(maximumNumberOfQueries, 10000000 / numberOfSamples));
+    vector<lineSample*> samplesWithUnknownStatuses = BenchmarkRandomLineSamples(numberOfQueries, numberOfOtherCurrents);
+    if (find(samplesWithUnknownStatuses.begin(), samplesWithUnknownStatuses.end(), (lineSample*)NULL) !=
+        samplesWithUnknownStatuses.end()) {
+        cout << "Error: BenchmarkCompactScans() failed to allocate memory for the unknown line samples\n";
+        BenchmarkFreeLineSamples(samplesWithUnknownStatuses);
+        return;
+    }
+
+    featureStorage storages[2] = { featureStorage::Float32, featureStorage::Int8 };
+    for (int storageIndex = 0; storageIndex < 2; storageIndex++) {
+        chrono::steady_clock::time_point startTime = chrono::steady_clock::now();
+        compactFeatureIndex compactIndex(trainingSet.Features, storages[storageIndex]);
+        double buildSeconds = SecondsSince(startTime);
+
+        knnQueryEngine engine(&compactIndex, numberOfNearestNeighbors);
+        startTime = chrono::steady_clock::now();
+        for (int queryIndex = 0; queryIndex < numberOfQueries; queryIndex++) {
+            bool predictedStatus = true;
+            engine.PredictStatus(samplesWithUnknownStatuses[queryIndex], &predictedStatus);
+        }
+        double seconds = SecondsSince(startTime);
+        double recall = compactIndex.MeasureRecall(samplesWithUnknownStatuses.data(), min(numberOfQueries, 20),
+            numberOfNearestNeighbors);
+
+        BenchmarkRecord(results, storageIndex == 0 ? "float32ScanPrediction" : "int8ScanPrediction",
+            { { "numberOfSamples", numberOfSamples }, { "numberOfOtherCurrents", numberOfOtherCurrents },
+            { "numberOfNearestNeighbors", numberOfNearestNeighbors }, { "numberOfQueries", numberOfQueries },
+            { "buildSeconds", buildSeconds }, { "numberOfBytes", (double)compactIndex.NumberOfBytes() },
+            { "queriesPerSecond", numberOfQueries / seconds }, { "recall", recall } });
+    }
+
+    BenchmarkFreeLineSamples(samplesWithUnknownStatuses);
+}
+
+
+/// <summary>
+/// Read the value of an integer argument.
+/// </summary>
+/// <param name="argc">The number of arguments</param>
+/// <param name="argv">The arguments</param>
+/// <param name="name">The name of the argument</param>
+/// <param name="defaultValue">The value if the argument isn't given</param>
+/// <returns>The value of the argument</returns>
+long long BenchmarkArgument(int argc, char** argv, string name, long long defaultValue)
+{
+    for (int argumentIndex = 1; argumentIndex + 1 < argc; argumentIndex++) {
+        if (name == argv[argumentIndex]) return atoll(argv[argumentIndex + 1]);
+    }
+    return defaultValue;
+}
+
+
+int main(int argc, char** argv)
+{
+    long long maximumNumberOfSamples = BenchmarkArgument(argc, argv, "--max-samples", 10000000);
+    int maximumNumberOfQueries = (int)BenchmarkArgument(argc, argv, "--queries", 1000);
+    int maximumNumberOfThreads = (int)BenchmarkArgument(argc, argv, "--threads", max(1, (int)thread::hardware_concurrency()));
+    string outputPath = "knnBenchmark.json";
+    for (int argumentIndex = 1; argumentIndex + 1 < argc; argumentIndex++) {
+        if (string(argv[argumentIndex]) == "--output") outputPath = argv[argumentIndex + 1];
+    }
+
+    vector<int> numbersOfOtherCurrents = { 1, 3 };
+    vector<int> numbersOfNearestNeighbors = { 1, 5, 25 };
+    vector<int> threadCounts;
+    for (int numberOfThreads = 1; numberOfThreads <= maximumNumberOfThreads; numberOfThreads *= 2) threadCounts.push_back(numberOfThreads);
+    if (threadCounts.back() != maximumNumberOfThreads) threadCounts.push_back(maximumNumberOfThreads);
+
+    vector<string> results;
+    for (int currentsIndex = 0; currentsIndex < (int)numbersOfOtherCurrents.size(); currentsIndex++) {
+        int numberOfOtherCurrents = numbersOfOtherCurrents[currentsIndex];
+        for (long long numberOfSamples = 1000; numberOfSamples <= maximumNumberOfSamples; numberOfSamples *= 10) {
+            benchmarkTrainingSet trainingSet((int)numberOfSamples, numberOfOtherCurrents);
+            if (trainingSet.Features == NULL) break;
+
+            BenchmarkRecord(results, "lineSampleConstruction", { { "numberOfSamples", (double)numberOfSamples },
+                { "numberOfOtherCurrents", numberOfOtherCurrents }, { "seconds", trainingSet.ConstructionSeconds },
+                { "samplesPerSecond", numberOfSamples / trainingSet.ConstructionSeconds } });
+            BenchmarkRecord(results, "featureMatrixBuild", { { "numberOfSamples", (double)numberOfSamples },
+                { "numberOfOtherCurrents", numberOfOtherCurrents }, { "seconds", trainingSet.FeatureMatrixSeconds },
+                { "samplesPerSecond", numberOfSamples / trainingSet.FeatureMatrixSeconds } });
+            BenchmarkIndexBuilds(results, trainingSet, numberOfOtherCurrents);
+            BenchmarkPredictions(results, trainingSet, numberOfOtherCurrents, numbersOfNearestNeighbors, threadCounts,
+                maximumNumberOfQueries);
+            BenchmarkCompactScans(results, trainingSet, numberOfOtherCurrents, maximumNumberOfQueries);
+        }
+    }
+
+    ofstream output(outputPath);
+    if (output.is_open() == false) {
+        cout << "Error: knnBenchmark failed to open " << outputPath << "\n";
+        return 1;
+    }
+    output << "{\n  \"benchmark\": \"knnBenchmark\",\n  \"timeStamp\": " << to_string((long long)time(NULL)) <<
+        ",\n  \"numberOfHardwareThreads\": " << to_string(thread::hardware_concurrency()) << ",\n  \"results\": [\n";
+    for (int resultIndex = 0; resultIndex < (int)results.size(); resultIndex++) {
+        output << results[resultIndex] << ((resultIndex + 1 < (int)results.size()) ? ",\n" : "\n");
+    }
+    output << "  ]";
+    if (knnInstrumentation::IsEnabled() == true) output << ",\n  \"instrumentation\": " << knnInstrumentation::Snapshot().ToJson();
+    output << "\n}\n";
+    cout << "Wrote " << to_string(results.size()) << " results to " << outputPath << "\n";
+    return 0;
+}
@@ -0,0 +1,124 @@
+#define _USE_MATH_DEFINES
+
+using namespace std;
+
+#include <atomic>
+#include <cmath>
+#include <exception>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+#include "allocationCounter.h"
+#include "latencyHistogram.h"
+#include "knnInstrumentationSnapshot.h"
+#include "knnInstrumentation.h"
+
+
+/// <summary>
+/// The totals one thread has recorded. Only the owning thread writes them, so the atomics are only there for Snapshot() to read
+/// them from another thread and every access is relaxed.
+/// </summary>
+class knnThreadInstrumentation {
+public:
+    atomic<long long> BucketCounts[knnInstrumentationSnapshot::NumberOfStages][latencyHistogram::NumberOfBuckets] = {};
+    atomic<long long> StageCounts[knnInstrumentationSnapshot::NumberOfStages] = {};
+    atomic<long long> StageTotalNanoseconds[knnInstrumentationSnapshot::NumberOfStages] = {};
+    atomic<long long> StageMaximumNanoseconds[knnInstrumentationSnapshot::NumberOfStages] = {};
+    atomic<long long> StageAllocations[knnInstrumentationSnapshot::NumberOfStages] = {};
+    atomic<long long> Counters[knnInstrumentationSnapshot::NumberOfCounters] = {};
+};
+
+/// <summary>
+/// Add to a total only the calling thread writes.
+/// </summary>
+static inline void AddToTotal(atomic<long long>& total, long long amount)
+{
+    total.store(total.load(memory_order_relaxed) + amount, memory_order_relaxed);
+}
+
+/// <summary>
+/// The lock of the list of every thread's totals
+/// </summary>
+static mutex& RegistryMutex()
+{
+    static mutex registryMutex;
+    return registryMutex;
+}
+/// <summary>
+/// The totals of every thread that has recorded anything. The list keeps them after their thread finishes.
+/// </summary>
+static vector<shared_ptr<knnThreadInstrumentation>>& Registry()
+{
+    static vector<shared_ptr<knnThreadInstrumentation>> registry;
+    return registry;
+}
+/// <summary>
+/// The totals of the calling thread, registered on first use
+/// </summary>
+static knnThreadInstrumentation* ThisThread()
+{
+    thread_local shared_ptr<knnThreadInstrumentation> thisThread = NULL;
+    if (thisThread == NULL) {
+        thisThread = make_shared<knnThreadInstrumentation>();
+        lock_guard<mutex> lock(RegistryMutex());
+        Registry().push_back(thisThread);
+    }
+    return thisThread.get();
+}
+
+
+const bool knnInstrumentation::IsEnabled()
+{
+#ifdef KNN_INSTRUMENTATION
+    return true;
+#else
+    return false;
+#endif
+}
+
+const void knnInstrumentation::RecordStage(knnStage stage, long long nanoseconds, long long numberOfAllocations)
+{
+    knnThreadInstrumentation* thisThread = ThisThread();
+    int stageIndex = (int)stage;
+    AddToTotal(thisThread->BucketCounts[stageIndex][latencyHistogram::BucketIndex(nanoseconds)], 1);
+    AddToTotal(thisThread->StageCounts[stageIndex], 1);
+    AddToTotal(thisThread->StageTotalNanoseconds[stageIndex], nanoseconds);
+    AddToTotal(thisThread->StageAllocations[stageIndex], numberOfAllocations);
+    if (nanoseconds > thisThread->StageMaximumNanoseconds[stageIndex].load(memory_order_relaxed)) {
+        thisThread->StageMaximumNanoseconds[stageIndex].store(nanoseconds, memory_order_relaxed);
+    }
+}
+const void knnInstrumentation::Count(knnCounter counter, long long amount)
+{
+    AddToTotal(ThisThread()->Counters[(int)counter], amount);
+}
+
+const knnInstrumentationSnapshot knnInstrumentation::Snapshot()
+{
+    knnInstrumentationSnapshot snapshot;
+    snapshot.NumberOfAllocations = allocationCounter::NumberOfAllocations();
+
+    lock_guard<mutex> lock(RegistryMutex());
+    vector<shared_ptr<knnThreadInstrumentation>>& registry = Registry();
+    snapshot.NumberOfThreads = (int)registry.size();
+    for (int threadIndex = 0; threadIndex < (int)registry.size(); threadIndex++) {
+        knnThreadInstrumentation* thread = registry[threadIndex].get();
+        for (int stageIndex = 0; stageIndex < knnInstrumentationSnapshot::NumberOfStages; stageIndex++) {
+            latencyHistogram& latencies = snapshot.StageLatencies[stageIndex];
+            for (int bucketIndex = 0; bucketIndex < latencyHistogram::NumberOfBuckets; bucketIndex++) {
+                latencies.Counts[bucketIndex] += thread->BucketCounts[stageIndex][bucketIndex].load(memory_order_relaxed);
+            }
+            latencies.Count += thread->StageCounts[stageIndex].load(memory_order_relaxed);
+            latencies.TotalNanoseconds += thread->StageTotalNanoseconds[stageIndex].load(memory_order_relaxed);
+            long long maximumNanoseconds = thread->StageMaximumNanoseconds[stageIndex].load(memory_order_relaxed);
+            if (maximumNanoseconds > latencies.MaximumNanoseconds) latencies.MaximumNanoseconds = maximumNanoseconds;
+            snapshot.StageAllocations[stageIndex] += thread->StageAllocations[stageIndex].load(memory_order_relaxed);
+        }
+        for (int counterIndex = 0; counterIndex < knnInstrumentationSnapshot::NumberOfCounters; counterIndex++) {
+            snapshot.Counters[counterIndex] += thread->Counters[counterIndex].load(memory_order_relaxed);
+        }
+    }
+    return snapshot;
+}
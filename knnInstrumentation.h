@@ -0,0 +1,49 @@
+#pragma once
+
+#define _USE_MATH_DEFINES
+
+using namespace std;
+
+#include <cmath>
+#include <exception>
+#include <iostream>
+#include <string>
+#include "latencyHistogram.h"
+#include "knnInstrumentationSnapshot.h"
+
+
+/// <summary>
+/// The per-thread stage latencies, stage allocations, and counters of the KNN pipeline. The hot paths record through the
+/// KNN_TIME_STAGE and KNN_COUNT macros of knnStageTimer.h, which only expand to anything when KNN_INSTRUMENTATION is defined at
+/// compile time, and the allocations are only counted under the same switch (see allocationCounter), so the pipeline has no
+/// instrumentation cost otherwise. Each thread only writes its own totals, and Snapshot() adds every thread's totals together
+/// (including threads that have finished).
+/// </summary>
+class knnInstrumentation {
+public:
+    /// <summary>
+    /// True if the program was compiled with KNN_INSTRUMENTATION defined
+    /// </summary>
+    static const bool IsEnabled();
+
+    /// <summary>
+    /// Record one run of a stage on the calling thread.
+    /// </summary>
+    /// <param name="stage">The stage</param>
+    /// <param name="nanoseconds">The time the stage took</param>
+    /// <param name="numberOfAllocations">The heap allocations the calling thread made during the stage</param>
+    static const void RecordStage(knnStage stage, long long nanoseconds, long long numberOfAllocations);
+    /// <summary>
+    /// Add to a counter of the calling thread.
+    /// </summary>
+    /// <param name="counter">The counter</param>
+    /// <param name="amount">The amount to add</param>
+    static const void Count(knnCounter counter, long long amount);
+
+    /// <summary>
+    /// Add up what every thread has recorded so far. Take two snapshots and use knnInstrumentationSnapshot::Since() for what was
+    /// recorded between them.
+    /// </summary>
+    /// <returns>The snapshot</returns>
+    static const knnInstrumentationSnapshot Snapshot();
+};
@@ -0,0 +1,85 @@
+#define _USE_MATH_DEFINES
+
+using namespace std;
+
+#include <cmath>
+#include <exception>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include "latencyHistogram.h"
+#include "knnInstrumentationSnapshot.h"
+
+
+const string knnInstrumentationSnapshot::StageName(knnStage stage)
+{
+    if (stage == knnStage::LineSampleConstruction) return "lineSampleConstruction";
+    if (stage == knnStage::TopologyCheck) return "topologyCheck";
+    if (stage == knnStage::DistanceCalculation) return "distanceCalculation";
+    if (stage == knnStage::NeighborSelection) return "neighborSelection";
+    return "prediction";
+}
+const string knnInstrumentationSnapshot::CounterName(knnCounter counter)
+{
+    if (counter == knnCounter::Predictions) return "predictions";
+    if (counter == knnCounter::DistancesCalculated) return "distancesCalculated";
+    if (counter == knnCounter::NeighborsPushed) return "neighborsPushed";
+    if (counter == knnCounter::Scans) return "scans";
+    return "distancesAbandoned";
+}
+
+
+const latencyHistogram& knnInstrumentationSnapshot::Latencies(knnStage stage) const
+{
+    return StageLatencies[(int)stage];
+}
+const long long knnInstrumentationSnapshot::Counter(knnCounter counter) const
+{
+    return Counters[(int)counter];
+}
+const knnInstrumentationSnapshot knnInstrumentationSnapshot::Since(const knnInstrumentationSnapshot& earlier) const
+{
+    knnInstrumentationSnapshot difference = *this;
+    for (int stageIndex = 0; stageIndex < NumberOfStages; stageIndex++) {
+        difference.StageLatencies[stageIndex].Subtract(earlier.StageLatencies[stageIndex]);
+        difference.StageAllocations[stageIndex] -= earlier.StageAllocations[stageIndex];
+    }
+    for (int counterIndex = 0; counterIndex < NumberOfCounters; counterIndex++) {
+        difference.Counters[counterIndex] -= earlier.Counters[counterIndex];
+    }
+    difference.NumberOfAllocations -= earlier.NumberOfAllocations;
+    return difference;
+}
+
+
+const string knnInstrumentationSnapshot::ToJson() const
+{
+    ostringstream json;
+    json << "{\"numberOfThreads\": " << NumberOfThreads << ", \"numberOfAllocations\": " << NumberOfAllocations << ", \"stages\": {";
+    for (int stageIndex = 0; stageIndex < NumberOfStages; stageIndex++) {
+        const latencyHistogram& latencies = StageLatencies[stageIndex];
+        json << (stageIndex == 0 ? "" : ", ") << "\"" << StageName((knnStage)stageIndex) << "\": {\"count\": " << latencies.Count <<
+            ", \"meanNanoseconds\": " << latencies.MeanNanoseconds() << ", \"p50Nanoseconds\": " << latencies.Percentile(50) <<
+            ", \"p99Nanoseconds\": " << latencies.Percentile(99) << ", \"p999Nanoseconds\": " << latencies.Percentile(99.9) <<
+            ", \"maximumNanoseconds\": " << latencies.MaximumNanoseconds << ", \"allocations\": " << StageAllocations[stageIndex] << "}";
+    }
+    json << "}, \"counters\": {";
+    for (int counterIndex = 0; counterIndex < NumberOfCounters; counterIndex++) {
+        json << (counterIndex == 0 ? "" : ", ") << "\"" << CounterName((knnCounter)counterIndex) << "\": " << Counters[counterIndex];
+    }
+    json << "}}";
+    return json.str();
+}
+const void knnInstrumentationSnapshot::Print() const
+{
+    for (int stageIndex = 0; stageIndex < NumberOfStages; stageIndex++) {
+        const latencyHistogram& latencies = StageLatencies[stageIndex];
+        if (latencies.Count == 0) continue;
+        cout << StageName((knnStage)stageIndex) << ": " << to_string(latencies.Count) << " times, p50 " <<
+            to_string(latencies.Percentile(50)) << " ns, p99 " << to_string(latencies.Percentile(99)) << " ns, max " <<
+            to_string(latencies.MaximumNanoseconds) << " ns, " << to_string(StageAllocations[stageIndex]) << " allocations\n";
+    }
+    for (int counterIndex = 0; counterIndex < NumberOfCounters; counterIndex++) {
+        cout << CounterName((knnCounter)counterIndex) << ": " << to_string(Counters[counterIndex]) << "\n";
+    }
+}
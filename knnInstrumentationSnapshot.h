@@ -0,0 +1,136 @@
+#pragma once
+
+#define _USE_MATH_DEFINES
+
+using namespace std;
+
+#include <cmath>
+#include <exception>
+#include <iostream>
+#include <string>
+#include "latencyHistogram.h"
+
+
+/// <summary>
+/// The timed stages of the KNN pipeline. Prediction contains the other stages it runs, so the stage times overlap.
+/// </summary>
+enum class knnStage {
+    /// <summary>
+    /// A lineSample constructor normalizing the parameters of its nodes
+    /// </summary>
+    LineSampleConstruction,
+    /// <summary>
+    /// A check that a line sample is of the same line as the known line samples
+    /// </summary>
+    TopologyCheck,
+    /// <summary>
+    /// distanceSample::CalculateDistance() or one block of distanceKernel::SquaredDistances()
+    /// </summary>
+    DistanceCalculation,
+    /// <summary>
+    /// Keeping the nearest of a block of squared distances, partially sorting them, or merging heaps
+    /// </summary>
+    NeighborSelection,
+    /// <summary>
+    /// One scan of the known line samples for an unknown line sample
+    /// </summary>
+    Prediction
+};
+/// <summary>
+/// The counted events of the KNN pipeline
+/// </summary>
+enum class knnCounter {
+    /// <summary>
+    /// The line status predictions made
+    /// </summary>
+    Predictions,
+    /// <summary>
+    /// The squared distances calculated between known and unknown line samples
+    /// </summary>
+    DistancesCalculated,
+    /// <summary>
+    /// The nearest neighbors pushed into a heap
+    /// </summary>
+    NeighborsPushed,
+    /// <summary>
+    /// The scans of the known line samples
+    /// </summary>
+    Scans,
+    /// <summary>
+    /// The squared distances abandoned by distanceKernel::BoundedSquaredDistances() once their partial sum passed the k-th
+    /// nearest neighbor (also counted in DistancesCalculated)
+    /// </summary>
+    DistancesAbandoned
+};
+
+
+/// <summary>
+/// The totals of every thread's instrumentation at one moment from knnInstrumentation::Snapshot()
+/// </summary>
+class knnInstrumentationSnapshot {
+public:
+    /// <summary>
+    /// The number of values of knnStage
+    /// </summary>
+    static const int NumberOfStages = 5;
+    /// <summary>
+    /// The number of values of knnCounter
+    /// </summary>
+    static const int NumberOfCounters = 5;
+
+    /// <summary>
+    /// The latencies of each stage indexed by knnStage
+    /// </summary>
+    latencyHistogram StageLatencies[NumberOfStages];
+    /// <summary>
+    /// The heap allocations made inside each stage indexed by knnStage
+    /// </summary>
+    long long StageAllocations[NumberOfStages] = {};
+    /// <summary>
+    /// The value of each counter indexed by knnCounter
+    /// </summary>
+    long long Counters[NumberOfCounters] = {};
+    /// <summary>
+    /// The heap allocations of the whole program (see allocationCounter, 0 without KNN_INSTRUMENTATION)
+    /// </summary>
+    long long NumberOfAllocations = 0;
+    /// <summary>
+    /// The number of threads that recorded anything
+    /// </summary>
+    int NumberOfThreads = 0;
+
+
+    /// <summary>
+    /// The name of a stage
+    /// </summary>
+    static const string StageName(knnStage stage);
+    /// <summary>
+    /// The name of a counter
+    /// </summary>
+    static const string CounterName(knnCounter counter);
+
+    /// <summary>
+    /// The latencies of a stage
+    /// </summary>
+    const latencyHistogram& Latencies(knnStage stage) const;
+    /// <summary>
+    /// The value of a counter
+    /// </summary>
+    const long long Counter(knnCounter counter) const;
+    /// <summary>
+    /// What was recorded between an earlier snapshot and this one
+    /// </summary>
+    /// <param name="earlier">The earlier snapshot</param>
+    /// <returns>The snapshot of the difference</returns>
+    const knnInstrumentationSnapshot Since(const knnInstrumentationSnapshot& earlier) const;
+
+    /// <summary>
+    /// Write the snapshot as a JSON object.
+    /// </summary>
+    /// <returns>The JSON object</returns>
+    const string ToJson() const;
+    /// <summary>
+    /// Print the count, latency percentiles, and allocations of each stage and the counters.
+    /// </summary>
+    const void Print() const;
+};
@@ -2,6 +2,7 @@
 
 using namespace std;
 
+#include <algorithm>
 #include <cmath>
 #include <exception>
 #include <iostream>
@@ -10,93 +11,221 @@ using namespace std;
 #include "parameter.h"
 #include "nodeSample.h"
 #include "lineSample.h"
-#include "distanceSample.h"
+#include "lineFeatureMatrix.h"
+#include "distanceKernel.h"
+#include "nearestNeighbor.h"
+#include "nearestNeighborHeap.h"
+#include "threadPool.h"
+#include "nearestNeighborIndex.h"
+#include "knnPredictionResult.h"
+#include "allocationCounter.h"
+#include "latencyHistogram.h"
+#include "knnInstrumentationSnapshot.h"
+#include "knnInstrumentation.h"
+#include "knnStageTimer.h"
 #include "knnPredictionOfUnknownLineSample.h"
 
 
-const void knnPredictionOfUnknownLineSample::SetDistances()
+const bool knnPredictionOfUnknownLineSample::AllocateScan()
 {
-    if (numberOfNearestNeighbors > NumberOfKnownStatuses) {
-        cout << "Error: The number of nearest neighbors is larger than the number of known statuses.\n";
-        return;
+    if (unknownRealParts == NULL) {
+        unknownRealParts = new double[knownFeatures->NumberOfFeatures];
+        if (unknownRealParts == NULL) {
+            MemoryAllocationFailure("unknownRealParts");
+            return false;
+        }
     }
-
-    if (distances != NULL) {
-        for (int freeingIndex = 0; freeingIndex < numberOfNearestNeighbors; freeingIndex++) {
-            if (distances[freeingIndex] != NULL) {
-                delete distances[freeingIndex];
-                distances[freeingIndex] = NULL;
-            }
+    if (unknownImaginaryParts == NULL) {
+        unknownImaginaryParts = new double[knownFeatures->NumberOfFeatures];
+        if (unknownImaginaryParts == NULL) {
+            MemoryAllocationFailure("unknownImaginaryParts");
+            return false;
         }
-        delete[] distances;
-        distances = NULL;
     }
-
-    distances = new distanceSample * [numberOfNearestNeighbors];
     if (distances == NULL) {
-        MemoryAllocationFailure("distances");
-        return;
+        distances = new nearestNeighbor[numberOfCachedNeighbors];
+        if (distances == NULL) {
+            MemoryAllocationFailure("distances");
+            return false;
+        }
     }
-    for (int initializingIndex = 0; initializingIndex < numberOfNearestNeighbors; initializingIndex++) {
-        distances[initializingIndex] = NULL;
+
+    if (blockDistances == NULL) {
+        blockDistances = new double[knownSamplesPerBlock];
+        if (blockDistances == NULL) {
+            MemoryAllocationFailure("blockDistances");
+            return false;
+        }
     }
 
-    for (int knownSampleIndex = 0; knownSampleIndex < NumberOfKnownStatuses; knownSampleIndex++) {
-        // Special case where not all elements of distances are filled
-        if (knownSampleIndex < numberOfNearestNeighbors) {
-            distances[knownSampleIndex] = new distanceSample(SamplesWithKnownStatuses[knownSampleIndex], SampleWithUnknownStatus);
-            if (distances[knownSampleIndex] == NULL) {
-                MemoryAllocationFailure("distances[knownSampleIndex]");
-                return;
-            }
-            if (knownSampleIndex > 0) {
-                SortDistances(knownSampleIndex);
+    if ((numberOfCachedNeighbors <= heapSelectionLimit) || (index != NULL)) {
+        if (heap == NULL) {
+            heap = new nearestNeighborHeap(numberOfCachedNeighbors);
+            if (heap == NULL) {
+                MemoryAllocationFailure("heap");
+                return false;
             }
         }
+    }
+    else if (candidates == NULL) {
+        candidates = new nearestNeighbor[NumberOfKnownStatuses];
+        if (candidates == NULL) {
+            MemoryAllocationFailure("candidates");
+            return false;
+        }
+    }
 
-        else {
-            distanceSample* distanceAtKnownSampleIndex =
-                new distanceSample(SamplesWithKnownStatuses[knownSampleIndex], SampleWithUnknownStatus);
-            if (distanceAtKnownSampleIndex == NULL) {
-                MemoryAllocationFailure("distanceAtIndexI");
-                return;
+    if ((pool == NULL) || (numberOfChunks <= 1) || (index != NULL)) return true;
+    if (chunkBlockDistances == NULL) {
+        chunkBlockDistances = new double[numberOfChunks * knownSamplesPerBlock];
+        if (chunkBlockDistances == NULL) {
+            MemoryAllocationFailure("chunkBlockDistances");
+            return false;
+        }
+    }
+    if ((numberOfCachedNeighbors <= heapSelectionLimit) && (chunkHeaps == NULL)) {
+        chunkHeaps = new nearestNeighborHeap*[numberOfChunks];
+        if (chunkHeaps == NULL) {
+            MemoryAllocationFailure("chunkHeaps");
+            return false;
+        }
+        for (int chunkIndex = 0; chunkIndex < numberOfChunks; chunkIndex++) chunkHeaps[chunkIndex] = NULL;
+        for (int chunkIndex = 0; chunkIndex < numberOfChunks; chunkIndex++) {
+            chunkHeaps[chunkIndex] = new nearestNeighborHeap(numberOfCachedNeighbors);
+            if (chunkHeaps[chunkIndex] == NULL) {
+                MemoryAllocationFailure("chunkHeaps[chunkIndex]");
+                return false;
             }
+        }
+    }
+    return true;
+}
+const void knnPredictionOfUnknownLineSample::SetDistances(int numberOfCachedNeighbors)
+{
+    KNN_TIME_STAGE(knnStage::Prediction);
+    this->numberOfCachedNeighbors = max(numberOfNearestNeighbors, numberOfCachedNeighbors);
+    if ((knownFeatures == NULL) || (NumberOfKnownStatuses == 0)) {
+        cout << "Error: There are no known statuses to compare to.\n";
+        FreeNearestNeighbors();
+        return;
+    }
+    if (this->numberOfCachedNeighbors > NumberOfKnownStatuses) {
+        cout << "Error: The number of nearest neighbors is larger than the number of known statuses.\n";
+        FreeNearestNeighbors();
+        return;
+    }
+    if (knownFeatures->IsSampleOfTheSameLine(SampleWithUnknownStatus) == false) {
+        cout << "Error: The line sample with an unknown status is not a sample of the same line as the known line samples.\n";
+        FreeNearestNeighbors();
+        return;
+    }
 
-            if (distanceAtKnownSampleIndex->Distance < distances[numberOfNearestNeighbors - 1]->Distance) {
-                delete distances[numberOfNearestNeighbors - 1];
-                distances[numberOfNearestNeighbors - 1] = distanceAtKnownSampleIndex;
-                distanceAtKnownSampleIndex = NULL;
-                SortDistances(knownSampleIndex);
-            }
-            else {
-                delete distanceAtKnownSampleIndex;
-                distanceAtKnownSampleIndex = NULL;
-            }
+    if (AllocateScan() == false) return;
+    knownFeatures->ExtractFeatures(SampleWithUnknownStatus, unknownRealParts, unknownImaginaryParts);
+
+    if (index != NULL) SelectWithIndex();
+    else if (this->numberOfCachedNeighbors <= heapSelectionLimit) SelectWithHeap();
+    else SelectWithPartialSort();
+    numberOfScans++;
+    KNN_COUNT(knnCounter::Scans, 1);
+}
+const void knnPredictionOfUnknownLineSample::SetNumberOfChunks()
+{
+    int numberOfBlocks = (NumberOfKnownStatuses + knownSamplesPerBlock - 1) / knownSamplesPerBlock;
+    numberOfChunks = 1;
+    if (pool != NULL) numberOfChunks = pool->NumberOfThreads() * chunksPerThread;
+    if (numberOfChunks > numberOfBlocks) numberOfChunks = numberOfBlocks;
+    if (numberOfChunks < 1) numberOfChunks = 1;
+}
+const int knnPredictionOfUnknownLineSample::FirstBlockOfChunk(int chunkIndex)
+{
+    int numberOfBlocks = (NumberOfKnownStatuses + knownSamplesPerBlock - 1) / knownSamplesPerBlock;
+    return (int)((long long)numberOfBlocks * chunkIndex / numberOfChunks);
+}
+const void knnPredictionOfUnknownLineSample::ScanBlocks(int firstBlockIndex, int lastBlockIndex, nearestNeighborHeap* blockHeap,
+    double* squaredDistances)
+{
+    blockHeap->Clear();
+    for (int blockIndex = firstBlockIndex; blockIndex < lastBlockIndex; blockIndex++) {
+        int firstKnownIndex = blockIndex * knownSamplesPerBlock;
+        int numberOfKnownsInBlock = knownSamplesPerBlock;
+        if (NumberOfKnownStatuses - firstKnownIndex < knownSamplesPerBlock) {
+            numberOfKnownsInBlock = NumberOfKnownStatuses - firstKnownIndex;
+        }
+
+        distanceKernel::BoundedSquaredDistances(knownFeatures, firstKnownIndex, numberOfKnownsInBlock,
+            unknownRealParts, unknownImaginaryParts, blockHeap->WorstSquaredDistance(), squaredDistances);
+        KNN_TIME_STAGE(knnStage::NeighborSelection);
+        for (int sampleIndex = 0; sampleIndex < numberOfKnownsInBlock; sampleIndex++) {
+            if (squaredDistances[sampleIndex] > blockHeap->WorstSquaredDistance()) continue;
+            blockHeap->Push(squaredDistances[sampleIndex], firstKnownIndex + sampleIndex,
+                knownFeatures->IsWorking(firstKnownIndex + sampleIndex));
         }
     }
 }
-const void knnPredictionOfUnknownLineSample::SortDistances(int knownSampleIndex) {
-    // Place the new entry on the proper place on the array
-    int lastNearestNeighborIndex = numberOfNearestNeighbors - 1;
-    if (knownSampleIndex < numberOfNearestNeighbors - 1) lastNearestNeighborIndex = knownSampleIndex;
+const void knnPredictionOfUnknownLineSample::ScoreBlocks(int firstBlockIndex, int lastBlockIndex, double* squaredDistances)
+{
+    for (int blockIndex = firstBlockIndex; blockIndex < lastBlockIndex; blockIndex++) {
+        int firstKnownIndex = blockIndex * knownSamplesPerBlock;
+        int numberOfKnownsInBlock = knownSamplesPerBlock;
+        if (NumberOfKnownStatuses - firstKnownIndex < knownSamplesPerBlock) {
+            numberOfKnownsInBlock = NumberOfKnownStatuses - firstKnownIndex;
+        }
 
-    for (int nearestNeighborsIndex = lastNearestNeighborIndex; nearestNeighborsIndex > 0; nearestNeighborsIndex--) {
-        // If the distance is less than it's predescesor, swap their positions
-        if (distances[nearestNeighborsIndex]->Distance < distances[nearestNeighborsIndex - 1]->Distance) {
-            distanceSample* dummy = new distanceSample(SamplesWithKnownStatuses[knownSampleIndex], SampleWithUnknownStatus);
-            *dummy = *distances[nearestNeighborsIndex - 1];
-            *distances[nearestNeighborsIndex - 1] = *distances[nearestNeighborsIndex];
-            *distances[nearestNeighborsIndex] = *dummy;
-            delete dummy; dummy = NULL;
+        distanceKernel::SquaredDistances(knownFeatures, firstKnownIndex, numberOfKnownsInBlock,
+            unknownRealParts, unknownImaginaryParts, squaredDistances);
+        for (int sampleIndex = 0; sampleIndex < numberOfKnownsInBlock; sampleIndex++) {
+            candidates[firstKnownIndex + sampleIndex].SquaredDistance = squaredDistances[sampleIndex];
+            candidates[firstKnownIndex + sampleIndex].Index = firstKnownIndex + sampleIndex;
+            candidates[firstKnownIndex + sampleIndex].IsWorking = knownFeatures->IsWorking(firstKnownIndex + sampleIndex);
         }
     }
 }
+const void knnPredictionOfUnknownLineSample::SelectWithHeap()
+{
+    if ((pool == NULL) || (numberOfChunks <= 1)) ScanBlocks(0, FirstBlockOfChunk(numberOfChunks), heap, blockDistances);
+    else {
+        pool->ParallelFor(numberOfChunks, [&](int chunkIndex) {
+            ScanBlocks(FirstBlockOfChunk(chunkIndex), FirstBlockOfChunk(chunkIndex + 1), chunkHeaps[chunkIndex],
+                chunkBlockDistances + chunkIndex * knownSamplesPerBlock);
+        });
+
+        KNN_TIME_STAGE(knnStage::NeighborSelection);
+        heap->Clear();
+        for (int chunkIndex = 0; chunkIndex < numberOfChunks; chunkIndex++) heap->PushAll(chunkHeaps[chunkIndex]);
+    }
+    heap->CopySorted(distances);
+}
+const void knnPredictionOfUnknownLineSample::SelectWithIndex()
+{
+    index->Search(unknownRealParts, unknownImaginaryParts, heap);
+    heap->CopySorted(distances);
+}
+const void knnPredictionOfUnknownLineSample::SelectWithPartialSort()
+{
+    if ((pool == NULL) || (numberOfChunks <= 1)) ScoreBlocks(0, FirstBlockOfChunk(numberOfChunks), blockDistances);
+    else {
+        pool->ParallelFor(numberOfChunks, [&](int chunkIndex) {
+            ScoreBlocks(FirstBlockOfChunk(chunkIndex), FirstBlockOfChunk(chunkIndex + 1),
+                chunkBlockDistances + chunkIndex * knownSamplesPerBlock);
+        });
+    }
+
+    KNN_TIME_STAGE(knnStage::NeighborSelection);
+    nearestNeighborHeap::SelectNearest(candidates, NumberOfKnownStatuses, numberOfCachedNeighbors);
+    for (int nearestNeighborIndex = 0; nearestNeighborIndex < numberOfCachedNeighbors; nearestNeighborIndex++) {
+        distances[nearestNeighborIndex] = candidates[nearestNeighborIndex];
+    }
+}
 const bool knnPredictionOfUnknownLineSample::PredictStatus() {
+    if (distances == NULL) return false;
+    KNN_COUNT(knnCounter::Predictions, 1);
+
     int numOfWorkingLines = 0;
     int numOfNotWorkingLines = 0;
 
     for (int nearestNeighborIndex = 0; nearestNeighborIndex < numberOfNearestNeighbors; nearestNeighborIndex++) {
-        if (distances[nearestNeighborIndex]->IsWorking == true) numOfWorkingLines += 1;
+        if (distances[nearestNeighborIndex].IsWorking == true) numOfWorkingLines += 1;
         else numOfNotWorkingLines += 1;
     }
 
@@ -106,34 +235,103 @@ const bool knnPredictionOfUnknownLineSample::PredictStatus() {
 
 
 const void knnPredictionOfUnknownLineSample::FreeMemory()
+{
+    FreeNearestNeighbors();
+    if (unknownRealParts != NULL) {
+        delete[] unknownRealParts;
+        unknownRealParts = NULL;
+    }
+    if (unknownImaginaryParts != NULL) {
+        delete[] unknownImaginaryParts;
+        unknownImaginaryParts = NULL;
+    }
+    if (blockDistances != NULL) {
+        delete[] blockDistances;
+        blockDistances = NULL;
+    }
+    if (chunkBlockDistances != NULL) {
+        delete[] chunkBlockDistances;
+        chunkBlockDistances = NULL;
+    }
+}
+const void knnPredictionOfUnknownLineSample::FreeNearestNeighbors()
 {
     if (distances != NULL) {
-        for (int freeingIndex = 0; freeingIndex < numberOfNearestNeighbors; freeingIndex++) {
-            if (distances[freeingIndex] != NULL) {
-                delete distances[freeingIndex];
-                distances[freeingIndex] = NULL;
-            }
-        }
         delete[] distances;
         distances = NULL;
     }
+    if (heap != NULL) {
+        delete heap;
+        heap = NULL;
+    }
+    if (candidates != NULL) {
+        delete[] candidates;
+        candidates = NULL;
+    }
+    if (chunkHeaps != NULL) {
+        for (int chunkIndex = 0; chunkIndex < numberOfChunks; chunkIndex++) {
+            if (chunkHeaps[chunkIndex] != NULL) {
+                delete chunkHeaps[chunkIndex];
+                chunkHeaps[chunkIndex] = NULL;
+            }
+        }
+        delete[] chunkHeaps;
+        chunkHeaps = NULL;
+    }
+    numberOfCachedNeighbors = 0;
 }
 
 const void knnPredictionOfUnknownLineSample::MemoryAllocationFailure(string variableName)
 {
-    cout << "Error: node() failed to allocate memory for " << variableName << "\n";
+    cout << "Error: knnPredictionOfUnknownLineSample() failed to allocate memory for " << variableName << "\n";
     FreeMemory();
 }
 
 
 
 knnPredictionOfUnknownLineSample::knnPredictionOfUnknownLineSample(lineSample** samplesWithKnownStatuses, int numberOfKnownStatuses,
-    lineSample* sampleWithUnknownStatus, int numberOfNearestNeighbors)
+    lineSample* sampleWithUnknownStatus, int numberOfNearestNeighbors, threadPool* pool)
 {
     SamplesWithKnownStatuses = samplesWithKnownStatuses;
-    NumberOfKnownStatuses = numberOfKnownStatuses;
     SampleWithUnknownStatus = sampleWithUnknownStatus;
     this->numberOfNearestNeighbors = numberOfNearestNeighbors;
+    this->pool = pool;
+
+    knownFeatures = new lineFeatureMatrix(samplesWithKnownStatuses, numberOfKnownStatuses);
+    if (knownFeatures == NULL) {
+        MemoryAllocationFailure("knownFeatures");
+        return;
+    }
+    ownsKnownFeatures = true;
+    NumberOfKnownStatuses = knownFeatures->NumberOfSamples;
+    SetNumberOfChunks();
+
+    SetDistances();
+    PredictedStatus = PredictStatus();
+}
+knnPredictionOfUnknownLineSample::knnPredictionOfUnknownLineSample(lineFeatureMatrix* knownFeatures,
+    lineSample* sampleWithUnknownStatus, int numberOfNearestNeighbors, threadPool* pool)
+{
+    this->knownFeatures = knownFeatures;
+    if (knownFeatures != NULL) NumberOfKnownStatuses = knownFeatures->NumberOfSamples;
+    SampleWithUnknownStatus = sampleWithUnknownStatus;
+    this->numberOfNearestNeighbors = numberOfNearestNeighbors;
+    this->pool = pool;
+    SetNumberOfChunks();
+
+    SetDistances();
+    PredictedStatus = PredictStatus();
+}
+
+knnPredictionOfUnknownLineSample::knnPredictionOfUnknownLineSample(nearestNeighborIndex* index,
+    lineSample* sampleWithUnknownStatus, int numberOfNearestNeighbors)
+{
+    this->index = index;
+    if (index != NULL) knownFeatures = index->Features();
+    if (knownFeatures != NULL) NumberOfKnownStatuses = knownFeatures->NumberOfSamples;
+    SampleWithUnknownStatus = sampleWithUnknownStatus;
+    this->numberOfNearestNeighbors = numberOfNearestNeighbors;
+
     SetDistances();
     PredictedStatus = PredictStatus();
 }
@@ -141,23 +339,49 @@ knnPredictionOfUnknownLineSample::knnPredictionOfUnknownLineSample(lineSample**
 knnPredictionOfUnknownLineSample::~knnPredictionOfUnknownLineSample()
 {
     FreeMemory();
+    if ((ownsKnownFeatures == true) && (knownFeatures != NULL)) {
+        delete knownFeatures;
+        knownFeatures = NULL;
+    }
 }
 
 
 const void knnPredictionOfUnknownLineSample::ChangeNumberOfNearestNeighbors(int numberOfNearestNeighbors)
 {
-    // Don't bother recalculating if the number of nearest neighbors won't change.
-    if (this->numberOfNearestNeighbors == numberOfNearestNeighbors) return;
-
+    // The cached neighbors are sorted, so the k nearest of a smaller k are the first k of them without scanning again.
     this->numberOfNearestNeighbors = numberOfNearestNeighbors;
-    SetDistances();
+    if ((distances == NULL) || (numberOfNearestNeighbors > numberOfCachedNeighbors)) {
+        // The arrays are sized by the old number of cached neighbors
+        FreeNearestNeighbors();
+        SetDistances();
+    }
+    PredictedStatus = PredictStatus();
+}
+const void knnPredictionOfUnknownLineSample::CacheNearestNeighbors(int maximumNumberOfNearestNeighbors)
+{
+    if ((distances != NULL) && (maximumNumberOfNearestNeighbors <= numberOfCachedNeighbors)) return;
+
+    FreeNearestNeighbors();
+    SetDistances(maximumNumberOfNearestNeighbors);
+    PredictedStatus = PredictStatus();
+}
+
+const int knnPredictionOfUnknownLineSample::NumberOfScans() const
+{
+    return numberOfScans;
+}
+const knnPredictionResult knnPredictionOfUnknownLineSample::Result() const
+{
+    if (distances == NULL) return knnPredictionResult();
+    return knnPredictionResult(distances, numberOfNearestNeighbors);
 }
 
 
 const void knnPredictionOfUnknownLineSample::Print()
 {
     cout << "\nKNN Algorithm:\n";
-    for (int i = 0; i < numberOfNearestNeighbors; i++) cout << "distances[" << to_string(i) << "] distance: " <<
-        to_string(distances[i]->Distance) << "\n";
+    if (index != NULL) cout << "Index: " << index->Name() << "\n";
+    if (distances != NULL) for (int i = 0; i < numberOfNearestNeighbors; i++) cout << "distances[" << to_string(i) <<
+        "] distance: " << to_string(sqrt(distances[i].SquaredDistance)) << "\n";
     cout << "Line Status Prediction: " << to_string(PredictedStatus) << "\n";
 }
\ No newline at end of file
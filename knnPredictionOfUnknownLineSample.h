@@ -12,7 +12,13 @@ using namespace std;
 #include "parameter.h"
 #include "nodeSample.h"
 #include "lineSample.h"
-#include "distanceSample.h"
+#include "lineFeatureMatrix.h"
+#include "distanceKernel.h"
+#include "nearestNeighbor.h"
+#include "nearestNeighborHeap.h"
+#include "threadPool.h"
+#include "nearestNeighborIndex.h"
+#include "knnPredictionResult.h"
 
 
 /// <summary>
@@ -21,24 +27,136 @@ using namespace std;
 class knnPredictionOfUnknownLineSample {
 private:
     /// <summary>
-    /// An array containing the k closest line samples and their distances with the closest having the lowest index
+    /// The number of known line samples scored together by distanceKernel
     /// </summary>
-    distanceSample** distances = NULL;
+    const int knownSamplesPerBlock = 256;
+    /// <summary>
+    /// The largest number of nearest neighbors kept in a heap during the scan. Larger values score every known line sample first
+    /// and partially sort them instead.
+    /// </summary>
+    const int heapSelectionLimit = 64;
+    /// <summary>
+    /// The number of chunks per thread the known line samples are split into when scanning in parallel
+    /// </summary>
+    const int chunksPerThread = 4;
+    /// <summary>
+    /// An array containing the numberOfCachedNeighbors closest line samples and their squared distances with the closest having the
+    /// lowest index
+    /// </summary>
+    nearestNeighbor* distances = NULL;
     /// <summary>
     /// The number of nearest neighbors to consider
     /// </summary>
     int numberOfNearestNeighbors = 5;
+    /// <summary>
+    /// The number of nearest neighbors the last scan kept (at least numberOfNearestNeighbors), so any k up to it is answered from
+    /// 'distances'
+    /// </summary>
+    int numberOfCachedNeighbors = 0;
+    /// <summary>
+    /// The number of times the known line samples were scanned
+    /// </summary>
+    int numberOfScans = 0;
+    /// <summary>
+    /// The normalized parameters of the line samples with a known line status
+    /// </summary>
+    lineFeatureMatrix* knownFeatures = NULL;
+    /// <summary>
+    /// True if knownFeatures was built by the constructor and is freed with this class
+    /// </summary>
+    bool ownsKnownFeatures = false;
+    /// <summary>
+    /// The real parts of the features of the unknown line sample
+    /// </summary>
+    double* unknownRealParts = NULL;
+    /// <summary>
+    /// The imaginary parts of the features of the unknown line sample
+    /// </summary>
+    double* unknownImaginaryParts = NULL;
+    /// <summary>
+    /// The squared distances of the block of known line samples currently being scored
+    /// </summary>
+    double* blockDistances = NULL;
+    /// <summary>
+    /// The bounded max heap of the nearest neighbors found so far
+    /// </summary>
+    nearestNeighborHeap* heap = NULL;
+    /// <summary>
+    /// Every known line sample's squared distance when the number of nearest neighbors is above heapSelectionLimit
+    /// </summary>
+    nearestNeighbor* candidates = NULL;
+    /// <summary>
+    /// The threads that scan the known line samples in parallel (NULL scans on the calling thread)
+    /// </summary>
+    threadPool* pool = NULL;
+    /// <summary>
+    /// The number of chunks the known line samples are split into
+    /// </summary>
+    int numberOfChunks = 1;
+    /// <summary>
+    /// The nearest neighbors each chunk found when scanning in parallel
+    /// </summary>
+    nearestNeighborHeap** chunkHeaps = NULL;
+    /// <summary>
+    /// The squared distances of the block currently being scored by each chunk (numberOfChunks * knownSamplesPerBlock elements)
+    /// </summary>
+    double* chunkBlockDistances = NULL;
+    /// <summary>
+    /// The search structure used in place of the brute force scan (NULL scans every known line sample)
+    /// </summary>
+    nearestNeighborIndex* index = NULL;
 
 
     /// <summary>
-    /// Create the pointer array of distances.
+    /// Allocate the arrays the scan needs for the number of cached neighbors.
     /// </summary>
-    const void SetDistances();
+    /// <returns>True if the memory allocation succeeded</returns>
+    const bool AllocateScan();
     /// <summary>
-    /// Sorts the array of distances when a new distance is added to the tail end of the list
+    /// Scan the known line samples and keep the nearest in the array of distances.
     /// </summary>
-    /// <param name="knownSampleIndex">The index of the knowns the constructor is currently at</param>
-    const void SortDistances(int knownSampleIndex);
+    /// <param name="numberOfCachedNeighbors">The number of nearest neighbors to keep (raised to numberOfNearestNeighbors)</param>
+    const void SetDistances(int numberOfCachedNeighbors = 0);
+    /// <summary>
+    /// Split the known line samples into chunks for the thread pool.
+    /// </summary>
+    const void SetNumberOfChunks();
+    /// <summary>
+    /// The first block of known line samples a chunk scans. The chunks contain whole blocks so every known line sample is scored
+    /// by the same distanceKernel lanes no matter how many chunks there are.
+    /// </summary>
+    /// <param name="chunkIndex">The index of the chunk (numberOfChunks gives the end of the last chunk)</param>
+    /// <returns>The index of the first block of the chunk</returns>
+    const int FirstBlockOfChunk(int chunkIndex);
+    /// <summary>
+    /// Score a range of blocks of known line samples and keep the nearest in a heap.
+    /// </summary>
+    /// <param name="firstBlockIndex">The index of the first block</param>
+    /// <param name="lastBlockIndex">The index after the last block</param>
+    /// <param name="blockHeap">The heap to keep the nearest neighbors in</param>
+    /// <param name="squaredDistances">The scratch space for one block of squared distances</param>
+    const void ScanBlocks(int firstBlockIndex, int lastBlockIndex, nearestNeighborHeap* blockHeap, double* squaredDistances);
+    /// <summary>
+    /// Score a range of blocks of known line samples into the candidate array.
+    /// </summary>
+    /// <param name="firstBlockIndex">The index of the first block</param>
+    /// <param name="lastBlockIndex">The index after the last block</param>
+    /// <param name="squaredDistances">The scratch space for one block of squared distances</param>
+    const void ScoreBlocks(int firstBlockIndex, int lastBlockIndex, double* squaredDistances);
+    /// <summary>
+    /// Keep the k nearest known line samples with the heap while scoring the known line samples in blocks. In parallel each chunk
+    /// keeps its own heap and the chunk heaps are merged at the end, which gives the same neighbors as the serial scan because
+    /// ties are broken by the known line sample index.
+    /// </summary>
+    const void SelectWithHeap();
+    /// <summary>
+    /// Keep the k nearest known line samples found by the index.
+    /// </summary>
+    const void SelectWithIndex();
+    /// <summary>
+    /// Score every known line sample and keep the k nearest by partially sorting them.
+    /// </summary>
+    const void SelectWithPartialSort();
     /// <summary>
     /// Predicts the line status of the unknown line sample. It will return false in the case of a tie, but k is usually odd and
     /// the statuses of the nearest neighbors are unanimous in virtually every case.
@@ -47,9 +165,14 @@ private:
     const bool PredictStatus();
 
     /// <summary>
-    /// Free the dynamically allocated memory and set their pointers to NULL. Notice that only distanceSample** distances is freed.
+    /// Free the dynamically allocated memory and set their pointers to NULL. Notice that the line samples aren't freed and
+    /// knownFeatures is only freed if this class built it.
     /// </summary>
     const void FreeMemory();
+    /// <summary>
+    /// Free the arrays sized by the number of cached neighbors.
+    /// </summary>
+    const void FreeNearestNeighbors();
 
     /// <summary>
     /// Display an error message and call FreeMemory().
@@ -60,7 +183,7 @@ private:
 
 public:
     /// <summary>
-    /// The array of line samples with a known line status
+    /// The array of line samples with a known line status (NULL when constructed from a feature matrix)
     /// </summary>
     lineSample** SamplesWithKnownStatuses = NULL;
     /// <summary>
@@ -85,8 +208,29 @@ public:
     /// <param name="sampleWithUnknownStatus">A line sample with an unknown line status</param>
     /// <param name="numberOfNearestNeighbors">
     /// The number of nearest neighbors the unknown sample is compared to for the prediction</param>
+    /// <param name="pool">The threads to scan the known line samples with (NULL scans on the calling thread)</param>
     explicit knnPredictionOfUnknownLineSample(lineSample** samplesWithKnownStatuses, int numberOfKnownStatuses,
-        lineSample* sampleWithUnknownStatus, int numberOfNearestNeighbors = 5);
+        lineSample* sampleWithUnknownStatus, int numberOfNearestNeighbors = 5, threadPool* pool = NULL);
+    /// <summary>
+    /// This constructor uses a previously built feature matrix that won't be freed on the deconstructor.
+    /// </summary>
+    /// <param name="knownFeatures">The feature matrix of the line samples with known line statuses</param>
+    /// <param name="sampleWithUnknownStatus">A line sample with an unknown line status</param>
+    /// <param name="numberOfNearestNeighbors">
+    /// The number of nearest neighbors the unknown sample is compared to for the prediction</param>
+    /// <param name="pool">The threads to scan the known line samples with (NULL scans on the calling thread)</param>
+    explicit knnPredictionOfUnknownLineSample(lineFeatureMatrix* knownFeatures, lineSample* sampleWithUnknownStatus,
+        int numberOfNearestNeighbors = 5, threadPool* pool = NULL);
+    /// <summary>
+    /// This constructor searches a previously built index (like kdTreeIndex) instead of scanning every known line sample. The index
+    /// and its feature matrix won't be freed on the deconstructor.
+    /// </summary>
+    /// <param name="index">The index over the feature matrix of the line samples with known line statuses</param>
+    /// <param name="sampleWithUnknownStatus">A line sample with an unknown line status</param>
+    /// <param name="numberOfNearestNeighbors">
+    /// The number of nearest neighbors the unknown sample is compared to for the prediction</param>
+    explicit knnPredictionOfUnknownLineSample(nearestNeighborIndex* index, lineSample* sampleWithUnknownStatus,
+        int numberOfNearestNeighbors = 5);
 
     /// <summary>
     /// The deconstructor
@@ -95,12 +239,28 @@ public:
 
 
     /// <summary>
-    /// Change the number of nearest neighbors and recalculate the nearest neighbors.
+    /// Change the number of nearest neighbors and predict the status again. The known line samples are only scanned again if the
+    /// new number is more than the cached neighbors.
     /// </summary>
     /// <param name="numberOfNearestNeighbors">The new number of nearest neighbors</param>
     const void ChangeNumberOfNearestNeighbors(int numberOfNearestNeighbors);
-    
-    
+    /// <summary>
+    /// Scan once for the nearest neighbors of the largest k a sweep will try, so ChangeNumberOfNearestNeighbors() answers every
+    /// k up to it without scanning.
+    /// </summary>
+    /// <param name="maximumNumberOfNearestNeighbors">The largest number of nearest neighbors</param>
+    const void CacheNearestNeighbors(int maximumNumberOfNearestNeighbors);
+    /// <summary>
+    /// The number of times the known line samples were scanned
+    /// </summary>
+    const int NumberOfScans() const;
+    /// <summary>
+    /// Score the prediction from the nearest neighbors it was made from without scanning again.
+    /// </summary>
+    /// <returns>The prediction with its vote fractions, nearest distance, and neighbor indices</returns>
+    const knnPredictionResult Result() const;
+
+
     /// <summary>
     /// Print the distances of the nearest neighbors and the line status prediction.
     /// </summary>
@@ -0,0 +1,58 @@
+#define _USE_MATH_DEFINES
+
+using namespace std;
+
+#include <cmath>
+#include <exception>
+#include <iostream>
+#include <string>
+#include <vector>
+#include "nearestNeighbor.h"
+#include "knnPredictionResult.h"
+
+
+knnPredictionResult::knnPredictionResult(const nearestNeighbor* nearestNeighbors, int numberOfNearestNeighbors)
+{
+    if ((nearestNeighbors == NULL) || (numberOfNearestNeighbors <= 0)) return;
+    NumberOfNearestNeighbors = numberOfNearestNeighbors;
+
+    int numOfWorkingLines = 0;
+    int numOfExactMatches = 0;
+    int numOfWorkingExactMatches = 0;
+    double totalWeight = 0;
+    double workingWeight = 0;
+    NeighborIndices.resize(numberOfNearestNeighbors);
+    for (int nearestNeighborIndex = 0; nearestNeighborIndex < numberOfNearestNeighbors; nearestNeighborIndex++) {
+        const nearestNeighbor& neighbor = nearestNeighbors[nearestNeighborIndex];
+        NeighborIndices[nearestNeighborIndex] = neighbor.Index;
+        if (neighbor.IsWorking == true) numOfWorkingLines += 1;
+
+        double distance = sqrt(neighbor.SquaredDistance);
+        if (distance == 0) {
+            numOfExactMatches += 1;
+            if (neighbor.IsWorking == true) numOfWorkingExactMatches += 1;
+            continue;
+        }
+        totalWeight += 1 / distance;
+        if (neighbor.IsWorking == true) workingWeight += 1 / distance;
+    }
+
+    int numOfNotWorkingLines = numberOfNearestNeighbors - numOfWorkingLines;
+    PredictedStatus = numOfWorkingLines > numOfNotWorkingLines;
+    IsTie = numOfWorkingLines == numOfNotWorkingLines;
+    NearestDistance = sqrt(nearestNeighbors[0].SquaredDistance);
+
+    double workingVoteFraction = (double)numOfWorkingLines / numberOfNearestNeighbors;
+    double workingWeightedVoteFraction = workingWeight / totalWeight;
+    if (numOfExactMatches > 0) workingWeightedVoteFraction = (double)numOfWorkingExactMatches / numOfExactMatches;
+    VoteFraction = PredictedStatus ? workingVoteFraction : 1 - workingVoteFraction;
+    WeightedVoteFraction = PredictedStatus ? workingWeightedVoteFraction : 1 - workingWeightedVoteFraction;
+}
+
+
+const void knnPredictionResult::Print() const
+{
+    cout << "Line Status Prediction: " << to_string(PredictedStatus) << (IsTie ? " (tie)" : "") << "\n";
+    cout << "Vote fraction: " << to_string(VoteFraction) << ", weighted vote fraction: " << to_string(WeightedVoteFraction) <<
+        ", nearest distance: " << to_string(NearestDistance) << "\n";
+}
@@ -0,0 +1,68 @@
+#pragma once
+
+#define _USE_MATH_DEFINES
+
+using namespace std;
+
+#include <cmath>
+#include <exception>
+#include <iostream>
+#include <string>
+#include <vector>
+#include "nearestNeighbor.h"
+
+
+/// <summary>
+/// The line status prediction of an unknown line sample with how strongly its nearest neighbors agree on it, all from the same
+/// nearest neighbors the prediction was made from.
+/// </summary>
+class knnPredictionResult {
+public:
+    /// <summary>
+    /// The majority status of the nearest neighbors (false in the case of a tie like the bool predictions)
+    /// </summary>
+    bool PredictedStatus = false;
+    /// <summary>
+    /// True if as many nearest neighbors are working as not working
+    /// </summary>
+    bool IsTie = false;
+    /// <summary>
+    /// The number of nearest neighbors the prediction was made from (0 if no prediction was made)
+    /// </summary>
+    int NumberOfNearestNeighbors = 0;
+    /// <summary>
+    /// The fraction of the nearest neighbors with the predicted status (between 0.5 and 1)
+    /// </summary>
+    double VoteFraction = 0;
+    /// <summary>
+    /// The fraction of the inverse distance weights of the nearest neighbors with the predicted status. Neighbors at distance 0
+    /// outweigh every other neighbor.
+    /// </summary>
+    double WeightedVoteFraction = 0;
+    /// <summary>
+    /// The distance of the nearest neighbor
+    /// </summary>
+    double NearestDistance = 0;
+    /// <summary>
+    /// The indices of the nearest known line samples from closest to farthest
+    /// </summary>
+    vector<int> NeighborIndices;
+
+
+    /// <summary>
+    /// The default constructor is the result of no prediction
+    /// </summary>
+    knnPredictionResult() {}
+    /// <summary>
+    /// The constructor scores the nearest neighbors of a prediction.
+    /// </summary>
+    /// <param name="nearestNeighbors">The nearest neighbors sorted from closest to farthest</param>
+    /// <param name="numberOfNearestNeighbors">The number of nearest neighbors to score</param>
+    explicit knnPredictionResult(const nearestNeighbor* nearestNeighbors, int numberOfNearestNeighbors);
+
+
+    /// <summary>
+    /// Print the prediction and its scores.
+    /// </summary>
+    const void Print() const;
+};
@@ -0,0 +1,131 @@
+#define _USE_MATH_DEFINES
+
+using namespace std;
+
+#include <cmath>
+#include <exception>
+#include <iostream>
+#include <string>
+#include "phasor.h"
+#include "parameter.h"
+#include "nodeSample.h"
+#include "lineSample.h"
+#include "lineFeatureMatrix.h"
+#include "distanceKernel.h"
+#include "nearestNeighbor.h"
+#include "nearestNeighborHeap.h"
+#include "nearestNeighborIndex.h"
+#include "allocationCounter.h"
+#include "latencyHistogram.h"
+#include "knnInstrumentationSnapshot.h"
+#include "knnInstrumentation.h"
+#include "knnStageTimer.h"
+#include "knnQueryScratch.h"
+#include "knnPredictionResult.h"
+#include "knnQueryEngine.h"
+
+
+knnQueryScratch& knnQueryEngine::Scratch()
+{
+    return knnQueryScratch::OfThisThread();
+}
+
+
+
+knnQueryEngine::knnQueryEngine(const lineFeatureMatrix* knownFeatures, int numberOfNearestNeighbors)
+{
+    this->knownFeatures = knownFeatures;
+    this->numberOfNearestNeighbors = numberOfNearestNeighbors;
+}
+knnQueryEngine::knnQueryEngine(const nearestNeighborIndex* index, int numberOfNearestNeighbors)
+{
+    this->index = index;
+    if (index != NULL) knownFeatures = index->Features();
+    this->numberOfNearestNeighbors = numberOfNearestNeighbors;
+}
+
+
+const bool knnQueryEngine::PredictStatus(lineSample* sampleWithUnknownStatus, bool* predictedStatus, int numberOfNearestNeighbors,
+    nearestNeighbor* nearestNeighbors) const
+{
+    KNN_TIME_STAGE(knnStage::Prediction);
+    if (numberOfNearestNeighbors <= 0) numberOfNearestNeighbors = this->numberOfNearestNeighbors;
+    if (predictedStatus == NULL) {
+        cout << "Error in knnQueryEngine::PredictStatus(): bool* predictedStatus = NULL!\n";
+        return false;
+    }
+    if ((knownFeatures == NULL) || (knownFeatures->NumberOfSamples == 0)) {
+        cout << "Error: There are no known statuses to compare to.\n";
+        return false;
+    }
+    if (numberOfNearestNeighbors > knownFeatures->NumberOfSamples) {
+        cout << "Error: The number of nearest neighbors is larger than the number of known statuses.\n";
+        return false;
+    }
+    if (knownFeatures->IsSampleOfTheSameLine(sampleWithUnknownStatus) == false) {
+        cout << "Error in knnQueryEngine::PredictStatus(): the line sample is not a sample of the same line as the known line samples.\n";
+        return false;
+    }
+
+    knnQueryScratch& scratch = Scratch();
+    nearestNeighborHeap* heap = scratch.Reserve(knownFeatures->NumberOfFeatures, knownSamplesPerBlock, numberOfNearestNeighbors);
+    double* realParts = scratch.RealParts.data();
+    double* imaginaryParts = scratch.ImaginaryParts.data();
+    knownFeatures->ExtractFeatures(sampleWithUnknownStatus, realParts, imaginaryParts);
+
+    if (index != NULL) index->Search(realParts, imaginaryParts, heap);
+    else {
+        double* squaredDistances = scratch.BlockDistances.data();
+        for (int firstKnownIndex = 0; firstKnownIndex < knownFeatures->NumberOfSamples; firstKnownIndex += knownSamplesPerBlock) {
+            int numberOfKnownsInBlock = knownSamplesPerBlock;
+            if (knownFeatures->NumberOfSamples - firstKnownIndex < knownSamplesPerBlock) {
+                numberOfKnownsInBlock = knownFeatures->NumberOfSamples - firstKnownIndex;
+            }
+            distanceKernel::BoundedSquaredDistances(knownFeatures, firstKnownIndex, numberOfKnownsInBlock, realParts, imaginaryParts,
+                heap->WorstSquaredDistance(), squaredDistances);
+            KNN_TIME_STAGE(knnStage::NeighborSelection);
+            for (int blockIndex = 0; blockIndex < numberOfKnownsInBlock; blockIndex++) {
+                if (squaredDistances[blockIndex] > heap->WorstSquaredDistance()) continue;
+                heap->Push(squaredDistances[blockIndex], firstKnownIndex + blockIndex,
+                    knownFeatures->IsWorking(firstKnownIndex + blockIndex));
+            }
+        }
+    }
+
+    int numOfWorkingLines = 0;
+    int numOfNotWorkingLines = 0;
+    for (int heapIndex = 0; heapIndex < heap->Size(); heapIndex++) {
+        if (heap->Neighbor(heapIndex).IsWorking == true) numOfWorkingLines += 1;
+        else numOfNotWorkingLines += 1;
+    }
+    *predictedStatus = numOfWorkingLines > numOfNotWorkingLines;
+    KNN_COUNT(knnCounter::Predictions, 1);
+    KNN_COUNT(knnCounter::Scans, 1);
+    if (nearestNeighbors != NULL) heap->CopySorted(nearestNeighbors);
+    return true;
+}
+
+const bool knnQueryEngine::PredictResult(lineSample* sampleWithUnknownStatus, knnPredictionResult* result,
+    int numberOfNearestNeighbors) const
+{
+    if (numberOfNearestNeighbors <= 0) numberOfNearestNeighbors = this->numberOfNearestNeighbors;
+    if (result == NULL) {
+        cout << "Error in knnQueryEngine::PredictResult(): knnPredictionResult* result = NULL!\n";
+        return false;
+    }
+
+    vector<nearestNeighbor>& neighbors = Scratch().Neighbors;
+    if ((int)neighbors.size() < numberOfNearestNeighbors) neighbors.resize(numberOfNearestNeighbors);
+    bool predictedStatus = false;
+    if (PredictStatus(sampleWithUnknownStatus, &predictedStatus, numberOfNearestNeighbors, neighbors.data()) == false) {
+        *result = knnPredictionResult();
+        return false;
+    }
+    *result = knnPredictionResult(neighbors.data(), numberOfNearestNeighbors);
+    return true;
+}
+
+const int knnQueryEngine::NumberOfNearestNeighbors() const
+{
+    return numberOfNearestNeighbors;
+}
\ No newline at end of file
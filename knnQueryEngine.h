@@ -0,0 +1,98 @@
+#pragma once
+
+#define _USE_MATH_DEFINES
+
+using namespace std;
+
+#include <cmath>
+#include <exception>
+#include <iostream>
+#include <string>
+#include "phasor.h"
+#include "parameter.h"
+#include "nodeSample.h"
+#include "lineSample.h"
+#include "lineFeatureMatrix.h"
+#include "distanceKernel.h"
+#include "nearestNeighbor.h"
+#include "nearestNeighborHeap.h"
+#include "nearestNeighborIndex.h"
+#include "knnQueryScratch.h"
+#include "knnPredictionResult.h"
+
+
+/// <summary>
+/// A stateless front-end for predicting line statuses from one immutable model (a feature matrix or an index over one) on any
+/// number of threads at once. Nothing about a query is stored in the engine, the number of nearest neighbors can be picked per
+/// query, and each thread scores into its own thread local knnQueryScratch, so queries never lock or wait on each other.
+/// </summary>
+class knnQueryEngine {
+private:
+    /// <summary>
+    /// The number of known line samples scored together by distanceKernel
+    /// </summary>
+    static const int knownSamplesPerBlock = 256;
+    /// <summary>
+    /// The normalized parameters of the line samples with a known line status
+    /// </summary>
+    const lineFeatureMatrix* knownFeatures = NULL;
+    /// <summary>
+    /// The search structure used in place of the brute force scan (NULL scans every known line sample)
+    /// </summary>
+    const nearestNeighborIndex* index = NULL;
+    /// <summary>
+    /// The number of nearest neighbors of a query that doesn't pick its own
+    /// </summary>
+    int numberOfNearestNeighbors = 5;
+
+
+    /// <summary>
+    /// The scratch space of the calling thread
+    /// </summary>
+    static knnQueryScratch& Scratch();
+
+
+public:
+    /// <summary>
+    /// The constructor scans every known line sample of a feature matrix. The matrix isn't freed on the deconstructor and must
+    /// not change while the engine is used.
+    /// </summary>
+    /// <param name="knownFeatures">The feature matrix of the line samples with known line statuses</param>
+    /// <param name="numberOfNearestNeighbors">The number of nearest neighbors of a query that doesn't pick its own</param>
+    explicit knnQueryEngine(const lineFeatureMatrix* knownFeatures, int numberOfNearestNeighbors = 5);
+    /// <summary>
+    /// This constructor searches an index (like kdTreeIndex) instead of scanning. The index and its feature matrix aren't freed
+    /// on the deconstructor and must not change while the engine is used.
+    /// </summary>
+    /// <param name="index">The index over the feature matrix of the line samples with known line statuses</param>
+    /// <param name="numberOfNearestNeighbors">The number of nearest neighbors of a query that doesn't pick its own</param>
+    explicit knnQueryEngine(const nearestNeighborIndex* index, int numberOfNearestNeighbors = 5);
+
+
+    /// <summary>
+    /// Predict the status of a line sample. It's safe to call from any number of threads at once.
+    /// </summary>
+    /// <param name="sampleWithUnknownStatus">The line sample with an unknown status</param>
+    /// <param name="predictedStatus">The predicted status (false in the case of a tie)</param>
+    /// <param name="numberOfNearestNeighbors">The number of nearest neighbors of this query (0 uses the engine's)</param>
+    /// <param name="nearestNeighbors">
+    /// The array of numberOfNearestNeighbors elements to fill with the nearest neighbors from closest to farthest (NULL skips
+    /// it)</param>
+    /// <returns>True if a prediction was made</returns>
+    const bool PredictStatus(lineSample* sampleWithUnknownStatus, bool* predictedStatus, int numberOfNearestNeighbors = 0,
+        nearestNeighbor* nearestNeighbors = NULL) const;
+    /// <summary>
+    /// Predict the status of a line sample and score the prediction from the same nearest neighbors. It's safe to call from any
+    /// number of threads at once.
+    /// </summary>
+    /// <param name="sampleWithUnknownStatus">The line sample with an unknown status</param>
+    /// <param name="result">The prediction with its vote fractions, nearest distance, and neighbor indices</param>
+    /// <param name="numberOfNearestNeighbors">The number of nearest neighbors of this query (0 uses the engine's)</param>
+    /// <returns>True if a prediction was made</returns>
+    const bool PredictResult(lineSample* sampleWithUnknownStatus, knnPredictionResult* result, int numberOfNearestNeighbors = 0) const;
+
+    /// <summary>
+    /// The number of nearest neighbors of a query that doesn't pick its own
+    /// </summary>
+    const int NumberOfNearestNeighbors() const;
+};
\ No newline at end of file
@@ -0,0 +1,91 @@
+#pragma once
+
+#define _USE_MATH_DEFINES
+
+using namespace std;
+
+#include <cmath>
+#include <exception>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <vector>
+#include "nearestNeighborHeap.h"
+
+
+/// <summary>
+/// The scratch space of one thread's knnQueryEngine queries and the index searches they run. Each thread has its own, so the
+/// queries share nothing but the immutable model, and the buffers only grow until they fit the largest model and number of
+/// nearest neighbors.
+/// </summary>
+class knnQueryScratch {
+public:
+    /// <summary>
+    /// The real parts of the features of the unknown line sample
+    /// </summary>
+    vector<double> RealParts;
+    /// <summary>
+    /// The imaginary parts of the features of the unknown line sample
+    /// </summary>
+    vector<double> ImaginaryParts;
+    /// <summary>
+    /// The squared distances of the block of known line samples currently being scored
+    /// </summary>
+    vector<double> BlockDistances;
+    /// <summary>
+    /// The bounded max heap of the nearest neighbors found so far
+    /// </summary>
+    unique_ptr<nearestNeighborHeap> Heap;
+    /// <summary>
+    /// The bounded max heap of the nearest centroids ivfIndex::Search() probes
+    /// </summary>
+    unique_ptr<nearestNeighborHeap> ProbeHeap;
+    /// <summary>
+    /// The bounded max heap of the candidates compactFeatureIndex::Search() screens with the approximate distance
+    /// </summary>
+    unique_ptr<nearestNeighborHeap> CandidateHeap;
+    /// <summary>
+    /// The nearest neighbors of the query sorted from closest to farthest for knnQueryEngine::PredictResult()
+    /// </summary>
+    vector<nearestNeighbor> Neighbors;
+
+
+    /// <summary>
+    /// The scratch space of the calling thread
+    /// </summary>
+    static knnQueryScratch& OfThisThread()
+    {
+        thread_local knnQueryScratch scratch;
+        return scratch;
+    }
+    /// <summary>
+    /// Clear a heap, replacing it first if it doesn't have the capacity.
+    /// </summary>
+    /// <param name="heap">The heap</param>
+    /// <param name="capacity">The capacity the heap needs</param>
+    /// <returns>The heap cleared and with the capacity</returns>
+    static nearestNeighborHeap* ReserveHeap(unique_ptr<nearestNeighborHeap>& heap, int capacity)
+    {
+        if ((heap == NULL) || (heap->Capacity() != capacity)) heap.reset(new nearestNeighborHeap(capacity));
+        heap->Clear();
+        return heap.get();
+    }
+
+
+    /// <summary>
+    /// Grow the buffers to fit a query.
+    /// </summary>
+    /// <param name="numberOfFeatures">The number of features of the model</param>
+    /// <param name="samplesPerBlock">The number of known line samples scored together</param>
+    /// <param name="numberOfNearestNeighbors">The number of nearest neighbors of the query</param>
+    /// <returns>The heap cleared and with a capacity of numberOfNearestNeighbors</returns>
+    nearestNeighborHeap* Reserve(int numberOfFeatures, int samplesPerBlock, int numberOfNearestNeighbors)
+    {
+        if ((int)RealParts.size() < numberOfFeatures) {
+            RealParts.resize(numberOfFeatures);
+            ImaginaryParts.resize(numberOfFeatures);
+        }
+        if ((int)BlockDistances.size() < samplesPerBlock) BlockDistances.resize(samplesPerBlock);
+        return ReserveHeap(Heap, numberOfNearestNeighbors);
+    }
+};
\ No newline at end of file
@@ -0,0 +1,77 @@
+#pragma once
+
+#define _USE_MATH_DEFINES
+
+using namespace std;
+
+#include <chrono>
+#include <cmath>
+#include <exception>
+#include <iostream>
+#include <string>
+#include "allocationCounter.h"
+#include "latencyHistogram.h"
+#include "knnInstrumentationSnapshot.h"
+#include "knnInstrumentation.h"
+
+
+#ifdef KNN_INSTRUMENTATION
+/// <summary>
+/// Times the scope it's declared in as one run of a stage and counts the heap allocations the thread made inside it. Use it
+/// through KNN_TIME_STAGE. It only exists when KNN_INSTRUMENTATION is defined, the same switch that makes allocationCounter.cpp
+/// replace operator new, so a default build has neither the timer nor the allocation hook.
+/// </summary>
+class knnStageTimer {
+private:
+    /// <summary>
+    /// The stage being timed
+    /// </summary>
+    knnStage stage;
+    /// <summary>
+    /// The time the scope began
+    /// </summary>
+    chrono::steady_clock::time_point startTime;
+    /// <summary>
+    /// The heap allocations of the thread when the scope began
+    /// </summary>
+    long long startNumberOfAllocations = 0;
+
+
+public:
+    /// <summary>
+    /// The constructor starts the timer.
+    /// </summary>
+    /// <param name="stage">The stage being timed</param>
+    explicit knnStageTimer(knnStage stage)
+    {
+        this->stage = stage;
+        startNumberOfAllocations = allocationCounter::NumberOfAllocationsOnThisThread();
+        startTime = chrono::steady_clock::now();
+    }
+
+    /// <summary>
+    /// The deconstructor records the stage.
+    /// </summary>
+    ~knnStageTimer()
+    {
+        long long nanoseconds = chrono::duration_cast<chrono::nanoseconds>(chrono::steady_clock::now() - startTime).count();
+        knnInstrumentation::RecordStage(stage, nanoseconds,
+            allocationCounter::NumberOfAllocationsOnThisThread() - startNumberOfAllocations);
+    }
+};
+
+
+#define KNN_TIME_STAGE_NAME(line) knnStageTimerOfLine##line
+#define KNN_TIME_STAGE_OF_LINE(stage, line) knnStageTimer KNN_TIME_STAGE_NAME(line)(stage)
+/// <summary>
+/// Time the rest of the enclosing scope as one run of a stage
+/// </summary>
+#define KNN_TIME_STAGE(stage) KNN_TIME_STAGE_OF_LINE(stage, __LINE__)
+/// <summary>
+/// Add to a counter of the calling thread
+/// </summary>
+#define KNN_COUNT(counter, amount) knnInstrumentation::Count(counter, amount)
+#else
+#define KNN_TIME_STAGE(stage)
+#define KNN_COUNT(counter, amount)
+#endif
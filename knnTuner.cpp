@@ -0,0 +1,225 @@
+#define _USE_MATH_DEFINES
+
+using namespace std;
+
+#include <cmath>
+#include <exception>
+#include <functional>
+#include <iostream>
+#include <string>
+#include <vector>
+#include "distanceWeights.h"
+#include "lineFeatureMatrix.h"
+#include "nearestNeighbor.h"
+#include "nearestNeighborHeap.h"
+#include "threadPool.h"
+#include "lineModelRegistry.h"
+#include "knnTuningResult.h"
+#include "knnTuner.h"
+
+
+const size_t knnTuner::PairIndex(int sampleIndex, int otherSampleIndex)
+{
+    size_t rowIndex = (size_t)((sampleIndex > otherSampleIndex) ? sampleIndex : otherSampleIndex);
+    size_t columnIndex = (size_t)((sampleIndex > otherSampleIndex) ? otherSampleIndex : sampleIndex);
+    return (rowIndex * (rowIndex - 1) / 2 + columnIndex) * numberOfGroups;
+}
+const int knnTuner::Fold(int sampleIndex) const
+{
+    if (numberOfFolds <= 1) return sampleIndex;
+    return sampleIndex % numberOfFolds;
+}
+const bool knnTuner::BuildGroupDistances()
+{
+    groupDistances = new float[(size_t)NumberOfSamples * (NumberOfSamples - 1) / 2 * numberOfGroups];
+    if (groupDistances == NULL) {
+        MemoryAllocationFailure("groupDistances");
+        return false;
+    }
+
+    int numberOfNode1OtherCurrents = features->NumberOfNode1OtherCurrents;
+    int numberOfNode2OtherCurrents = features->NumberOfNode2OtherCurrents;
+    ForEachRange([&](int firstSampleIndex, int lastSampleIndex, int) {
+        for (int sampleIndex = firstSampleIndex; sampleIndex < lastSampleIndex; sampleIndex++) {
+            for (int otherSampleIndex = 0; otherSampleIndex < sampleIndex; otherSampleIndex++) {
+                double squaredMagnitudes[numberOfGroups] = {};
+                for (int featureIndex = 0; featureIndex < features->NumberOfFeatures; featureIndex++) {
+                    double realDifference = features->RealColumn(featureIndex)[sampleIndex] -
+                        features->RealColumn(featureIndex)[otherSampleIndex];
+                    double imaginaryDifference = features->ImaginaryColumn(featureIndex)[sampleIndex] -
+                        features->ImaginaryColumn(featureIndex)[otherSampleIndex];
+                    double squaredMagnitude = realDifference * realDifference + imaginaryDifference * imaginaryDifference;
+
+                    // The same split of each weight as lineFeatureMatrix::SetWeights()
+                    if (featureIndex < 2) squaredMagnitudes[0] += squaredMagnitude / 2;
+                    else if (featureIndex < 4) squaredMagnitudes[1] += squaredMagnitude / 2;
+                    else if (featureIndex < 4 + numberOfNode1OtherCurrents) {
+                        squaredMagnitudes[2] += squaredMagnitude / (2 * (double)numberOfNode1OtherCurrents);
+                    }
+                    else squaredMagnitudes[2] += squaredMagnitude / (2 * (double)numberOfNode2OtherCurrents);
+                }
+
+                float* pairDistances = groupDistances + PairIndex(sampleIndex, otherSampleIndex);
+                for (int groupIndex = 0; groupIndex < numberOfGroups; groupIndex++) {
+                    pairDistances[groupIndex] = (float)squaredMagnitudes[groupIndex];
+                }
+            }
+        }
+    });
+    return true;
+}
+const int knnTuner::NumberOfRanges() const
+{
+    int numberOfRanges = 1;
+    if (pool != NULL) numberOfRanges = pool->NumberOfThreads() * chunksPerThread;
+    if (numberOfRanges > NumberOfSamples) numberOfRanges = NumberOfSamples;
+    return numberOfRanges;
+}
+const void knnTuner::ForEachRange(const function<void(int, int, int)>& task)
+{
+    int numberOfRanges = NumberOfRanges();
+    auto runRange = [&](int rangeIndex) {
+        // The rows of the lower triangle grow with the sample index, so the ranges are split by the number of pairs
+        double firstFraction = sqrt((double)rangeIndex / numberOfRanges);
+        double lastFraction = sqrt((double)(rangeIndex + 1) / numberOfRanges);
+        int firstSampleIndex = (rangeIndex == 0) ? 0 : (int)(firstFraction * NumberOfSamples);
+        int lastSampleIndex = (rangeIndex == numberOfRanges - 1) ? NumberOfSamples : (int)(lastFraction * NumberOfSamples);
+        task(firstSampleIndex, lastSampleIndex, rangeIndex);
+    };
+    if ((pool == NULL) || (numberOfRanges <= 1)) runRange(0);
+    else pool->ParallelFor(numberOfRanges, runRange);
+}
+
+
+const void knnTuner::FreeMemory()
+{
+    if (groupDistances != NULL) {
+        delete[] groupDistances;
+        groupDistances = NULL;
+    }
+}
+
+const void knnTuner::MemoryAllocationFailure(string variableName)
+{
+    cout << "Error: knnTuner() failed to allocate memory for " << variableName << "\n";
+    FreeMemory();
+}
+
+
+
+knnTuner::knnTuner(const lineFeatureMatrix* knownFeatures, int numberOfFolds, threadPool* pool)
+{
+    features = knownFeatures;
+    this->numberOfFolds = numberOfFolds;
+    this->pool = pool;
+    if ((knownFeatures == NULL) || (knownFeatures->NumberOfSamples < 2)) {
+        cout << "Error: knnTuner() needs a feature matrix with at least two line samples.\n";
+        return;
+    }
+
+    NumberOfSamples = knownFeatures->NumberOfSamples;
+    statuses.resize(NumberOfSamples);
+    for (int sampleIndex = 0; sampleIndex < NumberOfSamples; sampleIndex++) statuses[sampleIndex] = knownFeatures->IsWorking(sampleIndex);
+    if (BuildGroupDistances() == false) NumberOfSamples = 0;
+}
+
+knnTuner::~knnTuner()
+{
+    FreeMemory();
+}
+
+
+const vector<distanceWeights> knnTuner::WeightGrid(const vector<double>& wLines, const vector<double>& wNodes,
+    const vector<double>& wOthers)
+{
+    vector<distanceWeights> weightGrid;
+    for (double wLine : wLines) {
+        for (double wNode : wNodes) {
+            for (double wOther : wOthers) weightGrid.push_back(distanceWeights(wLine, wNode, wOther));
+        }
+    }
+    return weightGrid;
+}
+const vector<knnTuningResult> knnTuner::Evaluate(const vector<distanceWeights>& weightGrid, const vector<int>& neighborGrid)
+{
+    vector<knnTuningResult> results;
+    if (groupDistances == NULL) {
+        cout << "Error in knnTuner::Evaluate(): there are no line samples to evaluate.\n";
+        return results;
+    }
+    int maximumNumberOfNearestNeighbors = 0;
+    for (int numberOfNearestNeighbors : neighborGrid) {
+        if (numberOfNearestNeighbors <= 0) {
+            cout << "Error in knnTuner::Evaluate(): the number of nearest neighbors has to be at least one.\n";
+            return results;
+        }
+        if (numberOfNearestNeighbors > maximumNumberOfNearestNeighbors) maximumNumberOfNearestNeighbors = numberOfNearestNeighbors;
+    }
+    int largestFold = (numberOfFolds <= 1) ? 1 : (NumberOfSamples + numberOfFolds - 1) / numberOfFolds;
+    if (maximumNumberOfNearestNeighbors > NumberOfSamples - largestFold) {
+        cout << "Error in knnTuner::Evaluate(): the number of nearest neighbors is larger than the number of training samples.\n";
+        return results;
+    }
+
+    int numberOfRanges = NumberOfRanges();
+    int numberOfNeighborCounts = (int)neighborGrid.size();
+    for (const distanceWeights& weights : weightGrid) {
+        vector<int> numberOfCorrectPredictions((size_t)numberOfRanges * numberOfNeighborCounts, 0);
+        ForEachRange([&](int firstSampleIndex, int lastSampleIndex, int rangeIndex) {
+            nearestNeighborHeap heap(maximumNumberOfNearestNeighbors);
+            vector<nearestNeighbor> sortedNeighbors(maximumNumberOfNearestNeighbors);
+            vector<int> numbersOfWorkingNeighbors(maximumNumberOfNearestNeighbors + 1);
+            for (int sampleIndex = firstSampleIndex; sampleIndex < lastSampleIndex; sampleIndex++) {
+                heap.Clear();
+                for (int otherSampleIndex = 0; otherSampleIndex < NumberOfSamples; otherSampleIndex++) {
+                    if (Fold(otherSampleIndex) == Fold(sampleIndex)) continue;
+                    const float* pairDistances = groupDistances + PairIndex(sampleIndex, otherSampleIndex);
+                    double squaredDistance = weights.WLine * pairDistances[0] + weights.WNode * pairDistances[1] +
+                        weights.WOther * pairDistances[2];
+                    if (squaredDistance > heap.WorstSquaredDistance()) continue;
+                    heap.Push(squaredDistance, otherSampleIndex, statuses[otherSampleIndex] == 1);
+                }
+                heap.CopySorted(sortedNeighbors.data());
+
+                // Every k of the grid is voted by the first k of the same sorted neighbors
+                numbersOfWorkingNeighbors[0] = 0;
+                for (int neighborIndex = 0; neighborIndex < maximumNumberOfNearestNeighbors; neighborIndex++) {
+                    numbersOfWorkingNeighbors[neighborIndex + 1] = numbersOfWorkingNeighbors[neighborIndex] +
+                        (sortedNeighbors[neighborIndex].IsWorking ? 1 : 0);
+                }
+                for (int neighborCountIndex = 0; neighborCountIndex < numberOfNeighborCounts; neighborCountIndex++) {
+                    int numberOfNearestNeighbors = neighborGrid[neighborCountIndex];
+                    int numOfWorkingLines = numbersOfWorkingNeighbors[numberOfNearestNeighbors];
+                    bool predictedStatus = numOfWorkingLines > numberOfNearestNeighbors - numOfWorkingLines;
+                    if (predictedStatus == (statuses[sampleIndex] == 1)) {
+                        numberOfCorrectPredictions[(size_t)rangeIndex * numberOfNeighborCounts + neighborCountIndex]++;
+                    }
+                }
+            }
+        });
+
+        for (int neighborCountIndex = 0; neighborCountIndex < numberOfNeighborCounts; neighborCountIndex++) {
+            int numberOfCorrect = 0;
+            for (int rangeIndex = 0; rangeIndex < numberOfRanges; rangeIndex++) {
+                numberOfCorrect += numberOfCorrectPredictions[(size_t)rangeIndex * numberOfNeighborCounts + neighborCountIndex];
+            }
+            knnTuningResult result;
+            result.Weights = weights;
+            result.NumberOfNearestNeighbors = neighborGrid[neighborCountIndex];
+            result.Accuracy = (double)numberOfCorrect / NumberOfSamples;
+            results.push_back(result);
+        }
+    }
+    return results;
+}
+const knnTuningResult knnTuner::Tune(const vector<distanceWeights>& weightGrid, const vector<int>& neighborGrid)
+{
+    vector<knnTuningResult> results = Evaluate(weightGrid, neighborGrid);
+    if (results.size() == 0) return knnTuningResult();
+
+    knnTuningResult bestResult = results[0];
+    for (const knnTuningResult& result : results) {
+        if (result.Accuracy > bestResult.Accuracy) bestResult = result;
+    }
+    return bestResult;
+}
@@ -0,0 +1,146 @@
+#pragma once
+
+#define _USE_MATH_DEFINES
+
+using namespace std;
+
+#include <cmath>
+#include <exception>
+#include <functional>
+#include <iostream>
+#include <string>
+#include <vector>
+#include "distanceWeights.h"
+#include "lineFeatureMatrix.h"
+#include "nearestNeighbor.h"
+#include "nearestNeighborHeap.h"
+#include "threadPool.h"
+#include "lineModelRegistry.h"
+#include "knnTuningResult.h"
+
+
+/// <summary>
+/// Cross-validates a grid of weights and numbers of nearest neighbors over a line's training set. The squared distance is
+/// wLine * (line current group) + wNode * (voltage group) + wOther * (other current group), so the constructor scores the three
+/// unweighted groups of every pair of line samples once and each configuration of weights only adds them up again. Every number
+/// of nearest neighbors of the grid is voted from the same sorted neighbors of each held out line sample.
+/// </summary>
+class knnTuner {
+private:
+    /// <summary>
+    /// The number of feature groups (line currents, node voltages, and other currents)
+    /// </summary>
+    static const int numberOfGroups = 3;
+    /// <summary>
+    /// The number of chunks per thread the line samples are split into when scoring in parallel
+    /// </summary>
+    static const int chunksPerThread = 4;
+    /// <summary>
+    /// The feature matrix of the training set
+    /// </summary>
+    const lineFeatureMatrix* features = NULL;
+    /// <summary>
+    /// The statuses of the line samples
+    /// </summary>
+    vector<char> statuses;
+    /// <summary>
+    /// The number of folds (0 is leave-one-out)
+    /// </summary>
+    int numberOfFolds = 0;
+    /// <summary>
+    /// The threads that score the line samples in parallel (NULL scores on the calling thread)
+    /// </summary>
+    threadPool* pool = NULL;
+    /// <summary>
+    /// The unweighted squared distance of each feature group of every pair of line samples (numberOfGroups floats per pair stored
+    /// as the lower triangle row by row, so NumberOfSamples * (NumberOfSamples - 1) / 2 pairs)
+    /// </summary>
+    float* groupDistances = NULL;
+
+
+    /// <summary>
+    /// The index of the first group distance of a pair of line samples
+    /// </summary>
+    /// <param name="sampleIndex">The index of one line sample</param>
+    /// <param name="otherSampleIndex">The index of the other line sample (not sampleIndex)</param>
+    /// <returns>The index in groupDistances</returns>
+    static const size_t PairIndex(int sampleIndex, int otherSampleIndex);
+    /// <summary>
+    /// The fold a line sample is held out in
+    /// </summary>
+    /// <param name="sampleIndex">The index of the line sample</param>
+    /// <returns>The fold (the sample index itself for leave-one-out)</returns>
+    const int Fold(int sampleIndex) const;
+    /// <summary>
+    /// Score the unweighted group distances of every pair of line samples.
+    /// </summary>
+    /// <returns>True if the memory allocation succeeded</returns>
+    const bool BuildGroupDistances();
+    /// <summary>
+    /// The number of ranges ForEachRange() splits the line samples into
+    /// </summary>
+    const int NumberOfRanges() const;
+    /// <summary>
+    /// Run a task over ranges of line samples, in parallel when there is a thread pool.
+    /// </summary>
+    /// <param name="task">The task taking the first and the last (excluded) index of a range and the range index</param>
+    const void ForEachRange(const function<void(int, int, int)>& task);
+
+    /// <summary>
+    /// Free the dynamically allocated memory and set their pointers to NULL. Notice that the feature matrix isn't freed.
+    /// </summary>
+    const void FreeMemory();
+
+    /// <summary>
+    /// Display an error message and call FreeMemory().
+    /// </summary>
+    /// <param=variableName>The name of the variable that failed to get memory allocation</param>
+    const void MemoryAllocationFailure(string variableName);
+
+
+public:
+    /// <summary>
+    /// The number of line samples in the training set
+    /// </summary>
+    int NumberOfSamples = 0;
+
+
+    /// <summary>
+    /// The constructor scores the group distances of every pair of line samples. The feature matrix won't be freed on the
+    /// deconstructor and the group distances take 6 * NumberOfSamples^2 bytes.
+    /// </summary>
+    /// <param name="knownFeatures">The feature matrix of the line samples with known line statuses</param>
+    /// <param name="numberOfFolds">The number of folds of the cross-validation (0 is leave-one-out)</param>
+    /// <param name="pool">The threads to score the line samples with (NULL scores on the calling thread)</param>
+    explicit knnTuner(const lineFeatureMatrix* knownFeatures, int numberOfFolds = 0, threadPool* pool = NULL);
+
+    /// <summary>
+    /// The deconstructor
+    /// </summary>
+    ~knnTuner();
+
+
+    /// <summary>
+    /// Every combination of a set of line, node, and other current weights
+    /// </summary>
+    /// <param name="wLines">The weights of the line currents</param>
+    /// <param name="wNodes">The weights of the node voltages</param>
+    /// <param name="wOthers">The weights of the other currents</param>
+    /// <returns>The grid of weights</returns>
+    static const vector<distanceWeights> WeightGrid(const vector<double>& wLines, const vector<double>& wNodes,
+        const vector<double>& wOthers);
+    /// <summary>
+    /// Cross-validate every combination of the weights and the numbers of nearest neighbors.
+    /// </summary>
+    /// <param name="weightGrid">The weights to try</param>
+    /// <param name="neighborGrid">The numbers of nearest neighbors to try</param>
+    /// <returns>The accuracy of each combination in the order of the weights and then the numbers of nearest neighbors</returns>
+    const vector<knnTuningResult> Evaluate(const vector<distanceWeights>& weightGrid, const vector<int>& neighborGrid);
+    /// <summary>
+    /// The most accurate combination of the weights and the numbers of nearest neighbors (the first one of the grid on a tie)
+    /// </summary>
+    /// <param name="weightGrid">The weights to try</param>
+    /// <param name="neighborGrid">The numbers of nearest neighbors to try</param>
+    /// <returns>The best configuration (an accuracy of 0 if nothing could be evaluated)</returns>
+    const knnTuningResult Tune(const vector<distanceWeights>& weightGrid, const vector<int>& neighborGrid);
+};
@@ -0,0 +1,39 @@
+#define _USE_MATH_DEFINES
+
+using namespace std;
+
+#include <cmath>
+#include <exception>
+#include <iostream>
+#include <string>
+#include "distanceWeights.h"
+#include "lineFeatureMatrix.h"
+#include "lineModelRegistry.h"
+#include "knnTuningResult.h"
+
+
+const bool knnTuningResult::WriteTo(lineFeatureMatrix* features) const
+{
+    if (features == NULL) {
+        cout << "Error in knnTuningResult::WriteTo(): lineFeatureMatrix* features = NULL!\n";
+        return false;
+    }
+    return features->SetWeights(Weights);
+}
+const bool knnTuningResult::WriteTo(lineModelRegistry* registry, int node1Number, int node2Number) const
+{
+    if (registry == NULL) {
+        cout << "Error in knnTuningResult::WriteTo(): lineModelRegistry* registry = NULL!\n";
+        return false;
+    }
+    // Check k before touching the weights, so a k the registry can't take doesn't leave the line reweighted
+    if (registry->IsValidNumberOfNearestNeighbors(NumberOfNearestNeighbors) == false) return false;
+    if (registry->SetLineWeights(node1Number, node2Number, Weights) == false) return false;
+    return registry->ChangeNumberOfNearestNeighbors(NumberOfNearestNeighbors);
+}
+
+const void knnTuningResult::Print() const
+{
+    cout << "wLine = " << to_string(Weights.WLine) << ", wNode = " << to_string(Weights.WNode) << ", wOther = " <<
+        to_string(Weights.WOther) << ", k = " << to_string(NumberOfNearestNeighbors) << ": accuracy = " << to_string(Accuracy) << "\n";
+}
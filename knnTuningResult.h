@@ -0,0 +1,54 @@
+#pragma once
+
+#define _USE_MATH_DEFINES
+
+using namespace std;
+
+#include <cmath>
+#include <exception>
+#include <iostream>
+#include <string>
+#include "distanceWeights.h"
+#include "lineFeatureMatrix.h"
+#include "lineModelRegistry.h"
+
+
+/// <summary>
+/// The cross-validated accuracy of one configuration of the weights and the number of nearest neighbors
+/// </summary>
+class knnTuningResult {
+public:
+    /// <summary>
+    /// The weights of the weighted euclidean distance
+    /// </summary>
+    distanceWeights Weights;
+    /// <summary>
+    /// The number of nearest neighbors
+    /// </summary>
+    int NumberOfNearestNeighbors = 5;
+    /// <summary>
+    /// The fraction of the held out line samples predicted correctly
+    /// </summary>
+    double Accuracy = 0;
+
+
+    /// <summary>
+    /// Write the weights into a line's feature matrix.
+    /// </summary>
+    /// <param name="features">The feature matrix</param>
+    /// <returns>True if the weights were written</returns>
+    const bool WriteTo(lineFeatureMatrix* features) const;
+    /// <summary>
+    /// Write the weights into a line of a registry and the number of nearest neighbors into the registry.
+    /// </summary>
+    /// <param name="registry">The registry</param>
+    /// <param name="node1Number">The number of the first node of the line</param>
+    /// <param name="node2Number">The number of the second node of the line</param>
+    /// <returns>True if both were written. If either can't be, neither is</returns>
+    const bool WriteTo(lineModelRegistry* registry, int node1Number, int node2Number) const;
+
+    /// <summary>
+    /// Print the configuration and its accuracy.
+    /// </summary>
+    const void Print() const;
+};
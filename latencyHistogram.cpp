@@ -0,0 +1,75 @@
+#define _USE_MATH_DEFINES
+
+using namespace std;
+
+#include <cmath>
+#include <exception>
+#include <iostream>
+#include <string>
+#include "latencyHistogram.h"
+
+
+const int latencyHistogram::BucketIndex(long long nanoseconds)
+{
+    if (nanoseconds < SubBucketsPerPowerOfTwo) return nanoseconds < 0 ? 0 : (int)nanoseconds;
+
+    // The top 5 bits of the latency pick the power of 2 and the bucket within it
+    int exponent = 4;
+    while ((nanoseconds >> (exponent + 1)) != 0) exponent++;
+    int subBucket = (int)(nanoseconds >> (exponent - 4)) - SubBucketsPerPowerOfTwo;
+    return SubBucketsPerPowerOfTwo + (exponent - 4) * SubBucketsPerPowerOfTwo + subBucket;
+}
+const long long latencyHistogram::BucketLowerBound(int bucketIndex)
+{
+    if (bucketIndex < SubBucketsPerPowerOfTwo) return bucketIndex;
+
+    int exponent = (bucketIndex - SubBucketsPerPowerOfTwo) / SubBucketsPerPowerOfTwo + 4;
+    int subBucket = (bucketIndex - SubBucketsPerPowerOfTwo) % SubBucketsPerPowerOfTwo;
+    return (long long)(SubBucketsPerPowerOfTwo + subBucket) << (exponent - 4);
+}
+
+
+const void latencyHistogram::Record(long long nanoseconds)
+{
+    Counts[BucketIndex(nanoseconds)]++;
+    Count++;
+    TotalNanoseconds += nanoseconds;
+    if (nanoseconds > MaximumNanoseconds) MaximumNanoseconds = nanoseconds;
+}
+const void latencyHistogram::Add(const latencyHistogram& other)
+{
+    for (int bucketIndex = 0; bucketIndex < NumberOfBuckets; bucketIndex++) Counts[bucketIndex] += other.Counts[bucketIndex];
+    Count += other.Count;
+    TotalNanoseconds += other.TotalNanoseconds;
+    if (other.MaximumNanoseconds > MaximumNanoseconds) MaximumNanoseconds = other.MaximumNanoseconds;
+}
+const void latencyHistogram::Subtract(const latencyHistogram& earlier)
+{
+    for (int bucketIndex = 0; bucketIndex < NumberOfBuckets; bucketIndex++) Counts[bucketIndex] -= earlier.Counts[bucketIndex];
+    Count -= earlier.Count;
+    TotalNanoseconds -= earlier.TotalNanoseconds;
+}
+
+
+const long long latencyHistogram::Percentile(double percentile) const
+{
+    if (Count == 0) return 0;
+
+    long long rank = (long long)ceil(percentile / 100 * (double)Count);
+    if (rank < 1) rank = 1;
+    long long numberAtOrBelow = 0;
+    for (int bucketIndex = 0; bucketIndex < NumberOfBuckets; bucketIndex++) {
+        numberAtOrBelow += Counts[bucketIndex];
+        if (numberAtOrBelow < rank) continue;
+
+        if (bucketIndex + 1 == NumberOfBuckets) return MaximumNanoseconds;
+        long long bucketUpperBound = BucketLowerBound(bucketIndex + 1) - 1;
+        return bucketUpperBound < MaximumNanoseconds ? bucketUpperBound : MaximumNanoseconds;
+    }
+    return MaximumNanoseconds;
+}
+const double latencyHistogram::MeanNanoseconds() const
+{
+    if (Count == 0) return 0;
+    return (double)TotalNanoseconds / (double)Count;
+}
@@ -0,0 +1,86 @@
+#pragma once
+
+#define _USE_MATH_DEFINES
+
+using namespace std;
+
+#include <cmath>
+#include <exception>
+#include <iostream>
+#include <string>
+
+
+/// <summary>
+/// A log-linear latency histogram in the style of HdrHistogram. Latencies under 16 ns have a bucket each, and every power of 2 above
+/// is split into 16 buckets, so any latency is recorded within 6.25% with a fixed number of buckets and no allocation.
+/// </summary>
+class latencyHistogram {
+public:
+    /// <summary>
+    /// The number of buckets per power of 2
+    /// </summary>
+    static const int SubBucketsPerPowerOfTwo = 16;
+    /// <summary>
+    /// The number of buckets covering every non-negative 64-bit latency
+    /// </summary>
+    static const int NumberOfBuckets = SubBucketsPerPowerOfTwo + (63 - 4 + 1) * SubBucketsPerPowerOfTwo;
+
+    /// <summary>
+    /// The number of latencies recorded in each bucket
+    /// </summary>
+    long long Counts[NumberOfBuckets] = {};
+    /// <summary>
+    /// The number of latencies recorded
+    /// </summary>
+    long long Count = 0;
+    /// <summary>
+    /// The sum of the latencies recorded in nanoseconds
+    /// </summary>
+    long long TotalNanoseconds = 0;
+    /// <summary>
+    /// The largest latency recorded in nanoseconds
+    /// </summary>
+    long long MaximumNanoseconds = 0;
+
+
+    /// <summary>
+    /// The bucket a latency is recorded in
+    /// </summary>
+    /// <param name="nanoseconds">The latency in nanoseconds</param>
+    /// <returns>The index of the bucket</returns>
+    static const int BucketIndex(long long nanoseconds);
+    /// <summary>
+    /// The lowest latency recorded in a bucket
+    /// </summary>
+    /// <param name="bucketIndex">The index of the bucket</param>
+    /// <returns>The latency in nanoseconds</returns>
+    static const long long BucketLowerBound(int bucketIndex);
+
+    /// <summary>
+    /// Record a latency.
+    /// </summary>
+    /// <param name="nanoseconds">The latency in nanoseconds</param>
+    const void Record(long long nanoseconds);
+    /// <summary>
+    /// Add the recorded latencies of another histogram.
+    /// </summary>
+    /// <param name="other">The other histogram</param>
+    const void Add(const latencyHistogram& other);
+    /// <summary>
+    /// Remove the recorded latencies of an earlier state of this histogram. The maximum is kept since it can't be taken back.
+    /// </summary>
+    /// <param name="earlier">The earlier state of the histogram</param>
+    const void Subtract(const latencyHistogram& earlier);
+
+    /// <summary>
+    /// The latency a percentage of the recorded latencies are at or below, rounded up to the top of its bucket
+    /// </summary>
+    /// <param name="percentile">The percentage between 0 and 100</param>
+    /// <returns>The latency in nanoseconds (0 if nothing was recorded)</returns>
+    const long long Percentile(double percentile) const;
+    /// <summary>
+    /// The average recorded latency
+    /// </summary>
+    /// <returns>The latency in nanoseconds (0 if nothing was recorded)</returns>
+    const double MeanNanoseconds() const;
+};
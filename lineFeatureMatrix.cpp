@@ -0,0 +1,276 @@
+#define _USE_MATH_DEFINES
+
+using namespace std;
+
+#include <cmath>
+#include <exception>
+#include <iostream>
+#include <new>
+#include <string>
+#include "phasor.h"
+#include "parameter.h"
+#include "nodeSample.h"
+#include "lineSample.h"
+#include "distanceWeights.h"
+#include "allocationCounter.h"
+#include "latencyHistogram.h"
+#include "knnInstrumentationSnapshot.h"
+#include "knnInstrumentation.h"
+#include "knnStageTimer.h"
+#include "lineFeatureMatrix.h"
+#include "distanceKernel.h"
+
+
+parameter* lineFeatureMatrix::FeatureParameter(lineSample* sample, int featureIndex)
+{
+    if (featureIndex == 0) return sample->Node1LineCurrentNorm;
+    if (featureIndex == 1) return sample->Node2LineCurrentNorm;
+    if (featureIndex == 2) return sample->Node1VoltageNorm;
+    if (featureIndex == 3) return sample->Node2VoltageNorm;
+    if (featureIndex < 4 + sample->NumberOfNode1OtherCurrents) return sample->Node1OtherCurrentsNorm[featureIndex - 4];
+    return sample->Node2OtherCurrentsNorm[featureIndex - 4 - sample->NumberOfNode1OtherCurrents];
+}
+const bool lineFeatureMatrix::SetLineLayout(lineSample* sample)
+{
+    NumberOfNode1OtherCurrents = sample->NumberOfNode1OtherCurrents;
+    NumberOfNode2OtherCurrents = sample->NumberOfNode2OtherCurrents;
+    NumberOfFeatures = 4 + NumberOfNode1OtherCurrents + NumberOfNode2OtherCurrents;
+    TopologyKey = sample->TopologyKey();
+    SquaredDistancesKernel = distanceKernel::Select(NumberOfNode1OtherCurrents, NumberOfNode2OtherCurrents);
+    BoundedSquaredDistancesKernel = distanceKernel::SelectBounded(NumberOfNode1OtherCurrents, NumberOfNode2OtherCurrents);
+
+    StartNodeNumbers = new int[NumberOfFeatures];
+    if (StartNodeNumbers == NULL) {
+        MemoryAllocationFailure("StartNodeNumbers");
+        return false;
+    }
+    DestinationNodeNumbers = new int[NumberOfFeatures];
+    if (DestinationNodeNumbers == NULL) {
+        MemoryAllocationFailure("DestinationNodeNumbers");
+        return false;
+    }
+    for (int featureIndex = 0; featureIndex < NumberOfFeatures; featureIndex++) {
+        StartNodeNumbers[featureIndex] = FeatureParameter(sample, featureIndex)->StartNodeNumber;
+        DestinationNodeNumbers[featureIndex] = FeatureParameter(sample, featureIndex)->DestinationNodeNumber;
+    }
+    return true;
+}
+
+
+const void lineFeatureMatrix::FreeMemory()
+{
+    if ((values != NULL) && (ownsColumns == true)) ::operator delete[](values, align_val_t(columnAlignment));
+    values = NULL;
+    if ((statuses != NULL) && (ownsColumns == true)) delete[] statuses;
+    statuses = NULL;
+    if (FeatureWeights != NULL) {
+        delete[] FeatureWeights;
+        FeatureWeights = NULL;
+    }
+    if (StartNodeNumbers != NULL) {
+        delete[] StartNodeNumbers;
+        StartNodeNumbers = NULL;
+    }
+    if (DestinationNodeNumbers != NULL) {
+        delete[] DestinationNodeNumbers;
+        DestinationNodeNumbers = NULL;
+    }
+    NumberOfSamples = 0;
+    Stride = 0;
+    TopologyKey = 0;
+}
+
+const void lineFeatureMatrix::MemoryAllocationFailure(string variableName)
+{
+    cout << "Error: lineFeatureMatrix() failed to allocate memory for " << variableName << "\n";
+    FreeMemory();
+}
+
+
+
+lineFeatureMatrix::lineFeatureMatrix(lineSample** samples, int numberOfSamples, distanceWeights weights)
+{
+    if ((samples == NULL) || (numberOfSamples <= 0) || (samples[0] == NULL) || (samples[0]->TopologyKey() == 0)) {
+        cout << "Error: lineFeatureMatrix() needs at least one line sample.\n";
+        return;
+    }
+    if (SetLineLayout(samples[0]) == false) return;
+    for (int sampleIndex = 1; sampleIndex < numberOfSamples; sampleIndex++) {
+        if (IsSampleOfTheSameLine(samples[sampleIndex]) == false) {
+            cout << "Error: lineFeatureMatrix(): samples[" << to_string(sampleIndex) << "] is not a sample of the same line.\n";
+            FreeMemory();
+            return;
+        }
+    }
+
+    FeatureWeights = new double[NumberOfFeatures];
+    if (FeatureWeights == NULL) {
+        MemoryAllocationFailure("FeatureWeights");
+        return;
+    }
+    if (SetWeights(weights) == false) return;
+
+    // Pad the columns so each one starts on the column alignment
+    int elementsPerAlignment = (int)(columnAlignment / sizeof(double));
+    Stride = (numberOfSamples + elementsPerAlignment - 1) / elementsPerAlignment * elementsPerAlignment;
+    values = (double*)::operator new[](2 * (size_t)NumberOfFeatures * Stride * sizeof(double), align_val_t(columnAlignment), nothrow);
+    if (values == NULL) {
+        MemoryAllocationFailure("values");
+        return;
+    }
+    statuses = new bool[numberOfSamples];
+    if (statuses == NULL) {
+        MemoryAllocationFailure("statuses");
+        return;
+    }
+
+    for (int featureIndex = 0; featureIndex < NumberOfFeatures; featureIndex++) {
+        double* realColumn = values + (size_t)(2 * featureIndex) * Stride;
+        double* imaginaryColumn = values + (size_t)(2 * featureIndex + 1) * Stride;
+        for (int sampleIndex = 0; sampleIndex < numberOfSamples; sampleIndex++) {
+            phasor feature = FeatureParameter(samples[sampleIndex], featureIndex)->Phasor;
+            realColumn[sampleIndex] = feature.RealPart();
+            imaginaryColumn[sampleIndex] = feature.ImaginaryPart();
+        }
+        for (int paddingIndex = numberOfSamples; paddingIndex < Stride; paddingIndex++) {
+            realColumn[paddingIndex] = 0;
+            imaginaryColumn[paddingIndex] = 0;
+        }
+    }
+    for (int sampleIndex = 0; sampleIndex < numberOfSamples; sampleIndex++) statuses[sampleIndex] = samples[sampleIndex]->IsWorking;
+
+    NumberOfSamples = numberOfSamples;
+}
+
+lineFeatureMatrix::lineFeatureMatrix(const double* values, const bool* statuses, int numberOfSamples, int stride,
+    int numberOfNode1OtherCurrents, int numberOfNode2OtherCurrents, const double* featureWeights, const int* startNodeNumbers,
+    const int* destinationNodeNumbers, size_t topologyKey)
+{
+    ownsColumns = false;
+    if ((values == NULL) || (statuses == NULL) || (numberOfSamples <= 0) || (stride < numberOfSamples) ||
+        (featureWeights == NULL) || (startNodeNumbers == NULL) || (destinationNodeNumbers == NULL)) {
+        cout << "Error: lineFeatureMatrix() needs the columns of at least one line sample.\n";
+        return;
+    }
+    if ((size_t)values % columnAlignment != 0) {
+        cout << "Error: lineFeatureMatrix(): the columns aren't aligned on " << to_string(columnAlignment) << " bytes.\n";
+        return;
+    }
+
+    NumberOfNode1OtherCurrents = numberOfNode1OtherCurrents;
+    NumberOfNode2OtherCurrents = numberOfNode2OtherCurrents;
+    NumberOfFeatures = 4 + NumberOfNode1OtherCurrents + NumberOfNode2OtherCurrents;
+    SquaredDistancesKernel = distanceKernel::Select(NumberOfNode1OtherCurrents, NumberOfNode2OtherCurrents);
+    BoundedSquaredDistancesKernel = distanceKernel::SelectBounded(NumberOfNode1OtherCurrents, NumberOfNode2OtherCurrents);
+    FeatureWeights = new double[NumberOfFeatures];
+    if (FeatureWeights == NULL) {
+        MemoryAllocationFailure("FeatureWeights");
+        return;
+    }
+    StartNodeNumbers = new int[NumberOfFeatures];
+    if (StartNodeNumbers == NULL) {
+        MemoryAllocationFailure("StartNodeNumbers");
+        return;
+    }
+    DestinationNodeNumbers = new int[NumberOfFeatures];
+    if (DestinationNodeNumbers == NULL) {
+        MemoryAllocationFailure("DestinationNodeNumbers");
+        return;
+    }
+    for (int featureIndex = 0; featureIndex < NumberOfFeatures; featureIndex++) {
+        FeatureWeights[featureIndex] = featureWeights[featureIndex];
+        StartNodeNumbers[featureIndex] = startNodeNumbers[featureIndex];
+        DestinationNodeNumbers[featureIndex] = destinationNodeNumbers[featureIndex];
+    }
+
+    // The columns are only read, so the borrowed block can be read-only memory
+    this->values = (double*)values;
+    this->statuses = (bool*)statuses;
+    Stride = stride;
+    TopologyKey = topologyKey;
+    NumberOfSamples = numberOfSamples;
+}
+
+lineFeatureMatrix::~lineFeatureMatrix()
+{
+    FreeMemory();
+}
+
+
+const double* lineFeatureMatrix::RealColumn(int featureIndex) const
+{
+    return values + (size_t)(2 * featureIndex) * Stride;
+}
+const double* lineFeatureMatrix::ImaginaryColumn(int featureIndex) const
+{
+    return values + (size_t)(2 * featureIndex + 1) * Stride;
+}
+const size_t lineFeatureMatrix::ColumnAlignment()
+{
+    return columnAlignment;
+}
+const bool lineFeatureMatrix::SetWeights(distanceWeights weights)
+{
+    if (FeatureWeights == NULL) return false;
+
+    // The same weighting as distanceSample::CalculateDistance()
+    FeatureWeights[0] = weights.WLine / 2;
+    FeatureWeights[1] = weights.WLine / 2;
+    FeatureWeights[2] = weights.WNode / 2;
+    FeatureWeights[3] = weights.WNode / 2;
+    for (int currentIndex = 0; currentIndex < NumberOfNode1OtherCurrents; currentIndex++) {
+        FeatureWeights[4 + currentIndex] = weights.WOther / (2 * (double)NumberOfNode1OtherCurrents);
+    }
+    for (int currentIndex = 0; currentIndex < NumberOfNode2OtherCurrents; currentIndex++) {
+        FeatureWeights[4 + NumberOfNode1OtherCurrents + currentIndex] = weights.WOther / (2 * (double)NumberOfNode2OtherCurrents);
+    }
+    weightsVersion++;
+    return true;
+}
+const long long lineFeatureMatrix::WeightsVersion() const
+{
+    return weightsVersion;
+}
+const bool lineFeatureMatrix::IsWorking(int sampleIndex) const
+{
+    return statuses[sampleIndex];
+}
+
+const bool lineFeatureMatrix::IsSampleOfTheSameLine(lineSample* sample) const
+{
+    KNN_TIME_STAGE(knnStage::TopologyCheck);
+    if (sample == NULL) {
+        cout << "Error in lineFeatureMatrix: lineSample* sample = NULL!\n";
+        return false;
+    }
+    if ((TopologyKey == 0) || (sample->TopologyKey() != TopologyKey)) return false;
+
+    // Different lines can hash to the same key, so the key only rules lines out and the layout and node numbers decide
+    if ((sample->NumberOfNode1OtherCurrents != NumberOfNode1OtherCurrents) ||
+        (sample->NumberOfNode2OtherCurrents != NumberOfNode2OtherCurrents)) return false;
+    if ((StartNodeNumbers == NULL) || (DestinationNodeNumbers == NULL)) return false;
+    for (int featureIndex = 0; featureIndex < NumberOfFeatures; featureIndex++) {
+        const parameter* feature = FeatureParameter(sample, featureIndex);
+        if ((feature == NULL) || (feature->StartNodeNumber != StartNodeNumbers[featureIndex]) ||
+            (feature->DestinationNodeNumber != DestinationNodeNumbers[featureIndex])) return false;
+    }
+    return true;
+}
+const void lineFeatureMatrix::ExtractFeatures(lineSample* sample, double* realParts, double* imaginaryParts) const
+{
+    for (int featureIndex = 0; featureIndex < NumberOfFeatures; featureIndex++) {
+        phasor feature = FeatureParameter(sample, featureIndex)->Phasor;
+        realParts[featureIndex] = feature.RealPart();
+        imaginaryParts[featureIndex] = feature.ImaginaryPart();
+    }
+}
+const double lineFeatureMatrix::SquaredDistance(int sampleIndex, const double* realParts, const double* imaginaryParts) const
+{
+    double squaredDistance = 0;
+    for (int featureIndex = 0; featureIndex < NumberOfFeatures; featureIndex++) {
+        double realDifference = RealColumn(featureIndex)[sampleIndex] - realParts[featureIndex];
+        double imaginaryDifference = ImaginaryColumn(featureIndex)[sampleIndex] - imaginaryParts[featureIndex];
+        squaredDistance += FeatureWeights[featureIndex] * (realDifference * realDifference + imaginaryDifference * imaginaryDifference);
+    }
+    return squaredDistance;
+}
\ No newline at end of file
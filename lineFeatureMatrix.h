@@ -0,0 +1,229 @@
+#pragma once
+
+#define _USE_MATH_DEFINES
+
+using namespace std;
+
+#include <cmath>
+#include <exception>
+#include <iostream>
+#include <new>
+#include <string>
+#include "phasor.h"
+#include "parameter.h"
+#include "nodeSample.h"
+#include "lineSample.h"
+#include "distanceWeights.h"
+
+
+class lineFeatureMatrix;
+/// <summary>
+/// A kernel of distanceKernel::SquaredDistances() for one line layout (see distanceKernel::Select())
+/// </summary>
+typedef const void (*squaredDistancesFunction)(const lineFeatureMatrix* features, int firstSampleIndex, int numberOfSamples,
+    const double* realParts, const double* imaginaryParts, double* squaredDistances);
+/// <summary>
+/// A kernel of distanceKernel::BoundedSquaredDistances() for one line layout (see distanceKernel::SelectBounded())
+/// </summary>
+typedef const int (*boundedSquaredDistancesFunction)(const lineFeatureMatrix* features, int firstSampleIndex, int numberOfSamples,
+    const double* realParts, const double* imaginaryParts, double bound, double* squaredDistances);
+
+
+/// <summary>
+/// The normalized parameters of a set of line samples of the same line stored as contiguous columns. A feature is one normalized
+/// phasor of the line sample in the order node 1 line current, node 2 line current, node 1 voltage, node 2 voltage, node 1 other
+/// currents, and node 2 other currents. Each feature has a column of real parts and a column of imaginary parts.
+/// </summary>
+class lineFeatureMatrix {
+private:
+    /// <summary>
+    /// The alignment of every column in bytes
+    /// </summary>
+    static const size_t columnAlignment = 64;
+    /// <summary>
+    /// The aligned block holding every column (2 * NumberOfFeatures columns of 'Stride' elements)
+    /// </summary>
+    double* values = NULL;
+    /// <summary>
+    /// The statuses of the line samples
+    /// </summary>
+    bool* statuses = NULL;
+    /// <summary>
+    /// False if values and statuses are borrowed (like the pages of a trainingSetFile) and aren't freed with this class
+    /// </summary>
+    bool ownsColumns = true;
+    /// <summary>
+    /// The number of times SetWeights() changed the weights
+    /// </summary>
+    long long weightsVersion = 0;
+
+
+    /// <summary>
+    /// Find the normalized parameter of a line sample that a feature index refers to.
+    /// </summary>
+    /// <param name="sample">The line sample</param>
+    /// <param name="featureIndex">The index of the feature</param>
+    /// <returns>The pointer to the normalized parameter</returns>
+    static parameter* FeatureParameter(lineSample* sample, int featureIndex);
+    /// <summary>
+    /// Record the topology key and the node numbers of every feature of the first line sample as the line every other line sample
+    /// must match.
+    /// </summary>
+    /// <param name="sample">The first line sample</param>
+    /// <returns>True if the memory allocation succeeded</returns>
+    const bool SetLineLayout(lineSample* sample);
+
+    /// <summary>
+    /// Free the dynamically allocated memory and set their pointers to NULL. Notice that the line samples aren't freed.
+    /// </summary>
+    const void FreeMemory();
+
+    /// <summary>
+    /// Display an error message and call FreeMemory().
+    /// </summary>
+    /// <param=variableName>The name of the variable that failed to get memory allocation</param>
+    const void MemoryAllocationFailure(string variableName);
+
+
+public:
+    /// <summary>
+    /// The number of line samples in the matrix
+    /// </summary>
+    int NumberOfSamples = 0;
+    /// <summary>
+    /// The number of elements allocated per column (NumberOfSamples rounded up so every column starts on the column alignment)
+    /// </summary>
+    int Stride = 0;
+    /// <summary>
+    /// The number of normalized phasors per line sample
+    /// </summary>
+    int NumberOfFeatures = 0;
+    /// <summary>
+    /// The number of currents flowing from node 1 not counting the line current
+    /// </summary>
+    int NumberOfNode1OtherCurrents = 0;
+    /// <summary>
+    /// The number of currents flowing from node 2 not counting the line current
+    /// </summary>
+    int NumberOfNode2OtherCurrents = 0;
+    /// <summary>
+    /// The weight of each feature in the weighted euclidean distance (the same weighting distanceSample uses)
+    /// </summary>
+    double* FeatureWeights = NULL;
+    /// <summary>
+    /// The topology key every line sample in the matrix shares (see lineSample::TopologyKey())
+    /// </summary>
+    size_t TopologyKey = 0;
+    /// <summary>
+    /// The starting node number of each feature
+    /// </summary>
+    int* StartNodeNumbers = NULL;
+    /// <summary>
+    /// The destination node number of each feature
+    /// </summary>
+    int* DestinationNodeNumbers = NULL;
+    /// <summary>
+    /// The distance kernel specialized for the numbers of other currents of the line, picked once when the matrix is built
+    /// </summary>
+    squaredDistancesFunction SquaredDistancesKernel = NULL;
+    /// <summary>
+    /// The early abandoning distance kernel specialized for the numbers of other currents of the line
+    /// </summary>
+    boundedSquaredDistancesFunction BoundedSquaredDistancesKernel = NULL;
+
+
+    /// <summary>
+    /// The constructor copies the normalized phasors of every line sample into the columns.
+    /// </summary>
+    /// <param name="samples">The array of line samples of the same line with known statuses</param>
+    /// <param name="numberOfSamples">The number of elements in the samples array</param>
+    /// <param name="weights">The weights of the weighted euclidean distance</param>
+    explicit lineFeatureMatrix(lineSample** samples, int numberOfSamples, distanceWeights weights = distanceWeights());
+    /// <summary>
+    /// This constructor uses previously laid out columns (like the mapped pages of a trainingSetFile) without copying them. The
+    /// columns won't be freed on the deconstructor and must outlive the matrix, and the small per-feature arrays are copied.
+    /// </summary>
+    /// <param name="values">
+    /// The block of 2 * NumberOfFeatures columns of 'stride' elements aligned on the column alignment</param>
+    /// <param name="statuses">The statuses of the line samples</param>
+    /// <param name="numberOfSamples">The number of line samples</param>
+    /// <param name="stride">The number of elements per column</param>
+    /// <param name="numberOfNode1OtherCurrents">The number of currents flowing from node 1 not counting the line current</param>
+    /// <param name="numberOfNode2OtherCurrents">The number of currents flowing from node 2 not counting the line current</param>
+    /// <param name="featureWeights">The weight of each feature</param>
+    /// <param name="startNodeNumbers">The starting node number of each feature</param>
+    /// <param name="destinationNodeNumbers">The destination node number of each feature</param>
+    /// <param name="topologyKey">The topology key of the line samples</param>
+    explicit lineFeatureMatrix(const double* values, const bool* statuses, int numberOfSamples, int stride,
+        int numberOfNode1OtherCurrents, int numberOfNode2OtherCurrents, const double* featureWeights, const int* startNodeNumbers,
+        const int* destinationNodeNumbers, size_t topologyKey);
+
+    /// <summary>
+    /// The deconstructor
+    /// </summary>
+    ~lineFeatureMatrix();
+
+    lineFeatureMatrix(const lineFeatureMatrix&) = delete;
+    lineFeatureMatrix& operator=(const lineFeatureMatrix&) = delete;
+
+
+    /// <summary>
+    /// The column of real parts of a feature
+    /// </summary>
+    /// <param name="featureIndex">The index of the feature</param>
+    /// <returns>The aligned column with 'Stride' elements</returns>
+    const double* RealColumn(int featureIndex) const;
+    /// <summary>
+    /// The column of imaginary parts of a feature
+    /// </summary>
+    /// <param name="featureIndex">The index of the feature</param>
+    /// <returns>The aligned column with 'Stride' elements</returns>
+    const double* ImaginaryColumn(int featureIndex) const;
+    /// <summary>
+    /// The alignment every column starts on in bytes
+    /// </summary>
+    static const size_t ColumnAlignment();
+    /// <summary>
+    /// Weight the features with new weights without touching the columns, like writing the weights picked by knnTuner into a
+    /// line's model. The matrix mustn't be scanned by another thread while its weights change. An index built over the matrix
+    /// before keeps the weights it was built with: kdTreeIndex scans every line sample until it's rebuilt, and ivfIndex and
+    /// compactFeatureIndex still rank with the new weights but pick their candidates with the old ones.
+    /// </summary>
+    /// <param name="weights">The weights of the weighted euclidean distance</param>
+    /// <returns>True if the matrix has features to weight and the memory allocation succeeded</returns>
+    const bool SetWeights(distanceWeights weights);
+    /// <summary>
+    /// The number of times SetWeights() changed the weights, so an index can tell if the weights it was built with are stale
+    /// </summary>
+    const long long WeightsVersion() const;
+    /// <summary>
+    /// The status of a line sample in the matrix
+    /// </summary>
+    /// <param name="sampleIndex">The index of the line sample</param>
+    /// <returns>True if the line is working</returns>
+    const bool IsWorking(int sampleIndex) const;
+
+    /// <summary>
+    /// Verify if a line sample is a sample of the same line as the line samples in the matrix. The topology keys are compared
+    /// first to rule out most other lines at once, then the numbers of other currents and the node numbers of every feature.
+    /// </summary>
+    /// <param name="sample">The line sample to check</param>
+    /// <returns>True if the line sample is of the same line</returns>
+    const bool IsSampleOfTheSameLine(lineSample* sample) const;
+    /// <summary>
+    /// Copy the normalized phasors of a line sample in feature order. This method assumes the line sample was checked to be of
+    /// the same line beforehand.
+    /// </summary>
+    /// <param name="sample">The line sample</param>
+    /// <param name="realParts">The array of NumberOfFeatures real parts to fill</param>
+    /// <param name="imaginaryParts">The array of NumberOfFeatures imaginary parts to fill</param>
+    const void ExtractFeatures(lineSample* sample, double* realParts, double* imaginaryParts) const;
+    /// <summary>
+    /// Calculate the squared weighted euclidean distance between a line sample in the matrix and extracted features.
+    /// </summary>
+    /// <param name="sampleIndex">The index of the line sample in the matrix</param>
+    /// <param name="realParts">The real parts of the features from ExtractFeatures()</param>
+    /// <param name="imaginaryParts">The imaginary parts of the features from ExtractFeatures()</param>
+    /// <returns>The squared weighted euclidean distance</returns>
+    const double SquaredDistance(int sampleIndex, const double* realParts, const double* imaginaryParts) const;
+};
\ No newline at end of file
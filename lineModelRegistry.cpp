@@ -0,0 +1,397 @@
+#define _USE_MATH_DEFINES
+
+using namespace std;
+
+#include <algorithm>
+#include <cmath>
+#include <exception>
+#include <functional>
+#include <iostream>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "phasor.h"
+#include "parameter.h"
+#include "nodeSample.h"
+#include "lineSample.h"
+#include "distanceWeights.h"
+#include "lineFeatureMatrix.h"
+#include "distanceKernel.h"
+#include "nearestNeighborHeap.h"
+#include "threadPool.h"
+#include "gridSnapshot.h"
+#include "lineModelRegistry.h"
+
+
+const long long lineModelRegistry::LineKey(int node1Number, int node2Number)
+{
+    return ((long long)node1Number << 32) | (long long)(unsigned int)node2Number;
+}
+lineFeatureMatrix* lineModelRegistry::FindModel(lineSample* sample, string functionName) const
+{
+    if ((sample == NULL) || (sample->TopologyKey() == 0)) {
+        cout << "Error in " << functionName << ": the line sample is NULL or wasn't constructed.\n";
+        return NULL;
+    }
+
+    int node1Number = sample->Node1LineCurrentNorm->StartNodeNumber;
+    int node2Number = sample->Node1LineCurrentNorm->DestinationNodeNumber;
+    auto model = models.find(LineKey(node1Number, node2Number));
+    if (model == models.end()) {
+        cout << "Error in " << functionName << ": the line from node " << to_string(node1Number) << " to node " <<
+            to_string(node2Number) << " isn't registered.\n";
+        return NULL;
+    }
+    if (model->second->IsSampleOfTheSameLine(sample) == false) {
+        cout << "Error in " << functionName << ": the line sample from node " << to_string(node1Number) << " to node " <<
+            to_string(node2Number) << " doesn't match the topology of the registered line.\n";
+        return NULL;
+    }
+    return model->second;
+}
+const bool lineModelRegistry::AllocateScratch()
+{
+    int requiredFeatures = 0;
+    for (auto& model : models) {
+        if (model.second->NumberOfFeatures > requiredFeatures) requiredFeatures = model.second->NumberOfFeatures;
+    }
+    int requiredSlots = 1;
+    if (pool != NULL) requiredSlots = pool->NumberOfThreads();
+    if ((heaps != NULL) && (scratchFeatures >= requiredFeatures) && (numberOfScratchSlots >= requiredSlots)) return true;
+
+    FreeScratch();
+    unknownRealParts = new double[(size_t)requiredSlots * requiredFeatures];
+    if (unknownRealParts == NULL) {
+        MemoryAllocationFailure("unknownRealParts");
+        return false;
+    }
+    unknownImaginaryParts = new double[(size_t)requiredSlots * requiredFeatures];
+    if (unknownImaginaryParts == NULL) {
+        MemoryAllocationFailure("unknownImaginaryParts");
+        return false;
+    }
+    blockDistances = new double[(size_t)requiredSlots * knownSamplesPerBlock];
+    if (blockDistances == NULL) {
+        MemoryAllocationFailure("blockDistances");
+        return false;
+    }
+    heaps = new nearestNeighborHeap*[requiredSlots];
+    if (heaps == NULL) {
+        MemoryAllocationFailure("heaps");
+        return false;
+    }
+    for (int slotIndex = 0; slotIndex < requiredSlots; slotIndex++) heaps[slotIndex] = NULL;
+    numberOfScratchSlots = requiredSlots;
+    for (int slotIndex = 0; slotIndex < requiredSlots; slotIndex++) {
+        heaps[slotIndex] = new nearestNeighborHeap(numberOfNearestNeighbors);
+        if (heaps[slotIndex] == NULL) {
+            MemoryAllocationFailure("heaps[slotIndex]");
+            return false;
+        }
+    }
+    scratchFeatures = requiredFeatures;
+    return true;
+}
+double* lineModelRegistry::SlotRealParts(int scratchIndex) const
+{
+    return unknownRealParts + (size_t)scratchIndex * scratchFeatures;
+}
+double* lineModelRegistry::SlotImaginaryParts(int scratchIndex) const
+{
+    return unknownImaginaryParts + (size_t)scratchIndex * scratchFeatures;
+}
+const bool lineModelRegistry::Predict(const lineFeatureMatrix* knownFeatures, int scratchIndex)
+{
+    double* realParts = SlotRealParts(scratchIndex);
+    double* imaginaryParts = SlotImaginaryParts(scratchIndex);
+    double* squaredDistances = blockDistances + (size_t)scratchIndex * knownSamplesPerBlock;
+    nearestNeighborHeap* heap = heaps[scratchIndex];
+
+    heap->Clear();
+    for (int firstKnownIndex = 0; firstKnownIndex < knownFeatures->NumberOfSamples; firstKnownIndex += knownSamplesPerBlock) {
+        int numberOfKnownsInBlock = knownSamplesPerBlock;
+        if (knownFeatures->NumberOfSamples - firstKnownIndex < knownSamplesPerBlock) {
+            numberOfKnownsInBlock = knownFeatures->NumberOfSamples - firstKnownIndex;
+        }
+        distanceKernel::SquaredDistances(knownFeatures, firstKnownIndex, numberOfKnownsInBlock, realParts, imaginaryParts,
+            squaredDistances);
+        for (int blockIndex = 0; blockIndex < numberOfKnownsInBlock; blockIndex++) {
+            heap->Push(squaredDistances[blockIndex], firstKnownIndex + blockIndex, knownFeatures->IsWorking(firstKnownIndex + blockIndex));
+        }
+    }
+
+    int numOfWorkingLines = 0;
+    int numOfNotWorkingLines = 0;
+    for (int heapIndex = 0; heapIndex < heap->Size(); heapIndex++) {
+        if (heap->Neighbor(heapIndex).IsWorking == true) numOfWorkingLines += 1;
+        else numOfNotWorkingLines += 1;
+    }
+
+    if (numOfWorkingLines > numOfNotWorkingLines) return true;
+    else return false;
+}
+const void lineModelRegistry::ForEachPrediction(int numberOfPredictions, const function<void(int, int)>& predict)
+{
+    auto predictRange = [&](int scratchIndex) {
+        int firstIndex = (int)((long long)scratchIndex * numberOfPredictions / numberOfScratchSlots);
+        int lastIndex = (int)((long long)(scratchIndex + 1) * numberOfPredictions / numberOfScratchSlots);
+        for (int predictionIndex = firstIndex; predictionIndex < lastIndex; predictionIndex++) predict(predictionIndex, scratchIndex);
+    };
+    if (pool != NULL) pool->ParallelFor(numberOfScratchSlots, predictRange);
+    else predictRange(0);
+}
+
+
+const void lineModelRegistry::FreeScratch()
+{
+    if (unknownRealParts != NULL) {
+        delete[] unknownRealParts;
+        unknownRealParts = NULL;
+    }
+    if (unknownImaginaryParts != NULL) {
+        delete[] unknownImaginaryParts;
+        unknownImaginaryParts = NULL;
+    }
+    if (blockDistances != NULL) {
+        delete[] blockDistances;
+        blockDistances = NULL;
+    }
+    if (heaps != NULL) {
+        for (int slotIndex = 0; slotIndex < numberOfScratchSlots; slotIndex++) {
+            if (heaps[slotIndex] != NULL) {
+                delete heaps[slotIndex];
+                heaps[slotIndex] = NULL;
+            }
+        }
+        delete[] heaps;
+        heaps = NULL;
+    }
+    numberOfScratchSlots = 0;
+    scratchFeatures = 0;
+}
+const void lineModelRegistry::FreeMemory()
+{
+    FreeScratch();
+    for (auto& model : models) delete model.second;
+    models.clear();
+}
+
+const void lineModelRegistry::MemoryAllocationFailure(string variableName)
+{
+    cout << "Error: lineModelRegistry() failed to allocate memory for " << variableName << "\n";
+    FreeScratch();
+}
+
+
+
+lineModelRegistry::lineModelRegistry(int numberOfNearestNeighbors, threadPool* pool, distanceWeights weights)
+{
+    this->numberOfNearestNeighbors = numberOfNearestNeighbors;
+    this->pool = pool;
+    this->weights = weights;
+}
+
+lineModelRegistry::~lineModelRegistry()
+{
+    FreeMemory();
+}
+
+
+const int lineModelRegistry::AddTrainingSamples(lineSample** samplesWithKnownStatuses, int numberOfKnownStatuses)
+{
+    if (samplesWithKnownStatuses == NULL) {
+        cout << "Error in AddTrainingSamples(): lineSample** samplesWithKnownStatuses = NULL!\n";
+        return 0;
+    }
+
+    // Group the line samples by line keeping their order within each line
+    unordered_map<long long, vector<lineSample*>> lines;
+    for (int sampleIndex = 0; sampleIndex < numberOfKnownStatuses; sampleIndex++) {
+        lineSample* sample = samplesWithKnownStatuses[sampleIndex];
+        if ((sample == NULL) || (sample->TopologyKey() == 0)) {
+            cout << "Error in AddTrainingSamples(): samplesWithKnownStatuses[" << to_string(sampleIndex) <<
+                "] is NULL or wasn't constructed and is skipped.\n";
+            continue;
+        }
+        lines[LineKey(sample->Node1LineCurrentNorm->StartNodeNumber, sample->Node1LineCurrentNorm->DestinationNodeNumber)]
+            .push_back(sample);
+    }
+
+    int numberOfLinesAdded = 0;
+    for (auto& line : lines) {
+        if ((int)line.second.size() < numberOfNearestNeighbors) {
+            cout << "Error in AddTrainingSamples(): a line has fewer known line samples than the number of nearest neighbors.\n";
+            continue;
+        }
+        lineFeatureMatrix* knownFeatures = new lineFeatureMatrix(line.second.data(), (int)line.second.size(), weights);
+        if (knownFeatures == NULL) {
+            MemoryAllocationFailure("knownFeatures");
+            continue;
+        }
+        if (knownFeatures->NumberOfSamples == 0) {     // The line samples weren't all of the same topology
+            delete knownFeatures;
+            continue;
+        }
+
+        auto model = models.find(line.first);
+        if (model != models.end()) {
+            delete model->second;
+            model->second = knownFeatures;
+        }
+        else models[line.first] = knownFeatures;
+        numberOfLinesAdded++;
+    }
+    return numberOfLinesAdded;
+}
+const bool lineModelRegistry::RemoveLine(int node1Number, int node2Number)
+{
+    auto model = models.find(LineKey(node1Number, node2Number));
+    if (model == models.end()) return false;
+    delete model->second;
+    models.erase(model);
+    return true;
+}
+const bool lineModelRegistry::SetLineWeights(int node1Number, int node2Number, distanceWeights weights)
+{
+    auto model = models.find(LineKey(node1Number, node2Number));
+    if (model == models.end()) {
+        cout << "Error in SetLineWeights(): the line between nodes " << to_string(node1Number) << " and " << to_string(node2Number) <<
+            " isn't registered.\n";
+        return false;
+    }
+    return model->second->SetWeights(weights);
+}
+const bool lineModelRegistry::ChangeNumberOfNearestNeighbors(int numberOfNearestNeighbors)
+{
+    if (IsValidNumberOfNearestNeighbors(numberOfNearestNeighbors) == false) return false;
+
+    this->numberOfNearestNeighbors = numberOfNearestNeighbors;
+    FreeScratch();
+    return true;
+}
+const bool lineModelRegistry::IsValidNumberOfNearestNeighbors(int numberOfNearestNeighbors) const
+{
+    if (numberOfNearestNeighbors <= 0) {
+        cout << "Error in ChangeNumberOfNearestNeighbors(): the number of nearest neighbors has to be at least one.\n";
+        return false;
+    }
+    for (auto& model : models) {
+        if (model.second->NumberOfSamples < numberOfNearestNeighbors) {
+            cout << "Error in ChangeNumberOfNearestNeighbors(): a line has fewer known line samples than nearest neighbors.\n";
+            return false;
+        }
+    }
+    return true;
+}
+const int lineModelRegistry::NumberOfLines() const
+{
+    return (int)models.size();
+}
+const int lineModelRegistry::NumberOfNearestNeighbors() const
+{
+    return numberOfNearestNeighbors;
+}
+const lineFeatureMatrix* lineModelRegistry::Features(int node1Number, int node2Number) const
+{
+    auto model = models.find(LineKey(node1Number, node2Number));
+    if (model == models.end()) return NULL;
+    return model->second;
+}
+
+
+const bool lineModelRegistry::PredictStatus(lineSample* sampleWithUnknownStatus, bool* predictedStatus)
+{
+    if (predictedStatus == NULL) {
+        cout << "Error in PredictStatus(): bool* predictedStatus = NULL!\n";
+        return false;
+    }
+    lineFeatureMatrix* knownFeatures = FindModel(sampleWithUnknownStatus, "PredictStatus()");
+    if (knownFeatures == NULL) return false;
+    if (AllocateScratch() == false) return false;
+
+    knownFeatures->ExtractFeatures(sampleWithUnknownStatus, SlotRealParts(0), SlotImaginaryParts(0));
+    *predictedStatus = Predict(knownFeatures, 0);
+    return true;
+}
+const vector<bool> lineModelRegistry::PredictStatuses(lineSample** samplesWithUnknownStatuses, int numberOfUnknownStatuses)
+{
+    vector<bool> predictedStatuses;
+
+    if (samplesWithUnknownStatuses == NULL) {
+        cout << "Error in PredictStatuses(): lineSample** samplesWithUnknownStatuses = NULL!\n";
+        return predictedStatuses;
+    }
+    if (numberOfUnknownStatuses <= 0) return predictedStatuses;
+
+    // Route every line sample before predicting so a bad snapshot fails as a whole
+    snapshotModels.resize(numberOfUnknownStatuses);
+    snapshotStatuses.resize(numberOfUnknownStatuses);
+    for (int sampleIndex = 0; sampleIndex < numberOfUnknownStatuses; sampleIndex++) {
+        snapshotModels[sampleIndex] = FindModel(samplesWithUnknownStatuses[sampleIndex], "PredictStatuses()");
+        if (snapshotModels[sampleIndex] == NULL) return predictedStatuses;
+    }
+    if (AllocateScratch() == false) return predictedStatuses;
+
+    ForEachPrediction(numberOfUnknownStatuses, [&](int sampleIndex, int scratchIndex) {
+        snapshotModels[sampleIndex]->ExtractFeatures(samplesWithUnknownStatuses[sampleIndex], SlotRealParts(scratchIndex),
+            SlotImaginaryParts(scratchIndex));
+        snapshotStatuses[sampleIndex] = Predict(snapshotModels[sampleIndex], scratchIndex);
+    });
+
+    predictedStatuses.reserve(numberOfUnknownStatuses);
+    for (int sampleIndex = 0; sampleIndex < numberOfUnknownStatuses; sampleIndex++) {
+        predictedStatuses.push_back(snapshotStatuses[sampleIndex] != 0);
+    }
+    return predictedStatuses;
+}
+const vector<bool> lineModelRegistry::PredictStatuses(const gridSnapshot* snapshot)
+{
+    vector<bool> predictedStatuses;
+
+    if (snapshot == NULL) {
+        cout << "Error in PredictStatuses(): const gridSnapshot* snapshot = NULL!\n";
+        return predictedStatuses;
+    }
+    int numberOfLines = snapshot->NumberOfLines();
+    if (numberOfLines == 0) return predictedStatuses;
+
+    // Route every line before predicting so a bad snapshot fails as a whole
+    snapshotModels.resize(numberOfLines);
+    snapshotStatuses.resize(numberOfLines);
+    snapshotIsReversed.resize(numberOfLines);
+    for (int lineIndex = 0; lineIndex < numberOfLines; lineIndex++) {
+        int node1Number = snapshot->Node1Number(lineIndex);
+        int node2Number = snapshot->Node2Number(lineIndex);
+        snapshotIsReversed[lineIndex] = false;
+        auto model = models.find(LineKey(node1Number, node2Number));
+        if (model == models.end()) {
+            snapshotIsReversed[lineIndex] = true;
+            model = models.find(LineKey(node2Number, node1Number));
+        }
+        if (model == models.end()) {
+            cout << "Error in PredictStatuses(): the line between node " << to_string(node1Number) << " and node " <<
+                to_string(node2Number) << " isn't registered.\n";
+            return predictedStatuses;
+        }
+        if (snapshotIsReversed[lineIndex] == true) swap(node1Number, node2Number);
+        if (snapshot->LineTopologyKey(node1Number, node2Number) != model->second->TopologyKey) {
+            cout << "Error in PredictStatuses(): the line from node " << to_string(node1Number) << " to node " <<
+                to_string(node2Number) << " doesn't match the topology of the registered line.\n";
+            return predictedStatuses;
+        }
+        snapshotModels[lineIndex] = model->second;
+    }
+    if (AllocateScratch() == false) return predictedStatuses;
+
+    ForEachPrediction(numberOfLines, [&](int lineIndex, int scratchIndex) {
+        int node1Number = snapshot->Node1Number(lineIndex);
+        int node2Number = snapshot->Node2Number(lineIndex);
+        if (snapshotIsReversed[lineIndex] == true) swap(node1Number, node2Number);
+        snapshot->ExtractLineFeatures(node1Number, node2Number, SlotRealParts(scratchIndex), SlotImaginaryParts(scratchIndex));
+        snapshotStatuses[lineIndex] = Predict(snapshotModels[lineIndex], scratchIndex);
+    });
+
+    predictedStatuses.reserve(numberOfLines);
+    for (int lineIndex = 0; lineIndex < numberOfLines; lineIndex++) predictedStatuses.push_back(snapshotStatuses[lineIndex] != 0);
+    return predictedStatuses;
+}
\ No newline at end of file
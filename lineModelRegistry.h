@@ -0,0 +1,240 @@
+#pragma once
+
+#define _USE_MATH_DEFINES
+
+using namespace std;
+
+#include <algorithm>
+#include <cmath>
+#include <exception>
+#include <functional>
+#include <iostream>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "phasor.h"
+#include "parameter.h"
+#include "nodeSample.h"
+#include "lineSample.h"
+#include "distanceWeights.h"
+#include "lineFeatureMatrix.h"
+#include "distanceKernel.h"
+#include "nearestNeighborHeap.h"
+#include "threadPool.h"
+#include "gridSnapshot.h"
+
+
+/// <summary>
+/// This holds the known line samples of every line in the grid as one feature matrix per line, keyed by the node numbers of the
+/// line, and routes each unknown line sample to the feature matrix of its line. The scratch space of the scan is kept between
+/// predictions so predicting doesn't allocate once it has grown to the largest line.
+/// </summary>
+class lineModelRegistry {
+private:
+    /// <summary>
+    /// The number of known line samples scored together by distanceKernel
+    /// </summary>
+    const int knownSamplesPerBlock = 256;
+    /// <summary>
+    /// The feature matrix of each line keyed by LineKey()
+    /// </summary>
+    unordered_map<long long, lineFeatureMatrix*> models;
+    /// <summary>
+    /// The number of nearest neighbors to consider
+    /// </summary>
+    int numberOfNearestNeighbors = 5;
+    /// <summary>
+    /// The weights the feature matrices are built with
+    /// </summary>
+    distanceWeights weights;
+    /// <summary>
+    /// The threads that evaluate a snapshot in parallel (NULL evaluates on the calling thread)
+    /// </summary>
+    threadPool* pool = NULL;
+    /// <summary>
+    /// The number of scratch slots (one per thread of the pool)
+    /// </summary>
+    int numberOfScratchSlots = 0;
+    /// <summary>
+    /// The largest number of features a scratch slot holds
+    /// </summary>
+    int scratchFeatures = 0;
+    /// <summary>
+    /// The real parts of the features of the unknown line sample of each scratch slot
+    /// </summary>
+    double* unknownRealParts = NULL;
+    /// <summary>
+    /// The imaginary parts of the features of the unknown line sample of each scratch slot
+    /// </summary>
+    double* unknownImaginaryParts = NULL;
+    /// <summary>
+    /// The squared distances of the block currently being scored by each scratch slot
+    /// </summary>
+    double* blockDistances = NULL;
+    /// <summary>
+    /// The nearest neighbors of each scratch slot
+    /// </summary>
+    nearestNeighborHeap** heaps = NULL;
+    /// <summary>
+    /// The feature matrix each line sample of the snapshot is routed to
+    /// </summary>
+    vector<lineFeatureMatrix*> snapshotModels;
+    /// <summary>
+    /// The predicted status of each line sample of the snapshot (char so the threads don't share bits)
+    /// </summary>
+    vector<char> snapshotStatuses;
+    /// <summary>
+    /// True for each line of a gridSnapshot registered with its nodes in the opposite order
+    /// </summary>
+    vector<char> snapshotIsReversed;
+
+
+    /// <summary>
+    /// The key of a line made of the node numbers it connects
+    /// </summary>
+    /// <param name="node1Number">The number of the first node of the line</param>
+    /// <param name="node2Number">The number of the second node of the line</param>
+    /// <returns>The key of the line</returns>
+    static const long long LineKey(int node1Number, int node2Number);
+    /// <summary>
+    /// Find the feature matrix of the line of a line sample and check the line sample against it.
+    /// </summary>
+    /// <param name="sample">The line sample</param>
+    /// <param name="functionName">The name of the calling function for the error messages</param>
+    /// <returns>The feature matrix (NULL if the line isn't registered or the line sample doesn't match it)</returns>
+    lineFeatureMatrix* FindModel(lineSample* sample, string functionName) const;
+    /// <summary>
+    /// Grow the scratch slots to hold the features of every registered line.
+    /// </summary>
+    /// <returns>True if the memory allocation succeeded</returns>
+    const bool AllocateScratch();
+    /// <summary>
+    /// The real parts of the features of the unknown line sample of a scratch slot
+    /// </summary>
+    /// <param name="scratchIndex">The scratch slot</param>
+    double* SlotRealParts(int scratchIndex) const;
+    /// <summary>
+    /// The imaginary parts of the features of the unknown line sample of a scratch slot
+    /// </summary>
+    /// <param name="scratchIndex">The scratch slot</param>
+    double* SlotImaginaryParts(int scratchIndex) const;
+    /// <summary>
+    /// Scan the known line samples of a line for the nearest neighbors of the features in a scratch slot and vote.
+    /// </summary>
+    /// <param name="knownFeatures">The feature matrix of the line</param>
+    /// <param name="scratchIndex">The scratch slot holding the features of the unknown line sample</param>
+    /// <returns>The predicted status</returns>
+    const bool Predict(const lineFeatureMatrix* knownFeatures, int scratchIndex);
+    /// <summary>
+    /// Run a task for each scratch slot with a contiguous range of predictions, in parallel when there is a thread pool.
+    /// </summary>
+    /// <param name="numberOfPredictions">The number of predictions</param>
+    /// <param name="predict">The task predicting one index with a scratch slot (index, scratchIndex)</param>
+    const void ForEachPrediction(int numberOfPredictions, const function<void(int, int)>& predict);
+
+    /// <summary>
+    /// Free the scratch space and set their pointers to NULL.
+    /// </summary>
+    const void FreeScratch();
+    /// <summary>
+    /// Free the dynamically allocated memory and set their pointers to NULL. Notice that the line samples aren't freed.
+    /// </summary>
+    const void FreeMemory();
+
+    /// <summary>
+    /// Display an error message and call FreeScratch().
+    /// </summary>
+    /// <param=variableName>The name of the variable that failed to get memory allocation</param>
+    const void MemoryAllocationFailure(string variableName);
+
+
+public:
+    /// <summary>
+    /// The constructor
+    /// </summary>
+    /// <param name="numberOfNearestNeighbors">The number of nearest neighbors each prediction is voted by</param>
+    /// <param name="pool">The threads to evaluate snapshots with (NULL evaluates on the calling thread)</param>
+    /// <param name="weights">The weights of the weighted euclidean distance</param>
+    explicit lineModelRegistry(int numberOfNearestNeighbors = 5, threadPool* pool = NULL, distanceWeights weights = distanceWeights());
+
+    /// <summary>
+    /// The deconstructor frees the feature matrices
+    /// </summary>
+    ~lineModelRegistry();
+
+
+    /// <summary>
+    /// Group line samples with known statuses by line and build a feature matrix for each line. The line samples can be of any
+    /// number of lines, and a line that is already registered has its feature matrix replaced. The line samples can be freed
+    /// afterwards.
+    /// </summary>
+    /// <param name="samplesWithKnownStatuses">The array of line samples with known line statuses</param>
+    /// <param name="numberOfKnownStatuses">The number of elements in the samplesWithKnownStatuses array</param>
+    /// <returns>The number of lines registered or replaced</returns>
+    const int AddTrainingSamples(lineSample** samplesWithKnownStatuses, int numberOfKnownStatuses);
+    /// <summary>
+    /// Remove a line and free its feature matrix.
+    /// </summary>
+    /// <param name="node1Number">The number of the first node of the line</param>
+    /// <param name="node2Number">The number of the second node of the line</param>
+    /// <returns>True if the line was registered</returns>
+    const bool RemoveLine(int node1Number, int node2Number);
+    /// <summary>
+    /// Weight the feature matrix of a line with new weights, like the ones picked by knnTuner.
+    /// </summary>
+    /// <param name="node1Number">The number of the first node of the line</param>
+    /// <param name="node2Number">The number of the second node of the line</param>
+    /// <param name="weights">The weights of the weighted euclidean distance</param>
+    /// <returns>True if the line is registered</returns>
+    const bool SetLineWeights(int node1Number, int node2Number, distanceWeights weights);
+    /// <summary>
+    /// Change the number of nearest neighbors every prediction is voted by. The heaps of the scratch space are rebuilt on the next
+    /// prediction.
+    /// </summary>
+    /// <param name="numberOfNearestNeighbors">The new number of nearest neighbors</param>
+    /// <returns>True if every registered line has at least that many known line samples</returns>
+    const bool ChangeNumberOfNearestNeighbors(int numberOfNearestNeighbors);
+    /// <summary>
+    /// Check a number of nearest neighbors ChangeNumberOfNearestNeighbors() would take, without changing anything.
+    /// </summary>
+    /// <param name="numberOfNearestNeighbors">The number of nearest neighbors</param>
+    /// <returns>True if it's at least one and every registered line has at least that many known line samples</returns>
+    const bool IsValidNumberOfNearestNeighbors(int numberOfNearestNeighbors) const;
+    /// <summary>
+    /// The number of registered lines
+    /// </summary>
+    const int NumberOfLines() const;
+    /// <summary>
+    /// The number of nearest neighbors every prediction is voted by
+    /// </summary>
+    const int NumberOfNearestNeighbors() const;
+    /// <summary>
+    /// The feature matrix of a line
+    /// </summary>
+    /// <param name="node1Number">The number of the first node of the line</param>
+    /// <param name="node2Number">The number of the second node of the line</param>
+    /// <returns>The feature matrix (NULL if the line isn't registered)</returns>
+    const lineFeatureMatrix* Features(int node1Number, int node2Number) const;
+
+    /// <summary>
+    /// Predict the status of a line sample with the known line samples of its line.
+    /// </summary>
+    /// <param name="sampleWithUnknownStatus">The line sample with an unknown line status</param>
+    /// <param name="predictedStatus">The predicted status</param>
+    /// <returns>True if the line is registered and the prediction succeeded</returns>
+    const bool PredictStatus(lineSample* sampleWithUnknownStatus, bool* predictedStatus);
+    /// <summary>
+    /// Predict the statuses of a snapshot of line samples of any number of lines, in parallel when there is a thread pool.
+    /// </summary>
+    /// <param name="samplesWithUnknownStatuses">The array of line samples with unknown line statuses</param>
+    /// <param name="numberOfUnknownStatuses">The number of elements in the samplesWithUnknownStatuses array</param>
+    /// <returns>The predicted status of each line sample in order (empty if any line sample is of an unregistered line)</returns>
+    const vector<bool> PredictStatuses(lineSample** samplesWithUnknownStatuses, int numberOfUnknownStatuses);
+    /// <summary>
+    /// Predict the status of every line of a grid snapshot from the normalized nodes without building line samples. A line can be
+    /// registered with its nodes in either order.
+    /// </summary>
+    /// <param name="snapshot">The grid snapshot</param>
+    /// <returns>The predicted status of each line of the snapshot in its line order (empty if any line isn't registered)</returns>
+    const vector<bool> PredictStatuses(const gridSnapshot* snapshot);
+};
\ No newline at end of file
@@ -2,58 +2,91 @@
 
 using namespace std;
 
+#include <algorithm>
 #include <cmath>
 #include <exception>
 #include <iostream>
 #include <string>
+#include <utility>
+#include <vector>
 #include "phasor.h"
 #include "parameter.h"
 #include "nodeSample.h"
+#include "sampleArena.h"
+#include "topologyHash.h"
 #include "lineSample.h"
+#include "allocationCounter.h"
+#include "latencyHistogram.h"
+#include "knnInstrumentationSnapshot.h"
+#include "knnInstrumentation.h"
+#include "knnStageTimer.h"
 
 
-const void lineSample::FreeMemory()
+parameter* lineSample::NewParameter()
+{
+    if (arena != NULL) return arena->New<parameter>();
+    if (numberOfOwnedParameters == (int)ownedParameters.size()) return NULL;
+    numberOfOwnedParameters++;
+    return &ownedParameters[(size_t)numberOfOwnedParameters - 1];
+}
+parameter** lineSample::NewParameterArray(int numberOfParameters)
+{
+    if (arena != NULL) return arena->NewArray<parameter*>(numberOfParameters);
+    if (numberOfOwnedOtherCurrents + numberOfParameters > (int)ownedOtherCurrents.size()) return NULL;
+    numberOfOwnedOtherCurrents += numberOfParameters;
+    return &ownedOtherCurrents[(size_t)numberOfOwnedOtherCurrents - numberOfParameters];
+}
+const void lineSample::SetNormalized(parameter* normalized, const parameter* measured, double rating)
+{
+    // Only the phasor is normalized, so the measured samples aren't copied
+    normalized->Phasor = measured->Phasor / phasor(rating, 0);
+    normalized->Name = measured->Name;
+    normalized->Units = measured->Units;
+    normalized->StartNodeNumber = measured->StartNodeNumber;
+    normalized->DestinationNodeNumber = measured->DestinationNodeNumber;
+}
+const void lineSample::SetTopologyKey()
 {
-    if (Node1LineCurrentNorm != NULL) {
-        delete Node1LineCurrentNorm;
-        Node1LineCurrentNorm = NULL;
+    // The same node numbers distanceSample used to compare one by one
+    topologyHash hash;
+    hash.Add(Node1LineCurrentNorm->StartNodeNumber);
+    hash.Add(Node1LineCurrentNorm->DestinationNodeNumber);
+    hash.Add(Node2LineCurrentNorm->StartNodeNumber);
+    hash.Add(Node2LineCurrentNorm->DestinationNodeNumber);
+    hash.Add(Node1VoltageNorm->StartNodeNumber);
+    hash.Add(Node2VoltageNorm->StartNodeNumber);
+    hash.Add(NumberOfNode1OtherCurrents);
+    for (int currentIndex = 0; currentIndex < NumberOfNode1OtherCurrents; currentIndex++) {
+        hash.Add(Node1OtherCurrentsNorm[currentIndex]->StartNodeNumber);
+        hash.Add(Node1OtherCurrentsNorm[currentIndex]->DestinationNodeNumber);
     }
-    if (Node2LineCurrentNorm != NULL) {
-        delete Node2LineCurrentNorm;
-        Node2LineCurrentNorm = NULL;
+    hash.Add(NumberOfNode2OtherCurrents);
+    for (int currentIndex = 0; currentIndex < NumberOfNode2OtherCurrents; currentIndex++) {
+        hash.Add(Node2OtherCurrentsNorm[currentIndex]->StartNodeNumber);
+        hash.Add(Node2OtherCurrentsNorm[currentIndex]->DestinationNodeNumber);
     }
 
-    if (Node1VoltageNorm != NULL) {
-        delete Node1VoltageNorm;
-        Node1VoltageNorm = NULL;
-    }
-    if (Node2VoltageNorm != NULL) {
-        delete Node2VoltageNorm;
-        Node2VoltageNorm = NULL;
-    }
+    topologyKey = hash.Key();
+}
 
-    if (Node1OtherCurrentsNorm != NULL) {
-        for (int deletingIndex = 0; deletingIndex < NumberOfNode1OtherCurrents; deletingIndex++) {
-            if (Node1OtherCurrentsNorm[deletingIndex] != NULL) {
-                delete Node1OtherCurrentsNorm[deletingIndex];
-                Node1OtherCurrentsNorm[deletingIndex] = NULL;
-            }
-        }
-        delete[] Node1OtherCurrentsNorm;
-        Node1OtherCurrentsNorm = NULL;
-        NumberOfNode1OtherCurrents = 0;
-    }
-    if (Node2OtherCurrentsNorm != NULL) {
-        for (int deletingIndex = 0; deletingIndex < NumberOfNode2OtherCurrents; deletingIndex++) {
-            if (Node2OtherCurrentsNorm[deletingIndex] != NULL) {
-                delete Node2OtherCurrentsNorm[deletingIndex];
-                Node2OtherCurrentsNorm[deletingIndex] = NULL;
-            }
-        }
-        delete[] Node2OtherCurrentsNorm;
-        Node2OtherCurrentsNorm = NULL;
-        NumberOfNode2OtherCurrents = 0;
-    }
+
+const void lineSample::FreeMemory()
+{
+    // The vectors free their own parameters, and the arena destroys its parameters on sampleArena::Release()
+    ownedParameters.clear();
+    numberOfOwnedParameters = 0;
+    ownedOtherCurrents.clear();
+    numberOfOwnedOtherCurrents = 0;
+
+    Node1LineCurrentNorm = NULL;
+    Node2LineCurrentNorm = NULL;
+    Node1VoltageNorm = NULL;
+    Node2VoltageNorm = NULL;
+    Node1OtherCurrentsNorm = NULL;
+    NumberOfNode1OtherCurrents = 0;
+    Node2OtherCurrentsNorm = NULL;
+    NumberOfNode2OtherCurrents = 0;
+    topologyKey = 0;
 }
 
 const void lineSample::MemoryAllocationFailure(string variableName)
@@ -64,14 +97,23 @@ const void lineSample::MemoryAllocationFailure(string variableName)
 
 
 
-lineSample::lineSample(shared_ptr<nodeSample> node1, shared_ptr<nodeSample> node2, bool isWorking)
+lineSample::lineSample(shared_ptr<nodeSample> node1, shared_ptr<nodeSample> node2, bool isWorking, sampleArena* arena)
 {
+    KNN_TIME_STAGE(knnStage::LineSampleConstruction);
+    this->arena = arena;
     this->node1 = node1;
     this->node2 = node2;
     IsWorking = isWorking;
 
+    // Every normalized parameter comes from one vector and every other current pointer from another
+    if (arena == NULL) {
+        int numberOfOtherCurrents = max(node1->NumberOfCurrents - 1, 0) + max(node2->NumberOfCurrents - 1, 0);
+        ownedParameters.resize(4 + (size_t)numberOfOtherCurrents);
+        ownedOtherCurrents.resize(numberOfOtherCurrents);
+    }
+
     // Node 1 line current
-    Node1LineCurrentNorm = new parameter();
+    Node1LineCurrentNorm = NewParameter();
     if (Node1LineCurrentNorm == NULL) {
         MemoryAllocationFailure("Node1LineCurrentNorm");
         return;
@@ -79,8 +121,7 @@ lineSample::lineSample(shared_ptr<nodeSample> node1, shared_ptr<nodeSample> node
     bool foundCurrent = false;
     for (int currentIndex = 0; currentIndex < node1->NumberOfCurrents; currentIndex++) {    // Find the current going to node 2
         if (node1->Currents[currentIndex]->DestinationNodeNumber == node2->NodeNumber) {    // Found the current going to node 2
-            *Node1LineCurrentNorm = *node1->Currents[currentIndex];
-            Node1LineCurrentNorm->Phasor = node1->Currents[currentIndex]->Phasor / phasor(node1->RatedCurrent, 0);
+            SetNormalized(Node1LineCurrentNorm, node1->Currents[currentIndex], node1->RatedCurrent);
             foundCurrent = true;
             break;
         }
@@ -92,7 +133,7 @@ lineSample::lineSample(shared_ptr<nodeSample> node1, shared_ptr<nodeSample> node
     }
 
     // Node 2 line current
-    Node2LineCurrentNorm = new parameter();
+    Node2LineCurrentNorm = NewParameter();
     if (Node2LineCurrentNorm == NULL) {
         MemoryAllocationFailure("Node2LineCurrentNorm");
         return;
@@ -100,8 +141,7 @@ lineSample::lineSample(shared_ptr<nodeSample> node1, shared_ptr<nodeSample> node
     foundCurrent = false;
     for (int currentIndex = 0; currentIndex < node2->NumberOfCurrents; currentIndex++) {    // Find the current going to node 1
         if (node2->Currents[currentIndex]->DestinationNodeNumber == node1->NodeNumber) {    // Found the current going to node 1
-            *Node2LineCurrentNorm = *node2->Currents[currentIndex];
-            Node2LineCurrentNorm->Phasor = node2->Currents[currentIndex]->Phasor / phasor(node2->RatedCurrent, 0);
+            SetNormalized(Node2LineCurrentNorm, node2->Currents[currentIndex], node2->RatedCurrent);
             foundCurrent = true;
             break;
         }
@@ -113,28 +153,26 @@ lineSample::lineSample(shared_ptr<nodeSample> node1, shared_ptr<nodeSample> node
     }
 
     // Node 1 voltage
-    Node1VoltageNorm = new parameter();
+    Node1VoltageNorm = NewParameter();
     if (Node1VoltageNorm == NULL) {
         MemoryAllocationFailure("Node1VoltageNorm");
         return;
     }
-    *Node1VoltageNorm = *node1->Voltage;
-    Node1VoltageNorm->Phasor = node1->Voltage->Phasor / phasor(node1->RatedVoltage, 0);
+    SetNormalized(Node1VoltageNorm, node1->Voltage, node1->RatedVoltage);
 
     // Node 2 voltage
-    Node2VoltageNorm = new parameter();
+    Node2VoltageNorm = NewParameter();
     if (Node2VoltageNorm == NULL) {
         MemoryAllocationFailure("Node2VoltageNorm");
         return;
     }
-    *Node2VoltageNorm = *node2->Voltage;
-    Node2VoltageNorm->Phasor = node2->Voltage->Phasor / phasor(node2->RatedVoltage, 0);
+    SetNormalized(Node2VoltageNorm, node2->Voltage, node2->RatedVoltage);
 
     // Node 1 other currents
     if (node1->NumberOfCurrents <= 1) NumberOfNode1OtherCurrents = 0;
     else {
         NumberOfNode1OtherCurrents = node1->NumberOfCurrents - 1;
-        Node1OtherCurrentsNorm = new parameter*[NumberOfNode1OtherCurrents];
+        Node1OtherCurrentsNorm = NewParameterArray(NumberOfNode1OtherCurrents);
         if (Node1OtherCurrentsNorm == NULL) {
             MemoryAllocationFailure("Node1OtherCurrentsNorm");
             return;
@@ -150,26 +188,22 @@ lineSample::lineSample(shared_ptr<nodeSample> node1, shared_ptr<nodeSample> node
                 if (node1->Currents[currentIndex]->DestinationNodeNumber == node2->NodeNumber) foundCurrent = true;
 
                 else if (currentIndex < node1->NumberOfCurrents - 1) {
-                    Node1OtherCurrentsNorm[currentIndex] = new parameter();
+                    Node1OtherCurrentsNorm[currentIndex] = NewParameter();
                     if (Node1OtherCurrentsNorm[currentIndex] == NULL) {
                         MemoryAllocationFailure("Node1OtherCurrentsNorm[currentIndex]");
                         return;
                     }
-                    *Node1OtherCurrentsNorm[currentIndex] = *node1->Currents[currentIndex];
-                    Node1OtherCurrentsNorm[currentIndex]->Phasor =
-                        node1->Currents[currentIndex]->Phasor / phasor(node1->RatedCurrent, 0);
+                    SetNormalized(Node1OtherCurrentsNorm[currentIndex], node1->Currents[currentIndex], node1->RatedCurrent);
                 }
             }
 
             else {
-                Node1OtherCurrentsNorm[currentIndex - 1] = new parameter();
+                Node1OtherCurrentsNorm[currentIndex - 1] = NewParameter();
                 if (Node1OtherCurrentsNorm[currentIndex - 1] == NULL) {
                     MemoryAllocationFailure("Node1OtherCurrentsNorm[currentIndex - 1]");
                     return;
                 }
-                *Node1OtherCurrentsNorm[currentIndex - 1] = *node1->Currents[currentIndex];
-                Node1OtherCurrentsNorm[currentIndex - 1]->Phasor =
-                    node1->Currents[currentIndex]->Phasor / phasor(node1->RatedCurrent, 0);
+                SetNormalized(Node1OtherCurrentsNorm[currentIndex - 1], node1->Currents[currentIndex], node1->RatedCurrent);
             }
         }
     }
@@ -178,7 +212,7 @@ lineSample::lineSample(shared_ptr<nodeSample> node1, shared_ptr<nodeSample> node
     if (node2->NumberOfCurrents <= 1) NumberOfNode2OtherCurrents = 0;
     else {
         NumberOfNode2OtherCurrents = node2->NumberOfCurrents - 1;
-        Node2OtherCurrentsNorm = new parameter * [NumberOfNode2OtherCurrents];
+        Node2OtherCurrentsNorm = NewParameterArray(NumberOfNode2OtherCurrents);
         if (Node2OtherCurrentsNorm == NULL) {
             MemoryAllocationFailure("Node2OtherCurrentsNorm");
             return;
@@ -193,29 +227,70 @@ lineSample::lineSample(shared_ptr<nodeSample> node1, shared_ptr<nodeSample> node
                 if (node2->Currents[currentIndex]->DestinationNodeNumber == node1->NodeNumber) foundCurrent = true;
 
                 else if (currentIndex < node2->NumberOfCurrents - 1) {
-                    Node2OtherCurrentsNorm[currentIndex] = new parameter();
+                    Node2OtherCurrentsNorm[currentIndex] = NewParameter();
                     if (Node2OtherCurrentsNorm[currentIndex] == NULL) {
                         MemoryAllocationFailure("Node2OtherCurrentsNorm[currentIndex]");
                         return;
                     }
-                    *Node2OtherCurrentsNorm[currentIndex] = *node2->Currents[currentIndex];
-                    Node2OtherCurrentsNorm[currentIndex]->Phasor =
-                        node2->Currents[currentIndex]->Phasor / phasor(node2->RatedCurrent, 0);
+                    SetNormalized(Node2OtherCurrentsNorm[currentIndex], node2->Currents[currentIndex], node2->RatedCurrent);
                 }
             }
 
             else {
-                Node2OtherCurrentsNorm[currentIndex - 1] = new parameter();
+                Node2OtherCurrentsNorm[currentIndex - 1] = NewParameter();
                 if (Node2OtherCurrentsNorm[currentIndex - 1] == NULL) {
                     MemoryAllocationFailure("Node2OtherCurrentsNorm[currentIndex - 1]");
                     return;
                 }
-                *Node2OtherCurrentsNorm[currentIndex - 1] = *node2->Currents[currentIndex];
-                Node2OtherCurrentsNorm[currentIndex - 1]->Phasor =
-                    node2->Currents[currentIndex]->Phasor / phasor(node2->RatedCurrent, 0);
+                SetNormalized(Node2OtherCurrentsNorm[currentIndex - 1], node2->Currents[currentIndex], node2->RatedCurrent);
             }
         }
     }
+
+    SetTopologyKey();
+}
+
+lineSample::lineSample(const lineSample& other)
+{
+    node1 = other.node1;
+    node2 = other.node2;
+    IsWorking = other.IsWorking;
+    if (other.Node1LineCurrentNorm == NULL) return;   // Nothing to copy from a failed or moved-from line sample
+
+    // The copy owns its parameters even when the other line sample's are in an arena
+    int numberOfOtherCurrents = other.NumberOfNode1OtherCurrents + other.NumberOfNode2OtherCurrents;
+    ownedParameters.reserve(4 + (size_t)numberOfOtherCurrents);
+    ownedParameters.push_back(*other.Node1LineCurrentNorm);
+    ownedParameters.push_back(*other.Node2LineCurrentNorm);
+    ownedParameters.push_back(*other.Node1VoltageNorm);
+    ownedParameters.push_back(*other.Node2VoltageNorm);
+    for (int currentIndex = 0; currentIndex < other.NumberOfNode1OtherCurrents; currentIndex++) {
+        ownedParameters.push_back(*other.Node1OtherCurrentsNorm[currentIndex]);
+    }
+    for (int currentIndex = 0; currentIndex < other.NumberOfNode2OtherCurrents; currentIndex++) {
+        ownedParameters.push_back(*other.Node2OtherCurrentsNorm[currentIndex]);
+    }
+    numberOfOwnedParameters = (int)ownedParameters.size();
+    ownedOtherCurrents.resize(numberOfOtherCurrents);
+    numberOfOwnedOtherCurrents = numberOfOtherCurrents;
+
+    // Point into the new vectors in the same order they were filled
+    Node1LineCurrentNorm = &ownedParameters[0];
+    Node2LineCurrentNorm = &ownedParameters[1];
+    Node1VoltageNorm = &ownedParameters[2];
+    Node2VoltageNorm = &ownedParameters[3];
+    for (int currentIndex = 0; currentIndex < numberOfOtherCurrents; currentIndex++) {
+        ownedOtherCurrents[currentIndex] = &ownedParameters[4 + (size_t)currentIndex];
+    }
+    NumberOfNode1OtherCurrents = other.NumberOfNode1OtherCurrents;
+    if (NumberOfNode1OtherCurrents > 0) Node1OtherCurrentsNorm = &ownedOtherCurrents[0];
+    NumberOfNode2OtherCurrents = other.NumberOfNode2OtherCurrents;
+    if (NumberOfNode2OtherCurrents > 0) Node2OtherCurrentsNorm = &ownedOtherCurrents[NumberOfNode1OtherCurrents];
+    topologyKey = other.topologyKey;
+}
+lineSample::lineSample(lineSample&& other) noexcept
+{
+    *this = move(other);
 }
 
 lineSample::~lineSample()
@@ -224,6 +299,45 @@ lineSample::~lineSample()
 }
 
 
+lineSample& lineSample::operator=(const lineSample& other)
+{
+    if (this != &other) *this = lineSample(other);
+    return *this;
+}
+lineSample& lineSample::operator=(lineSample&& other) noexcept
+{
+    if (this == &other) return *this;
+    FreeMemory();
+
+    // Moving the vectors keeps their elements in place, so the pointers into them stay valid
+    node1 = move(other.node1);
+    node2 = move(other.node2);
+    arena = other.arena;
+    ownedParameters = move(other.ownedParameters);
+    numberOfOwnedParameters = other.numberOfOwnedParameters;
+    ownedOtherCurrents = move(other.ownedOtherCurrents);
+    numberOfOwnedOtherCurrents = other.numberOfOwnedOtherCurrents;
+    Node1LineCurrentNorm = other.Node1LineCurrentNorm;
+    Node2LineCurrentNorm = other.Node2LineCurrentNorm;
+    Node1VoltageNorm = other.Node1VoltageNorm;
+    Node2VoltageNorm = other.Node2VoltageNorm;
+    Node1OtherCurrentsNorm = other.Node1OtherCurrentsNorm;
+    NumberOfNode1OtherCurrents = other.NumberOfNode1OtherCurrents;
+    Node2OtherCurrentsNorm = other.Node2OtherCurrentsNorm;
+    NumberOfNode2OtherCurrents = other.NumberOfNode2OtherCurrents;
+    IsWorking = other.IsWorking;
+    topologyKey = other.topologyKey;
+
+    other.FreeMemory();
+    return *this;
+}
+
+
+const size_t lineSample::TopologyKey() const
+{
+    return topologyKey;
+}
+
 const void lineSample::PrintLine()
 {
     cout << "\nNode 1:\n";
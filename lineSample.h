@@ -7,10 +7,14 @@ using namespace std;
 #include <cmath>
 #include <exception>
 #include <iostream>
+#include <memory>
 #include <string>
+#include <vector>
 #include "phasor.h"
 #include "parameter.h"
 #include "nodeSample.h"
+#include "sampleArena.h"
+#include "topologyHash.h"
 
 
 /// <summary>
@@ -26,6 +30,55 @@ private:
     /// The second node the line is connected to
     /// </summary>
     shared_ptr<nodeSample> node2 = NULL;
+    /// <summary>
+    /// The hash of the node numbers of every normalized parameter (0 if the constructor failed)
+    /// </summary>
+    size_t topologyKey = 0;
+    /// <summary>
+    /// The arena the normalized parameters were built in (NULL if they're freed with this class)
+    /// </summary>
+    sampleArena* arena = NULL;
+    /// <summary>
+    /// Every normalized parameter when they're built by this class on the heap
+    /// </summary>
+    vector<parameter> ownedParameters;
+    /// <summary>
+    /// The number of ownedParameters handed out by NewParameter()
+    /// </summary>
+    int numberOfOwnedParameters = 0;
+    /// <summary>
+    /// The pointers Node1OtherCurrentsNorm and Node2OtherCurrentsNorm point into when they're built by this class on the heap
+    /// </summary>
+    vector<parameter*> ownedOtherCurrents;
+    /// <summary>
+    /// The number of ownedOtherCurrents handed out by NewParameterArray()
+    /// </summary>
+    int numberOfOwnedOtherCurrents = 0;
+
+
+    /// <summary>
+    /// Take an empty normalized parameter from the arena or from ownedParameters.
+    /// </summary>
+    /// <returns>The parameter or NULL if the memory allocation failed</returns>
+    parameter* NewParameter();
+    /// <summary>
+    /// Take an array of normalized parameter pointers from the arena or from ownedOtherCurrents.
+    /// </summary>
+    /// <param name="numberOfParameters">The number of elements</param>
+    /// <returns>The array or NULL if the memory allocation failed</returns>
+    parameter** NewParameterArray(int numberOfParameters);
+    /// <summary>
+    /// Set a normalized parameter to a measured parameter with the magnitude divided by the rating.
+    /// </summary>
+    /// <param name="normalized">The normalized parameter</param>
+    /// <param name="measured">The measured parameter of the node</param>
+    /// <param name="rating">The rated voltage or current of the node</param>
+    static const void SetNormalized(parameter* normalized, const parameter* measured, double rating);
+    /// <summary>
+    /// Hash the node numbers of every normalized parameter into the topology key with topologyHash. Two line samples of the same
+    /// line get the same key, so most other lines are ruled out by one integer comparison.
+    /// </summary>
+    const void SetTopologyKey();
 
 
     /// <summary>
@@ -88,14 +141,50 @@ public:
     /// <param name="node1">The first node of the line</param>
     /// <param name="node2">The second node of the line</param>
     /// <param name="isWorking">The status of the line</param>
-    explicit lineSample(shared_ptr<nodeSample> node1, shared_ptr<nodeSample> node2, bool isWorking);
+    /// <param name="arena">
+    /// The arena to build the normalized parameters in (NULL allocates them on the heap). The arena releases them instead of this
+    /// class, so it has to outlive the line sample.</param>
+    explicit lineSample(shared_ptr<nodeSample> node1, shared_ptr<nodeSample> node2, bool isWorking, sampleArena* arena = NULL);
+
+    /// <summary>
+    /// The copy constructor copies the normalized parameters so the copy owns its own, even when the other's are in an arena.
+    /// </summary>
+    /// <param name="other">The line sample to copy</param>
+    lineSample(const lineSample& other);
+    /// <summary>
+    /// The move constructor takes the normalized parameters of the other line sample without copying them.
+    /// </summary>
+    /// <param name="other">The line sample to move (left without parameters)</param>
+    lineSample(lineSample&& other) noexcept;
 
     /// <summary>
     /// The deconstructor
     /// </summary>
     ~lineSample();
+
+
+    /// <summary>
+    /// Free the normalized parameters and copy the other line sample's.
+    /// </summary>
+    /// <param name="other">The line sample to copy</param>
+    /// <returns>This line sample</returns>
+    lineSample& operator=(const lineSample& other);
+    /// <summary>
+    /// Free the normalized parameters and take the other line sample's without copying them.
+    /// </summary>
+    /// <param name="other">The line sample to move (left without parameters)</param>
+    /// <returns>This line sample</returns>
+    lineSample& operator=(lineSample&& other) noexcept;
     
 
+    /// <summary>
+    /// The topology key computed by the constructor. Line samples of the same line, meaning the node numbers of the line currents,
+    /// node voltages, and other currents all match, have the same key. Different lines can collide on a key, so equal keys only
+    /// mean the line samples are likely of the same line.
+    /// </summary>
+    /// <returns>The topology key (0 if the constructor failed)</returns>
+    const size_t TopologyKey() const;
+
     /// <summary>
     /// Print the nodes, line status, and normalized parameters.
     /// </summary>
@@ -0,0 +1,20 @@
+#pragma once
+
+/// <summary>
+/// A known line sample's squared distance from an unknown line sample
+/// </summary>
+class nearestNeighbor {
+public:
+    /// <summary>
+    /// The squared weighted euclidean distance from the unknown line sample
+    /// </summary>
+    double SquaredDistance;
+    /// <summary>
+    /// The index of the known line sample
+    /// </summary>
+    int Index;
+    /// <summary>
+    /// The status of the known line sample
+    /// </summary>
+    bool IsWorking;
+};
\ No newline at end of file
@@ -0,0 +1,148 @@
+#define _USE_MATH_DEFINES
+
+using namespace std;
+
+#include <algorithm>
+#include <cmath>
+#include <exception>
+#include <iostream>
+#include <limits>
+#include <string>
+#include "nearestNeighbor.h"
+#include "allocationCounter.h"
+#include "latencyHistogram.h"
+#include "knnInstrumentationSnapshot.h"
+#include "knnInstrumentation.h"
+#include "knnStageTimer.h"
+#include "nearestNeighborHeap.h"
+
+
+const void nearestNeighborHeap::SiftUp(int heapIndex)
+{
+    nearestNeighbor entry = neighbors[heapIndex];
+    while (heapIndex > 0) {
+        int parentIndex = (heapIndex - 1) / 2;
+        if (IsNearer(entry, neighbors[parentIndex]) == true) break;
+        neighbors[heapIndex] = neighbors[parentIndex];
+        heapIndex = parentIndex;
+    }
+    neighbors[heapIndex] = entry;
+}
+const void nearestNeighborHeap::SiftDown(int heapIndex)
+{
+    nearestNeighbor entry = neighbors[heapIndex];
+    while (true) {
+        int childIndex = 2 * heapIndex + 1;
+        if (childIndex >= size) break;
+        // Follow the farther child
+        if ((childIndex + 1 < size) && (IsNearer(neighbors[childIndex], neighbors[childIndex + 1]) == true)) childIndex++;
+        if (IsNearer(neighbors[childIndex], entry) == true) break;
+        neighbors[heapIndex] = neighbors[childIndex];
+        heapIndex = childIndex;
+    }
+    neighbors[heapIndex] = entry;
+}
+
+
+const void nearestNeighborHeap::FreeMemory()
+{
+    if (neighbors != NULL) {
+        delete[] neighbors;
+        neighbors = NULL;
+    }
+    capacity = 0;
+    size = 0;
+}
+
+const void nearestNeighborHeap::MemoryAllocationFailure(string variableName)
+{
+    cout << "Error: nearestNeighborHeap() failed to allocate memory for " << variableName << "\n";
+    FreeMemory();
+}
+
+
+
+nearestNeighborHeap::nearestNeighborHeap(int capacity)
+{
+    if (capacity <= 0) {
+        cout << "Error: nearestNeighborHeap() needs a capacity of at least one.\n";
+        return;
+    }
+    neighbors = new nearestNeighbor[capacity];
+    if (neighbors == NULL) {
+        MemoryAllocationFailure("neighbors");
+        return;
+    }
+    this->capacity = capacity;
+}
+
+nearestNeighborHeap::~nearestNeighborHeap()
+{
+    FreeMemory();
+}
+
+
+const bool nearestNeighborHeap::IsNearer(const nearestNeighbor& lhs, const nearestNeighbor& rhs)
+{
+    if (lhs.SquaredDistance != rhs.SquaredDistance) return lhs.SquaredDistance < rhs.SquaredDistance;
+    return lhs.Index < rhs.Index;
+}
+const void nearestNeighborHeap::SelectNearest(nearestNeighbor* candidates, int numberOfCandidates, int numberOfNearestNeighbors)
+{
+    if (numberOfNearestNeighbors > numberOfCandidates) numberOfNearestNeighbors = numberOfCandidates;
+    if (numberOfNearestNeighbors <= 0) return;
+
+    nth_element(candidates, candidates + numberOfNearestNeighbors - 1, candidates + numberOfCandidates, IsNearer);
+    sort(candidates, candidates + numberOfNearestNeighbors, IsNearer);
+}
+
+const void nearestNeighborHeap::Push(double squaredDistance, int index, bool isWorking)
+{
+    KNN_COUNT(knnCounter::NeighborsPushed, 1);
+    nearestNeighbor candidate;
+    candidate.SquaredDistance = squaredDistance;
+    candidate.Index = index;
+    candidate.IsWorking = isWorking;
+
+    if (size < capacity) {
+        neighbors[size] = candidate;
+        size++;
+        SiftUp(size - 1);
+    }
+    else if ((capacity > 0) && (IsNearer(candidate, neighbors[0]) == true)) {
+        neighbors[0] = candidate;
+        SiftDown(0);
+    }
+}
+const void nearestNeighborHeap::PushAll(const nearestNeighborHeap* other)
+{
+    for (int heapIndex = 0; heapIndex < other->size; heapIndex++) {
+        Push(other->neighbors[heapIndex].SquaredDistance, other->neighbors[heapIndex].Index, other->neighbors[heapIndex].IsWorking);
+    }
+}
+const void nearestNeighborHeap::Clear()
+{
+    size = 0;
+}
+const double nearestNeighborHeap::WorstSquaredDistance() const
+{
+    if ((size < capacity) || (capacity == 0)) return numeric_limits<double>::infinity();
+    return neighbors[0].SquaredDistance;
+}
+const int nearestNeighborHeap::Size() const
+{
+    return size;
+}
+const int nearestNeighborHeap::Capacity() const
+{
+    return capacity;
+}
+const nearestNeighbor& nearestNeighborHeap::Neighbor(int heapIndex) const
+{
+    return neighbors[heapIndex];
+}
+const void nearestNeighborHeap::CopySorted(nearestNeighbor* sortedNeighbors) const
+{
+    for (int heapIndex = 0; heapIndex < size; heapIndex++) sortedNeighbors[heapIndex] = neighbors[heapIndex];
+    sort(sortedNeighbors, sortedNeighbors + size, IsNearer);
+}
\ No newline at end of file
@@ -0,0 +1,126 @@
+#pragma once
+
+#define _USE_MATH_DEFINES
+
+using namespace std;
+
+#include <cmath>
+#include <exception>
+#include <iostream>
+#include <string>
+#include "nearestNeighbor.h"
+
+
+/// <summary>
+/// A bounded max heap keeping the k nearest neighbors seen so far with the farthest one at the root. Ties in distance are broken
+/// by the known line sample index so the lower index is the nearer one. Nothing is allocated after the constructor.
+/// </summary>
+class nearestNeighborHeap {
+private:
+    /// <summary>
+    /// The heap of nearest neighbors stored by value
+    /// </summary>
+    nearestNeighbor* neighbors = NULL;
+    /// <summary>
+    /// The maximum number of nearest neighbors kept
+    /// </summary>
+    int capacity = 0;
+    /// <summary>
+    /// The number of nearest neighbors currently in the heap
+    /// </summary>
+    int size = 0;
+
+
+    /// <summary>
+    /// Move the entry at the index up until its parent is farther than it.
+    /// </summary>
+    /// <param name="heapIndex">The index of the entry</param>
+    const void SiftUp(int heapIndex);
+    /// <summary>
+    /// Move the entry at the index down until both of its children are nearer than it.
+    /// </summary>
+    /// <param name="heapIndex">The index of the entry</param>
+    const void SiftDown(int heapIndex);
+
+    /// <summary>
+    /// Free the dynamically allocated memory and set their pointers to NULL.
+    /// </summary>
+    const void FreeMemory();
+
+    /// <summary>
+    /// Display an error message and call FreeMemory().
+    /// </summary>
+    /// <param=variableName>The name of the variable that failed to get memory allocation</param>
+    const void MemoryAllocationFailure(string variableName);
+
+
+public:
+    /// <summary>
+    /// The constructor
+    /// </summary>
+    /// <param name="capacity">The number of nearest neighbors to keep</param>
+    explicit nearestNeighborHeap(int capacity);
+
+    /// <summary>
+    /// The deconstructor
+    /// </summary>
+    ~nearestNeighborHeap();
+
+
+    /// <summary>
+    /// Compare two neighbors by squared distance and then by index.
+    /// </summary>
+    /// <param name="lhs">The first neighbor</param>
+    /// <param name="rhs">The second neighbor</param>
+    /// <returns>True if lhs is nearer than rhs</returns>
+    static const bool IsNearer(const nearestNeighbor& lhs, const nearestNeighbor& rhs);
+    /// <summary>
+    /// Keep the k nearest of a set of candidates by partially sorting them in place, which is faster than the heap when k is a large
+    /// fraction of the candidates. The first k candidates are the nearest in ascending order afterwards.
+    /// </summary>
+    /// <param name="candidates">The array of candidates</param>
+    /// <param name="numberOfCandidates">The number of elements in the candidates array</param>
+    /// <param name="numberOfNearestNeighbors">The number of nearest neighbors to keep</param>
+    static const void SelectNearest(nearestNeighbor* candidates, int numberOfCandidates, int numberOfNearestNeighbors);
+
+    /// <summary>
+    /// Offer a known line sample to the heap. It is kept if the heap isn't full or if it is nearer than the farthest neighbor.
+    /// </summary>
+    /// <param name="squaredDistance">The squared distance of the known line sample from the unknown line sample</param>
+    /// <param name="index">The index of the known line sample</param>
+    /// <param name="isWorking">The status of the known line sample</param>
+    const void Push(double squaredDistance, int index, bool isWorking);
+    /// <summary>
+    /// Offer every neighbor of another heap to this heap.
+    /// </summary>
+    /// <param name="other">The heap to merge in</param>
+    const void PushAll(const nearestNeighborHeap* other);
+    /// <summary>
+    /// Remove every neighbor without freeing anything.
+    /// </summary>
+    const void Clear();
+    /// <summary>
+    /// The squared distance a known line sample has to be under to be kept
+    /// </summary>
+    /// <returns>The farthest kept squared distance or infinity if the heap isn't full</returns>
+    const double WorstSquaredDistance() const;
+    /// <summary>
+    /// The number of nearest neighbors currently in the heap
+    /// </summary>
+    const int Size() const;
+    /// <summary>
+    /// The maximum number of nearest neighbors kept
+    /// </summary>
+    const int Capacity() const;
+    /// <summary>
+    /// A nearest neighbor in heap order (the farthest one is at index 0)
+    /// </summary>
+    /// <param name="heapIndex">The index in the heap between 0 and Size() - 1</param>
+    /// <returns>The nearest neighbor</returns>
+    const nearestNeighbor& Neighbor(int heapIndex) const;
+    /// <summary>
+    /// Copy the nearest neighbors in ascending order of distance without changing the heap.
+    /// </summary>
+    /// <param name="sortedNeighbors">The array of at least Size() elements to fill</param>
+    const void CopySorted(nearestNeighbor* sortedNeighbors) const;
+};
\ No newline at end of file
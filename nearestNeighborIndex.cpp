@@ -0,0 +1,78 @@
+#define _USE_MATH_DEFINES
+
+using namespace std;
+
+#include <cmath>
+#include <exception>
+#include <iostream>
+#include <string>
+#include "lineFeatureMatrix.h"
+#include "distanceKernel.h"
+#include "nearestNeighbor.h"
+#include "nearestNeighborHeap.h"
+#include "nearestNeighborIndex.h"
+
+
+const double nearestNeighborIndex::MeasureRecall(lineSample** samplesWithUnknownStatuses, int numberOfSamples, int numberOfNearestNeighbors) const
+{
+    lineFeatureMatrix* features = Features();
+    if ((features == NULL) || (samplesWithUnknownStatuses == NULL) || (numberOfSamples <= 0)) return 0;
+    if (numberOfNearestNeighbors > features->NumberOfSamples) {
+        cout << "Error: The number of nearest neighbors is larger than the number of known statuses.\n";
+        return 0;
+    }
+
+    const int knownSamplesPerBlock = 256;
+    double* realParts = new double[features->NumberOfFeatures];
+    double* imaginaryParts = new double[features->NumberOfFeatures];
+    double* blockDistances = new double[knownSamplesPerBlock];
+    nearestNeighborHeap exactHeap(numberOfNearestNeighbors);
+    nearestNeighborHeap approximateHeap(numberOfNearestNeighbors);
+    if ((realParts == NULL) || (imaginaryParts == NULL) || (blockDistances == NULL)) {
+        cout << "Error: MeasureRecall() failed to allocate memory for its scratch space.\n";
+        if (realParts != NULL) delete[] realParts;
+        if (imaginaryParts != NULL) delete[] imaginaryParts;
+        if (blockDistances != NULL) delete[] blockDistances;
+        return 0;
+    }
+
+    double totalRecall = 0;
+    int numberOfQueries = 0;
+    for (int querySampleIndex = 0; querySampleIndex < numberOfSamples; querySampleIndex++) {
+        if (features->IsSampleOfTheSameLine(samplesWithUnknownStatuses[querySampleIndex]) == false) continue;
+        features->ExtractFeatures(samplesWithUnknownStatuses[querySampleIndex], realParts, imaginaryParts);
+
+        // The same brute force scan knnPredictionOfUnknownLineSample does
+        exactHeap.Clear();
+        for (int firstKnownIndex = 0; firstKnownIndex < features->NumberOfSamples; firstKnownIndex += knownSamplesPerBlock) {
+            int numberOfKnownsInBlock = knownSamplesPerBlock;
+            if (features->NumberOfSamples - firstKnownIndex < knownSamplesPerBlock) {
+                numberOfKnownsInBlock = features->NumberOfSamples - firstKnownIndex;
+            }
+            distanceKernel::SquaredDistances(features, firstKnownIndex, numberOfKnownsInBlock, realParts, imaginaryParts,
+                blockDistances);
+            for (int sampleIndex = 0; sampleIndex < numberOfKnownsInBlock; sampleIndex++) {
+                exactHeap.Push(blockDistances[sampleIndex], firstKnownIndex + sampleIndex, true);
+            }
+        }
+        Search(realParts, imaginaryParts, &approximateHeap);
+
+        int numberOfFound = 0;
+        for (int exactIndex = 0; exactIndex < exactHeap.Size(); exactIndex++) {
+            for (int approximateIndex = 0; approximateIndex < approximateHeap.Size(); approximateIndex++) {
+                if (exactHeap.Neighbor(exactIndex).Index == approximateHeap.Neighbor(approximateIndex).Index) {
+                    numberOfFound++;
+                    break;
+                }
+            }
+        }
+        totalRecall += (double)numberOfFound / exactHeap.Size();
+        numberOfQueries++;
+    }
+
+    delete[] realParts;
+    delete[] imaginaryParts;
+    delete[] blockDistances;
+    if (numberOfQueries == 0) return 0;
+    return totalRecall / numberOfQueries;
+}
\ No newline at end of file
@@ -0,0 +1,53 @@
+#pragma once
+
+#define _USE_MATH_DEFINES
+
+using namespace std;
+
+#include <cmath>
+#include <exception>
+#include <iostream>
+#include <string>
+#include "lineFeatureMatrix.h"
+#include "nearestNeighborHeap.h"
+
+
+/// <summary>
+/// The interface of a search structure built over a feature matrix that knnPredictionOfUnknownLineSample can use in place of the
+/// brute force scan.
+/// </summary>
+class nearestNeighborIndex {
+public:
+    /// <summary>
+    /// The deconstructor
+    /// </summary>
+    virtual ~nearestNeighborIndex() {}
+
+
+    /// <summary>
+    /// The feature matrix the index was built over
+    /// </summary>
+    /// <returns>The pointer to the feature matrix</returns>
+    virtual lineFeatureMatrix* Features() const = 0;
+    /// <summary>
+    /// Find the nearest known line samples to the features of an unknown line sample.
+    /// </summary>
+    /// <param name="realParts">The real parts of the features from lineFeatureMatrix::ExtractFeatures()</param>
+    /// <param name="imaginaryParts">The imaginary parts of the features from lineFeatureMatrix::ExtractFeatures()</param>
+    /// <param name="heap">The heap to fill with as many nearest neighbors as its capacity (cleared first)</param>
+    virtual const void Search(const double* realParts, const double* imaginaryParts, nearestNeighborHeap* heap) const = 0;
+    /// <summary>
+    /// The name of the index for printing
+    /// </summary>
+    virtual const string Name() const = 0;
+
+    /// <summary>
+    /// Measure the fraction of the exact k nearest neighbors (the brute force scan knnPredictionOfUnknownLineSample does) that
+    /// Search() finds.
+    /// </summary>
+    /// <param name="samplesWithUnknownStatuses">The line samples to query with</param>
+    /// <param name="numberOfSamples">The number of elements in the samplesWithUnknownStatuses array</param>
+    /// <param name="numberOfNearestNeighbors">The number of nearest neighbors</param>
+    /// <returns>The average recall between 0 and 1 (0 on failure)</returns>
+    const double MeasureRecall(lineSample** samplesWithUnknownStatuses, int numberOfSamples, int numberOfNearestNeighbors) const;
+};
\ No newline at end of file
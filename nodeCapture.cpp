@@ -0,0 +1,91 @@
+#define _USE_MATH_DEFINES
+
+using namespace std;
+
+#include <cmath>
+#include <exception>
+#include <iostream>
+#include <memory>
+#include <string>
+#include "phasor.h"
+#include "instantaneousMeasurement.h"
+#include "waveform.h"
+#include "parameter.h"
+#include "nodeSample.h"
+#include "nodeCapture.h"
+
+
+const void nodeCapture::FreeMemory()
+{
+    if (Voltage != NULL) {
+        delete Voltage;
+        Voltage = NULL;
+    }
+    if (Currents != NULL) {
+        for (int deletingIndex = 0; deletingIndex < NumberOfCurrents; deletingIndex++) {
+            if (Currents[deletingIndex] != NULL) delete Currents[deletingIndex];
+        }
+        delete[] Currents;
+        Currents = NULL;
+    }
+    if (CurrentDestinationNodes != NULL) {
+        delete[] CurrentDestinationNodes;
+        CurrentDestinationNodes = NULL;
+    }
+    NumberOfCurrents = 0;
+}
+
+const void nodeCapture::MemoryAllocationFailure(string variableName)
+{
+    cout << "Error: nodeCapture() failed to allocate memory for " << variableName << "\n";
+    FreeMemory();
+}
+
+
+
+nodeCapture::nodeCapture(int nodeNumber, waveform* voltage, waveform** currents, const int* currentDestinationNodes,
+    int numberOfCurrents)
+{
+    NodeNumber = nodeNumber;
+    Voltage = voltage;
+    Currents = currents;
+    NumberOfCurrents = numberOfCurrents;
+
+    CurrentDestinationNodes = new int[numberOfCurrents];
+    if (CurrentDestinationNodes == NULL) {
+        MemoryAllocationFailure("CurrentDestinationNodes");
+        return;
+    }
+    for (int currentIndex = 0; currentIndex < numberOfCurrents; currentIndex++) {
+        CurrentDestinationNodes[currentIndex] = currentDestinationNodes[currentIndex];
+    }
+}
+
+nodeCapture::~nodeCapture()
+{
+    FreeMemory();
+}
+
+
+const shared_ptr<nodeSample> nodeCapture::EstimateNode() const
+{
+    if ((Voltage == NULL) || (Currents == NULL) || (CurrentDestinationNodes == NULL)) return NULL;
+    for (int currentIndex = 0; currentIndex < NumberOfCurrents; currentIndex++) {
+        if (Currents[currentIndex] == NULL) return NULL;
+    }
+
+    // The node adopts the parameters, which read the samples straight from the waveforms
+    parameter* voltage = new parameter(Voltage, "V" + to_string(NodeNumber), "V", NodeNumber, 0);
+    if (voltage == NULL) return NULL;
+    parameter** currents = new parameter*[NumberOfCurrents];
+    if (currents == NULL) {
+        delete voltage;
+        return NULL;
+    }
+    for (int currentIndex = 0; currentIndex < NumberOfCurrents; currentIndex++) {
+        currents[currentIndex] = new parameter(Currents[currentIndex],
+            "I" + to_string(NodeNumber) + to_string(CurrentDestinationNodes[currentIndex]), "A", NodeNumber,
+            CurrentDestinationNodes[currentIndex]);
+    }
+    return shared_ptr<nodeSample>(new nodeSample(NodeNumber, voltage, currents, NumberOfCurrents));
+}
@@ -0,0 +1,85 @@
+#pragma once
+
+#define _USE_MATH_DEFINES
+
+using namespace std;
+
+#include <cmath>
+#include <exception>
+#include <iostream>
+#include <memory>
+#include <string>
+#include "phasor.h"
+#include "instantaneousMeasurement.h"
+#include "waveform.h"
+#include "parameter.h"
+#include "nodeSample.h"
+
+
+/// <summary>
+/// The raw waveforms captured at a node (its voltage and the currents flowing from it) before their phasors are estimated. It's
+/// what ingestPipeline takes in, and the waveforms are read by the parameters of the node built from it, so the capture has to
+/// outlive that node.
+/// </summary>
+class nodeCapture {
+private:
+    /// <summary>
+    /// Free the dynamically allocated memory and set their pointers to NULL.
+    /// </summary>
+    const void FreeMemory();
+
+    /// <summary>
+    /// Display an error message and call FreeMemory().
+    /// </summary>
+    /// <param=variableName>The name of the variable that failed to get memory allocation</param>
+    const void MemoryAllocationFailure(string variableName);
+
+
+public:
+    /// <summary>
+    /// The unique identifying number for the node
+    /// </summary>
+    int NodeNumber = 0;
+    /// <summary>
+    /// The waveform of the node voltage
+    /// </summary>
+    waveform* Voltage = NULL;
+    /// <summary>
+    /// The waveforms of the currents flowing from the node
+    /// </summary>
+    waveform** Currents = NULL;
+    /// <summary>
+    /// The destination node number of each current
+    /// </summary>
+    int* CurrentDestinationNodes = NULL;
+    /// <summary>
+    /// The number of currents
+    /// </summary>
+    int NumberOfCurrents = 0;
+
+
+    /// <summary>
+    /// This constructor uses previously allocated waveforms that will be freed on the deconstructor. The destination node numbers
+    /// are copied.
+    /// </summary>
+    /// <param name="nodeNumber">The unique identifying number for the node</param>
+    /// <param name="voltage">The waveform of the node voltage</param>
+    /// <param name="currents">The dynamically allocated array of current waveforms</param>
+    /// <param name="currentDestinationNodes">The array of current destination node numbers</param>
+    /// <param name="numberOfCurrents">The number of elements in the currents array</param>
+    explicit nodeCapture(int nodeNumber, waveform* voltage, waveform** currents, const int* currentDestinationNodes,
+        int numberOfCurrents);
+
+    /// <summary>
+    /// The deconstructor frees the waveforms
+    /// </summary>
+    ~nodeCapture();
+
+
+    /// <summary>
+    /// Estimate the phasor of every waveform and build the node from them. It only reads the capture, so any number of threads
+    /// can estimate the same capture at once.
+    /// </summary>
+    /// <returns>The node (NULL if a waveform is missing or the memory allocation failed)</returns>
+    const shared_ptr<nodeSample> EstimateNode() const;
+};
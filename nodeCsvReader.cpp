@@ -0,0 +1,170 @@
+#define _USE_MATH_DEFINES
+
+using namespace std;
+
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <exception>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <vector>
+#include "phasor.h"
+#include "parameter.h"
+#include "nodeSample.h"
+#include "threadPool.h"
+#include "nodeCsvRow.h"
+#include "nodeCsvReader.h"
+
+
+const void nodeCsvReader::ParseRow(const char* rowStart, const char* rowEnd, nodeCsvRow* row)
+{
+    row->IsValid = false;
+    while ((rowStart < rowEnd) && ((*rowStart == ' ') || (*rowStart == '\t'))) rowStart++;
+    if ((rowStart >= rowEnd) || (*rowStart == '#') || (*rowStart == '\r')) return;
+
+    // strtol() and strtod() stop on the ',' after each field, and a field that doesn't parse leaves the row invalid (like a header)
+    char* fieldEnd = NULL;
+    const char* field = rowStart;
+    double fields[6] = { 0 };
+    for (int fieldIndex = 0; fieldIndex < 6; fieldIndex++) {
+        fields[fieldIndex] = strtod(field, &fieldEnd);
+        if ((fieldEnd == field) || (fieldEnd > rowEnd)) return;
+        field = fieldEnd;
+        if ((field < rowEnd) && (*field == ',')) field++;
+        else if (fieldIndex < 5) return;
+    }
+    row->SnapshotNumber = (long long)fields[0];
+    row->NodeNumber = (int)fields[1];
+    row->RatedVoltage = fields[2];
+    row->RatedCurrent = fields[3];
+    row->VoltageRMSvalue = fields[4];
+    row->VoltagePhaseAngleDegrees = fields[5];
+
+    row->NumberOfCurrents = 0;
+    while ((field < rowEnd) && (*field != '\r') && (*field != '\n')) {
+        if (row->NumberOfCurrents == nodeCsvRow::MaximumNumberOfCurrents) return;
+        double currentFields[3] = { 0 };
+        for (int fieldIndex = 0; fieldIndex < 3; fieldIndex++) {
+            currentFields[fieldIndex] = strtod(field, &fieldEnd);
+            if ((fieldEnd == field) || (fieldEnd > rowEnd)) return;
+            field = fieldEnd;
+            if ((field < rowEnd) && (*field == ',')) field++;
+            else if (fieldIndex < 2) return;
+        }
+        row->CurrentDestinationNodes[row->NumberOfCurrents] = (int)currentFields[0];
+        row->CurrentRMSvalues[row->NumberOfCurrents] = currentFields[1];
+        row->CurrentPhaseAnglesDegrees[row->NumberOfCurrents] = currentFields[2];
+        row->NumberOfCurrents++;
+    }
+    if (row->NumberOfCurrents == 0) return;
+
+    row->IsValid = true;
+}
+
+
+
+nodeCsvReader::nodeCsvReader(string path, threadPool* pool, int chunkBytes)
+{
+    this->path = path;
+    this->pool = pool;
+    this->chunkBytes = chunkBytes;
+    if (this->chunkBytes < 1024) this->chunkBytes = 1024;
+}
+
+
+const bool nodeCsvReader::Read(const function<void(long long, shared_ptr<nodeSample>*, int)>& emitSnapshot)
+{
+    ifstream file(path, ios::binary);
+    if (file.is_open() == false) {
+        cout << "Error in nodeCsvReader::Read(): " << path << " couldn't be opened.\n";
+        return false;
+    }
+
+    // The buffers are sized once and reused for every chunk
+    buffer.resize((size_t)chunkBytes + 1);
+    batch.clear();
+    NumberOfRows = 0;
+    NumberOfSkippedRows = 0;
+    RowsPerSecond = 0;
+    long long batchSnapshotNumber = 0;
+    phasor currents[nodeCsvRow::MaximumNumberOfCurrents];
+    chrono::steady_clock::time_point startTime = chrono::steady_clock::now();
+
+    int numberOfCarriedBytes = 0;
+    bool isEndOfFile = false;
+    while (isEndOfFile == false) {
+        file.read(buffer.data() + numberOfCarriedBytes, (streamsize)chunkBytes - numberOfCarriedBytes);
+        int numberOfBytes = numberOfCarriedBytes + (int)file.gcount();
+        isEndOfFile = (file.eof() == true) || (file.gcount() == 0);
+        buffer[numberOfBytes] = 0;
+
+        // Every complete row of the chunk (the partial last row is carried to the next chunk unless the file ended)
+        rowStarts.clear();
+        int rowStart = 0;
+        while (rowStart < numberOfBytes) {
+            const char* rowEnd = (const char*)memchr(buffer.data() + rowStart, '\n', (size_t)numberOfBytes - rowStart);
+            if ((rowEnd == NULL) && (isEndOfFile == false)) break;
+            rowStarts.push_back(rowStart);
+            rowStart = (rowEnd == NULL) ? numberOfBytes : (int)(rowEnd - buffer.data()) + 1;
+        }
+        if ((rowStarts.empty() == true) && (isEndOfFile == false)) {
+            cout << "Error in nodeCsvReader::Read(): a row of " << path << " is longer than " << to_string(chunkBytes) << " bytes.\n";
+            return false;
+        }
+        int numberOfRowsInChunk = (int)rowStarts.size();
+        rowStarts.push_back(rowStart);
+
+        // Parse the rows in contiguous ranges so the parsed rows stay in file order
+        if ((int)rows.size() < numberOfRowsInChunk) rows.resize(numberOfRowsInChunk);
+        int numberOfTasks = (numberOfRowsInChunk + rowsPerTask - 1) / rowsPerTask;
+        const char* chunk = buffer.data();
+        auto parseTask = [&](int taskIndex) {
+            int lastRowIndex = min((taskIndex + 1) * rowsPerTask, numberOfRowsInChunk);
+            for (int rowIndex = taskIndex * rowsPerTask; rowIndex < lastRowIndex; rowIndex++) {
+                ParseRow(chunk + rowStarts[rowIndex], chunk + rowStarts[rowIndex + 1], &rows[rowIndex]);
+            }
+        };
+        if ((pool != NULL) && (numberOfTasks > 1)) pool->ParallelFor(numberOfTasks, parseTask);
+        else for (int taskIndex = 0; taskIndex < numberOfTasks; taskIndex++) parseTask(taskIndex);
+
+        // Build the nodes in order and emit a snapshot when the snapshot number changes
+        for (int rowIndex = 0; rowIndex < numberOfRowsInChunk; rowIndex++) {
+            const nodeCsvRow& row = rows[rowIndex];
+            if (row.IsValid == false) {
+                NumberOfSkippedRows++;
+                continue;
+            }
+            if ((batch.empty() == false) && (row.SnapshotNumber != batchSnapshotNumber)) {
+                emitSnapshot(batchSnapshotNumber, batch.data(), (int)batch.size());
+                batch.clear();
+            }
+            batchSnapshotNumber = row.SnapshotNumber;
+
+            for (int currentIndex = 0; currentIndex < row.NumberOfCurrents; currentIndex++) {
+                currents[currentIndex] = phasor(row.CurrentRMSvalues[currentIndex], row.CurrentPhaseAnglesDegrees[currentIndex]);
+            }
+            shared_ptr<nodeSample> node(new nodeSample(row.NodeNumber, phasor(row.VoltageRMSvalue, row.VoltagePhaseAngleDegrees),
+                currents, (int*)row.CurrentDestinationNodes, row.NumberOfCurrents));
+            node->RatedVoltage = row.RatedVoltage;
+            node->RatedCurrent = row.RatedCurrent;
+            batch.push_back(node);
+            NumberOfRows++;
+        }
+
+        numberOfCarriedBytes = numberOfBytes - rowStart;
+        if (numberOfCarriedBytes > 0) memmove(buffer.data(), buffer.data() + rowStart, (size_t)numberOfCarriedBytes);
+    }
+    if (batch.empty() == false) {
+        emitSnapshot(batchSnapshotNumber, batch.data(), (int)batch.size());
+        batch.clear();
+    }
+
+    double seconds = chrono::duration<double>(chrono::steady_clock::now() - startTime).count();
+    if (seconds > 0) RowsPerSecond = NumberOfRows / seconds;
+    return true;
+}
\ No newline at end of file
@@ -0,0 +1,107 @@
+#pragma once
+
+#define _USE_MATH_DEFINES
+
+using namespace std;
+
+#include <cmath>
+#include <exception>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <vector>
+#include "phasor.h"
+#include "parameter.h"
+#include "nodeSample.h"
+#include "threadPool.h"
+#include "nodeCsvRow.h"
+
+
+/// <summary>
+/// A streaming reader of node phasor CSV files that emits the nodes of each snapshot as a batch of nodeSamples. The file is read
+/// in fixed size chunks, the rows of a chunk are parsed in place across an optional thread pool into reused row records, and only
+/// the nodeSamples themselves are allocated. Each row is one node of one snapshot:
+///     snapshot, node, rated voltage, rated current, voltage rms, voltage angle, then destination node, rms, angle per current
+/// with the angles in degrees. The rows of a snapshot have to be consecutive, and blank rows, rows starting with '#', and a header
+/// row are skipped.
+/// </summary>
+class nodeCsvReader {
+private:
+    /// <summary>
+    /// The number of rows of a chunk each parse task handles
+    /// </summary>
+    const int rowsPerTask = 1024;
+    /// <summary>
+    /// The path of the CSV file
+    /// </summary>
+    string path;
+    /// <summary>
+    /// The threads that parse the rows of a chunk (NULL parses on the calling thread)
+    /// </summary>
+    threadPool* pool = NULL;
+    /// <summary>
+    /// The number of bytes read per chunk
+    /// </summary>
+    int chunkBytes = 0;
+    /// <summary>
+    /// The chunk being parsed with room for a terminating 0
+    /// </summary>
+    vector<char> buffer;
+    /// <summary>
+    /// The offset of the first character of each row of the chunk
+    /// </summary>
+    vector<int> rowStarts;
+    /// <summary>
+    /// The parsed rows of the chunk
+    /// </summary>
+    vector<nodeCsvRow> rows;
+    /// <summary>
+    /// The nodes of the snapshot being assembled
+    /// </summary>
+    vector<shared_ptr<nodeSample>> batch;
+
+
+    /// <summary>
+    /// Parse one row in place.
+    /// </summary>
+    /// <param name="rowStart">The first character of the row</param>
+    /// <param name="rowEnd">The character after the last character of the row</param>
+    /// <param name="row">The row record to fill</param>
+    static const void ParseRow(const char* rowStart, const char* rowEnd, nodeCsvRow* row);
+
+
+public:
+    /// <summary>
+    /// The number of valid rows read so far
+    /// </summary>
+    long long NumberOfRows = 0;
+    /// <summary>
+    /// The number of rows skipped as blank, comments, headers, or malformed
+    /// </summary>
+    long long NumberOfSkippedRows = 0;
+    /// <summary>
+    /// The number of valid rows per second of the last Read()
+    /// </summary>
+    double RowsPerSecond = 0;
+
+
+    /// <summary>
+    /// The constructor
+    /// </summary>
+    /// <param name="path">The path of the CSV file</param>
+    /// <param name="pool">The threads to parse with (NULL parses on the calling thread)</param>
+    /// <param name="chunkBytes">The number of bytes read per chunk (a row can't be longer)</param>
+    explicit nodeCsvReader(string path, threadPool* pool = NULL, int chunkBytes = 1 << 22);
+
+
+    /// <summary>
+    /// Read the whole file and emit every snapshot as soon as its last row is parsed.
+    /// </summary>
+    /// <param name="emitSnapshot">
+    /// Called with the snapshot number, the array of nodes, and the number of nodes of each snapshot (the array is reused after
+    /// the call returns, but the nodes are shared and can be kept)</param>
+    /// <returns>True if the file was read to the end</returns>
+    const bool Read(const function<void(long long, shared_ptr<nodeSample>*, int)>& emitSnapshot);
+};
\ No newline at end of file
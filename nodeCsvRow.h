@@ -0,0 +1,57 @@
+#pragma once
+
+/// <summary>
+/// One parsed row of a node CSV file. The currents are held in fixed arrays so parsing a row never allocates.
+/// </summary>
+class nodeCsvRow {
+public:
+    /// <summary>
+    /// The largest number of currents a row can hold
+    /// </summary>
+    static const int MaximumNumberOfCurrents = 16;
+
+    /// <summary>
+    /// False for blank, comment, header, and malformed rows
+    /// </summary>
+    bool IsValid;
+    /// <summary>
+    /// The number of the snapshot (time step) the row belongs to
+    /// </summary>
+    long long SnapshotNumber;
+    /// <summary>
+    /// The unique identifying number for the node
+    /// </summary>
+    int NodeNumber;
+    /// <summary>
+    /// The rated voltage of the node
+    /// </summary>
+    double RatedVoltage;
+    /// <summary>
+    /// The rated current of the node
+    /// </summary>
+    double RatedCurrent;
+    /// <summary>
+    /// The rms value of the node voltage
+    /// </summary>
+    double VoltageRMSvalue;
+    /// <summary>
+    /// The phase angle of the node voltage in degrees
+    /// </summary>
+    double VoltagePhaseAngleDegrees;
+    /// <summary>
+    /// The number of currents in the row
+    /// </summary>
+    int NumberOfCurrents;
+    /// <summary>
+    /// The destination node number of each current
+    /// </summary>
+    int CurrentDestinationNodes[MaximumNumberOfCurrents];
+    /// <summary>
+    /// The rms value of each current
+    /// </summary>
+    double CurrentRMSvalues[MaximumNumberOfCurrents];
+    /// <summary>
+    /// The phase angle of each current in degrees
+    /// </summary>
+    double CurrentPhaseAnglesDegrees[MaximumNumberOfCurrents];
+};
\ No newline at end of file
@@ -6,29 +6,85 @@ using namespace std;
 #include <exception>
 #include <iostream>
 #include <string>
+#include <utility>
+#include <vector>
 #include "phasor.h"
 #include "instantaneousMeasurement.h"
 #include "parameter.h"
+#include "sampleArena.h"
 #include "nodeSample.h"
 
 
-const void nodeSample::FreeMemory()
+const void nodeSample::SetParameters(phasor voltage, const phasor* currents, const int* currentDestinationNodes,
+    int numberOfCurrents)
 {
-    if (Voltage != NULL) {
-        delete Voltage;
-        Voltage = NULL;
+    if (arena != NULL) {
+        Voltage = arena->New<parameter>(voltage, "V" + to_string(NodeNumber), "V", NodeNumber, 0);
+        if (Voltage == NULL) {
+            MemoryAllocationFailure("Voltage");
+            return;
+        }
+        if (numberOfCurrents > 0) {
+            Currents = arena->NewArray<parameter*>(numberOfCurrents);
+            if (Currents == NULL) {
+                MemoryAllocationFailure("Currents");
+                return;
+            }
+        }
+        for (int currentsIndex = 0; currentsIndex < numberOfCurrents; currentsIndex++) {
+            Currents[currentsIndex] = arena->New<parameter>(currents[currentsIndex],
+                "I" + to_string(NodeNumber) + to_string(currentDestinationNodes[currentsIndex]), "A", NodeNumber,
+                currentDestinationNodes[currentsIndex]);
+            if (Currents[currentsIndex] == NULL) {
+                MemoryAllocationFailure("Currents[currentsIndex]");
+                return;
+            }
+        }
+        NumberOfCurrents = numberOfCurrents;
+        return;
     }
 
-    if (Currents != NULL) {
-        for (int deletingIndex = 0; deletingIndex < NumberOfCurrents; deletingIndex++) {
-            if (Currents[deletingIndex] != NULL) {
-                delete Currents[deletingIndex];
-                Currents[deletingIndex] = NULL;
+    // The voltage and the currents share one vector and the pointers into it share another
+    ownedParameters.reserve(1 + (size_t)numberOfCurrents);
+    ownedParameters.emplace_back(voltage, "V" + to_string(NodeNumber), "V", NodeNumber, 0);
+    for (int currentsIndex = 0; currentsIndex < numberOfCurrents; currentsIndex++) {
+        ownedParameters.emplace_back(currents[currentsIndex],
+            "I" + to_string(NodeNumber) + to_string(currentDestinationNodes[currentsIndex]), "A", NodeNumber,
+            currentDestinationNodes[currentsIndex]);
+    }
+    NumberOfCurrents = numberOfCurrents;
+    SetPointers();
+}
+const void nodeSample::SetPointers()
+{
+    Voltage = &ownedParameters[0];
+    ownedCurrents.resize(NumberOfCurrents);
+    for (int currentsIndex = 0; currentsIndex < NumberOfCurrents; currentsIndex++) {
+        ownedCurrents[currentsIndex] = &ownedParameters[1 + (size_t)currentsIndex];
+    }
+    Currents = (NumberOfCurrents > 0) ? ownedCurrents.data() : NULL;
+}
+
+
+const void nodeSample::FreeMemory()
+{
+    if (ownsAdoptedParameters == true) {    // The parameters handed to the parameter pointer constructor
+        if (Voltage != NULL) delete Voltage;
+        if (Currents != NULL) {
+            for (int deletingIndex = 0; deletingIndex < NumberOfCurrents; deletingIndex++) {
+                if (Currents[deletingIndex] != NULL) delete Currents[deletingIndex];
             }
+            delete[] Currents;
         }
-        delete[] Currents;
-        Currents = NULL;
+        ownsAdoptedParameters = false;
     }
+
+    // The vectors free their own parameters, and the arena destroys its parameters on sampleArena::Release()
+    ownedParameters.clear();
+    ownedCurrents.clear();
+    Voltage = NULL;
+    Currents = NULL;
+    NumberOfCurrents = 0;
 }
 
 const void nodeSample::MemoryAllocationFailure(string variableName)
@@ -45,107 +101,88 @@ nodeSample::nodeSample(int nodeNumber, parameter* voltage, parameter** currents,
     Voltage = voltage;
     Currents = currents;
     NumberOfCurrents = numberOfCurrents;
+    ownsAdoptedParameters = true;
 }
-nodeSample::nodeSample(int nodeNumber, phasor voltage, phasor* currents, int* currentDestinationNodes, int numberOfCurrents)
+nodeSample::nodeSample(int nodeNumber, phasor voltage, phasor* currents, int* currentDestinationNodes, int numberOfCurrents,
+    sampleArena* arena)
 {
     NodeNumber = nodeNumber;
-
-    Voltage = new parameter(voltage, "V" + to_string(nodeNumber), "V", nodeNumber, 0);
-    if (Voltage == NULL) {
-        MemoryAllocationFailure("Voltage");
-        return;
-    }
-
-    if (numberOfCurrents > 0) {
-        Currents = new parameter * [numberOfCurrents];
-        if (Currents == NULL) {
-            MemoryAllocationFailure("Currents");
-            return;
-        }
-        for (int currentsIndex = 0; currentsIndex < numberOfCurrents; currentsIndex++) Currents[currentsIndex] = NULL;
-
-        for (int currentsIndex = 0; currentsIndex < numberOfCurrents; currentsIndex++) {
-            Currents[currentsIndex] = new parameter(currents[currentsIndex],
-                "I" + to_string(nodeNumber) + to_string(currentDestinationNodes[currentsIndex]),
-                "A", nodeNumber, currentDestinationNodes[currentsIndex]);
-            if (Currents[currentsIndex] == NULL) {
-                MemoryAllocationFailure("Currents[currentsIndex]");
-                return;
-            }
-        }
-    }
-    NumberOfCurrents = numberOfCurrents;
+    this->arena = arena;
+    SetParameters(voltage, currents, currentDestinationNodes, numberOfCurrents);
 }
 nodeSample::nodeSample(int nodeNumber, phasor voltage, phasor current1, int current1DestinationNode,
     phasor current2, int current2DestinationNode)
 {
+    // This constructor is for specifically two currents.
     NodeNumber = nodeNumber;
-
-    Voltage = new parameter(voltage, "V" + to_string(nodeNumber), "V", nodeNumber, 0);
-    if (Voltage == NULL) {
-        MemoryAllocationFailure("Voltage");
-        return;
-    }
-
-    NumberOfCurrents = 2;   // This constructor is for specifically two currents.
-    Currents = new parameter*[NumberOfCurrents];
-    if (Currents == NULL) {
-        MemoryAllocationFailure("Currents");
-        return;
-    }
-    Currents[0] = new parameter(current1, "I" + to_string(nodeNumber) + to_string(current1DestinationNode), "A",
-        nodeNumber, current1DestinationNode);
-    if (Currents[0] == NULL) {
-        MemoryAllocationFailure("Currents[0]");
-        return;
-    }
-    Currents[1] = new parameter(current2, "I" + to_string(nodeNumber) + to_string(current2DestinationNode), "A",
-        nodeNumber, current2DestinationNode);
-    if (Currents[1] == NULL) {
-        MemoryAllocationFailure("Currents[1]");
-        return;
-    }
+    phasor currents[2] = { current1, current2 };
+    int currentDestinationNodes[2] = { current1DestinationNode, current2DestinationNode };
+    SetParameters(voltage, currents, currentDestinationNodes, 2);
 }
 nodeSample::nodeSample(int nodeNumber, phasor voltage, phasor current1, int current1DestinationNode,
     phasor current2, int current2DestinationNode, phasor current3, int current3DestinationNode)
 {
+    // This constructor is for specifically three currents.
     NodeNumber = nodeNumber;
+    phasor currents[3] = { current1, current2, current3 };
+    int currentDestinationNodes[3] = { current1DestinationNode, current2DestinationNode, current3DestinationNode };
+    SetParameters(voltage, currents, currentDestinationNodes, 3);
+}
+nodeSample::nodeSample(const nodeSample& other)
+{
+    *this = other;
+}
+nodeSample::nodeSample(nodeSample&& other) noexcept
+{
+    *this = move(other);
+}
 
-    Voltage = new parameter(voltage, "V" + to_string(nodeNumber), "V", nodeNumber, 0);
-    if (Voltage == NULL) {
-        MemoryAllocationFailure("Voltage");
-        return;
-    }
+nodeSample::~nodeSample()
+{
+    FreeMemory();
+}
 
-    NumberOfCurrents = 3;   // This constructor is for specifically three currents.
-    Currents = new parameter*[NumberOfCurrents];
-    if (Currents == NULL) {
-        MemoryAllocationFailure("Currents");
-        return;
-    }
-    Currents[0] = new parameter(current1, "I" + to_string(nodeNumber) + to_string(current1DestinationNode), "A",
-        nodeNumber, current1DestinationNode);
-    if (Currents[0] == NULL) {
-        MemoryAllocationFailure("Currents[0]");
-        return;
-    }
-    Currents[1] = new parameter(current2, "I" + to_string(nodeNumber) + to_string(current2DestinationNode), "A",
-        nodeNumber, current2DestinationNode);
-    if (Currents[1] == NULL) {
-        MemoryAllocationFailure("Currents[1]");
-        return;
-    }
-    Currents[2] = new parameter(current3, "I" + to_string(nodeNumber) + to_string(current3DestinationNode), "A",
-        nodeNumber, current3DestinationNode);
-    if (Currents[2] == NULL) {
-        MemoryAllocationFailure("Currents[2]");
-        return;
+
+nodeSample& nodeSample::operator=(const nodeSample& other)
+{
+    if (this == &other) return *this;
+    FreeMemory();
+
+    // The copy always owns its parameters no matter where the other node's came from
+    NodeNumber = other.NodeNumber;
+    RatedVoltage = other.RatedVoltage;
+    RatedCurrent = other.RatedCurrent;
+    arena = NULL;
+    if (other.Voltage == NULL) return *this;
+    ownedParameters.reserve(1 + (size_t)other.NumberOfCurrents);
+    ownedParameters.push_back(*other.Voltage);
+    for (int currentsIndex = 0; currentsIndex < other.NumberOfCurrents; currentsIndex++) {
+        ownedParameters.push_back(*other.Currents[currentsIndex]);
     }
+    NumberOfCurrents = other.NumberOfCurrents;
+    SetPointers();
+    return *this;
 }
-
-nodeSample::~nodeSample()
+nodeSample& nodeSample::operator=(nodeSample&& other) noexcept
 {
+    if (this == &other) return *this;
     FreeMemory();
+
+    // Moving the vectors keeps their elements in place, so the pointers into them stay valid
+    NodeNumber = other.NodeNumber;
+    RatedVoltage = other.RatedVoltage;
+    RatedCurrent = other.RatedCurrent;
+    arena = other.arena;
+    ownsAdoptedParameters = other.ownsAdoptedParameters;
+    ownedParameters = move(other.ownedParameters);
+    ownedCurrents = move(other.ownedCurrents);
+    Voltage = other.Voltage;
+    Currents = other.Currents;
+    NumberOfCurrents = other.NumberOfCurrents;
+
+    other.ownsAdoptedParameters = false;
+    other.FreeMemory();
+    return *this;
 }
 
 
@@ -8,9 +8,11 @@ using namespace std;
 #include <exception>
 #include <iostream>
 #include <string>
+#include <vector>
 #include "phasor.h"
 #include "instantaneousMeasurement.h"
 #include "parameter.h"
+#include "sampleArena.h"
 
 
 /// <summary>
@@ -26,6 +28,36 @@ private:
     /// The default rated current
     /// </summary>
     const double defaultRatedCurrent = 25;
+    /// <summary>
+    /// The arena the parameters were built in (NULL if they're freed with this class)
+    /// </summary>
+    sampleArena* arena = NULL;
+    /// <summary>
+    /// The voltage followed by the currents when the parameters are built by this class on the heap
+    /// </summary>
+    vector<parameter> ownedParameters;
+    /// <summary>
+    /// The pointers to the currents in ownedParameters that 'Currents' points to
+    /// </summary>
+    vector<parameter*> ownedCurrents;
+    /// <summary>
+    /// True if the parameters were handed to the parameter pointer constructor and are deleted with this class
+    /// </summary>
+    bool ownsAdoptedParameters = false;
+
+
+    /// <summary>
+    /// Build the voltage and current parameters in the arena or in ownedParameters.
+    /// </summary>
+    /// <param name="voltage">The node voltage phasor</param>
+    /// <param name="currents">The array of current phasors</param>
+    /// <param name="currentDestinationNodes">The array of current destination node numbers</param>
+    /// <param name="numberOfCurrents">The number of currents</param>
+    const void SetParameters(phasor voltage, const phasor* currents, const int* currentDestinationNodes, int numberOfCurrents);
+    /// <summary>
+    /// Point 'Voltage' and 'Currents' into ownedParameters.
+    /// </summary>
+    const void SetPointers();
 
     /// <summary>
     /// Free the dynamically allocated memory and set their pointers to NULL.
@@ -80,10 +112,11 @@ public:
     /// <param name="currents">The array of current phasors</param>
     /// <param name="currentDestinationNodes">The array of current destination node numbers</param>
     /// <param name="numberOfCurrents">The number of currents the dynamically allocated array 'currents' has</param>
-    /// <param name="ratedVoltage">The rated voltage (typically the voltage at peak normal usage of the grid)</param>
-    /// <param name="ratedCurrent">
-    /// The rated current (typically the magnitude for a two line node at peak normal usage of the grid) </param>
-    explicit nodeSample(int nodeNumber, phasor voltage, phasor* currents, int* currentDestinationNodes, int numberOfCurrents);
+    /// <param name="arena">
+    /// The arena to build the parameters in (NULL allocates them on the heap). The arena releases them instead of this class, so
+    /// it has to outlive the node.</param>
+    explicit nodeSample(int nodeNumber, phasor voltage, phasor* currents, int* currentDestinationNodes, int numberOfCurrents,
+        sampleArena* arena = NULL);
     /// <summary>
     /// A specific constructor for a node with two currents
     /// </summary>
@@ -109,12 +142,37 @@ public:
     explicit nodeSample(int nodeNumber, phasor voltage, phasor current1, int current1DestinationNode,
         phasor current2, int current2DestinationNode, phasor current3, int current3DestinationNode);
 
+    /// <summary>
+    /// The copy constructor copies every parameter so the copy owns its own.
+    /// </summary>
+    /// <param name="other">The node to copy</param>
+    nodeSample(const nodeSample& other);
+    /// <summary>
+    /// The move constructor takes the parameters of the other node without copying them.
+    /// </summary>
+    /// <param name="other">The node to move (left without parameters)</param>
+    nodeSample(nodeSample&& other) noexcept;
+
     /// <summary>
     /// This will free everything in its pointers
     /// </summary>
     ~nodeSample();
 
 
+    /// <summary>
+    /// Free the parameters and copy every parameter of the other node.
+    /// </summary>
+    /// <param name="other">The node to copy</param>
+    /// <returns>This node</returns>
+    nodeSample& operator=(const nodeSample& other);
+    /// <summary>
+    /// Free the parameters and take the other node's without copying them.
+    /// </summary>
+    /// <param name="other">The node to move (left without parameters)</param>
+    /// <returns>This node</returns>
+    nodeSample& operator=(nodeSample&& other) noexcept;
+
+
     /// <summary>
     /// Prints the node number, voltage phasor, and current phasors
     /// </summary>
@@ -0,0 +1,183 @@
+#define _USE_MATH_DEFINES
+
+using namespace std;
+
+#include <atomic>
+#include <cmath>
+#include <deque>
+#include <exception>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+#include "phasor.h"
+#include "parameter.h"
+#include "nodeSample.h"
+#include "lineSample.h"
+#include "distanceWeights.h"
+#include "lineFeatureMatrix.h"
+#include "distanceKernel.h"
+#include "nearestNeighborHeap.h"
+#include "trainingStoreSegment.h"
+#include "trainingStoreView.h"
+#include "onlineTrainingStore.h"
+
+
+const bool onlineTrainingStore::AddSegment()
+{
+    if (segments.empty() == false) {
+        shared_ptr<const lineFeatureMatrix> fullFeatures = segments.back()->Features(numberOfSamplesInLastSegment);
+        if (fullFeatures == NULL) return false;
+
+        // The list is copied once per segment so the views already published keep theirs
+        vector<shared_ptr<const lineFeatureMatrix>>* newFullSegments = new vector<shared_ptr<const lineFeatureMatrix>>();
+        if (fullSegments != NULL) *newFullSegments = *fullSegments;
+        newFullSegments->push_back(fullFeatures);
+        fullSegments = shared_ptr<const vector<shared_ptr<const lineFeatureMatrix>>>(newFullSegments);
+    }
+
+    shared_ptr<trainingStoreSegment> segment = make_shared<trainingStoreSegment>(layout.get(), samplesPerSegment);
+    if (segment->Capacity == 0) return false;
+    segments.push_back(segment);
+    numberOfSamplesInLastSegment = 0;
+    return true;
+}
+const void onlineTrainingStore::Evict(double newestTimeStamp)
+{
+    while (numberOfSamples > 1) {
+        bool isOverTheLimit = (maximumNumberOfSamples > 0) && (numberOfSamples > maximumNumberOfSamples);
+        bool isOutsideTheWindow = (timeWindow > 0) && (segments.front()->TimeStamp(firstSampleIndex) < newestTimeStamp - timeWindow);
+        if ((isOverTheLimit == false) && (isOutsideTheWindow == false)) break;
+
+        firstSampleIndex++;
+        numberOfSamples--;
+        if ((segments.size() > 1) && (firstSampleIndex == segments.front()->Capacity)) {
+            segments.pop_front();
+            vector<shared_ptr<const lineFeatureMatrix>>* newFullSegments =
+                new vector<shared_ptr<const lineFeatureMatrix>>(fullSegments->begin() + 1, fullSegments->end());
+            fullSegments = shared_ptr<const vector<shared_ptr<const lineFeatureMatrix>>>(newFullSegments);
+            firstSampleIndex = 0;
+        }
+    }
+}
+const void onlineTrainingStore::Publish()
+{
+    shared_ptr<trainingStoreView> newView = make_shared<trainingStoreView>();
+    newView->FullSegments = fullSegments;
+    newView->LastSegment = segments.back()->Features(numberOfSamplesInLastSegment);
+    newView->FirstSampleIndex = firstSampleIndex;
+    newView->NumberOfSamples = numberOfSamples;
+    atomic_store(&view, shared_ptr<const trainingStoreView>(newView));
+}
+
+
+
+onlineTrainingStore::onlineTrainingStore(int numberOfNearestNeighbors, int maximumNumberOfSamples, double timeWindow,
+    int samplesPerSegment, distanceWeights weights)
+{
+    this->numberOfNearestNeighbors = numberOfNearestNeighbors;
+    this->maximumNumberOfSamples = maximumNumberOfSamples;
+    this->timeWindow = timeWindow;
+    if (samplesPerSegment > 0) this->samplesPerSegment = samplesPerSegment;
+    this->weights = weights;
+}
+
+
+const bool onlineTrainingStore::Append(lineSample* sample, double timeStamp)
+{
+    if ((sample == NULL) || (sample->TopologyKey() == 0)) {
+        cout << "Error in onlineTrainingStore::Append(): the line sample is NULL or wasn't built.\n";
+        return false;
+    }
+    lock_guard<mutex> lock(appendMutex);
+
+    if (layout == NULL) {
+        layout.reset(new lineFeatureMatrix(&sample, 1, weights));
+        if ((layout == NULL) || (layout->NumberOfSamples == 0)) {
+            layout.reset();
+            return false;
+        }
+        appendRealParts.resize(layout->NumberOfFeatures);
+        appendImaginaryParts.resize(layout->NumberOfFeatures);
+    }
+    else if (layout->IsSampleOfTheSameLine(sample) == false) {
+        cout << "Error in onlineTrainingStore::Append(): the line sample is not a sample of the same line as the store.\n";
+        return false;
+    }
+
+    if ((segments.empty() == true) || (numberOfSamplesInLastSegment == segments.back()->Capacity)) {
+        if (AddSegment() == false) return false;
+    }
+    layout->ExtractFeatures(sample, appendRealParts.data(), appendImaginaryParts.data());
+    segments.back()->Write(numberOfSamplesInLastSegment, appendRealParts.data(), appendImaginaryParts.data(), sample->IsWorking,
+        timeStamp);
+    numberOfSamplesInLastSegment++;
+    numberOfSamples++;
+
+    Evict(timeStamp);
+    Publish();
+    return true;
+}
+
+shared_ptr<const trainingStoreView> onlineTrainingStore::View() const
+{
+    return atomic_load(&view);
+}
+const int onlineTrainingStore::NumberOfSamples() const
+{
+    shared_ptr<const trainingStoreView> currentView = View();
+    if (currentView == NULL) return 0;
+    return currentView->NumberOfSamples;
+}
+
+const bool onlineTrainingStore::PredictStatus(lineSample* sampleWithUnknownStatus, bool* predictedStatus) const
+{
+    if (predictedStatus == NULL) {
+        cout << "Error in onlineTrainingStore::PredictStatus(): bool* predictedStatus = NULL!\n";
+        return false;
+    }
+    shared_ptr<const trainingStoreView> currentView = View();
+    if ((currentView == NULL) || (currentView->NumberOfSamples < numberOfNearestNeighbors)) {
+        cout << "Error in onlineTrainingStore::PredictStatus(): there are fewer known statuses than nearest neighbors.\n";
+        return false;
+    }
+    // The layout is set before the first view is published and never changes after
+    if (layout->IsSampleOfTheSameLine(sampleWithUnknownStatus) == false) {
+        cout << "Error in onlineTrainingStore::PredictStatus(): the line sample is not a sample of the same line as the store.\n";
+        return false;
+    }
+
+    vector<double> realParts(layout->NumberOfFeatures);
+    vector<double> imaginaryParts(layout->NumberOfFeatures);
+    vector<double> squaredDistances(knownSamplesPerBlock);
+    nearestNeighborHeap heap(numberOfNearestNeighbors);
+    layout->ExtractFeatures(sampleWithUnknownStatus, realParts.data(), imaginaryParts.data());
+
+    // The index keeps counting across segments so ties are broken by age like one matrix would
+    int knownIndex = 0;
+    for (int segmentIndex = 0; segmentIndex < currentView->NumberOfSegments(); segmentIndex++) {
+        const lineFeatureMatrix* knownFeatures = currentView->Segment(segmentIndex);
+        int firstKnownIndex = (segmentIndex == 0) ? currentView->FirstSampleIndex : 0;
+        for (; firstKnownIndex < knownFeatures->NumberOfSamples; firstKnownIndex += knownSamplesPerBlock) {
+            int numberOfKnownsInBlock = knownSamplesPerBlock;
+            if (knownFeatures->NumberOfSamples - firstKnownIndex < knownSamplesPerBlock) {
+                numberOfKnownsInBlock = knownFeatures->NumberOfSamples - firstKnownIndex;
+            }
+            distanceKernel::BoundedSquaredDistances(knownFeatures, firstKnownIndex, numberOfKnownsInBlock, realParts.data(),
+                imaginaryParts.data(), heap.WorstSquaredDistance(), squaredDistances.data());
+            for (int blockIndex = 0; blockIndex < numberOfKnownsInBlock; blockIndex++) {
+                heap.Push(squaredDistances[blockIndex], knownIndex++, knownFeatures->IsWorking(firstKnownIndex + blockIndex));
+            }
+        }
+    }
+
+    int numOfWorkingLines = 0;
+    int numOfNotWorkingLines = 0;
+    for (int heapIndex = 0; heapIndex < heap.Size(); heapIndex++) {
+        if (heap.Neighbor(heapIndex).IsWorking == true) numOfWorkingLines += 1;
+        else numOfNotWorkingLines += 1;
+    }
+    *predictedStatus = numOfWorkingLines > numOfNotWorkingLines;
+    return true;
+}
\ No newline at end of file
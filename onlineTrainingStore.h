@@ -0,0 +1,160 @@
+#pragma once
+
+#define _USE_MATH_DEFINES
+
+using namespace std;
+
+#include <cmath>
+#include <deque>
+#include <exception>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+#include "phasor.h"
+#include "parameter.h"
+#include "nodeSample.h"
+#include "lineSample.h"
+#include "distanceWeights.h"
+#include "lineFeatureMatrix.h"
+#include "distanceKernel.h"
+#include "nearestNeighborHeap.h"
+#include "trainingStoreSegment.h"
+#include "trainingStoreView.h"
+
+
+/// <summary>
+/// The known line samples of one line that keeps growing as operators label new snapshots. Appending writes the features into the
+/// next slot of a fixed capacity segment, so it never moves or rebuilds the samples already stored, and the oldest samples are
+/// evicted past a maximum number of samples or outside a sliding time window. Every append publishes a new immutable
+/// trainingStoreView with an atomic pointer swap, so readers predict from whichever view they loaded without ever waiting for
+/// the writer, and a segment is freed once the last view holding it is gone.
+/// </summary>
+class onlineTrainingStore {
+private:
+    /// <summary>
+    /// The number of known line samples scored together by distanceKernel
+    /// </summary>
+    const int knownSamplesPerBlock = 256;
+    /// <summary>
+    /// The number of nearest neighbors to consider
+    /// </summary>
+    int numberOfNearestNeighbors = 5;
+    /// <summary>
+    /// The largest number of line samples kept (0 keeps every line sample the time window allows)
+    /// </summary>
+    int maximumNumberOfSamples = 0;
+    /// <summary>
+    /// The line samples older than this many time units before the newest one are evicted (0 keeps every line sample)
+    /// </summary>
+    double timeWindow = 0;
+    /// <summary>
+    /// The number of line samples per segment
+    /// </summary>
+    int samplesPerSegment = 1024;
+    /// <summary>
+    /// The weights the features are scored with
+    /// </summary>
+    distanceWeights weights;
+    /// <summary>
+    /// A one line sample feature matrix of the first line sample appended holding the layout every segment copies
+    /// </summary>
+    unique_ptr<lineFeatureMatrix> layout;
+    /// <summary>
+    /// Serializes the writers (readers never take it)
+    /// </summary>
+    mutex appendMutex;
+    /// <summary>
+    /// The real parts of the features of the line sample being appended
+    /// </summary>
+    vector<double> appendRealParts;
+    /// <summary>
+    /// The imaginary parts of the features of the line sample being appended
+    /// </summary>
+    vector<double> appendImaginaryParts;
+    /// <summary>
+    /// Every segment still holding line samples from oldest to newest
+    /// </summary>
+    deque<shared_ptr<trainingStoreSegment>> segments;
+    /// <summary>
+    /// The feature matrices of the full segments the next view is published with
+    /// </summary>
+    shared_ptr<const vector<shared_ptr<const lineFeatureMatrix>>> fullSegments;
+    /// <summary>
+    /// The number of filled slots of the newest segment
+    /// </summary>
+    int numberOfSamplesInLastSegment = 0;
+    /// <summary>
+    /// The number of evicted line samples at the start of the oldest segment
+    /// </summary>
+    int firstSampleIndex = 0;
+    /// <summary>
+    /// The number of line samples stored
+    /// </summary>
+    int numberOfSamples = 0;
+    /// <summary>
+    /// The newest published view (only read and written with atomic_load() and atomic_store())
+    /// </summary>
+    shared_ptr<const trainingStoreView> view;
+
+
+    /// <summary>
+    /// Start a new segment and move the full one into fullSegments.
+    /// </summary>
+    /// <returns>True if the memory allocation succeeded</returns>
+    const bool AddSegment();
+    /// <summary>
+    /// Evict the oldest line samples past the maximum number of samples or outside the time window, and drop the segments that
+    /// are left empty.
+    /// </summary>
+    /// <param name="newestTimeStamp">The time stamp of the newest line sample</param>
+    const void Evict(double newestTimeStamp);
+    /// <summary>
+    /// Publish the current state as a new view.
+    /// </summary>
+    const void Publish();
+
+
+public:
+    /// <summary>
+    /// The constructor
+    /// </summary>
+    /// <param name="numberOfNearestNeighbors">The number of nearest neighbors to consider</param>
+    /// <param name="maximumNumberOfSamples">The largest number of line samples kept (0 for no limit)</param>
+    /// <param name="timeWindow">
+    /// How far before the newest line sample the oldest kept line sample can be in time stamp units (0 for no window)</param>
+    /// <param name="samplesPerSegment">The number of line samples per segment</param>
+    /// <param name="weights">The weights of the weighted euclidean distance</param>
+    explicit onlineTrainingStore(int numberOfNearestNeighbors = 5, int maximumNumberOfSamples = 0, double timeWindow = 0,
+        int samplesPerSegment = 1024, distanceWeights weights = distanceWeights());
+
+
+    /// <summary>
+    /// Append a labeled line sample. The line samples have to be of the same line and appended in time stamp order, and the
+    /// line sample isn't kept, only its features.
+    /// </summary>
+    /// <param name="sample">The line sample with a known status</param>
+    /// <param name="timeStamp">The time the line sample was labeled</param>
+    /// <returns>True if the line sample was appended</returns>
+    const bool Append(lineSample* sample, double timeStamp);
+
+    /// <summary>
+    /// The newest view. It stays valid and unchanged for as long as it's held.
+    /// </summary>
+    /// <returns>The view or NULL if nothing was appended yet</returns>
+    shared_ptr<const trainingStoreView> View() const;
+    /// <summary>
+    /// The number of line samples in the newest view
+    /// </summary>
+    const int NumberOfSamples() const;
+
+    /// <summary>
+    /// Predict the status of a line sample from the newest view without waiting for the writer. Ties between equal distances are
+    /// broken by age, so the prediction matches a lineFeatureMatrix of the same line samples in the same order.
+    /// </summary>
+    /// <param name="sampleWithUnknownStatus">The line sample with an unknown status</param>
+    /// <param name="predictedStatus">The predicted status</param>
+    /// <returns>True if a prediction was made</returns>
+    const bool PredictStatus(lineSample* sampleWithUnknownStatus, bool* predictedStatus) const;
+};
\ No newline at end of file
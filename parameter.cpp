@@ -6,24 +6,35 @@ using namespace std;
 #include <exception>
 #include <iostream>
 #include <string>
+#include <utility>
+#include <vector>
 #include "phasor.h"
+#include "internedString.h"
 #include "instantaneousMeasurement.h"
+#include "waveform.h"
 #include "parameter.h"
 
 
+const double parameter::SampleValue(int sampleIndex)
+{
+    if (Waveform != NULL) return Waveform->Value(sampleIndex);
+    return Samples[sampleIndex].value;
+}
 const phasor parameter::CalculatePhasor()
 {
-    if (NumberOfSamples <= 1) {
+    if (NumberOfSamples() <= 1) {
         cout << "Insufficient number of samples to calculate a phasor.\n";
         return phasor();
     }
-    return phasor(RMS(), PhaseAngleDegrees(RMS()));
+    double rms = RMS();
+    return phasor(rms, PhaseAngleDegrees(rms));
 }
 const double parameter::RMS()
 {
+    int numberOfSamples = NumberOfSamples();
     double rms = 0;
-    for (int sampleIndex = 0; sampleIndex < NumberOfSamples; sampleIndex++) rms += pow(Samples[sampleIndex].value, 2);
-    if (NumberOfSamples > 0) rms = sqrt(rms / NumberOfSamples);
+    for (int sampleIndex = 0; sampleIndex < numberOfSamples; sampleIndex++) rms += pow(SampleValue(sampleIndex), 2);
+    if (numberOfSamples > 0) rms = sqrt(rms / numberOfSamples);
     return rms;
 }
 const double parameter::PhaseAngleDegrees(double rms)
@@ -31,51 +42,55 @@ const double parameter::PhaseAngleDegrees(double rms)
     double phaseAngleDegrees = 0;
 
     // Count the phase angle as 90 or -90 if the first point's magnitude is greater than the peak.
-    if (Samples[0].value >= rms * sqrt(2)) phaseAngleDegrees = 90;
-    else if (Samples[0].value <= -rms * sqrt(2)) phaseAngleDegrees = -90;
+    if (SampleValue(0) >= rms * sqrt(2)) phaseAngleDegrees = 90;
+    else if (SampleValue(0) <= -rms * sqrt(2)) phaseAngleDegrees = -90;
 
     // Ascending
-    else if (Samples[1].value >= Samples[0].value) {
-        phaseAngleDegrees = 180 / M_PI * asin(Samples[0].value / (rms * sqrt(2)));
+    else if (SampleValue(1) >= SampleValue(0)) {
+        phaseAngleDegrees = 180 / M_PI * asin(SampleValue(0) / (rms * sqrt(2)));
     }
 
     // Descending
     else {
         // Belongs in Q2
-        if (Samples[0].value >= 0) {
-            phaseAngleDegrees = 180 - 180 / M_PI * asin(Samples[0].value / (rms * sqrt(2)));
+        if (SampleValue(0) >= 0) {
+            phaseAngleDegrees = 180 - 180 / M_PI * asin(SampleValue(0) / (rms * sqrt(2)));
         }
 
         // Belongs in Q4
-        else phaseAngleDegrees = -180 - 180 / M_PI * asin(Samples[0].value / (rms * sqrt(2)));
+        else phaseAngleDegrees = -180 - 180 / M_PI * asin(SampleValue(0) / (rms * sqrt(2)));
     }
 
     return phaseAngleDegrees;
 }
 
 
-const void parameter::FreeMemory()
+parameter::parameter() {}
+parameter::parameter(instantaneousMeasurement* samples, int numberOfSamples, string name = "", string units = "",
+    int startNodeNumber = 0, int destinationNodeNumber = 0)
 {
-    if (Samples != NULL) {
-        delete[] Samples;
-        Samples = NULL;
-    }
+    if ((samples != NULL) && (numberOfSamples > 0)) Samples.assign(samples, samples + numberOfSamples);
+    if (samples != NULL) delete[] samples;
+    Phasor = CalculatePhasor();
+    Name = name;
+    Units = units;
+    StartNodeNumber = startNodeNumber;
+    DestinationNodeNumber = destinationNodeNumber;
 }
-
-const void parameter::MemoryAllocationFailure(string variableName)
+parameter::parameter(vector<instantaneousMeasurement>&& samples, string name = "", string units = "", int startNodeNumber = 0,
+    int destinationNodeNumber = 0)
 {
-    cout << "Error: node() failed to allocate memory for " << variableName << "\n";
-    FreeMemory();
+    Samples = move(samples);
+    Phasor = CalculatePhasor();
+    Name = name;
+    Units = units;
+    StartNodeNumber = startNodeNumber;
+    DestinationNodeNumber = destinationNodeNumber;
 }
-
-
-
-parameter::parameter() {}
-parameter::parameter(instantaneousMeasurement* samples, int numberOfSamples, string name = "", string units = "",
-    int startNodeNumber = 0, int destinationNodeNumber = 0)
+parameter::parameter(const waveform* samples, string name = "", string units = "", int startNodeNumber = 0,
+    int destinationNodeNumber = 0)
 {
-    Samples = samples;
-    NumberOfSamples = numberOfSamples;
+    Waveform = samples;
     Phasor = CalculatePhasor();
     Name = name;
     Units = units;
@@ -84,8 +99,6 @@ parameter::parameter(instantaneousMeasurement* samples, int numberOfSamples, str
 }
 parameter::parameter(phasor phasorr, string name = "", string units = "", int startNodeNumber = 0, int destinationNodeNumber = 0)
 {
-    Samples = NULL;
-    NumberOfSamples = 0;
     Phasor = phasorr;
     Name = name;
     Units = units;
@@ -93,16 +106,17 @@ parameter::parameter(phasor phasorr, string name = "", string units = "", int st
     DestinationNodeNumber = destinationNodeNumber;
 }
 
-parameter::~parameter()
+
+const int parameter::NumberOfSamples() const
 {
-    FreeMemory();
+    if (Waveform != NULL) return Waveform->NumberOfSamples();
+    return (int)Samples.size();
 }
 
-
 const void parameter::PrintParameter()
 {
     cout << "\nName: " << Name << "\n";
-    cout << "Number of samples: " << NumberOfSamples << "\n";
+    cout << "Number of samples: " << NumberOfSamples() << "\n";
     cout << "Phasor: " << Phasor.PhasorToString() << Units << "\n";
     cout << "Starting Node: " << to_string(StartNodeNumber) + "\n";
     cout << "Destination Node: " << to_string(DestinationNodeNumber) + "\n";
@@ -8,8 +8,11 @@ using namespace std;
 #include <exception>
 #include <iostream>
 #include <string>
+#include <vector>
 #include "phasor.h"
+#include "internedString.h"
 #include "instantaneousMeasurement.h"
+#include "waveform.h"
 
 
 /// <summary>
@@ -17,6 +20,12 @@ using namespace std;
 /// </summary>
 class parameter {
 private:
+    /// <summary>
+    /// The value of a sample read from 'Samples' or from 'Waveform'
+    /// </summary>
+    /// <param name="sampleIndex">The index of the sample</param>
+    /// <returns>The instantaneous measurement in base units</returns>
+    const double SampleValue(int sampleIndex);
     /// <summary>
     /// Find the phasor representation of the data in 'samples' that is assumed to be perfectly sinusoidal.
     /// </summary>
@@ -34,41 +43,29 @@ private:
     /// <param name="rms">The RMS value of the values found by RMS()</param>
     /// <returns>The phase angle of the phasor representation of the values in 'samples' in degrees</returns>
     const double PhaseAngleDegrees(double rms);
-    
-    
-    /// <summary>
-    /// Free the dynamically allocated memory and set their pointers to NULL.
-    /// </summary>
-    const void FreeMemory();
-
-    /// <summary>
-    /// Display an error message and call FreeMemory().
-    /// </summary>
-    /// <param=variableName>The name of the variable that failed to get memory allocation</param>
-    const void MemoryAllocationFailure(string variableName);
 
 
 public:
     /// <summary>
-    /// A dynamically allocated array of the samples.
+    /// The samples (empty when they're read from 'Waveform' or the parameter was built from a phasor)
     /// </summary>
-    instantaneousMeasurement* Samples = NULL;
+    vector<instantaneousMeasurement> Samples;
     /// <summary>
-    /// The number of samples allocated in 'samples'
+    /// The waveform the samples are read from in place of 'Samples' (it isn't freed on the deconstructor)
     /// </summary>
-    int NumberOfSamples = 0;
+    const waveform* Waveform = NULL;
     /// <summary>
     /// The phasor representation of the data in 'samples'
     /// </summary>
     phasor Phasor = phasor(0, 0);
     /// <summary>
-    /// The name of the parameter
+    /// The name of the parameter (interned, so copying a parameter doesn't copy the string)
     /// </summary>
-    string Name = "";
+    internedString Name;
     /// <summary>
-    /// The base unit name
+    /// The base unit name (interned, so copying a parameter doesn't copy the string)
     /// </summary>
-    string Units = "";
+    internedString Units;
     /// <summary>
     /// The number of the starting node (0 is ground).
     /// </summary>
@@ -84,9 +81,10 @@ public:
     /// </summary>
     parameter();
     /// <summary>
-    /// This constructor calculates the phasor from the array of instantaneous measurements.
+    /// This constructor calculates the phasor from the array of instantaneous measurements. The array is copied into 'Samples'
+    /// and freed, so callers building a new set of samples should hand over a vector instead.
     /// </summary>
-    /// <param name="samples">The array of instantaneous measurements</param>
+    /// <param name="samples">The dynamically allocated array of instantaneous measurements</param>
     /// <param name="numberOfSamples">The number of elements in the array or instantaneous measurements</param>
     /// <param name="name">The name to be used for the parameter</param>
     /// <param name="units">The base unit suffix</param>
@@ -95,6 +93,26 @@ public:
     explicit parameter(instantaneousMeasurement* samples, int numberOfSamples, string name, string units,
         int startNodeNumber, int destinationNodeNumber);
     /// <summary>
+    /// This constructor calculates the phasor from the instantaneous measurements and takes them as 'Samples' without copying.
+    /// </summary>
+    /// <param name="samples">The instantaneous measurements (left empty)</param>
+    /// <param name="name">The name to be used for the parameter</param>
+    /// <param name="units">The base unit suffix</param>
+    /// <param name="startNodeNumber">The starting node number (0 is ground)</param>
+    /// <param name="destinationNodeNumber">The destination node number (0 is ground)</param>
+    explicit parameter(vector<instantaneousMeasurement>&& samples, string name, string units, int startNodeNumber,
+        int destinationNodeNumber);
+    /// <summary>
+    /// This constructor calculates the phasor from a waveform without copying its samples. The waveform won't be freed on the
+    /// deconstructor.
+    /// </summary>
+    /// <param name="samples">The waveform of the parameter</param>
+    /// <param name="name">The name to be used for the parameter</param>
+    /// <param name="units">The base unit suffix</param>
+    /// <param name="startNodeNumber">The starting node number (0 is ground)</param>
+    /// <param name="destinationNodeNumber">The destination node number (0 is ground)</param>
+    explicit parameter(const waveform* samples, string name, string units, int startNodeNumber, int destinationNodeNumber);
+    /// <summary>
     /// This constructor doesn't involve a set of instantaneous measurements.
     /// </summary>
     /// <param name="phasorr">The phasor representation of the parameter</param>
@@ -105,11 +123,37 @@ public:
     explicit parameter(phasor phasorr, string name, string units, int startNodeNumber, int destinationNodeNumber);
 
     /// <summary>
-    /// This will free everything in its pointers
+    /// The copy constructor copies the samples so each parameter has its own.
     /// </summary>
-    ~parameter();
+    /// <param name="other">The parameter to copy</param>
+    parameter(const parameter& other) = default;
+    /// <summary>
+    /// The move constructor takes the samples of the other parameter without copying them.
+    /// </summary>
+    /// <param name="other">The parameter to move (its 'Samples' are left empty)</param>
+    parameter(parameter&& other) noexcept = default;
 
 
+    /// <summary>
+    /// Copy the other parameter and its samples.
+    /// </summary>
+    /// <param name="other">The parameter to copy</param>
+    /// <returns>This parameter</returns>
+    parameter& operator=(const parameter& other) = default;
+    /// <summary>
+    /// Take the other parameter's samples without copying them.
+    /// </summary>
+    /// <param name="other">The parameter to move (its 'Samples' are left empty)</param>
+    /// <returns>This parameter</returns>
+    parameter& operator=(parameter&& other) noexcept = default;
+
+
+    /// <summary>
+    /// The number of samples in 'Samples' or 'Waveform'
+    /// </summary>
+    /// <returns>The number of samples (0 when the parameter was built from a phasor or moved from)</returns>
+    const int NumberOfSamples() const;
+
     /// <summary>
     /// Print the name, number of samples, phasor, and the starting and destination node numbers.
     /// </summary>
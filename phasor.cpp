@@ -9,125 +9,71 @@ using namespace std;
 #include "phasor.h"
 
 
-const void phasor::UpdateRealAndImag() 
-{
-    real = RMSvalue * cos(M_PI / 180 * PhaseAngleDegrees);
-    imaginary = RMSvalue * sin(M_PI / 180 * PhaseAngleDegrees);
-}
-
-const void phasor::UpdateRMSandPhase()
-{
-    RMSvalue = hypot(real, imaginary);
-
-    if (real == 0) {   // special case to avoid division by zero
-        if (imaginary < 0) PhaseAngleDegrees = -90;       // phasor is on border of Q3 and Q4
-        else if (imaginary > 0) PhaseAngleDegrees = 90;   // phasor is on border of Q1 and Q2
-        else PhaseAngleDegrees = 0;                       // This is the zero phasor case
-    }
-    else {
-        PhaseAngleDegrees = 180 / M_PI * atan(imaginary / real);
-        if (real < 0) {
-            if (imaginary >= 0) PhaseAngleDegrees += 180; // phasor should be in Q2 and atan would've put it in Q4
-            else PhaseAngleDegrees -= 180;                // phasor should be in Q3 and atan would've put it in Q1
-        }
-    }
-}
-
-
-
-phasor::phasor() {}
 phasor::phasor(double rmsValue, double phaseAngleDegrees)
 {
-    RMSvalue = rmsValue;
-    PhaseAngleDegrees = phaseAngleDegrees;
-    UpdateRealAndImag();
+    real = rmsValue * cos(M_PI / 180 * phaseAngleDegrees);
+    imaginary = rmsValue * sin(M_PI / 180 * phaseAngleDegrees);
 }
 
 
 const void phasor::Print()
 {
-    cout << RMSvalue << " @ " << PhaseAngleDegrees << "deg\n";
+    cout << RMSvalue() << " @ " << PhaseAngleDegrees() << "deg\n";
 }
 const string phasor::PhasorToString()
 {
-    return to_string(RMSvalue) + " @ " + to_string(PhaseAngleDegrees) + "deg";
+    return to_string(RMSvalue()) + " @ " + to_string(PhaseAngleDegrees()) + "deg";
 }
-
-
-const phasor phasor::operator+(const phasor& rhs) const
+const double phasor::RMSvalue() const
 {
-    phasor sum;
-    sum.real = this->real + rhs.real;
-    sum.imaginary = this->imaginary + rhs.imaginary;
-    sum.UpdateRMSandPhase();
-    return sum;
+    return hypot(real, imaginary);
 }
-const phasor phasor::operator-(const phasor& rhs) const
+const double phasor::PhaseAngleDegrees() const
 {
-    phasor difference;
-    difference.real = this->real - rhs.real;
-    difference.imaginary = this->imaginary - rhs.imaginary;
-    difference.UpdateRMSandPhase();
-    return difference;
+    if (real == 0) {   // special case to avoid division by zero
+        if (imaginary < 0) return -90;      // phasor is on border of Q3 and Q4
+        else if (imaginary > 0) return 90;  // phasor is on border of Q1 and Q2
+        else return 0;                      // This is the zero phasor case
+    }
+
+    double phaseAngleDegrees = 180 / M_PI * atan(imaginary / real);
+    if (real < 0) {
+        if (imaginary >= 0) phaseAngleDegrees += 180;   // phasor should be in Q2 and atan would've put it in Q4
+        else phaseAngleDegrees -= 180;                  // phasor should be in Q3 and atan would've put it in Q1
+    }
+    return phaseAngleDegrees;
 }
-const phasor phasor::operator*(const phasor& rhs) const
-{
-    phasor product;
-    product.RMSvalue = this->RMSvalue * rhs.RMSvalue;
-    product.PhaseAngleDegrees = this->PhaseAngleDegrees + rhs.PhaseAngleDegrees;
 
-    // Keep -180deg < phase_angle_degrees <= 180deg
-    while (product.PhaseAngleDegrees > 180) product.PhaseAngleDegrees -= 360;
-    while (product.PhaseAngleDegrees <= -180) product.PhaseAngleDegrees += 360;
 
-    product.UpdateRealAndImag();
-    return product;
-}
 const phasor phasor::operator/(const phasor& p2) const
 {
-    phasor quotient(0, 0);
-
     try {   // Handle the divide by zero exception
-        if (p2.RMSvalue == 0) throw 360;
-
-        quotient.RMSvalue = this->RMSvalue / p2.RMSvalue;
-        quotient.PhaseAngleDegrees = this->PhaseAngleDegrees - p2.PhaseAngleDegrees;
-
-        // Keep -180deg < phase_angle_degrees <= 180deg
-        while (quotient.PhaseAngleDegrees > 180) quotient.PhaseAngleDegrees -= 360;
-        while (quotient.PhaseAngleDegrees <= -180) quotient.PhaseAngleDegrees += 360;
+        if ((p2.real == 0) && (p2.imaginary == 0)) throw 360;
     }
     catch (int e) {
         if (e == 360) cout << "Error: Divisor phasor is 0.\n";
         else cout << "Exception number " << e << " has occured.\n";
-        quotient.RMSvalue = 0;
-        quotient.PhaseAngleDegrees = 0;
+        return phasor();
     }
 
-    quotient.UpdateRealAndImag();
-    return quotient;
+    // A divisor with no imaginary part (like the ratings lineSample normalizes by) only scales the parts
+    if (p2.imaginary == 0) return Cartesian(this->real / p2.real, this->imaginary / p2.real);
+
+    double divisorSquaredMagnitude = p2.SquaredMagnitude();
+    return Cartesian((this->real * p2.real + this->imaginary * p2.imaginary) / divisorSquaredMagnitude,
+        (this->imaginary * p2.real - this->real * p2.imaginary) / divisorSquaredMagnitude);
 }
 const phasor phasor::Pow(double power) const
 {
-    phasor exponent = phasor(0, 0);
-
     try {   // Handle the case with the 0 phasor to a nonpositive power
-        if ((RMSvalue == 0) && (power <= 0)) throw 360;
-
-        exponent.RMSvalue = pow(RMSvalue, power);
-        exponent.PhaseAngleDegrees = PhaseAngleDegrees * power;
-
-        // Keep -180deg < phase_angle_degrees <= 180deg
-        while (exponent.PhaseAngleDegrees > 180) exponent.PhaseAngleDegrees -= 360;
-        while (exponent.PhaseAngleDegrees <= -180) exponent.PhaseAngleDegrees += 360;
+        if ((real == 0) && (imaginary == 0) && (power <= 0)) throw 360;
     }
     catch (int e) {
         if (e == 360) cout << "Error: Base is 0 and power is non-positive.\n";
         else cout << "Exception number " << e << " has occured.\n";
-        exponent.RMSvalue = 0;
-        exponent.PhaseAngleDegrees = 0;
+        return phasor();
     }
 
-    exponent.UpdateRealAndImag();
-    return exponent;
+    // Raising to a power needs the polar form
+    return phasor(pow(RMSvalue(), power), PhaseAngleDegrees() * power);
 }
\ No newline at end of file
@@ -8,10 +8,12 @@ using namespace std;
 #include <exception>
 #include <iostream>
 #include <string>
-#include "phasor.h"
+#include <type_traits>
 
 /// <summary>
-/// This is the complex number representation of a sinusoidal signal.
+/// This is the complex number representation of a sinusoidal signal. Only the cartesian form is stored, so the arithmetic operators
+/// don't need any trigonometry and the rms value and phase angle are calculated when they're read. The cartesian members and the
+/// +, -, and * operators are constexpr and defined in this header so arrays of phasors can be vectorized.
 /// </summary>
 class phasor {
 private:
@@ -25,38 +27,30 @@ private:
     double imaginary = 0;
 
 
-    /// <summary>
-    /// Calculate the real and imaginary parts of the complex number in cartesian form.
-    /// </summary>
-    const void UpdateRealAndImag();
-
-    /// <summary>
-    /// Calculate the rms value and phase angle of the complex number.
-    /// </summary>
-    const void UpdateRMSandPhase();
-
-
 public:
-    /// <summary>
-    /// The RMS (Root Mean Square) of the sinusoidal waveform
-    /// </summary>
-    double RMSvalue = 0;
-    /// <summary>
-    /// The offset angle of the sinusoidal waveform in degrees
-    /// </summary>
-    double PhaseAngleDegrees = 0;
-
-
     /// <summary>
     /// Set variables to default values.
     /// </summary>
-    phasor();
+    phasor() = default;
     /// <summary>
     /// Initialize the polar parameters and calculate the cartesian parameters from those.
     /// </summary>
     /// <param name="rmsValue">The rms value of the phasor (use base units)</param>
     /// <param name="phaseAngleDegrees">The phase angle of the phasor in degrees</param>
     explicit phasor(double rmsValue, double phaseAngleDegrees);
+    /// <summary>
+    /// Create a phasor from the cartesian parameters without any trigonometry.
+    /// </summary>
+    /// <param name="realPart">The real part of the complex number</param>
+    /// <param name="imaginaryPart">The imaginary part of the complex number</param>
+    /// <returns>The phasor</returns>
+    static constexpr phasor Cartesian(double realPart, double imaginaryPart)
+    {
+        phasor cartesian;
+        cartesian.real = realPart;
+        cartesian.imaginary = imaginaryPart;
+        return cartesian;
+    }
 
 
     /// <summary>
@@ -68,6 +62,40 @@ public:
     /// </summary>
     /// <returns>The phasor in printable string form</returns>
     const string PhasorToString();
+    /// <summary>
+    /// The RMS (Root Mean Square) of the sinusoidal waveform
+    /// </summary>
+    /// <returns>The magnitude of the complex number</returns>
+    const double RMSvalue() const;
+    /// <summary>
+    /// The offset angle of the sinusoidal waveform in degrees
+    /// </summary>
+    /// <returns>The phase angle with -180deg < phase angle <= 180deg</returns>
+    const double PhaseAngleDegrees() const;
+    /// <summary>
+    /// The real part of the complex number in cartesian form
+    /// </summary>
+    /// <returns>The real part</returns>
+    constexpr double RealPart() const
+    {
+        return real;
+    }
+    /// <summary>
+    /// The imaginary part of the complex number in cartesian form
+    /// </summary>
+    /// <returns>The imaginary part</returns>
+    constexpr double ImaginaryPart() const
+    {
+        return imaginary;
+    }
+    /// <summary>
+    /// The squared RMS value without the square root
+    /// </summary>
+    /// <returns>The squared magnitude of the complex number</returns>
+    constexpr double SquaredMagnitude() const
+    {
+        return real * real + imaginary * imaginary;
+    }
 
     
     /// <summary>
@@ -75,19 +103,28 @@ public:
     /// </summary>
     /// <param name="rhs">The phasor to the right of the operator</param>
     /// <returns>The sum of the left and right hand phasors</returns>
-    const phasor operator+(const phasor& rhs) const;
+    constexpr phasor operator+(const phasor& rhs) const
+    {
+        return Cartesian(real + rhs.real, imaginary + rhs.imaginary);
+    }
     /// <summary>
     /// The phasor subtraction operator (this class phasor is the one to the left of the operator)
     /// </summary>
     /// <param name="rhs">The phasor to the right of the operator</param>
     /// <returns>The difference of the left and right hand phasors</returns>
-    const phasor operator-(const phasor& rhs) const;
+    constexpr phasor operator-(const phasor& rhs) const
+    {
+        return Cartesian(real - rhs.real, imaginary - rhs.imaginary);
+    }
     /// <summary>
     /// The phasor multiplication operator (this class phasor is the one to the left of the operator)
     /// </summary>
     /// <param name="rhs">The phasor to the right of the operator</param>
     /// <returns>The product of the left and right hand phasors</returns>
-    const phasor operator*(const phasor& rhs) const;
+    constexpr phasor operator*(const phasor& rhs) const
+    {
+        return Cartesian(real * rhs.real - imaginary * rhs.imaginary, real * rhs.imaginary + imaginary * rhs.real);
+    }
     /// <summary>
     /// The phasor division operator (this class phasor is the one to the left of the operator) that also returns the default phasor
     /// in the case of the divide by zero exception.
@@ -101,4 +138,6 @@ public:
     /// <param name="power">The power to raise the phasor to</param>
     /// <returns>The phasor to the power of 'power'</returns>
     const phasor Pow(double power) const;
-};
\ No newline at end of file
+};
+
+static_assert(is_trivially_copyable<phasor>::value, "phasor must stay trivially copyable so arrays of it can be copied and vectorized");
\ No newline at end of file
@@ -0,0 +1,62 @@
+#define _USE_MATH_DEFINES
+
+using namespace std;
+
+#include <cmath>
+#include <exception>
+#include <iostream>
+#include <string>
+#include "phasor.h"
+#include "phasorEstimator.h"
+
+
+phasorEstimator::phasorEstimator(double samplesPerSecond, double nominalFrequency, int samplesPerReport)
+{
+    if ((samplesPerSecond <= 0) || (nominalFrequency <= 0)) {
+        cout << "Error: phasorEstimator() needs a positive sample rate and nominal frequency.\n";
+        return;
+    }
+    this->samplesPerSecond = samplesPerSecond;
+    this->nominalFrequency = nominalFrequency;
+    if (samplesPerReport <= 0) samplesPerReport = (int)round(samplesPerSecond / nominalFrequency);
+    if (samplesPerReport < 1) samplesPerReport = 1;
+    this->samplesPerReport = samplesPerReport;
+
+    double anglePerSample = 2 * M_PI * nominalFrequency / samplesPerSecond;
+    rotation = phasor::Cartesian(cos(anglePerSample), -sin(anglePerSample));
+}
+
+
+const bool phasorEstimator::AddSample(double value)
+{
+    if (samplesPerReport == 0) return false;
+
+    sum = sum + phasor::Cartesian(value * oscillator.RealPart(), value * oscillator.ImaginaryPart());
+    oscillator = oscillator * rotation;
+    samplesInReport++;
+    if (samplesInReport < samplesPerReport) return false;
+
+    // sum = N * sqrt(2) * RMS * e^(j*angle) / (2j) for a whole number of cycles, so the rms phasor is j * sqrt(2) * sum / N
+    double scale = sqrt(2) / samplesPerReport;
+    Phasor = phasor::Cartesian(-scale * sum.ImaginaryPart(), scale * sum.RealPart());
+    NumberOfReports++;
+
+    // Keep the rounding of the repeated rotations from growing the oscillator
+    double oscillatorMagnitude = oscillator.RMSvalue();
+    oscillator = phasor::Cartesian(oscillator.RealPart() / oscillatorMagnitude, oscillator.ImaginaryPart() / oscillatorMagnitude);
+    sum = phasor();
+    samplesInReport = 0;
+    return true;
+}
+const void phasorEstimator::Reset()
+{
+    sum = phasor();
+    oscillator = phasor::Cartesian(1, 0);
+    samplesInReport = 0;
+    Phasor = phasor(0, 0);
+    NumberOfReports = 0;
+}
+const int phasorEstimator::SamplesPerReport() const
+{
+    return samplesPerReport;
+}
\ No newline at end of file
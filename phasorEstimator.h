@@ -0,0 +1,88 @@
+#pragma once
+
+#define _USE_MATH_DEFINES
+
+using namespace std;
+
+#include <cmath>
+#include <exception>
+#include <iostream>
+#include <string>
+#include "phasor.h"
+
+
+/// <summary>
+/// A recursive DFT at the nominal frequency that turns a continuous stream of evenly spaced instantaneous measurements into one
+/// phasor per reporting interval. Each sample costs one complex multiply-add and the raw samples aren't kept, so a feed of any
+/// length only needs the running sum. The phase angle is relative to the first sample, the same sine reference parameter uses
+/// (value = sqrt(2) * RMS * sin(2*pi*f*t + angle)).
+/// </summary>
+class phasorEstimator {
+private:
+    /// <summary>
+    /// The number of samples per second of the feed
+    /// </summary>
+    double samplesPerSecond = 0;
+    /// <summary>
+    /// The nominal frequency of the grid in Hz
+    /// </summary>
+    double nominalFrequency = 60;
+    /// <summary>
+    /// The number of samples in each reporting interval
+    /// </summary>
+    int samplesPerReport = 0;
+    /// <summary>
+    /// The number of samples added to the current reporting interval
+    /// </summary>
+    int samplesInReport = 0;
+    /// <summary>
+    /// The running sum of the samples times the oscillator over the current reporting interval
+    /// </summary>
+    phasor sum;
+    /// <summary>
+    /// e^(-j*2*pi*f*t) at the time of the next sample
+    /// </summary>
+    phasor oscillator = phasor::Cartesian(1, 0);
+    /// <summary>
+    /// e^(-j*2*pi*f/samplesPerSecond), the rotation of the oscillator per sample
+    /// </summary>
+    phasor rotation = phasor::Cartesian(1, 0);
+
+
+public:
+    /// <summary>
+    /// The phasor of the last completed reporting interval
+    /// </summary>
+    phasor Phasor = phasor(0, 0);
+    /// <summary>
+    /// The number of completed reporting intervals
+    /// </summary>
+    int NumberOfReports = 0;
+
+
+    /// <summary>
+    /// The constructor
+    /// </summary>
+    /// <param name="samplesPerSecond">The number of samples per second of the feed</param>
+    /// <param name="nominalFrequency">The nominal frequency of the grid in Hz</param>
+    /// <param name="samplesPerReport">
+    /// The number of samples in each reporting interval (0 uses one cycle, and a whole number of cycles keeps the estimate exact)
+    /// </param>
+    explicit phasorEstimator(double samplesPerSecond, double nominalFrequency = 60, int samplesPerReport = 0);
+
+
+    /// <summary>
+    /// Add the next instantaneous measurement of the feed.
+    /// </summary>
+    /// <param name="value">The instantaneous measurement in base units</param>
+    /// <returns>True if the sample completed a reporting interval and Phasor was updated</returns>
+    const bool AddSample(double value);
+    /// <summary>
+    /// Restart the feed so the next sample is at time 0.
+    /// </summary>
+    const void Reset();
+    /// <summary>
+    /// The number of samples in each reporting interval
+    /// </summary>
+    const int SamplesPerReport() const;
+};
\ No newline at end of file
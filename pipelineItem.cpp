@@ -0,0 +1,46 @@
+#define _USE_MATH_DEFINES
+
+using namespace std;
+
+#include <chrono>
+#include <cmath>
+#include <exception>
+#include <iostream>
+#include <memory>
+#include <string>
+#include "phasor.h"
+#include "instantaneousMeasurement.h"
+#include "waveform.h"
+#include "parameter.h"
+#include "nodeSample.h"
+#include "lineSample.h"
+#include "nodeCapture.h"
+#include "pipelineItem.h"
+
+
+
+pipelineItem::pipelineItem(long long sequence, nodeCapture* node1Capture, nodeCapture* node2Capture)
+{
+    Sequence = sequence;
+    Node1Capture = node1Capture;
+    Node2Capture = node2Capture;
+    SubmitTime = chrono::steady_clock::now();
+}
+
+pipelineItem::~pipelineItem()
+{
+    if (Sample != NULL) {
+        delete Sample;
+        Sample = NULL;
+    }
+    Node1 = NULL;
+    Node2 = NULL;
+    if (Node1Capture != NULL) {
+        delete Node1Capture;
+        Node1Capture = NULL;
+    }
+    if (Node2Capture != NULL) {
+        delete Node2Capture;
+        Node2Capture = NULL;
+    }
+}
@@ -0,0 +1,83 @@
+#pragma once
+
+#define _USE_MATH_DEFINES
+
+using namespace std;
+
+#include <chrono>
+#include <cmath>
+#include <exception>
+#include <iostream>
+#include <memory>
+#include <string>
+#include "phasor.h"
+#include "instantaneousMeasurement.h"
+#include "waveform.h"
+#include "parameter.h"
+#include "nodeSample.h"
+#include "lineSample.h"
+#include "nodeCapture.h"
+
+
+/// <summary>
+/// One capture of a line on its way through ingestPipeline. Each stage fills in the next part (the nodes, then the line sample,
+/// then the prediction) and the finished item is handed to the pipeline's callback before it's freed.
+/// </summary>
+class pipelineItem {
+public:
+    /// <summary>
+    /// A number unique to the capture that increases in the order of submission (starting at 0, and a refused capture leaves a
+    /// gap)
+    /// </summary>
+    long long Sequence = 0;
+    /// <summary>
+    /// The waveforms captured at the first node of the line
+    /// </summary>
+    nodeCapture* Node1Capture = NULL;
+    /// <summary>
+    /// The waveforms captured at the second node of the line
+    /// </summary>
+    nodeCapture* Node2Capture = NULL;
+    /// <summary>
+    /// The first node with its phasors estimated
+    /// </summary>
+    shared_ptr<nodeSample> Node1 = NULL;
+    /// <summary>
+    /// The second node with its phasors estimated
+    /// </summary>
+    shared_ptr<nodeSample> Node2 = NULL;
+    /// <summary>
+    /// The line sample normalized from the nodes
+    /// </summary>
+    lineSample* Sample = NULL;
+    /// <summary>
+    /// True if a stage failed (a missing waveform, a line that isn't registered, ...) and the later stages passed it on untouched
+    /// </summary>
+    bool IsFailed = false;
+    /// <summary>
+    /// The predicted status (only meaningful when IsFailed is false)
+    /// </summary>
+    bool PredictedStatus = true;
+    /// <summary>
+    /// The time the capture was submitted
+    /// </summary>
+    chrono::steady_clock::time_point SubmitTime;
+    /// <summary>
+    /// The time from the submission to the prediction in nanoseconds
+    /// </summary>
+    long long LatencyNanoseconds = 0;
+
+
+    /// <summary>
+    /// The constructor adopts the captures of the two nodes of the line.
+    /// </summary>
+    /// <param name="sequence">The order the capture was submitted in</param>
+    /// <param name="node1Capture">The waveforms captured at the first node</param>
+    /// <param name="node2Capture">The waveforms captured at the second node</param>
+    explicit pipelineItem(long long sequence, nodeCapture* node1Capture, nodeCapture* node2Capture);
+
+    /// <summary>
+    /// The deconstructor frees the line sample, the nodes, and then the captures their parameters read from
+    /// </summary>
+    ~pipelineItem();
+};
@@ -0,0 +1,83 @@
+#define _USE_MATH_DEFINES
+
+using namespace std;
+
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <exception>
+#include <iostream>
+#include <memory>
+#include <new>
+#include <string>
+#include <type_traits>
+#include <utility>
+#include <vector>
+#include "sampleArena.h"
+
+
+const bool sampleArena::AddChunk(size_t minimumBytes)
+{
+    size_t newChunkBytes = chunkBytes;
+    if (minimumBytes > newChunkBytes) newChunkBytes = minimumBytes;
+
+    char* chunk = new (nothrow) char[newChunkBytes];
+    if (chunk == NULL) {
+        cout << "Error: sampleArena() failed to allocate memory for a chunk of " << to_string(newChunkBytes) << " bytes\n";
+        return false;
+    }
+    chunks.push_back(chunk);
+    next = chunk;
+    end = chunk + newChunkBytes;
+    return true;
+}
+
+
+
+sampleArena::sampleArena(size_t chunkBytes)
+{
+    if (chunkBytes > 0) this->chunkBytes = chunkBytes;
+}
+
+sampleArena::~sampleArena()
+{
+    Release();
+}
+
+
+void* sampleArena::Allocate(size_t bytes, size_t alignment)
+{
+    if (bytes == 0) bytes = 1;
+    uintptr_t aligned = ((uintptr_t)next + alignment - 1) & ~(uintptr_t)(alignment - 1);
+    if ((next == NULL) || (aligned + bytes > (uintptr_t)end)) {
+        // The chunk memory is aligned on max_align_t, so the padding is only needed past that
+        if (AddChunk(bytes + alignment) == false) return NULL;
+        aligned = ((uintptr_t)next + alignment - 1) & ~(uintptr_t)(alignment - 1);
+    }
+
+    next = (char*)(aligned + bytes);
+    numberOfBytes += bytes;
+    return (void*)aligned;
+}
+
+const void sampleArena::Release()
+{
+    for (int destructorIndex = (int)destructors.size() - 1; destructorIndex >= 0; destructorIndex--) {
+        destructors[destructorIndex].first(destructors[destructorIndex].second);
+    }
+    destructors.clear();
+    for (int chunkIndex = 0; chunkIndex < (int)chunks.size(); chunkIndex++) delete[] chunks[chunkIndex];
+    chunks.clear();
+    next = NULL;
+    end = NULL;
+    numberOfBytes = 0;
+}
+
+const size_t sampleArena::NumberOfBytes() const
+{
+    return numberOfBytes;
+}
+const int sampleArena::NumberOfChunks() const
+{
+    return (int)chunks.size();
+}
\ No newline at end of file
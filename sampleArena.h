@@ -0,0 +1,196 @@
+#pragma once
+
+#define _USE_MATH_DEFINES
+
+using namespace std;
+
+#include <cmath>
+#include <cstddef>
+#include <exception>
+#include <iostream>
+#include <memory>
+#include <new>
+#include <string>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+
+class sampleArena;
+
+/// <summary>
+/// The standard allocator interface over a sampleArena so allocate_shared() can place the object and its control block in the
+/// arena. Deallocating does nothing since the arena releases everything at once.
+/// </summary>
+template <typename T>
+class arenaAllocator {
+public:
+    typedef T value_type;
+
+    /// <summary>
+    /// The arena the memory comes from
+    /// </summary>
+    sampleArena* Arena = NULL;
+
+
+    /// <summary>
+    /// The constructor
+    /// </summary>
+    /// <param name="arena">The arena the memory comes from</param>
+    explicit arenaAllocator(sampleArena* arena) : Arena(arena) {}
+    /// <summary>
+    /// The rebinding constructor allocate_shared() uses for its control block
+    /// </summary>
+    template <typename U>
+    arenaAllocator(const arenaAllocator<U>& other) : Arena(other.Arena) {}
+
+
+    T* allocate(size_t numberOfElements);
+    void deallocate(T*, size_t) {}
+
+    template <typename U>
+    bool operator==(const arenaAllocator<U>& other) const { return Arena == other.Arena; }
+    template <typename U>
+    bool operator!=(const arenaAllocator<U>& other) const { return Arena != other.Arena; }
+};
+
+
+/// <summary>
+/// A bump allocator for building a whole training set's nodeSamples, lineSamples, and parameters from a few large chunks and
+/// releasing them all in one shot. Allocating moves a pointer through the current chunk, objects with destructors are destroyed in
+/// reverse order on Release(), and nothing is freed one at a time. An arena isn't thread safe, so each thread building samples
+/// needs its own.
+/// </summary>
+class sampleArena {
+private:
+    /// <summary>
+    /// The default number of bytes per chunk
+    /// </summary>
+    static const size_t defaultChunkBytes = 1 << 20;
+    /// <summary>
+    /// The number of bytes per chunk (larger allocations get a chunk of their own)
+    /// </summary>
+    size_t chunkBytes = defaultChunkBytes;
+    /// <summary>
+    /// Every chunk allocated
+    /// </summary>
+    vector<char*> chunks;
+    /// <summary>
+    /// The next free byte of the current chunk
+    /// </summary>
+    char* next = NULL;
+    /// <summary>
+    /// The byte after the current chunk
+    /// </summary>
+    char* end = NULL;
+    /// <summary>
+    /// The objects New() built that have a destructor and the function that destroys each
+    /// </summary>
+    vector<pair<void (*)(void*), void*>> destructors;
+    /// <summary>
+    /// The number of bytes handed out since the last Release()
+    /// </summary>
+    size_t numberOfBytes = 0;
+
+
+    /// <summary>
+    /// Call the destructor of an object built by New().
+    /// </summary>
+    /// <param name="object">The object</param>
+    template <typename T>
+    static void DestroyObject(void* object) { ((T*)object)->~T(); }
+
+    /// <summary>
+    /// Start a new chunk.
+    /// </summary>
+    /// <param name="minimumBytes">The smallest number of bytes the chunk has to hold</param>
+    /// <returns>True if the memory allocation succeeded</returns>
+    const bool AddChunk(size_t minimumBytes);
+
+
+public:
+    /// <summary>
+    /// The constructor
+    /// </summary>
+    /// <param name="chunkBytes">The number of bytes per chunk</param>
+    explicit sampleArena(size_t chunkBytes = defaultChunkBytes);
+
+    /// <summary>
+    /// The deconstructor calls Release().
+    /// </summary>
+    ~sampleArena();
+
+    sampleArena(const sampleArena&) = delete;
+    sampleArena& operator=(const sampleArena&) = delete;
+
+
+    /// <summary>
+    /// Allocate uninitialized memory from the current chunk.
+    /// </summary>
+    /// <param name="bytes">The number of bytes</param>
+    /// <param name="alignment">The alignment (a power of two)</param>
+    /// <returns>The memory or NULL if the memory allocation failed</returns>
+    void* Allocate(size_t bytes, size_t alignment = alignof(max_align_t));
+    /// <summary>
+    /// Build an object in the arena. Its destructor runs on Release() if it has one.
+    /// </summary>
+    /// <param name="arguments">The arguments of the constructor</param>
+    /// <returns>The object or NULL if the memory allocation failed</returns>
+    template <typename T, typename... Arguments>
+    T* New(Arguments&&... arguments)
+    {
+        void* memory = Allocate(sizeof(T), alignof(T));
+        if (memory == NULL) return NULL;
+        T* object = new (memory) T(forward<Arguments>(arguments)...);
+        if (is_trivially_destructible<T>::value == false) destructors.push_back(make_pair(&DestroyObject<T>, (void*)object));
+        return object;
+    }
+    /// <summary>
+    /// Allocate a value initialized array of trivial elements (like an array of parameter pointers) in the arena.
+    /// </summary>
+    /// <param name="numberOfElements">The number of elements</param>
+    /// <returns>The array or NULL if the memory allocation failed</returns>
+    template <typename T>
+    T* NewArray(int numberOfElements)
+    {
+        static_assert(is_trivially_destructible<T>::value, "sampleArena::NewArray() only holds trivial elements");
+        T* elements = (T*)Allocate(sizeof(T) * (size_t)numberOfElements, alignof(T));
+        if (elements == NULL) return NULL;
+        for (int elementIndex = 0; elementIndex < numberOfElements; elementIndex++) new (elements + elementIndex) T();
+        return elements;
+    }
+    /// <summary>
+    /// Build a shared object with its control block in the arena. It's destroyed when the last pointer to it goes away like any
+    /// other shared_ptr, so every pointer has to be gone before Release().
+    /// </summary>
+    /// <param name="arguments">The arguments of the constructor</param>
+    /// <returns>The shared pointer</returns>
+    template <typename T, typename... Arguments>
+    shared_ptr<T> NewShared(Arguments&&... arguments)
+    {
+        return allocate_shared<T>(arenaAllocator<T>(this), forward<Arguments>(arguments)...);
+    }
+
+    /// <summary>
+    /// Destroy every object New() built in reverse order and free every chunk.
+    /// </summary>
+    const void Release();
+
+    /// <summary>
+    /// The number of bytes handed out since the last Release()
+    /// </summary>
+    const size_t NumberOfBytes() const;
+    /// <summary>
+    /// The number of chunks allocated since the last Release()
+    /// </summary>
+    const int NumberOfChunks() const;
+};
+
+
+template <typename T>
+T* arenaAllocator<T>::allocate(size_t numberOfElements)
+{
+    void* memory = Arena->Allocate(sizeof(T) * numberOfElements, alignof(T));
+    if (memory == NULL) throw bad_alloc();    // allocate_shared() expects the standard allocator failure
+    return (T*)memory;
+}
\ No newline at end of file
@@ -0,0 +1,101 @@
+#define _USE_MATH_DEFINES
+
+using namespace std;
+
+#include <atomic>
+#include <condition_variable>
+#include <exception>
+#include <functional>
+#include <iostream>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include "threadPool.h"
+
+
+const void threadPool::WorkerLoop()
+{
+    int lastGeneration = 0;
+    while (true) {
+        {
+            unique_lock<mutex> lock(poolMutex);
+            taskAvailable.wait(lock, [&] { return (isStopping == true) || (generation != lastGeneration); });
+            if (isStopping == true) return;
+            lastGeneration = generation;
+        }
+
+        RunTasks();
+
+        {
+            lock_guard<mutex> lock(poolMutex);
+            numberOfBusyWorkers--;
+            if (numberOfBusyWorkers == 0) tasksFinished.notify_one();
+        }
+    }
+}
+const void threadPool::RunTasks()
+{
+    while (true) {
+        int taskIndex = nextTaskIndex.fetch_add(1);
+        if (taskIndex >= numberOfTasks) return;
+        (*task)(taskIndex);
+    }
+}
+
+
+
+threadPool::threadPool(int numberOfThreads)
+{
+    nextTaskIndex = 0;
+    if (numberOfThreads <= 0) numberOfThreads = (int)thread::hardware_concurrency();
+    if (numberOfThreads <= 0) numberOfThreads = 1;
+
+    for (int workerIndex = 0; workerIndex < numberOfThreads - 1; workerIndex++) {
+        workers.push_back(thread(&threadPool::WorkerLoop, this));
+    }
+}
+
+threadPool::~threadPool()
+{
+    {
+        lock_guard<mutex> lock(poolMutex);
+        isStopping = true;
+    }
+    taskAvailable.notify_all();
+    for (int workerIndex = 0; workerIndex < (int)workers.size(); workerIndex++) workers[workerIndex].join();
+}
+
+
+const int threadPool::NumberOfThreads() const
+{
+    return (int)workers.size() + 1;
+}
+const void threadPool::ParallelFor(int numberOfTasks, const function<void(int)>& task)
+{
+    if (numberOfTasks <= 0) return;
+
+    // Not worth waking the workers for a single task
+    if ((numberOfTasks == 1) || (workers.size() == 0)) {
+        for (int taskIndex = 0; taskIndex < numberOfTasks; taskIndex++) task(taskIndex);
+        return;
+    }
+
+    {
+        lock_guard<mutex> lock(poolMutex);
+        this->task = &task;
+        this->numberOfTasks = numberOfTasks;
+        nextTaskIndex = 0;
+        numberOfBusyWorkers = (int)workers.size();
+        generation++;
+    }
+    taskAvailable.notify_all();
+
+    RunTasks();
+
+    {
+        unique_lock<mutex> lock(poolMutex);
+        tasksFinished.wait(lock, [&] { return numberOfBusyWorkers == 0; });
+        this->task = NULL;
+    }
+}
\ No newline at end of file
@@ -0,0 +1,100 @@
+#pragma once
+
+#define _USE_MATH_DEFINES
+
+using namespace std;
+
+#include <atomic>
+#include <condition_variable>
+#include <exception>
+#include <functional>
+#include <iostream>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+
+/// <summary>
+/// A fixed set of worker threads that run the tasks of ParallelFor(). The calling thread runs tasks too, so a pool of one thread
+/// has no workers and runs everything on the caller.
+/// </summary>
+class threadPool {
+private:
+    /// <summary>
+    /// The worker threads
+    /// </summary>
+    vector<thread> workers;
+    /// <summary>
+    /// Guards every member below it
+    /// </summary>
+    mutex poolMutex;
+    /// <summary>
+    /// Wakes the workers when a new ParallelFor() starts or the pool is stopping
+    /// </summary>
+    condition_variable taskAvailable;
+    /// <summary>
+    /// Wakes the caller of ParallelFor() when the last worker is done
+    /// </summary>
+    condition_variable tasksFinished;
+    /// <summary>
+    /// The task of the current ParallelFor()
+    /// </summary>
+    const function<void(int)>* task = NULL;
+    /// <summary>
+    /// The number of tasks of the current ParallelFor()
+    /// </summary>
+    int numberOfTasks = 0;
+    /// <summary>
+    /// The index of the next task to run
+    /// </summary>
+    atomic<int> nextTaskIndex;
+    /// <summary>
+    /// The number of workers still running tasks of the current ParallelFor()
+    /// </summary>
+    int numberOfBusyWorkers = 0;
+    /// <summary>
+    /// Incremented on every ParallelFor() so each worker joins each one exactly once
+    /// </summary>
+    int generation = 0;
+    /// <summary>
+    /// True when the deconstructor is stopping the workers
+    /// </summary>
+    bool isStopping = false;
+
+
+    /// <summary>
+    /// The loop each worker thread runs until the pool is stopped
+    /// </summary>
+    const void WorkerLoop();
+    /// <summary>
+    /// Run tasks of the current ParallelFor() until there are none left.
+    /// </summary>
+    const void RunTasks();
+
+
+public:
+    /// <summary>
+    /// The constructor
+    /// </summary>
+    /// <param name="numberOfThreads">The number of threads including the caller (0 uses every hardware thread)</param>
+    explicit threadPool(int numberOfThreads = 0);
+
+    /// <summary>
+    /// The deconstructor stops and joins the workers
+    /// </summary>
+    ~threadPool();
+
+
+    /// <summary>
+    /// The number of threads that run tasks including the caller
+    /// </summary>
+    const int NumberOfThreads() const;
+    /// <summary>
+    /// Run task(0) to task(numberOfTasks - 1) across the threads and return once every task is done. Tasks can run in any order.
+    /// Only one thread can call this at a time and a task must not call it on the same pool.
+    /// </summary>
+    /// <param name="numberOfTasks">The number of tasks</param>
+    /// <param name="task">The task to run with each task index</param>
+    const void ParallelFor(int numberOfTasks, const function<void(int)>& task);
+};
\ No newline at end of file
@@ -0,0 +1,23 @@
+#define _USE_MATH_DEFINES
+
+using namespace std;
+
+#include <cmath>
+#include <exception>
+#include <iostream>
+#include <string>
+#include "topologyHash.h"
+
+
+const void topologyHash::Add(int number)
+{
+    for (int byteIndex = 0; byteIndex < (int)sizeof(int); byteIndex++) {
+        key ^= (unsigned long long)(((unsigned int)number >> (8 * byteIndex)) & 0xFF);
+        key *= prime;
+    }
+}
+const size_t topologyHash::Key() const
+{
+    if (key == 0) return 1;
+    return (size_t)key;
+}
\ No newline at end of file
@@ -0,0 +1,43 @@
+#pragma once
+
+#define _USE_MATH_DEFINES
+
+using namespace std;
+
+#include <cmath>
+#include <exception>
+#include <iostream>
+#include <string>
+
+
+/// <summary>
+/// A 64-bit FNV-1a hash of a sequence of node numbers. lineSample and gridSnapshot both build their topology keys with it so a
+/// line sample and a snapshot line of the same line get the same key.
+/// </summary>
+class topologyHash {
+private:
+    /// <summary>
+    /// The FNV-1a offset basis the hash starts from
+    /// </summary>
+    static const unsigned long long offsetBasis = 14695981039346656037ULL;
+    /// <summary>
+    /// The FNV-1a prime each byte is multiplied by
+    /// </summary>
+    static const unsigned long long prime = 1099511628211ULL;
+    /// <summary>
+    /// The hash of the numbers added so far
+    /// </summary>
+    unsigned long long key = offsetBasis;
+
+
+public:
+    /// <summary>
+    /// Hash a number into the key one byte at a time.
+    /// </summary>
+    /// <param name="number">The node number or count to add</param>
+    const void Add(int number);
+    /// <summary>
+    /// The key of the numbers added so far, never 0 since 0 marks a line sample whose constructor failed
+    /// </summary>
+    const size_t Key() const;
+};
\ No newline at end of file
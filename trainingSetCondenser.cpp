@@ -0,0 +1,318 @@
+#define _USE_MATH_DEFINES
+
+using namespace std;
+
+#include <cmath>
+#include <exception>
+#include <functional>
+#include <iostream>
+#include <new>
+#include <string>
+#include <vector>
+#include "phasor.h"
+#include "parameter.h"
+#include "nodeSample.h"
+#include "lineSample.h"
+#include "lineFeatureMatrix.h"
+#include "distanceKernel.h"
+#include "nearestNeighbor.h"
+#include "nearestNeighborHeap.h"
+#include "threadPool.h"
+#include "trainingSetCondenser.h"
+
+
+const void trainingSetCondenser::ExtractRow(const lineFeatureMatrix* features, int sampleIndex, double* realParts,
+    double* imaginaryParts)
+{
+    for (int featureIndex = 0; featureIndex < features->NumberOfFeatures; featureIndex++) {
+        realParts[featureIndex] = features->RealColumn(featureIndex)[sampleIndex];
+        imaginaryParts[featureIndex] = features->ImaginaryColumn(featureIndex)[sampleIndex];
+    }
+}
+const bool trainingSetCondenser::PredictWithout(const lineFeatureMatrix* features, const double* realParts,
+    const double* imaginaryParts, int excludedIndex, nearestNeighborHeap* heap, double* squaredDistances)
+{
+    heap->Clear();
+    for (int firstKnownIndex = 0; firstKnownIndex < features->NumberOfSamples; firstKnownIndex += knownSamplesPerBlock) {
+        int numberOfKnownsInBlock = knownSamplesPerBlock;
+        if (features->NumberOfSamples - firstKnownIndex < knownSamplesPerBlock) {
+            numberOfKnownsInBlock = features->NumberOfSamples - firstKnownIndex;
+        }
+        distanceKernel::BoundedSquaredDistances(features, firstKnownIndex, numberOfKnownsInBlock, realParts, imaginaryParts,
+            heap->WorstSquaredDistance(), squaredDistances);
+        for (int blockIndex = 0; blockIndex < numberOfKnownsInBlock; blockIndex++) {
+            if (firstKnownIndex + blockIndex == excludedIndex) continue;
+            if (squaredDistances[blockIndex] > heap->WorstSquaredDistance()) continue;
+            heap->Push(squaredDistances[blockIndex], firstKnownIndex + blockIndex, features->IsWorking(firstKnownIndex + blockIndex));
+        }
+    }
+
+    int numOfWorkingLines = 0;
+    int numOfNotWorkingLines = 0;
+    for (int heapIndex = 0; heapIndex < heap->Size(); heapIndex++) {
+        if (heap->Neighbor(heapIndex).IsWorking == true) numOfWorkingLines += 1;
+        else numOfNotWorkingLines += 1;
+    }
+    return numOfWorkingLines > numOfNotWorkingLines;
+}
+const void trainingSetCondenser::ForEachSample(const function<void(int, nearestNeighborHeap*, double*, double*, double*)>& task)
+{
+    int numberOfChunks = 1;
+    if (pool != NULL) numberOfChunks = pool->NumberOfThreads() * chunksPerThread;
+    if (numberOfChunks > NumberOfSourceSamples) numberOfChunks = NumberOfSourceSamples;
+
+    auto runChunk = [&](int chunkIndex) {
+        int firstSampleIndex = (int)((long long)NumberOfSourceSamples * chunkIndex / numberOfChunks);
+        int lastSampleIndex = (int)((long long)NumberOfSourceSamples * (chunkIndex + 1) / numberOfChunks);
+        nearestNeighborHeap heap(numberOfNearestNeighbors);
+        vector<double> realParts(sourceFeatures->NumberOfFeatures);
+        vector<double> imaginaryParts(sourceFeatures->NumberOfFeatures);
+        vector<double> squaredDistances(knownSamplesPerBlock);
+        for (int sampleIndex = firstSampleIndex; sampleIndex < lastSampleIndex; sampleIndex++) {
+            task(sampleIndex, &heap, realParts.data(), imaginaryParts.data(), squaredDistances.data());
+        }
+    };
+    if ((pool == NULL) || (numberOfChunks <= 1)) runChunk(0);
+    else pool->ParallelFor(numberOfChunks, runChunk);
+}
+const double trainingSetCondenser::LeaveOneOutAccuracy(const lineFeatureMatrix* referenceFeatures,
+    const vector<int>& referenceIndices)
+{
+    vector<char> isCorrect(NumberOfSourceSamples, 0);
+    ForEachSample([&](int sampleIndex, nearestNeighborHeap* heap, double* realParts, double* imaginaryParts,
+        double* squaredDistances) {
+        ExtractRow(sourceFeatures, sampleIndex, realParts, imaginaryParts);
+        bool predictedStatus = PredictWithout(referenceFeatures, realParts, imaginaryParts, referenceIndices[sampleIndex], heap,
+            squaredDistances);
+        isCorrect[sampleIndex] = predictedStatus == sourceFeatures->IsWorking(sampleIndex);
+    });
+
+    int numberOfCorrectPredictions = 0;
+    for (int sampleIndex = 0; sampleIndex < NumberOfSourceSamples; sampleIndex++) numberOfCorrectPredictions += isCorrect[sampleIndex];
+    return (double)numberOfCorrectPredictions / NumberOfSourceSamples;
+}
+const vector<int> trainingSetCondenser::EditedIndices()
+{
+    vector<char> isKept(NumberOfSourceSamples, 0);
+    ForEachSample([&](int sampleIndex, nearestNeighborHeap* heap, double* realParts, double* imaginaryParts,
+        double* squaredDistances) {
+        ExtractRow(sourceFeatures, sampleIndex, realParts, imaginaryParts);
+        bool predictedStatus = PredictWithout(sourceFeatures, realParts, imaginaryParts, sampleIndex, heap, squaredDistances);
+        isKept[sampleIndex] = predictedStatus == sourceFeatures->IsWorking(sampleIndex);
+    });
+
+    vector<int> editedIndices;
+    for (int sampleIndex = 0; sampleIndex < NumberOfSourceSamples; sampleIndex++) {
+        if (isKept[sampleIndex] == 1) editedIndices.push_back(sampleIndex);
+    }
+    return editedIndices;
+}
+const vector<int> trainingSetCondenser::CondensedIndices(const vector<int>& candidateIndices)
+{
+    vector<char> isKept(NumberOfSourceSamples, 0);
+    vector<int> keptIndices;
+    vector<double> realParts(sourceFeatures->NumberOfFeatures);
+    vector<double> imaginaryParts(sourceFeatures->NumberOfFeatures);
+
+    // Start with the first line sample of each status so both are represented
+    bool hasWorkingSample = false;
+    bool hasFailingSample = false;
+    for (int candidateIndex : candidateIndices) {
+        bool isWorking = sourceFeatures->IsWorking(candidateIndex);
+        if (((isWorking == true) && (hasWorkingSample == true)) || ((isWorking == false) && (hasFailingSample == true))) continue;
+        if (isWorking == true) hasWorkingSample = true;
+        else hasFailingSample = true;
+        isKept[candidateIndex] = 1;
+        keptIndices.push_back(candidateIndex);
+    }
+
+    // Keep passing over the candidates until the kept line samples predict every one of them with their k nearest neighbors
+    nearestNeighborHeap heap(numberOfNearestNeighbors);
+    bool isChanged = true;
+    while (isChanged == true) {
+        isChanged = false;
+        for (int candidateIndex : candidateIndices) {
+            if (isKept[candidateIndex] == 1) continue;
+            ExtractRow(sourceFeatures, candidateIndex, realParts.data(), imaginaryParts.data());
+
+            heap.Clear();
+            for (int keptIndex : keptIndices) {
+                double squaredDistance = sourceFeatures->SquaredDistance(keptIndex, realParts.data(), imaginaryParts.data());
+                if (squaredDistance > heap.WorstSquaredDistance()) continue;
+                heap.Push(squaredDistance, keptIndex, sourceFeatures->IsWorking(keptIndex));
+            }
+            int numOfWorkingLines = 0;
+            for (int heapIndex = 0; heapIndex < heap.Size(); heapIndex++) {
+                if (heap.Neighbor(heapIndex).IsWorking == true) numOfWorkingLines += 1;
+            }
+            bool predictedStatus = numOfWorkingLines > heap.Size() - numOfWorkingLines;
+            if (predictedStatus == sourceFeatures->IsWorking(candidateIndex)) continue;
+
+            isKept[candidateIndex] = 1;
+            keptIndices.push_back(candidateIndex);
+            isChanged = true;
+        }
+    }
+
+    vector<int> condensedIndices;
+    for (int candidateIndex : candidateIndices) {
+        if (isKept[candidateIndex] == 1) condensedIndices.push_back(candidateIndex);
+    }
+    return condensedIndices;
+}
+const bool trainingSetCondenser::BuildCondensedFeatures()
+{
+    int numberOfKeptSamples = (int)KeptIndices.size();
+    int numberOfFeatures = sourceFeatures->NumberOfFeatures;
+    int elementsPerAlignment = (int)(lineFeatureMatrix::ColumnAlignment() / sizeof(double));
+    int stride = (numberOfKeptSamples + elementsPerAlignment - 1) / elementsPerAlignment * elementsPerAlignment;
+
+    condensedValues = (double*)::operator new[](2 * (size_t)numberOfFeatures * stride * sizeof(double),
+        align_val_t(lineFeatureMatrix::ColumnAlignment()), nothrow);
+    if (condensedValues == NULL) {
+        MemoryAllocationFailure("condensedValues");
+        return false;
+    }
+    condensedStatuses = new bool[numberOfKeptSamples];
+    if (condensedStatuses == NULL) {
+        MemoryAllocationFailure("condensedStatuses");
+        return false;
+    }
+
+    for (int featureIndex = 0; featureIndex < numberOfFeatures; featureIndex++) {
+        double* realColumn = condensedValues + (size_t)(2 * featureIndex) * stride;
+        double* imaginaryColumn = condensedValues + (size_t)(2 * featureIndex + 1) * stride;
+        for (int keptIndex = 0; keptIndex < stride; keptIndex++) {
+            realColumn[keptIndex] = 0;
+            imaginaryColumn[keptIndex] = 0;
+            if (keptIndex >= numberOfKeptSamples) continue;
+            realColumn[keptIndex] = sourceFeatures->RealColumn(featureIndex)[KeptIndices[keptIndex]];
+            imaginaryColumn[keptIndex] = sourceFeatures->ImaginaryColumn(featureIndex)[KeptIndices[keptIndex]];
+        }
+    }
+    for (int keptIndex = 0; keptIndex < numberOfKeptSamples; keptIndex++) {
+        condensedStatuses[keptIndex] = sourceFeatures->IsWorking(KeptIndices[keptIndex]);
+    }
+
+    condensedFeatures = new lineFeatureMatrix(condensedValues, condensedStatuses, numberOfKeptSamples, stride,
+        sourceFeatures->NumberOfNode1OtherCurrents, sourceFeatures->NumberOfNode2OtherCurrents, sourceFeatures->FeatureWeights,
+        sourceFeatures->StartNodeNumbers, sourceFeatures->DestinationNodeNumbers, sourceFeatures->TopologyKey);
+    if (condensedFeatures == NULL) {
+        MemoryAllocationFailure("condensedFeatures");
+        return false;
+    }
+    return true;
+}
+const void trainingSetCondenser::Condense()
+{
+    NumberOfSourceSamples = sourceFeatures->NumberOfSamples;
+    if (numberOfNearestNeighbors >= NumberOfSourceSamples) {
+        cout << "Error: trainingSetCondenser() needs more line samples than nearest neighbors.\n";
+        return;
+    }
+
+    vector<int> sourceIndices(NumberOfSourceSamples);
+    for (int sampleIndex = 0; sampleIndex < NumberOfSourceSamples; sampleIndex++) sourceIndices[sampleIndex] = sampleIndex;
+    AccuracyBefore = LeaveOneOutAccuracy(sourceFeatures, sourceIndices);
+
+    if (method == condensationMethod::Condensed) KeptIndices = CondensedIndices(sourceIndices);
+    else if (method == condensationMethod::Edited) KeptIndices = EditedIndices();
+    else KeptIndices = CondensedIndices(EditedIndices());
+    if ((int)KeptIndices.size() < numberOfNearestNeighbors) {
+        cout << "Error: trainingSetCondenser() kept fewer line samples than nearest neighbors.\n";
+        KeptIndices.clear();
+        return;
+    }
+    if (BuildCondensedFeatures() == false) return;
+
+    // A kept line sample is left out of its own vote like in the leave-one-out accuracy before
+    vector<int> condensedIndices(NumberOfSourceSamples, -1);
+    for (int keptIndex = 0; keptIndex < (int)KeptIndices.size(); keptIndex++) condensedIndices[KeptIndices[keptIndex]] = keptIndex;
+    AccuracyAfter = LeaveOneOutAccuracy(condensedFeatures, condensedIndices);
+}
+
+
+const void trainingSetCondenser::FreeMemory()
+{
+    if (condensedFeatures != NULL) {
+        delete condensedFeatures;
+        condensedFeatures = NULL;
+    }
+    if (condensedValues != NULL) {
+        ::operator delete[](condensedValues, align_val_t(lineFeatureMatrix::ColumnAlignment()));
+        condensedValues = NULL;
+    }
+    if (condensedStatuses != NULL) {
+        delete[] condensedStatuses;
+        condensedStatuses = NULL;
+    }
+    if ((ownsSourceFeatures == true) && (sourceFeatures != NULL)) {
+        delete sourceFeatures;
+        sourceFeatures = NULL;
+    }
+}
+
+const void trainingSetCondenser::MemoryAllocationFailure(string variableName)
+{
+    cout << "Error: trainingSetCondenser() failed to allocate memory for " << variableName << "\n";
+    FreeMemory();
+}
+
+
+
+trainingSetCondenser::trainingSetCondenser(lineSample** samplesWithKnownStatuses, int numberOfKnownStatuses,
+    condensationMethod method, int numberOfNearestNeighbors, threadPool* pool)
+{
+    this->method = method;
+    this->numberOfNearestNeighbors = numberOfNearestNeighbors;
+    this->pool = pool;
+
+    sourceFeatures = new lineFeatureMatrix(samplesWithKnownStatuses, numberOfKnownStatuses);
+    if (sourceFeatures == NULL) {
+        MemoryAllocationFailure("sourceFeatures");
+        return;
+    }
+    ownsSourceFeatures = true;
+    if (sourceFeatures->NumberOfSamples == 0) return;
+
+    Condense();
+    for (int keptIndex : KeptIndices) CondensedSamples.push_back(samplesWithKnownStatuses[keptIndex]);
+}
+trainingSetCondenser::trainingSetCondenser(lineFeatureMatrix* knownFeatures, condensationMethod method, int numberOfNearestNeighbors,
+    threadPool* pool)
+{
+    this->method = method;
+    this->numberOfNearestNeighbors = numberOfNearestNeighbors;
+    this->pool = pool;
+    sourceFeatures = knownFeatures;
+    if ((knownFeatures == NULL) || (knownFeatures->NumberOfSamples == 0)) {
+        cout << "Error: trainingSetCondenser() needs a feature matrix with at least one line sample.\n";
+        return;
+    }
+
+    Condense();
+}
+
+trainingSetCondenser::~trainingSetCondenser()
+{
+    FreeMemory();
+}
+
+
+lineFeatureMatrix* trainingSetCondenser::CondensedFeatures() const
+{
+    return condensedFeatures;
+}
+const string trainingSetCondenser::MethodName(condensationMethod method)
+{
+    if (method == condensationMethod::Condensed) return "condensed";
+    if (method == condensationMethod::Edited) return "edited";
+    return "editedThenCondensed";
+}
+
+const void trainingSetCondenser::Print() const
+{
+    cout << MethodName(method) << ": " << to_string(KeptIndices.size()) << "/" << to_string(NumberOfSourceSamples) <<
+        " line samples kept, leave-one-out accuracy " << to_string(AccuracyBefore) << " before and " << to_string(AccuracyAfter) <<
+        " after (k = " << to_string(numberOfNearestNeighbors) << ")\n";
+}
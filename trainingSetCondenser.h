@@ -0,0 +1,226 @@
+#pragma once
+
+#define _USE_MATH_DEFINES
+
+using namespace std;
+
+#include <cmath>
+#include <exception>
+#include <functional>
+#include <iostream>
+#include <string>
+#include <vector>
+#include "phasor.h"
+#include "parameter.h"
+#include "nodeSample.h"
+#include "lineSample.h"
+#include "lineFeatureMatrix.h"
+#include "nearestNeighbor.h"
+#include "nearestNeighborHeap.h"
+#include "threadPool.h"
+
+
+/// <summary>
+/// The ways trainingSetCondenser can reduce a training set
+/// </summary>
+enum class condensationMethod {
+    /// <summary>
+    /// Hart's condensed nearest neighbor: keep only the line samples the ones kept so far misclassify with their k nearest
+    /// neighbors, which drops the near-duplicates deep inside each status
+    /// </summary>
+    Condensed,
+    /// <summary>
+    /// Wilson's edited nearest neighbor: drop the line samples their k nearest neighbors misclassify, which removes noisy labels
+    /// near the boundary between the statuses
+    /// </summary>
+    Edited,
+    /// <summary>
+    /// Edit and then condense what is left, so the condensed set isn't padded with noisy labels
+    /// </summary>
+    EditedThenCondensed
+};
+
+
+/// <summary>
+/// An offline reduction of a line's training set to a much smaller set of line samples that predicts nearly the same statuses. The
+/// reduction is done by the constructor, and the kept line samples come out as a feature matrix (and as line samples when built
+/// from line samples) that knnPredictionOfUnknownLineSample takes in place of the full training set.
+/// </summary>
+class trainingSetCondenser {
+private:
+    /// <summary>
+    /// The number of known line samples scored together by distanceKernel
+    /// </summary>
+    static const int knownSamplesPerBlock = 256;
+    /// <summary>
+    /// The number of chunks per thread the line samples are split into when scoring in parallel
+    /// </summary>
+    static const int chunksPerThread = 4;
+    /// <summary>
+    /// The reduction done by the constructor
+    /// </summary>
+    condensationMethod method = condensationMethod::EditedThenCondensed;
+    /// <summary>
+    /// The feature matrix of the full training set
+    /// </summary>
+    lineFeatureMatrix* sourceFeatures = NULL;
+    /// <summary>
+    /// True if sourceFeatures was built by the constructor and is freed with this class
+    /// </summary>
+    bool ownsSourceFeatures = false;
+    /// <summary>
+    /// The number of nearest neighbors of the leave-one-out predictions and of the edit
+    /// </summary>
+    int numberOfNearestNeighbors = 3;
+    /// <summary>
+    /// The threads that score the line samples in parallel (NULL scores on the calling thread)
+    /// </summary>
+    threadPool* pool = NULL;
+    /// <summary>
+    /// The aligned block of the columns of the kept line samples
+    /// </summary>
+    double* condensedValues = NULL;
+    /// <summary>
+    /// The statuses of the kept line samples
+    /// </summary>
+    bool* condensedStatuses = NULL;
+    /// <summary>
+    /// The feature matrix over condensedValues and condensedStatuses
+    /// </summary>
+    lineFeatureMatrix* condensedFeatures = NULL;
+
+
+    /// <summary>
+    /// Copy the features of a line sample in a feature matrix.
+    /// </summary>
+    /// <param name="features">The feature matrix</param>
+    /// <param name="sampleIndex">The index of the line sample</param>
+    /// <param name="realParts">The array of NumberOfFeatures real parts to fill</param>
+    /// <param name="imaginaryParts">The array of NumberOfFeatures imaginary parts to fill</param>
+    static const void ExtractRow(const lineFeatureMatrix* features, int sampleIndex, double* realParts, double* imaginaryParts);
+    /// <summary>
+    /// Predict a status by majority of the k nearest line samples of a feature matrix, leaving one of them out.
+    /// </summary>
+    /// <param name="features">The feature matrix to predict with</param>
+    /// <param name="realParts">The real parts of the features to predict</param>
+    /// <param name="imaginaryParts">The imaginary parts of the features to predict</param>
+    /// <param name="excludedIndex">The index of the line sample to leave out (-1 leaves none out)</param>
+    /// <param name="heap">The heap of the k nearest neighbors to fill</param>
+    /// <param name="squaredDistances">The scratch space for one block of squared distances</param>
+    /// <returns>The predicted status (false in the case of a tie)</returns>
+    static const bool PredictWithout(const lineFeatureMatrix* features, const double* realParts, const double* imaginaryParts,
+        int excludedIndex, nearestNeighborHeap* heap, double* squaredDistances);
+    /// <summary>
+    /// Run a task over every line sample of the full training set in chunks, each with its own scratch space.
+    /// </summary>
+    /// <param name="task">The task taking the sample index, the heap, the real parts, the imaginary parts, and the block scratch</param>
+    const void ForEachSample(const function<void(int, nearestNeighborHeap*, double*, double*, double*)>& task);
+    /// <summary>
+    /// The fraction of the full training set a reference set predicts correctly, leaving each line sample itself out of the vote.
+    /// </summary>
+    /// <param name="referenceFeatures">The feature matrix to predict with</param>
+    /// <param name="referenceIndices">The index of each line sample of the full training set in the reference (-1 if it isn't in it)</param>
+    /// <returns>The leave-one-out accuracy</returns>
+    const double LeaveOneOutAccuracy(const lineFeatureMatrix* referenceFeatures, const vector<int>& referenceIndices);
+    /// <summary>
+    /// Wilson's edit of the full training set
+    /// </summary>
+    /// <returns>The indices of the line samples their k nearest neighbors predict correctly</returns>
+    const vector<int> EditedIndices();
+    /// <summary>
+    /// Hart's condensation of a subset of the full training set
+    /// </summary>
+    /// <param name="candidateIndices">The indices of the line samples to condense in ascending order</param>
+    /// <returns>The indices of the kept line samples in ascending order</returns>
+    const vector<int> CondensedIndices(const vector<int>& candidateIndices);
+    /// <summary>
+    /// Copy the columns of the kept line samples into the condensed feature matrix.
+    /// </summary>
+    /// <returns>True if the memory allocation succeeded</returns>
+    const bool BuildCondensedFeatures();
+    /// <summary>
+    /// Reduce the training set and measure the accuracy before and after.
+    /// </summary>
+    const void Condense();
+
+    /// <summary>
+    /// Free the dynamically allocated memory and set their pointers to NULL. Notice that the line samples aren't freed and
+    /// sourceFeatures is only freed if this class built it.
+    /// </summary>
+    const void FreeMemory();
+
+    /// <summary>
+    /// Display an error message and call FreeMemory().
+    /// </summary>
+    /// <param=variableName>The name of the variable that failed to get memory allocation</param>
+    const void MemoryAllocationFailure(string variableName);
+
+
+public:
+    /// <summary>
+    /// The indices of the kept line samples in the full training set in ascending order
+    /// </summary>
+    vector<int> KeptIndices;
+    /// <summary>
+    /// The kept line samples (empty when constructed from a feature matrix), which are never freed by this class
+    /// </summary>
+    vector<lineSample*> CondensedSamples;
+    /// <summary>
+    /// The number of line samples in the full training set
+    /// </summary>
+    int NumberOfSourceSamples = 0;
+    /// <summary>
+    /// The leave-one-out accuracy of the full training set
+    /// </summary>
+    double AccuracyBefore = 0;
+    /// <summary>
+    /// The fraction of the full training set the kept line samples predict correctly, leaving each line sample itself out
+    /// </summary>
+    double AccuracyAfter = 0;
+
+
+    /// <summary>
+    /// The constructor reduces an array of line samples of the same line.
+    /// </summary>
+    /// <param name="samplesWithKnownStatuses">The array of line samples with known line statuses</param>
+    /// <param name="numberOfKnownStatuses">The number of elements in the samplesWithKnownStatuses array</param>
+    /// <param name="method">The reduction</param>
+    /// <param name="numberOfNearestNeighbors">The number of nearest neighbors of the leave-one-out predictions and of the edit</param>
+    /// <param name="pool">The threads to score the line samples with (NULL scores on the calling thread)</param>
+    explicit trainingSetCondenser(lineSample** samplesWithKnownStatuses, int numberOfKnownStatuses,
+        condensationMethod method = condensationMethod::EditedThenCondensed, int numberOfNearestNeighbors = 3,
+        threadPool* pool = NULL);
+    /// <summary>
+    /// This constructor reduces a previously built feature matrix that won't be freed on the deconstructor.
+    /// </summary>
+    /// <param name="knownFeatures">The feature matrix of the line samples with known line statuses</param>
+    /// <param name="method">The reduction</param>
+    /// <param name="numberOfNearestNeighbors">The number of nearest neighbors of the leave-one-out predictions and of the edit</param>
+    /// <param name="pool">The threads to score the line samples with (NULL scores on the calling thread)</param>
+    explicit trainingSetCondenser(lineFeatureMatrix* knownFeatures,
+        condensationMethod method = condensationMethod::EditedThenCondensed, int numberOfNearestNeighbors = 3,
+        threadPool* pool = NULL);
+
+    /// <summary>
+    /// The deconstructor
+    /// </summary>
+    ~trainingSetCondenser();
+
+
+    /// <summary>
+    /// The feature matrix of the kept line samples, which is freed with this class
+    /// </summary>
+    /// <returns>The condensed feature matrix (NULL if the reduction failed)</returns>
+    lineFeatureMatrix* CondensedFeatures() const;
+    /// <summary>
+    /// The name of a reduction
+    /// </summary>
+    /// <param name="method">The reduction</param>
+    /// <returns>"condensed", "edited", or "editedThenCondensed"</returns>
+    static const string MethodName(condensationMethod method);
+
+    /// <summary>
+    /// Print the size of the training set and the accuracy before and after the reduction.
+    /// </summary>
+    const void Print() const;
+};
@@ -0,0 +1,221 @@
+#define _USE_MATH_DEFINES
+
+using namespace std;
+
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <exception>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <vector>
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+#include "phasor.h"
+#include "parameter.h"
+#include "nodeSample.h"
+#include "lineSample.h"
+#include "distanceWeights.h"
+#include "lineFeatureMatrix.h"
+#include "trainingSetFileHeader.h"
+#include "trainingSetFile.h"
+
+
+const uint64_t trainingSetFile::AlignOffset(uint64_t offset)
+{
+    uint64_t alignment = lineFeatureMatrix::ColumnAlignment();
+    return (offset + alignment - 1) / alignment * alignment;
+}
+const bool trainingSetFile::MapFile(string path)
+{
+#ifdef _WIN32
+    HANDLE file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+    if (file == INVALID_HANDLE_VALUE) return false;
+    LARGE_INTEGER fileSize;
+    if ((GetFileSizeEx(file, &fileSize) == FALSE) || (fileSize.QuadPart == 0)) {
+        CloseHandle(file);
+        return false;
+    }
+    HANDLE fileMapping = CreateFileMappingA(file, NULL, PAGE_READONLY, 0, 0, NULL);
+    CloseHandle(file);
+    if (fileMapping == NULL) return false;
+    mapping = MapViewOfFile(fileMapping, FILE_MAP_READ, 0, 0, 0);
+    CloseHandle(fileMapping);   // The view keeps the mapping alive
+    if (mapping == NULL) return false;
+    mappingBytes = (size_t)fileSize.QuadPart;
+#else
+    int file = open(path.c_str(), O_RDONLY);
+    if (file < 0) return false;
+    struct stat fileStatus;
+    if ((fstat(file, &fileStatus) != 0) || (fileStatus.st_size == 0)) {
+        close(file);
+        return false;
+    }
+    void* pages = mmap(NULL, (size_t)fileStatus.st_size, PROT_READ, MAP_PRIVATE, file, 0);
+    close(file);                // The mapping keeps the file alive
+    if (pages == MAP_FAILED) return false;
+    mapping = pages;
+    mappingBytes = (size_t)fileStatus.st_size;
+#endif
+    return true;
+}
+const bool trainingSetFile::IsSectionInFile(uint64_t offset, uint64_t size) const
+{
+    return (offset <= mappingBytes) && (size <= mappingBytes - offset);
+}
+const bool trainingSetFile::IsValidHeader(const trainingSetFileHeader* header) const
+{
+    if (mappingBytes < sizeof(trainingSetFileHeader)) return false;
+    if (memcmp(header->Magic, "KNNLINE", 8) != 0) return false;
+    if ((header->Version != fileVersion) || (header->ByteOrderMark != 0x01020304)) return false;
+    if ((header->NumberOfSamples <= 0) || (header->Stride < header->NumberOfSamples)) return false;
+    if ((header->NumberOfNode1OtherCurrents < 0) || (header->NumberOfNode1OtherCurrents > maximumNumberOfOtherCurrents) ||
+        (header->NumberOfNode2OtherCurrents < 0) || (header->NumberOfNode2OtherCurrents > maximumNumberOfOtherCurrents)) return false;
+    if (header->NumberOfFeatures != 4 + header->NumberOfNode1OtherCurrents + header->NumberOfNode2OtherCurrents) return false;
+
+    // The sections are read in place as doubles and int32s
+    if (header->ValuesOffset % lineFeatureMatrix::ColumnAlignment() != 0) return false;
+    if ((header->WeightsOffset % sizeof(double) != 0) || (header->NodeNumbersOffset % sizeof(int32_t) != 0)) return false;
+
+    // Every section has to fit in the file
+    uint64_t numberOfFeatures = (uint64_t)header->NumberOfFeatures;
+    if (header->FileBytes != mappingBytes) return false;
+    if (IsSectionInFile(header->WeightsOffset, numberOfFeatures * sizeof(double)) == false) return false;
+    if (IsSectionInFile(header->NodeNumbersOffset, 2 * numberOfFeatures * sizeof(int32_t)) == false) return false;
+    if (IsSectionInFile(header->ValuesOffset, 2 * numberOfFeatures * (uint64_t)header->Stride * sizeof(double)) == false) return false;
+    if (IsSectionInFile(header->StatusesOffset, (uint64_t)header->NumberOfSamples) == false) return false;
+
+    // The statuses are read in place as bools, so any byte other than 0 or 1 is rejected
+    const unsigned char* statuses = (const unsigned char*)mapping + header->StatusesOffset;
+    for (int sampleIndex = 0; sampleIndex < header->NumberOfSamples; sampleIndex++) {
+        if (statuses[sampleIndex] > 1) return false;
+    }
+    return true;
+}
+
+
+const void trainingSetFile::FreeMemory()
+{
+    if (features != NULL) {
+        delete features;
+        features = NULL;
+    }
+    if (mapping != NULL) {
+#ifdef _WIN32
+        UnmapViewOfFile(mapping);
+#else
+        munmap(mapping, mappingBytes);
+#endif
+        mapping = NULL;
+    }
+    mappingBytes = 0;
+}
+
+
+
+trainingSetFile::trainingSetFile(string path)
+{
+    if (MapFile(path) == false) {
+        cout << "Error: trainingSetFile() failed to map " << path << "\n";
+        return;
+    }
+    const trainingSetFileHeader* header = (const trainingSetFileHeader*)mapping;
+    if (IsValidHeader(header) == false) {
+        cout << "Error: trainingSetFile(): " << path << " isn't a valid version " << to_string(fileVersion) << " training set file.\n";
+        FreeMemory();
+        return;
+    }
+
+    const char* file = (const char*)mapping;
+    const int32_t* nodeNumbers = (const int32_t*)(file + header->NodeNumbersOffset);
+    features = new lineFeatureMatrix((const double*)(file + header->ValuesOffset), (const bool*)(file + header->StatusesOffset),
+        header->NumberOfSamples, header->Stride, header->NumberOfNode1OtherCurrents, header->NumberOfNode2OtherCurrents,
+        (const double*)(file + header->WeightsOffset), nodeNumbers, nodeNumbers + header->NumberOfFeatures,
+        (size_t)header->TopologyKey);
+    if (features == NULL) {
+        cout << "Error: trainingSetFile() failed to allocate memory for features\n";
+        FreeMemory();
+        return;
+    }
+    if (features->NumberOfSamples == 0) FreeMemory();
+}
+
+trainingSetFile::~trainingSetFile()
+{
+    FreeMemory();
+}
+
+
+const bool trainingSetFile::Write(const lineFeatureMatrix* features, string path)
+{
+    if ((features == NULL) || (features->NumberOfSamples == 0)) {
+        cout << "Error in trainingSetFile::Write(): there is no feature matrix to write.\n";
+        return false;
+    }
+
+    trainingSetFileHeader header;
+    memset(&header, 0, sizeof(header));
+    memcpy(header.Magic, "KNNLINE", 8);
+    header.Version = fileVersion;
+    header.ByteOrderMark = 0x01020304;
+    header.NumberOfSamples = features->NumberOfSamples;
+    header.Stride = features->Stride;
+    header.NumberOfFeatures = features->NumberOfFeatures;
+    header.NumberOfNode1OtherCurrents = features->NumberOfNode1OtherCurrents;
+    header.NumberOfNode2OtherCurrents = features->NumberOfNode2OtherCurrents;
+    header.TopologyKey = (uint64_t)features->TopologyKey;
+    header.WeightsOffset = AlignOffset(sizeof(trainingSetFileHeader));
+    header.NodeNumbersOffset = AlignOffset(header.WeightsOffset + features->NumberOfFeatures * sizeof(double));
+    header.ValuesOffset = AlignOffset(header.NodeNumbersOffset + 2 * features->NumberOfFeatures * sizeof(int32_t));
+    header.StatusesOffset = header.ValuesOffset + 2 * (uint64_t)features->NumberOfFeatures * features->Stride * sizeof(double);
+    header.FileBytes = header.StatusesOffset + features->NumberOfSamples;
+
+    ofstream file(path, ios::binary | ios::trunc);
+    if (file.is_open() == false) {
+        cout << "Error in trainingSetFile::Write(): failed to open " << path << "\n";
+        return false;
+    }
+    auto padTo = [&file](uint64_t offset) {
+        while ((uint64_t)file.tellp() < offset) file.put(0);
+    };
+
+    file.write((const char*)&header, sizeof(header));
+    padTo(header.WeightsOffset);
+    file.write((const char*)features->FeatureWeights, features->NumberOfFeatures * sizeof(double));
+    padTo(header.NodeNumbersOffset);
+    for (int featureIndex = 0; featureIndex < features->NumberOfFeatures; featureIndex++) {
+        int32_t nodeNumber = features->StartNodeNumbers[featureIndex];
+        file.write((const char*)&nodeNumber, sizeof(nodeNumber));
+    }
+    for (int featureIndex = 0; featureIndex < features->NumberOfFeatures; featureIndex++) {
+        int32_t nodeNumber = features->DestinationNodeNumbers[featureIndex];
+        file.write((const char*)&nodeNumber, sizeof(nodeNumber));
+    }
+    padTo(header.ValuesOffset);
+    for (int featureIndex = 0; featureIndex < features->NumberOfFeatures; featureIndex++) {
+        file.write((const char*)features->RealColumn(featureIndex), (size_t)features->Stride * sizeof(double));
+        file.write((const char*)features->ImaginaryColumn(featureIndex), (size_t)features->Stride * sizeof(double));
+    }
+    vector<char> statuses(features->NumberOfSamples);
+    for (int sampleIndex = 0; sampleIndex < features->NumberOfSamples; sampleIndex++) statuses[sampleIndex] = features->IsWorking(sampleIndex);
+    file.write(statuses.data(), statuses.size());
+
+    file.close();
+    if (file.fail() == true) {
+        cout << "Error in trainingSetFile::Write(): failed to write " << path << "\n";
+        return false;
+    }
+    return true;
+}
+
+lineFeatureMatrix* trainingSetFile::Features() const
+{
+    return features;
+}
\ No newline at end of file
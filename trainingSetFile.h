@@ -0,0 +1,109 @@
+#pragma once
+
+#define _USE_MATH_DEFINES
+
+using namespace std;
+
+#include <cmath>
+#include <cstdint>
+#include <exception>
+#include <iostream>
+#include <string>
+#include "phasor.h"
+#include "parameter.h"
+#include "nodeSample.h"
+#include "lineSample.h"
+#include "distanceWeights.h"
+#include "lineFeatureMatrix.h"
+#include "trainingSetFileHeader.h"
+
+
+/// <summary>
+/// A binary file holding the feature matrix, statuses, and topology key of one line's training set. Opening the file maps it into
+/// memory and the feature matrix reads the value columns straight from the mapped pages, so loading doesn't copy or recompute any
+/// phasor.
+/// </summary>
+class trainingSetFile {
+private:
+    /// <summary>
+    /// The version of the file layout this class writes and reads
+    /// </summary>
+    static const uint32_t fileVersion = 1;
+    /// <summary>
+    /// The most other currents per node a file can hold, which keeps the number of features and the section sizes of a corrupt
+    /// header from overflowing
+    /// </summary>
+    static const int32_t maximumNumberOfOtherCurrents = 1 << 16;
+    /// <summary>
+    /// The start of the mapped file (NULL if the file isn't open)
+    /// </summary>
+    void* mapping = NULL;
+    /// <summary>
+    /// The size of the mapping in bytes
+    /// </summary>
+    size_t mappingBytes = 0;
+    /// <summary>
+    /// The feature matrix over the mapped pages
+    /// </summary>
+    lineFeatureMatrix* features = NULL;
+
+
+    /// <summary>
+    /// Round an offset up to the column alignment of lineFeatureMatrix.
+    /// </summary>
+    /// <param name="offset">The offset in bytes</param>
+    /// <returns>The aligned offset</returns>
+    static const uint64_t AlignOffset(uint64_t offset);
+    /// <summary>
+    /// Map a whole file read-only.
+    /// </summary>
+    /// <param name="path">The path of the file</param>
+    /// <returns>True if the file was mapped</returns>
+    const bool MapFile(string path);
+    /// <summary>
+    /// Check that a section lies inside the mapped file without the offset plus the size wrapping around.
+    /// </summary>
+    /// <param name="offset">The offset of the section in bytes</param>
+    /// <param name="size">The size of the section in bytes</param>
+    /// <returns>True if the section fits in the mapping</returns>
+    const bool IsSectionInFile(uint64_t offset, uint64_t size) const;
+    /// <summary>
+    /// Check the header of the mapped file against the size of the file, the alignment of each section, and the statuses.
+    /// </summary>
+    /// <param name="header">The header at the start of the mapping</param>
+    /// <returns>True if the header describes a valid file of this version</returns>
+    const bool IsValidHeader(const trainingSetFileHeader* header) const;
+
+    /// <summary>
+    /// Free the feature matrix and unmap the file.
+    /// </summary>
+    const void FreeMemory();
+
+
+public:
+    /// <summary>
+    /// The constructor maps the file and builds the feature matrix over it. Check Features() for NULL to see if it succeeded.
+    /// </summary>
+    /// <param name="path">The path of the training set file</param>
+    explicit trainingSetFile(string path);
+
+    /// <summary>
+    /// The deconstructor frees the feature matrix and unmaps the file
+    /// </summary>
+    ~trainingSetFile();
+
+
+    /// <summary>
+    /// Write a feature matrix to a training set file.
+    /// </summary>
+    /// <param name="features">The feature matrix</param>
+    /// <param name="path">The path of the file to create or overwrite</param>
+    /// <returns>True if the file was written</returns>
+    static const bool Write(const lineFeatureMatrix* features, string path);
+
+    /// <summary>
+    /// The feature matrix over the mapped file that stays valid until this class is deconstructed
+    /// </summary>
+    /// <returns>The feature matrix (NULL if the file couldn't be opened or is invalid)</returns>
+    lineFeatureMatrix* Features() const;
+};
\ No newline at end of file
@@ -0,0 +1,71 @@
+#pragma once
+
+#include <cstdint>
+
+/// <summary>
+/// The first bytes of a training set file. Every offset is from the start of the file and the value columns start on the column
+/// alignment of lineFeatureMatrix so they can be scanned in place once the file is mapped.
+/// </summary>
+class trainingSetFileHeader {
+public:
+    /// <summary>
+    /// "KNNLINE" followed by a 0
+    /// </summary>
+    char Magic[8];
+    /// <summary>
+    /// The version of the file layout
+    /// </summary>
+    uint32_t Version;
+    /// <summary>
+    /// 0x01020304 as written by the host, so a file from a host of the other byte order is rejected
+    /// </summary>
+    uint32_t ByteOrderMark;
+    /// <summary>
+    /// The number of line samples
+    /// </summary>
+    int32_t NumberOfSamples;
+    /// <summary>
+    /// The number of elements per column
+    /// </summary>
+    int32_t Stride;
+    /// <summary>
+    /// The number of features per line sample
+    /// </summary>
+    int32_t NumberOfFeatures;
+    /// <summary>
+    /// The number of currents flowing from node 1 not counting the line current
+    /// </summary>
+    int32_t NumberOfNode1OtherCurrents;
+    /// <summary>
+    /// The number of currents flowing from node 2 not counting the line current
+    /// </summary>
+    int32_t NumberOfNode2OtherCurrents;
+    /// <summary>
+    /// Always 0
+    /// </summary>
+    int32_t Reserved;
+    /// <summary>
+    /// The topology key of the line samples
+    /// </summary>
+    uint64_t TopologyKey;
+    /// <summary>
+    /// The offset of the NumberOfFeatures doubles of feature weights
+    /// </summary>
+    uint64_t WeightsOffset;
+    /// <summary>
+    /// The offset of the NumberOfFeatures starting node numbers followed by the NumberOfFeatures destination node numbers (int32)
+    /// </summary>
+    uint64_t NodeNumbersOffset;
+    /// <summary>
+    /// The offset of the 2 * NumberOfFeatures columns of Stride doubles (real then imaginary column of each feature)
+    /// </summary>
+    uint64_t ValuesOffset;
+    /// <summary>
+    /// The offset of the NumberOfSamples status bytes (1 is working)
+    /// </summary>
+    uint64_t StatusesOffset;
+    /// <summary>
+    /// The size of the whole file in bytes
+    /// </summary>
+    uint64_t FileBytes;
+};
\ No newline at end of file
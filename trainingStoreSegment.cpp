@@ -0,0 +1,109 @@
+#define _USE_MATH_DEFINES
+
+using namespace std;
+
+#include <cmath>
+#include <exception>
+#include <iostream>
+#include <memory>
+#include <new>
+#include <string>
+#include "phasor.h"
+#include "parameter.h"
+#include "nodeSample.h"
+#include "lineSample.h"
+#include "lineFeatureMatrix.h"
+#include "trainingStoreSegment.h"
+
+
+const void trainingStoreSegment::FreeMemory()
+{
+    if (values != NULL) {
+        ::operator delete[](values, align_val_t(lineFeatureMatrix::ColumnAlignment()));
+        values = NULL;
+    }
+    if (statuses != NULL) {
+        delete[] statuses;
+        statuses = NULL;
+    }
+    if (timeStamps != NULL) {
+        delete[] timeStamps;
+        timeStamps = NULL;
+    }
+    Capacity = 0;
+}
+
+const void trainingStoreSegment::MemoryAllocationFailure(string variableName)
+{
+    cout << "Error: trainingStoreSegment() failed to allocate memory for " << variableName << "\n";
+    FreeMemory();
+}
+
+
+
+trainingStoreSegment::trainingStoreSegment(const lineFeatureMatrix* layout, int capacity)
+{
+    this->layout = layout;
+    if ((layout == NULL) || (capacity <= 0)) {
+        cout << "Error: trainingStoreSegment() needs the layout of a line and a positive capacity.\n";
+        return;
+    }
+
+    // Round up so every column starts on the column alignment like lineFeatureMatrix
+    int elementsPerAlignment = (int)(lineFeatureMatrix::ColumnAlignment() / sizeof(double));
+    int stride = (capacity + elementsPerAlignment - 1) / elementsPerAlignment * elementsPerAlignment;
+    values = (double*)::operator new[](2 * (size_t)layout->NumberOfFeatures * stride * sizeof(double),
+        align_val_t(lineFeatureMatrix::ColumnAlignment()), nothrow);
+    if (values == NULL) {
+        MemoryAllocationFailure("values");
+        return;
+    }
+    statuses = new bool[stride];
+    if (statuses == NULL) {
+        MemoryAllocationFailure("statuses");
+        return;
+    }
+    timeStamps = new double[stride];
+    if (timeStamps == NULL) {
+        MemoryAllocationFailure("timeStamps");
+        return;
+    }
+    Capacity = stride;
+}
+
+trainingStoreSegment::~trainingStoreSegment()
+{
+    FreeMemory();
+}
+
+
+const void trainingStoreSegment::Write(int slotIndex, const double* realParts, const double* imaginaryParts, bool isWorking,
+    double timeStamp)
+{
+    for (int featureIndex = 0; featureIndex < layout->NumberOfFeatures; featureIndex++) {
+        values[(size_t)(2 * featureIndex) * Capacity + slotIndex] = realParts[featureIndex];
+        values[(size_t)(2 * featureIndex + 1) * Capacity + slotIndex] = imaginaryParts[featureIndex];
+    }
+    statuses[slotIndex] = isWorking;
+    timeStamps[slotIndex] = timeStamp;
+}
+const double trainingStoreSegment::TimeStamp(int slotIndex) const
+{
+    return timeStamps[slotIndex];
+}
+shared_ptr<const lineFeatureMatrix> trainingStoreSegment::Features(int numberOfSamples)
+{
+    if ((values == NULL) || (numberOfSamples <= 0)) return NULL;
+
+    lineFeatureMatrix* features = new lineFeatureMatrix(values, statuses, numberOfSamples, Capacity,
+        layout->NumberOfNode1OtherCurrents, layout->NumberOfNode2OtherCurrents, layout->FeatureWeights, layout->StartNodeNumbers,
+        layout->DestinationNodeNumbers, layout->TopologyKey);
+    if (features == NULL) {
+        cout << "Error: trainingStoreSegment::Features() failed to allocate memory for features\n";
+        return NULL;
+    }
+
+    // The deleter holds the segment so the borrowed columns outlive every matrix over them
+    shared_ptr<trainingStoreSegment> segment = shared_from_this();
+    return shared_ptr<const lineFeatureMatrix>(features, [segment](const lineFeatureMatrix* matrix) { delete matrix; });
+}
\ No newline at end of file
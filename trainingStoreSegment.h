@@ -0,0 +1,100 @@
+#pragma once
+
+#define _USE_MATH_DEFINES
+
+using namespace std;
+
+#include <cmath>
+#include <exception>
+#include <iostream>
+#include <memory>
+#include <new>
+#include <string>
+#include "phasor.h"
+#include "parameter.h"
+#include "nodeSample.h"
+#include "lineSample.h"
+#include "lineFeatureMatrix.h"
+
+
+/// <summary>
+/// A fixed capacity block of labeled line samples of one line in the column layout of lineFeatureMatrix. The slots are written
+/// once in order by the writer of an onlineTrainingStore, and readers only see the slots that were published before them, so a
+/// slot is never read while it's written.
+/// </summary>
+class trainingStoreSegment : public enable_shared_from_this<trainingStoreSegment> {
+private:
+    /// <summary>
+    /// The aligned block holding every column (2 * NumberOfFeatures columns of 'Capacity' elements)
+    /// </summary>
+    double* values = NULL;
+    /// <summary>
+    /// The statuses of the line samples
+    /// </summary>
+    bool* statuses = NULL;
+    /// <summary>
+    /// The time stamp each line sample was appended with
+    /// </summary>
+    double* timeStamps = NULL;
+    /// <summary>
+    /// The feature matrix the layout (features, weights, node numbers, and topology key) is copied from
+    /// </summary>
+    const lineFeatureMatrix* layout = NULL;
+
+
+    /// <summary>
+    /// Free the dynamically allocated memory and set their pointers to NULL.
+    /// </summary>
+    const void FreeMemory();
+
+    /// <summary>
+    /// Display an error message and call FreeMemory().
+    /// </summary>
+    /// <param=variableName>The name of the variable that failed to get memory allocation</param>
+    const void MemoryAllocationFailure(string variableName);
+
+
+public:
+    /// <summary>
+    /// The number of line samples the segment holds (a multiple of the column alignment in elements)
+    /// </summary>
+    int Capacity = 0;
+
+
+    /// <summary>
+    /// The constructor
+    /// </summary>
+    /// <param name="layout">The feature matrix with the layout of the line (it has to outlive the segment)</param>
+    /// <param name="capacity">The number of line samples the segment holds</param>
+    explicit trainingStoreSegment(const lineFeatureMatrix* layout, int capacity);
+
+    /// <summary>
+    /// The deconstructor
+    /// </summary>
+    ~trainingStoreSegment();
+
+    trainingStoreSegment(const trainingStoreSegment&) = delete;
+    trainingStoreSegment& operator=(const trainingStoreSegment&) = delete;
+
+
+    /// <summary>
+    /// Write a line sample's features into a slot that no reader has been given yet.
+    /// </summary>
+    /// <param name="slotIndex">The index of the slot</param>
+    /// <param name="realParts">The real parts of the features from lineFeatureMatrix::ExtractFeatures()</param>
+    /// <param name="imaginaryParts">The imaginary parts of the features from lineFeatureMatrix::ExtractFeatures()</param>
+    /// <param name="isWorking">The status of the line</param>
+    /// <param name="timeStamp">The time the line sample was labeled</param>
+    const void Write(int slotIndex, const double* realParts, const double* imaginaryParts, bool isWorking, double timeStamp);
+    /// <summary>
+    /// The time stamp of a slot
+    /// </summary>
+    /// <param name="slotIndex">The index of the slot</param>
+    const double TimeStamp(int slotIndex) const;
+    /// <summary>
+    /// A feature matrix borrowing the first slots of the segment. The matrix keeps the segment alive, so it can outlive the store.
+    /// </summary>
+    /// <param name="numberOfSamples">The number of slots the matrix covers</param>
+    /// <returns>The feature matrix or NULL if the segment failed to allocate</returns>
+    shared_ptr<const lineFeatureMatrix> Features(int numberOfSamples);
+};
\ No newline at end of file
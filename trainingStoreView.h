@@ -0,0 +1,58 @@
+#pragma once
+
+#define _USE_MATH_DEFINES
+
+using namespace std;
+
+#include <cmath>
+#include <exception>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <vector>
+#include "lineFeatureMatrix.h"
+
+
+/// <summary>
+/// One published state of an onlineTrainingStore. A view never changes once it's published, so a reader can scan it for as long
+/// as it holds it while the writer appends and evicts into newer views. Consecutive views share the list of full segments until a
+/// segment fills or is evicted.
+/// </summary>
+class trainingStoreView {
+public:
+    /// <summary>
+    /// The feature matrices of the full segments from oldest to newest
+    /// </summary>
+    shared_ptr<const vector<shared_ptr<const lineFeatureMatrix>>> FullSegments;
+    /// <summary>
+    /// The feature matrix of the filled slots of the segment being appended to (NULL if it's empty)
+    /// </summary>
+    shared_ptr<const lineFeatureMatrix> LastSegment;
+    /// <summary>
+    /// The number of evicted line samples at the start of the oldest segment
+    /// </summary>
+    int FirstSampleIndex = 0;
+    /// <summary>
+    /// The number of line samples in the view
+    /// </summary>
+    int NumberOfSamples = 0;
+
+
+    /// <summary>
+    /// The feature matrix of a segment in the view from oldest to newest
+    /// </summary>
+    /// <param name="segmentIndex">The index of the segment between 0 and NumberOfSegments() - 1</param>
+    const lineFeatureMatrix* Segment(int segmentIndex) const
+    {
+        int numberOfFullSegments = (FullSegments == NULL) ? 0 : (int)FullSegments->size();
+        if (segmentIndex < numberOfFullSegments) return (*FullSegments)[segmentIndex].get();
+        return LastSegment.get();
+    }
+    /// <summary>
+    /// The number of segments in the view
+    /// </summary>
+    const int NumberOfSegments() const
+    {
+        return ((FullSegments == NULL) ? 0 : (int)FullSegments->size()) + ((LastSegment == NULL) ? 0 : 1);
+    }
+};
\ No newline at end of file
@@ -0,0 +1,178 @@
+#define _USE_MATH_DEFINES
+
+using namespace std;
+
+#include <cmath>
+#include <exception>
+#include <iostream>
+#include <string>
+#include "instantaneousMeasurement.h"
+#include "waveform.h"
+
+
+const bool waveform::StoreValues(const double* values, int valueStride)
+{
+    if (storage == waveformStorage::Float64) {
+        float64Values = new double[numberOfSamples];
+        if (float64Values == NULL) {
+            MemoryAllocationFailure("float64Values");
+            return false;
+        }
+        for (int sampleIndex = 0; sampleIndex < numberOfSamples; sampleIndex++) {
+            float64Values[sampleIndex] = values[(size_t)sampleIndex * valueStride];
+        }
+    }
+    else if (storage == waveformStorage::Float32) {
+        float32Values = new float[numberOfSamples];
+        if (float32Values == NULL) {
+            MemoryAllocationFailure("float32Values");
+            return false;
+        }
+        for (int sampleIndex = 0; sampleIndex < numberOfSamples; sampleIndex++) {
+            float32Values[sampleIndex] = (float)values[(size_t)sampleIndex * valueStride];
+        }
+    }
+    else {
+        int16Values = new short[numberOfSamples];
+        if (int16Values == NULL) {
+            MemoryAllocationFailure("int16Values");
+            return false;
+        }
+
+        // The largest magnitude maps to the largest int16 value
+        double largestMagnitude = 0;
+        for (int sampleIndex = 0; sampleIndex < numberOfSamples; sampleIndex++) {
+            largestMagnitude = fmax(largestMagnitude, fabs(values[(size_t)sampleIndex * valueStride]));
+        }
+        scale = 1;
+        if (largestMagnitude > 0) scale = largestMagnitude / 32767;
+        for (int sampleIndex = 0; sampleIndex < numberOfSamples; sampleIndex++) {
+            int16Values[sampleIndex] = (short)lround(values[(size_t)sampleIndex * valueStride] / scale);
+        }
+    }
+    return true;
+}
+
+
+const void waveform::FreeMemory()
+{
+    if (timeStamps != NULL) {
+        delete[] timeStamps;
+        timeStamps = NULL;
+    }
+    if (float64Values != NULL) {
+        delete[] float64Values;
+        float64Values = NULL;
+    }
+    if (float32Values != NULL) {
+        delete[] float32Values;
+        float32Values = NULL;
+    }
+    if (int16Values != NULL) {
+        delete[] int16Values;
+        int16Values = NULL;
+    }
+    numberOfSamples = 0;
+}
+
+const void waveform::MemoryAllocationFailure(string variableName)
+{
+    cout << "Error: waveform() failed to allocate memory for " << variableName << "\n";
+    FreeMemory();
+}
+
+
+
+waveform::waveform(const double* values, int numberOfSamples, double samplesPerSecond, double startTime, waveformStorage storage)
+{
+    if ((values == NULL) || (numberOfSamples <= 0) || (samplesPerSecond <= 0)) {
+        cout << "Error: waveform() needs at least one value and a positive sample rate.\n";
+        return;
+    }
+    this->numberOfSamples = numberOfSamples;
+    this->samplesPerSecond = samplesPerSecond;
+    this->startTime = startTime;
+    this->storage = storage;
+    StoreValues(values, 1);
+}
+waveform::waveform(const instantaneousMeasurement* samples, int numberOfSamples, waveformStorage storage)
+{
+    if ((samples == NULL) || (numberOfSamples <= 0)) {
+        cout << "Error: waveform() needs at least one instantaneous measurement.\n";
+        return;
+    }
+    this->numberOfSamples = numberOfSamples;
+    this->storage = storage;
+
+    // Drop the time stamps if every one is within a millionth of a sample period of the evenly spaced time
+    bool isUniform = numberOfSamples > 1;
+    double samplePeriod = 0;
+    if (isUniform == true) {
+        samplePeriod = (samples[numberOfSamples - 1].timeStamp - samples[0].timeStamp) / (numberOfSamples - 1);
+        if (samplePeriod <= 0) isUniform = false;
+    }
+    for (int sampleIndex = 1; (isUniform == true) && (sampleIndex < numberOfSamples - 1); sampleIndex++) {
+        double evenlySpacedTime = samples[0].timeStamp + sampleIndex * samplePeriod;
+        if (fabs(samples[sampleIndex].timeStamp - evenlySpacedTime) > 1e-6 * samplePeriod) isUniform = false;
+    }
+
+    if (isUniform == true) {
+        startTime = samples[0].timeStamp;
+        samplesPerSecond = 1 / samplePeriod;
+    }
+    else {
+        timeStamps = new double[numberOfSamples];
+        if (timeStamps == NULL) {
+            MemoryAllocationFailure("timeStamps");
+            return;
+        }
+        for (int sampleIndex = 0; sampleIndex < numberOfSamples; sampleIndex++) timeStamps[sampleIndex] = samples[sampleIndex].timeStamp;
+    }
+
+    // The values are read in place from the array of {timeStamp, value}
+    StoreValues(&samples[0].value, (int)(sizeof(instantaneousMeasurement) / sizeof(double)));
+}
+
+waveform::~waveform()
+{
+    FreeMemory();
+}
+
+
+const int waveform::NumberOfSamples() const
+{
+    return numberOfSamples;
+}
+const double waveform::Value(int sampleIndex) const
+{
+    if (float64Values != NULL) return float64Values[sampleIndex];
+    if (float32Values != NULL) return (double)float32Values[sampleIndex];
+    return scale * int16Values[sampleIndex];
+}
+const double waveform::TimeStamp(int sampleIndex) const
+{
+    if (timeStamps != NULL) return timeStamps[sampleIndex];
+    return startTime + sampleIndex / samplesPerSecond;
+}
+const bool waveform::IsUniform() const
+{
+    return timeStamps == NULL;
+}
+const double waveform::SamplesPerSecond() const
+{
+    return samplesPerSecond;
+}
+const waveformStorage waveform::Storage() const
+{
+    return storage;
+}
+const size_t waveform::MemoryBytes() const
+{
+    size_t bytesPerValue = sizeof(double);
+    if (storage == waveformStorage::Float32) bytesPerValue = sizeof(float);
+    else if (storage == waveformStorage::Int16) bytesPerValue = sizeof(short);
+
+    size_t memoryBytes = bytesPerValue * numberOfSamples;
+    if (timeStamps != NULL) memoryBytes += sizeof(double) * numberOfSamples;
+    return memoryBytes;
+}
\ No newline at end of file
@@ -0,0 +1,152 @@
+#pragma once
+
+#define _USE_MATH_DEFINES
+
+using namespace std;
+
+#include <cmath>
+#include <exception>
+#include <iostream>
+#include <string>
+#include "instantaneousMeasurement.h"
+
+
+/// <summary>
+/// How the values of a waveform are stored
+/// </summary>
+enum class waveformStorage {
+    /// <summary>
+    /// 8 bytes per value with no loss
+    /// </summary>
+    Float64,
+    /// <summary>
+    /// 4 bytes per value rounded to single precision
+    /// </summary>
+    Float32,
+    /// <summary>
+    /// 2 bytes per value quantized with the per-channel scale (value = scale * stored value)
+    /// </summary>
+    Int16
+};
+
+
+/// <summary>
+/// The samples of one channel stored as a single column of values. A uniformly sampled channel only keeps its start time and
+/// sample rate instead of a time stamp per sample, and the values can be stored as float32 or as int16 with a per-channel scale.
+/// </summary>
+class waveform {
+private:
+    /// <summary>
+    /// The number of samples
+    /// </summary>
+    int numberOfSamples = 0;
+    /// <summary>
+    /// How the values are stored
+    /// </summary>
+    waveformStorage storage = waveformStorage::Float64;
+    /// <summary>
+    /// The value of one step of an int16 value (1 for the other storages)
+    /// </summary>
+    double scale = 1;
+    /// <summary>
+    /// The time of the first sample in seconds for a uniformly sampled channel
+    /// </summary>
+    double startTime = 0;
+    /// <summary>
+    /// The number of samples per second for a uniformly sampled channel (0 when the time stamps are explicit)
+    /// </summary>
+    double samplesPerSecond = 0;
+    /// <summary>
+    /// The time stamp of every sample in seconds when the channel isn't uniformly sampled (NULL otherwise)
+    /// </summary>
+    double* timeStamps = NULL;
+    /// <summary>
+    /// The values when stored as float64
+    /// </summary>
+    double* float64Values = NULL;
+    /// <summary>
+    /// The values when stored as float32
+    /// </summary>
+    float* float32Values = NULL;
+    /// <summary>
+    /// The values when stored as int16
+    /// </summary>
+    short* int16Values = NULL;
+
+
+    /// <summary>
+    /// Allocate and fill the value column in the storage format.
+    /// </summary>
+    /// <param name="values">The values in base units (read with the stride)</param>
+    /// <param name="valueStride">The number of doubles between consecutive values</param>
+    /// <returns>True if the memory allocation succeeded</returns>
+    const bool StoreValues(const double* values, int valueStride);
+
+    /// <summary>
+    /// Free the dynamically allocated memory and set their pointers to NULL.
+    /// </summary>
+    const void FreeMemory();
+
+    /// <summary>
+    /// Display an error message and call FreeMemory().
+    /// </summary>
+    /// <param=variableName>The name of the variable that failed to get memory allocation</param>
+    const void MemoryAllocationFailure(string variableName);
+
+
+public:
+    /// <summary>
+    /// The constructor for a uniformly sampled channel
+    /// </summary>
+    /// <param name="values">The array of values in base units</param>
+    /// <param name="numberOfSamples">The number of elements in the values array</param>
+    /// <param name="samplesPerSecond">The sample rate</param>
+    /// <param name="startTime">The time of the first sample in seconds</param>
+    /// <param name="storage">How the values are stored</param>
+    explicit waveform(const double* values, int numberOfSamples, double samplesPerSecond, double startTime = 0,
+        waveformStorage storage = waveformStorage::Float64);
+    /// <summary>
+    /// The constructor for an array of instantaneous measurements. The time stamps are dropped if they are evenly spaced and kept
+    /// otherwise.
+    /// </summary>
+    /// <param name="samples">The array of instantaneous measurements</param>
+    /// <param name="numberOfSamples">The number of elements in the samples array</param>
+    /// <param name="storage">How the values are stored</param>
+    explicit waveform(const instantaneousMeasurement* samples, int numberOfSamples, waveformStorage storage = waveformStorage::Float64);
+    /// <summary>
+    /// The deconstructor
+    /// </summary>
+    ~waveform();
+
+
+    /// <summary>
+    /// The number of samples
+    /// </summary>
+    const int NumberOfSamples() const;
+    /// <summary>
+    /// The value of a sample in base units
+    /// </summary>
+    /// <param name="sampleIndex">The index of the sample</param>
+    const double Value(int sampleIndex) const;
+    /// <summary>
+    /// The time stamp of a sample in seconds
+    /// </summary>
+    /// <param name="sampleIndex">The index of the sample</param>
+    const double TimeStamp(int sampleIndex) const;
+    /// <summary>
+    /// True if the time stamps are implied by the start time and the sample rate
+    /// </summary>
+    const bool IsUniform() const;
+    /// <summary>
+    /// The sample rate of a uniformly sampled channel (0 when the time stamps are explicit)
+    /// </summary>
+    const double SamplesPerSecond() const;
+    /// <summary>
+    /// How the values are stored
+    /// </summary>
+    const waveformStorage Storage() const;
+    /// <summary>
+    /// The number of bytes the value and time stamp columns take
+    /// </summary>
+    const size_t MemoryBytes() const;
+};
\ No newline at end of file